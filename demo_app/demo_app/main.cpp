@@ -44,16 +44,21 @@ int main() {
 
         // rendering
         {"BUFFER", util::Logger::Level::info},
+        {"BUFFER_GEOMETRY", util::Logger::Level::info},
         {"BUFFER_MAPPED", util::Logger::Level::info},
         {"BUFFER_IMAGE", util::Logger::Level::info},
         {"BUFFER_STAGED", util::Logger::Level::info},
+        {"BUFFER_UPLOAD", util::Logger::Level::info},
         {"CONTEXT", util::Logger::Level::info},
         {"CUBEMAP", util::Logger::Level::info},
+        {"CULLING", util::Logger::Level::info},
         {"DEPTHBUFFER", util::Logger::Level::info},
         {"DEVICE", util::Logger::Level::info},
+        {"DRAW_PACKET", util::Logger::Level::info},
         {"IMAGE", util::Logger::Level::info},
         {"INSTANCE", util::Logger::Level::info},
         {"MATERIAL", util::Logger::Level::info},
+        {"MEMORY", util::Logger::Level::info},
         {"MODEL", util::Logger::Level::info},
         {"MODEL_MESH", util::Logger::Level::info},
         {"MODEL_PRIMITIVE", util::Logger::Level::info},
@@ -131,7 +136,10 @@ int main() {
         APPLICATION_PATCH_VERSION,
         800,
         600,
-        validationLayersEnabled
+        validationLayersEnabled,
+        2,
+        0,
+        vk::PresentModeKHR::eMailbox
     );
 
     try {
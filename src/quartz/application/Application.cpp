@@ -1,8 +1,10 @@
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include <GLFW/glfw3.h>
 
+#include "util/allocation_counter/AllocationCounter.hpp"
 #include "util/file_system/FileSystem.hpp"
 
 #include "quartz/Loggers.hpp"
@@ -22,7 +24,10 @@ quartz::Application::Application(
     const uint32_t applicationPatchVersion,
     const uint32_t windowWidthPixels,
     const uint32_t windowHeightPixels,
-    const bool validationLayersEnabled
+    const bool validationLayersEnabled,
+    const uint32_t maxNumFramesInFlight,
+    const uint32_t desiredSwapchainImageCount,
+    const vk::PresentModeKHR desiredPresentMode
 ) :
     m_applicationName(applicationName),
     m_majorVersion(applicationMajorVersion),
@@ -35,7 +40,10 @@ quartz::Application::Application(
         m_patchVersion,
         windowWidthPixels,
         windowHeightPixels,
-        validationLayersEnabled
+        validationLayersEnabled,
+        maxNumFramesInFlight,
+        desiredSwapchainImageCount,
+        desiredPresentMode
     ),
     mp_inputManager(quartz::managers::InputManager::getPtr(
         m_renderingContext.getRenderingWindow().getGLFWwindowPtr()
@@ -154,8 +162,19 @@ void quartz::Application::run() {
     );
     m_renderingContext.loadScene(m_scene);
 
+    uint32_t numFramesSinceWarmUpStarted = 0;
+    uint64_t numSwapchainRecreations = m_renderingContext.getNumSwapchainRecreations();
+    if (util::AllocationCounter::getIsCounting()) {
+        LOG_INFOthis("Counting allocations, frames after the first {} may not allocate", quartz::Application::numAllocationWarmUpFrames);
+    }
+
     LOG_INFOthis("Beginning main loop");
     while(!m_shouldQuit) {
+        // Wait for the frame before sampling input instead of after, so what we draw is as fresh as possible
+        if (m_renderingContext.getShouldMinimizeLatency()) {
+            m_renderingContext.waitForInFlightFrame();
+        }
+
         currentFrameStartTime = glfwGetTime();
         currentFrameTimeDelta = currentFrameStartTime - previousFrameStartTime;
         previousFrameStartTime = currentFrameStartTime;
@@ -172,7 +191,21 @@ void quartz::Application::run() {
             frameTimeAccumulator -= targetTickTimeDelta;
         }
 
+        const uint64_t numAllocationsBeforeDraw = util::AllocationCounter::getNumAllocations();
         m_renderingContext.draw(m_scene);
+        const uint64_t numAllocationsDuringDraw = util::AllocationCounter::getNumAllocations() - numAllocationsBeforeDraw;
+
+        /**
+         * @brief Recreating the swapchain is allowed to allocate, so start warming up again whenever it happens
+         */
+        if (numSwapchainRecreations != m_renderingContext.getNumSwapchainRecreations()) {
+            numSwapchainRecreations = m_renderingContext.getNumSwapchainRecreations();
+            numFramesSinceWarmUpStarted = 0;
+        } else if (numFramesSinceWarmUpStarted < quartz::Application::numAllocationWarmUpFrames) {
+            ++numFramesSinceWarmUpStarted;
+        } else if (numAllocationsDuringDraw > 0) {
+            LOG_THROWthis(std::runtime_error, "Drew a steady state frame which made {} heap allocations", numAllocationsDuringDraw);
+        }
     }
 
     LOG_INFOthis("Finishing");
@@ -24,14 +24,31 @@ public: // member functions
         const uint32_t applicationPatchVersion,
         const uint32_t windowWidthPixels,
         const uint32_t windowHeightPixels,
-        const bool validationLayersEnabled
+        const bool validationLayersEnabled,
+        const uint32_t maxNumFramesInFlight,
+        const uint32_t desiredSwapchainImageCount,
+        const vk::PresentModeKHR desiredPresentMode
     );
     ~Application();
 
     USE_LOGGER(APPLICATION);
 
+    /**
+     * @brief These can all be changed while running, see the rendering context for when they take effect
+     */
+    void setDesiredSwapchainImageCount(const uint32_t desiredSwapchainImageCount) { m_renderingContext.setDesiredSwapchainImageCount(desiredSwapchainImageCount); }
+    void setDesiredPresentMode(const vk::PresentModeKHR desiredPresentMode) { m_renderingContext.setDesiredPresentMode(desiredPresentMode); }
+    void setShouldMinimizeLatency(const bool shouldMinimizeLatency) { m_renderingContext.setShouldMinimizeLatency(shouldMinimizeLatency); }
+
     void run();
 
+public: // static variables
+    /**
+     * @brief When counting allocations, frames drawn after this many frames (since the last time the
+     *   swapchain was recreated) are not allowed to allocate
+     */
+    static constexpr uint32_t numAllocationWarmUpFrames = 16;
+
 private: // member functions
     void processInput();
 
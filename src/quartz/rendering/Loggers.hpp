@@ -3,16 +3,21 @@
 #include "util/logger/Logger.hpp"
 
 DECLARE_LOGGER(BUFFER, trace);
+DECLARE_LOGGER(BUFFER_GEOMETRY, trace);
 DECLARE_LOGGER(BUFFER_MAPPED, trace);
 DECLARE_LOGGER(BUFFER_STAGED, trace);
 DECLARE_LOGGER(BUFFER_IMAGE, trace);
+DECLARE_LOGGER(BUFFER_UPLOAD, trace);
 DECLARE_LOGGER(CONTEXT, trace);
 DECLARE_LOGGER(CUBEMAP, trace);
+DECLARE_LOGGER(CULLING, trace);
 DECLARE_LOGGER(DEPTHBUFFER, trace);
 DECLARE_LOGGER(DEVICE, trace);
+DECLARE_LOGGER(DRAW_PACKET, trace);
 DECLARE_LOGGER(IMAGE, trace);
 DECLARE_LOGGER(INSTANCE, trace);
 DECLARE_LOGGER(MATERIAL, trace);
+DECLARE_LOGGER(MEMORY, trace);
 DECLARE_LOGGER(MODEL, trace);
 DECLARE_LOGGER(MODEL_MESH, trace);
 DECLARE_LOGGER(MODEL_NODE, trace);
@@ -28,18 +33,23 @@ DECLARE_LOGGER(WINDOW, trace);
 
 DECLARE_LOGGER_GROUP(
         QUARTZ_RENDERING,
-        23,
+        28,
         BUFFER,
+        BUFFER_GEOMETRY,
         BUFFER_MAPPED,
         BUFFER_STAGED,
         BUFFER_IMAGE,
+        BUFFER_UPLOAD,
         CONTEXT,
         CUBEMAP,
+        CULLING,
         DEPTHBUFFER,
         DEVICE,
+        DRAW_PACKET,
         IMAGE,
         INSTANCE,
         MATERIAL,
+        MEMORY,
         MODEL,
         MODEL_MESH,
         MODEL_PRIMITIVE,
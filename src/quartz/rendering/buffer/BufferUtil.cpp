@@ -70,153 +70,36 @@ quartz::rendering::BufferUtil::createVulkanBufferPtr(
     return p_buffer;
 }
 
-uint32_t
-quartz::rendering::BufferUtil::chooseMemoryTypeIndex(
-    const vk::PhysicalDevice& physicalDevice,
+quartz::rendering::MemoryAllocator::Allocation
+quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemory(
+    const quartz::rendering::Device& renderingDevice,
+    const vk::UniqueBuffer& p_logicalBuffer,
     const vk::MemoryPropertyFlags requiredMemoryProperties,
-    const vk::MemoryRequirements& memoryRequirements
+    const vk::MemoryPropertyFlags preferredMemoryProperties
 ) {
     LOG_FUNCTION_SCOPE_TRACE(BUFFER, "");
 
-    vk::PhysicalDeviceMemoryProperties physicalDeviceMemoryProperties = physicalDevice.getMemoryProperties();
-
-    std::optional<uint32_t> chosenMemoryTypeIndex;
-    for (uint32_t i = 0; i < physicalDeviceMemoryProperties.memoryTypeCount; ++i) {
-        if (
-            (memoryRequirements.memoryTypeBits & (1 << i)) &&
-            physicalDeviceMemoryProperties.memoryTypes[i].propertyFlags & requiredMemoryProperties
-        ) {
-            chosenMemoryTypeIndex = i;
-            break;
-        }
-    }
-    if (!chosenMemoryTypeIndex.has_value()) {
-        LOG_THROW(BUFFER, util::VulkanFeatureNotSupportedError, "Failed to find a suitable memory type");
-    }
-
-    return chosenMemoryTypeIndex.value();
-}
-
-
-vk::UniqueDeviceMemory
-quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemoryPtr(
-    const vk::PhysicalDevice& physicalDevice,
-    const vk::UniqueDevice& p_logicalDevice,
-    UNUSED const uint32_t sizeBytes, /** @todo 2024/04/23 Do we need this parameter? Are we getting the size correctly from mem requirements? */
-    const vk::UniqueBuffer& p_logicalBuffer,
-    const vk::MemoryPropertyFlags requiredMemoryProperties
-) {
-    LOG_FUNCTION_SCOPE_TRACE(BUFFER, "{} bytes", sizeBytes);
+    const vk::UniqueDevice& p_logicalDevice = renderingDevice.getVulkanLogicalDevicePtr();
 
     vk::MemoryRequirements memoryRequirements = p_logicalDevice->getBufferMemoryRequirements(*p_logicalBuffer);
 
-    uint32_t chosenMemoryTypeIndex = quartz::rendering::BufferUtil::chooseMemoryTypeIndex(
-        physicalDevice,
+    LOG_TRACE(BUFFER, "Attempting to allocate {} bytes of device memory", memoryRequirements.size);
+    quartz::rendering::MemoryAllocator::Allocation allocation = renderingDevice.getMemoryAllocator().allocate(
+        memoryRequirements,
         requiredMemoryProperties,
-        memoryRequirements
+        preferredMemoryProperties,
+        true
     );
-
-    vk::MemoryAllocateInfo memoryAllocateInfo(
-        memoryRequirements.size,
-        chosenMemoryTypeIndex
-    );
-
-    LOG_TRACE(BUFFER, "Attempting to allocate vk::DeviceMemory");
-    vk::UniqueDeviceMemory p_logicalBufferPhysicalMemory = p_logicalDevice->allocateMemoryUnique(memoryAllocateInfo);
-
-    if (!p_logicalBufferPhysicalMemory) {
-        LOG_THROW(BUFFER, util::VulkanCreationFailedError, "Failed to allocated vk::DeviceMemory");
-    }
-    LOG_TRACE(BUFFER, "Successfully allocated vk::DeviceMemory instance at {}", static_cast<void*>(&(*p_logicalBufferPhysicalMemory)));
+    LOG_TRACE(BUFFER, "Successfully allocated {} bytes at offset {} of vk::DeviceMemory", allocation.getSizeBytes(), allocation.getOffsetBytes());
 
     LOG_TRACE(BUFFER, "Binding memory to logical device");
     p_logicalDevice->bindBufferMemory(
         *p_logicalBuffer,
-        *p_logicalBufferPhysicalMemory,
-        0
+        allocation.getVulkanDeviceMemory(),
+        allocation.getOffsetBytes()
     );
 
-    return p_logicalBufferPhysicalMemory;
-}
-
-void
-quartz::rendering::BufferUtil::populateVulkanPhysicalDeviceMemoryWithLocalData(
-    const vk::UniqueDevice& p_logicalDevice,
-    const uint32_t sizeBytes,
-    const void* p_bufferData,
-    vk::UniqueDeviceMemory& p_physicalMemory
-) {
-    LOG_FUNCTION_SCOPE_TRACE(BUFFER, "{} bytes", sizeBytes);
-
-    LOG_TRACE(BUFFER, "Memory *IS* allocated for a source buffer. Populating device's buffer memory with input raw data");
-
-    LOG_TRACE(BUFFER, "  - Creating mapping for allocated device memory of size {}", sizeBytes);
-    void* p_mappedDestinationDeviceMemory = p_logicalDevice->mapMemory(
-        *p_physicalMemory,
-        0,
-        sizeBytes
-    );
-
-    LOG_TRACE(BUFFER, "  - Copying {} bytes to mapped device memory at {} from buffer at {}", sizeBytes, p_mappedDestinationDeviceMemory, p_bufferData);
-    memcpy(
-        p_mappedDestinationDeviceMemory,
-        p_bufferData,
-        sizeBytes
-    );
-
-    LOG_TRACE(BUFFER, "  - Unmapping device memory");
-    p_logicalDevice->unmapMemory(*p_physicalMemory);
-
-    LOG_TRACE(BUFFER, "Successfully copied input data to device buffer memory");
-}
-
-vk::UniqueDeviceMemory
-quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceStagingMemoryPtr(
-    const vk::PhysicalDevice& physicalDevice,
-    const vk::UniqueDevice& p_logicalDevice,
-    const uint32_t sizeBytes,
-    const void* p_bufferData,
-    const vk::UniqueBuffer& p_logicalBuffer,
-    const vk::MemoryPropertyFlags requiredMemoryProperties
-) {
-    LOG_FUNCTION_SCOPE_TRACE(BUFFER, "{} bytes", sizeBytes);
-
-    vk::UniqueDeviceMemory p_logicalBufferPhysicalMemory = quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemoryPtr(
-        physicalDevice,
-        p_logicalDevice,
-        sizeBytes,
-        p_logicalBuffer,
-        requiredMemoryProperties
-    );
-
-    quartz::rendering::BufferUtil::populateVulkanPhysicalDeviceMemoryWithLocalData(
-        p_logicalDevice,
-        sizeBytes,
-        p_bufferData,
-        p_logicalBufferPhysicalMemory
-    );
-
-    return p_logicalBufferPhysicalMemory;
-}
-
-void
-quartz::rendering::BufferUtil::submitVulkanCommandBufferPtr(
-    const vk::Queue& graphicsQueue,
-    const vk::UniqueCommandBuffer& p_commandBuffer
-) {
-    LOG_FUNCTION_SCOPE_TRACE(BUFFER, "");
-
-    vk::SubmitInfo submitInfo(
-        0,
-        nullptr,
-        nullptr,
-        1,
-        &(*p_commandBuffer),
-        0,
-        nullptr
-    );
-    graphicsQueue.submit(submitInfo, VK_NULL_HANDLE);
-    graphicsQueue.waitIdle();
+    return allocation;
 }
 
 vk::UniqueImage
@@ -225,6 +108,7 @@ quartz::rendering::ImageBufferUtil::createVulkanImagePtr(
     const uint32_t imageWidth,
     const uint32_t imageHeight,
     const uint32_t layerCount,
+    const uint32_t mipLevelCount,
     const vk::ImageUsageFlags usageFlags,
     const vk::ImageCreateFlags createFlags,
     const vk::Format format,
@@ -236,6 +120,8 @@ quartz::rendering::ImageBufferUtil::createVulkanImagePtr(
 
     LOG_TRACE(IMAGE, "Using {} array layers", layerCount);
 
+    LOG_TRACE(IMAGE, "Using {} mip levels", mipLevelCount);
+
     vk::ImageCreateInfo imageCreateInfo(
         createFlags,
         vk::ImageType::e2D,
@@ -245,7 +131,7 @@ quartz::rendering::ImageBufferUtil::createVulkanImagePtr(
             static_cast<uint32_t>(imageHeight),
             1
         },
-        1,
+        mipLevelCount,
         layerCount,
         vk::SampleCountFlagBits::e1,
         tiling,
@@ -261,38 +147,33 @@ quartz::rendering::ImageBufferUtil::createVulkanImagePtr(
     return p_vulkanImage;
 }
 
-vk::UniqueDeviceMemory
+quartz::rendering::MemoryAllocator::Allocation
 quartz::rendering::ImageBufferUtil::allocateVulkanPhysicalDeviceImageMemory(
-    const vk::PhysicalDevice& physicalDevice,
-    const vk::UniqueDevice& p_logicalDevice,
+    const quartz::rendering::Device& renderingDevice,
     const vk::UniqueImage& p_image,
+    const vk::ImageTiling tiling,
     const vk::MemoryPropertyFlags requiredMemoryProperties
 ) {
     LOG_FUNCTION_SCOPE_TRACE(IMAGE, "");
 
+    const vk::UniqueDevice& p_logicalDevice = renderingDevice.getVulkanLogicalDevicePtr();
+
     vk::MemoryRequirements memoryRequirements = p_logicalDevice->getImageMemoryRequirements(*p_image);
 
-    uint32_t chosenMemoryTypeIndex = quartz::rendering::BufferUtil::chooseMemoryTypeIndex(
-        physicalDevice,
+    // Optimally tiled images can't sit next to linear resources without respecting bufferImageGranularity,
+    // so the allocator keeps them in blocks of their own
+    quartz::rendering::MemoryAllocator::Allocation allocation = renderingDevice.getMemoryAllocator().allocate(
+        memoryRequirements,
         requiredMemoryProperties,
-        memoryRequirements
-    );
-
-    vk::MemoryAllocateInfo memoryAllocateInfo(
-        memoryRequirements.size,
-        chosenMemoryTypeIndex
+        {},
+        tiling == vk::ImageTiling::eLinear
     );
 
-    vk::UniqueDeviceMemory p_vulkanPhysicalDeviceImageMemory = p_logicalDevice->allocateMemoryUnique(memoryAllocateInfo);
-    if (!p_vulkanPhysicalDeviceImageMemory) {
-        LOG_THROW(IMAGE, util::VulkanCreationFailedError, "Failed to create vk::DeviceMemory for vk::Image");
-    }
-
     p_logicalDevice->bindImageMemory(
         *p_image,
-        *p_vulkanPhysicalDeviceImageMemory,
-        0
+        allocation.getVulkanDeviceMemory(),
+        allocation.getOffsetBytes()
     );
 
-    return p_vulkanPhysicalDeviceImageMemory;
+    return allocation;
 }
\ No newline at end of file
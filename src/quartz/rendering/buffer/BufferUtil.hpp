@@ -7,15 +7,19 @@
 
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 
 namespace quartz {
 namespace rendering {
     class BufferUtil;
+    class FrameRingBuffer;
+    class GeometryPool;
     class ImageBuffer;
     class ImageBufferUtil;
     class LocallyMappedBuffer;
     class StagedBuffer;
     class StagedImageBuffer;
+    class UploadQueue;
 }
 }
 
@@ -32,46 +36,28 @@ private: // static functions
         const uint32_t bufferSizeBytes,
         const vk::BufferUsageFlags bufferUsageFlags
     );
-    static uint32_t chooseMemoryTypeIndex(
-        const vk::PhysicalDevice& physicalDevice,
-        const vk::MemoryPropertyFlags requiredMemoryProperties,
-        const vk::MemoryRequirements& memoryRequirements
-    );
-    static vk::UniqueDeviceMemory allocateVulkanPhysicalDeviceMemoryPtr(
-        const vk::PhysicalDevice& physicalDevice,
-        const vk::UniqueDevice& p_logicalDevice,
-        const uint32_t sizeBytes,
-        const vk::UniqueBuffer& p_logicalBuffer,
-        const vk::MemoryPropertyFlags requiredMemoryProperties
-    );
-    static void populateVulkanPhysicalDeviceMemoryWithLocalData(
-        const vk::UniqueDevice& p_logicalDevice,
-        const uint32_t sizeBytes,
-        const void* p_bufferData,
-        vk::UniqueDeviceMemory& p_logicalBufferPhysicalMemory
-    );
-    static vk::UniqueDeviceMemory allocateVulkanPhysicalDeviceStagingMemoryPtr(
-        const vk::PhysicalDevice& physicalDevice,
-        const vk::UniqueDevice& p_logicalDevice,
-        const uint32_t sizeBytes,
-        const void* p_bufferData,
-        const vk::UniqueBuffer& p_logicalBuffer,
-        const vk::MemoryPropertyFlags requiredMemoryProperties
-    );
 
-    // ----- command buffer things ----- //
-
-    static void submitVulkanCommandBufferPtr(
-        const vk::Queue& graphicsQueue,
-        const vk::UniqueCommandBuffer& p_commandBuffer
+    /**
+     * @brief Sub-allocate memory for the buffer from the device's allocator and bind it. Pass device local
+     *   as a preference for host visible buffers the cpu rewrites every frame, so they end up in
+     *   resizable BAR memory when there is any
+     */
+    static quartz::rendering::MemoryAllocator::Allocation allocateVulkanPhysicalDeviceMemory(
+        const quartz::rendering::Device& renderingDevice,
+        const vk::UniqueBuffer& p_logicalBuffer,
+        const vk::MemoryPropertyFlags requiredMemoryProperties,
+        const vk::MemoryPropertyFlags preferredMemoryProperties
     );
 
 private: // friends
+    friend class quartz::rendering::FrameRingBuffer;
+    friend class quartz::rendering::GeometryPool;
     friend class quartz::rendering::ImageBuffer;
     friend class quartz::rendering::ImageBufferUtil;
     friend class quartz::rendering::LocallyMappedBuffer;
     friend class quartz::rendering::StagedBuffer;
     friend class quartz::rendering::StagedImageBuffer;
+    friend class quartz::rendering::UploadQueue;
 };
 
 class quartz::rendering::ImageBufferUtil {
@@ -84,15 +70,16 @@ private: // static functions
         const uint32_t imageWidth,
         const uint32_t imageHeight,
         const uint32_t layerCount,
+        const uint32_t mipLevelCount,
         const vk::ImageUsageFlags usageFlags,
         const vk::ImageCreateFlags createFlags,
         const vk::Format format,
         const vk::ImageTiling tiling
     );
-    static vk::UniqueDeviceMemory allocateVulkanPhysicalDeviceImageMemory(
-        const vk::PhysicalDevice& physicalDevice,
-        const vk::UniqueDevice& p_logicalDevice,
+    static quartz::rendering::MemoryAllocator::Allocation allocateVulkanPhysicalDeviceImageMemory(
+        const quartz::rendering::Device& renderingDevice,
         const vk::UniqueImage& p_image,
+        const vk::ImageTiling tiling,
         const vk::MemoryPropertyFlags requiredMemoryProperties
     );
 
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/buffer/FrameRingBuffer.hpp"
+
+uint32_t
+quartz::rendering::FrameRingBuffer::calculateAlignmentBytes(
+    const quartz::rendering::Device& renderingDevice
+) {
+    const vk::PhysicalDeviceLimits& limits = renderingDevice.getVulkanPhysicalDeviceLimits();
+
+    /**
+     * @brief All of these are powers of two, so the largest of them is a multiple of the rest
+     */
+    const uint32_t alignmentBytes = std::max({
+        static_cast<uint32_t>(limits.minUniformBufferOffsetAlignment),
+        static_cast<uint32_t>(limits.minStorageBufferOffsetAlignment),
+        static_cast<uint32_t>(limits.nonCoherentAtomSize),
+        static_cast<uint32_t>(1)
+    });
+
+    LOG_TRACE(BUFFER_MAPPED, "Using alignment of {} bytes", alignmentBytes);
+
+    return alignmentBytes;
+}
+
+quartz::rendering::FrameRingBuffer::FrameRingBuffer(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t frameRegionSizeBytes,
+    const uint32_t maxNumFramesInFlight,
+    const vk::BufferUsageFlags usageFlags,
+    const vk::MemoryPropertyFlags requiredMemoryProperties
+) :
+    m_alignmentBytes(
+        quartz::rendering::FrameRingBuffer::calculateAlignmentBytes(
+            renderingDevice
+        )
+    ),
+    m_frameRegionSizeBytes(
+        std::max<uint32_t>(
+            (frameRegionSizeBytes + m_alignmentBytes - 1) & ~(m_alignmentBytes - 1),
+            m_alignmentBytes
+        )
+    ),
+    m_maxNumFramesInFlight(maxNumFramesInFlight),
+    m_usageFlags(usageFlags),
+    m_requiredMemoryProperties(requiredMemoryProperties),
+    mp_vulkanLogicalBuffer(
+        quartz::rendering::BufferUtil::createVulkanBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            m_frameRegionSizeBytes * m_maxNumFramesInFlight,
+            m_usageFlags
+        )
+    ),
+    m_physicalDeviceMemoryAllocation(
+        quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemory(
+            renderingDevice,
+            mp_vulkanLogicalBuffer,
+            m_requiredMemoryProperties,
+            vk::MemoryPropertyFlagBits::eDeviceLocal
+        )
+    ),
+    m_isHostCoherent(static_cast<bool>(
+        m_physicalDeviceMemoryAllocation.getVulkanMemoryPropertyFlags() & vk::MemoryPropertyFlagBits::eHostCoherent
+    )),
+    mp_mappedLocalMemory(m_physicalDeviceMemoryAllocation.getMappedLocalMemoryPtr()),
+    m_allocatedSizesBytes(m_maxNumFramesInFlight, 0),
+    m_pendingFlushRanges(m_maxNumFramesInFlight)
+{
+    LOG_FUNCTION_CALL_TRACEthis("{} frames of {} bytes each", m_maxNumFramesInFlight, m_frameRegionSizeBytes);
+
+    if (!mp_mappedLocalMemory) {
+        LOG_THROWthis(util::VulkanCreationFailedError, "Memory for a frame ring buffer must be host visible");
+    }
+
+    LOG_TRACEthis("Memory is {}host coherent and {}device local", m_isHostCoherent ? "" : "not ", (m_physicalDeviceMemoryAllocation.getVulkanMemoryPropertyFlags() & vk::MemoryPropertyFlagBits::eDeviceLocal) ? "" : "not ");
+}
+
+quartz::rendering::FrameRingBuffer::FrameRingBuffer(
+    quartz::rendering::FrameRingBuffer&& other
+) :
+    m_alignmentBytes(
+        other.m_alignmentBytes
+    ),
+    m_frameRegionSizeBytes(
+        other.m_frameRegionSizeBytes
+    ),
+    m_maxNumFramesInFlight(
+        other.m_maxNumFramesInFlight
+    ),
+    m_usageFlags(
+        other.m_usageFlags
+    ),
+    m_requiredMemoryProperties(
+        other.m_requiredMemoryProperties
+    ),
+    mp_vulkanLogicalBuffer(std::move(
+        other.mp_vulkanLogicalBuffer
+    )),
+    m_physicalDeviceMemoryAllocation(std::move(
+        other.m_physicalDeviceMemoryAllocation
+    )),
+    m_isHostCoherent(
+        other.m_isHostCoherent
+    ),
+    mp_mappedLocalMemory(std::move(
+        other.mp_mappedLocalMemory
+    )),
+    m_allocatedSizesBytes(std::move(
+        other.m_allocatedSizesBytes
+    )),
+    m_pendingFlushRanges(std::move(
+        other.m_pendingFlushRanges
+    ))
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::FrameRingBuffer::~FrameRingBuffer() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::FrameRingBuffer&
+quartz::rendering::FrameRingBuffer::operator=(
+    quartz::rendering::FrameRingBuffer&& other
+) {
+    LOG_FUNCTION_CALL_TRACEthis("");
+
+    if (this == &other) {
+        return *this;
+    }
+
+    m_alignmentBytes = other.m_alignmentBytes;
+    m_frameRegionSizeBytes = other.m_frameRegionSizeBytes;
+    m_maxNumFramesInFlight = other.m_maxNumFramesInFlight;
+    m_usageFlags = other.m_usageFlags;
+    m_requiredMemoryProperties = other.m_requiredMemoryProperties;
+    mp_vulkanLogicalBuffer = std::move(other.mp_vulkanLogicalBuffer);
+    m_physicalDeviceMemoryAllocation = std::move(other.m_physicalDeviceMemoryAllocation);
+    m_isHostCoherent = other.m_isHostCoherent;
+    mp_mappedLocalMemory = std::move(other.mp_mappedLocalMemory);
+    m_allocatedSizesBytes = std::move(other.m_allocatedSizesBytes);
+    m_pendingFlushRanges = std::move(other.m_pendingFlushRanges);
+
+    return *this;
+}
+
+uint32_t
+quartz::rendering::FrameRingBuffer::allocate(
+    const uint32_t inFlightFrameIndex,
+    const uint32_t sizeBytes
+) {
+    const uint32_t alignedSizeBytes = (sizeBytes + m_alignmentBytes - 1) & ~(m_alignmentBytes - 1);
+    uint32_t& allocatedSizeBytes = m_allocatedSizesBytes[inFlightFrameIndex];
+
+    if (allocatedSizeBytes + alignedSizeBytes > m_frameRegionSizeBytes) {
+        LOG_THROW(BUFFER_MAPPED, util::VulkanCreationFailedError, "Frame {} has {} of {} bytes left, cannot allocate {} more", inFlightFrameIndex, m_frameRegionSizeBytes - allocatedSizeBytes, m_frameRegionSizeBytes, alignedSizeBytes);
+    }
+
+    const uint32_t offsetBytes = (inFlightFrameIndex * m_frameRegionSizeBytes) + allocatedSizeBytes;
+    allocatedSizeBytes += alignedSizeBytes;
+
+    LOG_TRACEthis("Allocated {} bytes at offset {} for frame {}", alignedSizeBytes, offsetBytes, inFlightFrameIndex);
+
+    return offsetBytes;
+}
+
+void*
+quartz::rendering::FrameRingBuffer::getMappedLocalMemoryPtr(
+    const uint32_t offsetBytes
+) {
+    return static_cast<char*>(mp_mappedLocalMemory) + offsetBytes;
+}
+
+void
+quartz::rendering::FrameRingBuffer::markWritten(
+    const uint32_t inFlightFrameIndex,
+    const uint32_t offsetBytes,
+    const uint32_t sizeBytes
+) {
+    if (m_isHostCoherent || sizeBytes == 0) {
+        return;
+    }
+
+    /**
+     * @brief Flushed ranges have to start and end on multiples of the non coherent atom size. The frame
+     *   regions are aligned to it, so rounding outwards never reaches into another frame's region. The
+     *   allocator starts non coherent allocations on a multiple of the atom size too, so shifting the
+     *   range by the allocation's offset within its vk::DeviceMemory keeps it aligned
+     */
+    const uint32_t alignedOffsetBytes = offsetBytes & ~(m_alignmentBytes - 1);
+    const uint32_t alignedEndBytes = (offsetBytes + sizeBytes + m_alignmentBytes - 1) & ~(m_alignmentBytes - 1);
+
+    m_pendingFlushRanges[inFlightFrameIndex].emplace_back(
+        m_physicalDeviceMemoryAllocation.getVulkanDeviceMemory(),
+        m_physicalDeviceMemoryAllocation.getOffsetBytes() + alignedOffsetBytes,
+        alignedEndBytes - alignedOffsetBytes
+    );
+}
+
+void
+quartz::rendering::FrameRingBuffer::flush(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t inFlightFrameIndex
+) {
+    std::vector<vk::MappedMemoryRange>& pendingFlushRanges = m_pendingFlushRanges[inFlightFrameIndex];
+
+    if (pendingFlushRanges.empty()) {
+        return;
+    }
+
+    LOG_TRACEthis("Flushing {} ranges for frame {}", pendingFlushRanges.size(), inFlightFrameIndex);
+
+    renderingDevice.getVulkanLogicalDevicePtr()->flushMappedMemoryRanges(pendingFlushRanges);
+
+    pendingFlushRanges.clear();
+}
\ No newline at end of file
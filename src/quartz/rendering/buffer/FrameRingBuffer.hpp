@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
+
+namespace quartz {
+namespace rendering {
+    class FrameRingBuffer;
+}
+}
+
+/**
+ * @brief A single persistently mapped buffer split into one region per frame in flight, so the frames
+ *   cycle around it like a ring. Each region is handed out linearly, with every allocation aligned to
+ *   both the uniform and storage buffer offset alignments so it can be bound with a dynamic offset.
+ *   Every region is laid out the same way, so an allocation in one frame's region is always the same
+ *   distance from the start of the region as the matching allocation in every other frame's region.
+ *
+ * @brief The memory is not required to be host coherent. When it isn't, the ranges that were written get
+ *   queued up with markWritten and then all flushed to the device in a single call to flush.
+ *
+ * @brief Device local memory is preferred on top of the required properties, so the gpu reads every
+ *   frame's data out of resizable BAR memory instead of across the bus when the device has it.
+ */
+class quartz::rendering::FrameRingBuffer {
+public: // member functions
+    FrameRingBuffer(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t frameRegionSizeBytes,
+        const uint32_t maxNumFramesInFlight,
+        const vk::BufferUsageFlags usageFlags,
+        const vk::MemoryPropertyFlags requiredMemoryProperties
+    );
+    FrameRingBuffer(FrameRingBuffer&& other);
+    ~FrameRingBuffer();
+
+    FrameRingBuffer& operator=(FrameRingBuffer&& other);
+
+    USE_LOGGER(BUFFER_MAPPED);
+
+    const vk::UniqueBuffer& getVulkanLogicalBufferPtr() const { return mp_vulkanLogicalBuffer; }
+    uint32_t getAlignmentBytes() const { return m_alignmentBytes; }
+    uint32_t getFrameRegionSizeBytes() const { return m_frameRegionSizeBytes; }
+    bool getIsHostCoherent() const { return m_isHostCoherent; }
+
+    /**
+     * @brief Reserve sizeBytes in the given frame's region, returning the offset from the start of the
+     *   whole buffer
+     */
+    uint32_t allocate(
+        const uint32_t inFlightFrameIndex,
+        const uint32_t sizeBytes
+    );
+
+    void* getMappedLocalMemoryPtr(const uint32_t offsetBytes);
+
+    /**
+     * @brief Queue a range (offset from the start of the whole buffer) to be flushed with the rest of the
+     *   frame's writes. Does nothing for host coherent memory
+     */
+    void markWritten(
+        const uint32_t inFlightFrameIndex,
+        const uint32_t offsetBytes,
+        const uint32_t sizeBytes
+    );
+
+    /**
+     * @brief Flush every range queued for the given frame in a single vkFlushMappedMemoryRanges. This must be
+     *   called after the frame is done writing and before the frame's command buffer is submitted
+     */
+    void flush(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t inFlightFrameIndex
+    );
+
+public: // static functions
+    /**
+     * @brief The alignment every allocation gets, so users can size a frame region up front
+     */
+    static uint32_t calculateAlignmentBytes(
+        const quartz::rendering::Device& renderingDevice
+    );
+
+private: // member variables
+    /**
+     * @brief Every frame's region starts on a multiple of the alignment, which is also a multiple of the
+     *   non coherent atom size so flushed ranges never straddle two frames
+     */
+    uint32_t m_alignmentBytes;
+    uint32_t m_frameRegionSizeBytes;
+    uint32_t m_maxNumFramesInFlight;
+    vk::BufferUsageFlags m_usageFlags;
+    vk::MemoryPropertyFlags m_requiredMemoryProperties;
+
+    vk::UniqueBuffer mp_vulkanLogicalBuffer;
+    quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceMemoryAllocation;
+    bool m_isHostCoherent;
+    void* mp_mappedLocalMemory; // persistently mapped by the allocator
+
+    std::vector<uint32_t> m_allocatedSizesBytes; // indexed by frame in flight
+    std::vector<std::vector<vk::MappedMemoryRange>> m_pendingFlushRanges; // indexed by frame in flight
+};
\ No newline at end of file
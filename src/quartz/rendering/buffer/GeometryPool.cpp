@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
+#include "quartz/rendering/buffer/UploadQueue.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
+
+std::vector<quartz::rendering::GeometryPool::Block> quartz::rendering::GeometryPool::blocks;
+
+quartz::rendering::GeometryPool::Block::Block(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t vertexStrideBytes,
+    const uint32_t vertexCapacityBytes,
+    const uint32_t indexCapacityBytes
+) :
+    m_vertexStrideBytes(vertexStrideBytes),
+    m_vertexCapacityBytes(vertexCapacityBytes),
+    m_vertexUsedBytes(0),
+    m_indexCapacityBytes(indexCapacityBytes),
+    m_indexUsedBytes(0),
+    mp_vulkanLogicalVertexBuffer(
+        quartz::rendering::GeometryPool::createBlockVulkanLogicalBufferPtr(
+            renderingDevice,
+            m_vertexCapacityBytes,
+            vk::BufferUsageFlagBits::eVertexBuffer
+        )
+    ),
+    m_physicalDeviceVertexMemoryAllocation(
+        quartz::rendering::GeometryPool::allocateBlockVulkanPhysicalDeviceMemory(
+            renderingDevice,
+            m_vertexCapacityBytes,
+            mp_vulkanLogicalVertexBuffer
+        )
+    ),
+    mp_vulkanLogicalIndexBuffer(
+        quartz::rendering::GeometryPool::createBlockVulkanLogicalBufferPtr(
+            renderingDevice,
+            m_indexCapacityBytes,
+            vk::BufferUsageFlagBits::eIndexBuffer
+        )
+    ),
+    m_physicalDeviceIndexMemoryAllocation(
+        quartz::rendering::GeometryPool::allocateBlockVulkanPhysicalDeviceMemory(
+            renderingDevice,
+            m_indexCapacityBytes,
+            mp_vulkanLogicalIndexBuffer
+        )
+    )
+{
+    LOG_FUNCTION_CALL_TRACEthis("vertex stride {} bytes , {} vertex bytes , {} index bytes", m_vertexStrideBytes, m_vertexCapacityBytes, m_indexCapacityBytes);
+}
+
+quartz::rendering::GeometryPool::Block::Block(
+    quartz::rendering::GeometryPool::Block&& other
+) :
+    m_vertexStrideBytes(other.m_vertexStrideBytes),
+    m_vertexCapacityBytes(other.m_vertexCapacityBytes),
+    m_vertexUsedBytes(other.m_vertexUsedBytes),
+    m_indexCapacityBytes(other.m_indexCapacityBytes),
+    m_indexUsedBytes(other.m_indexUsedBytes),
+    mp_vulkanLogicalVertexBuffer(std::move(
+        other.mp_vulkanLogicalVertexBuffer
+    )),
+    m_physicalDeviceVertexMemoryAllocation(std::move(
+        other.m_physicalDeviceVertexMemoryAllocation
+    )),
+    mp_vulkanLogicalIndexBuffer(std::move(
+        other.mp_vulkanLogicalIndexBuffer
+    )),
+    m_physicalDeviceIndexMemoryAllocation(std::move(
+        other.m_physicalDeviceIndexMemoryAllocation
+    ))
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::GeometryPool::Block::~Block() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::GeometryPool::Block&
+quartz::rendering::GeometryPool::Block::operator=(
+    quartz::rendering::GeometryPool::Block&& other
+) {
+    LOG_FUNCTION_CALL_TRACEthis("");
+
+    if (this == &other) {
+        return *this;
+    }
+
+    m_vertexStrideBytes = other.m_vertexStrideBytes;
+    m_vertexCapacityBytes = other.m_vertexCapacityBytes;
+    m_vertexUsedBytes = other.m_vertexUsedBytes;
+    m_indexCapacityBytes = other.m_indexCapacityBytes;
+    m_indexUsedBytes = other.m_indexUsedBytes;
+    mp_vulkanLogicalVertexBuffer = std::move(other.mp_vulkanLogicalVertexBuffer);
+    m_physicalDeviceVertexMemoryAllocation = std::move(other.m_physicalDeviceVertexMemoryAllocation);
+    mp_vulkanLogicalIndexBuffer = std::move(other.mp_vulkanLogicalIndexBuffer);
+    m_physicalDeviceIndexMemoryAllocation = std::move(other.m_physicalDeviceIndexMemoryAllocation);
+
+    return *this;
+}
+
+bool
+quartz::rendering::GeometryPool::Block::canFit(
+    const uint32_t vertexStrideBytes,
+    const uint32_t vertexSizeBytes,
+    const uint32_t indexSizeBytes
+) const {
+    return
+        m_vertexStrideBytes == vertexStrideBytes &&
+        m_vertexUsedBytes + vertexSizeBytes <= m_vertexCapacityBytes &&
+        m_indexUsedBytes + indexSizeBytes <= m_indexCapacityBytes;
+}
+
+void
+quartz::rendering::GeometryPool::Block::claim(
+    const uint32_t vertexSizeBytes,
+    const uint32_t indexSizeBytes
+) {
+    m_vertexUsedBytes += vertexSizeBytes;
+    m_indexUsedBytes += indexSizeBytes;
+
+    LOG_TRACEthis("Block now using {} / {} vertex bytes and {} / {} index bytes", m_vertexUsedBytes, m_vertexCapacityBytes, m_indexUsedBytes, m_indexCapacityBytes);
+}
+
+vk::UniqueBuffer
+quartz::rendering::GeometryPool::createBlockVulkanLogicalBufferPtr(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t sizeBytes,
+    const vk::BufferUsageFlags usageFlags
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_GEOMETRY, "{} bytes", sizeBytes);
+
+    return quartz::rendering::BufferUtil::createVulkanBufferPtr(
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        sizeBytes,
+        vk::BufferUsageFlagBits::eTransferDst | usageFlags
+    );
+}
+
+quartz::rendering::MemoryAllocator::Allocation
+quartz::rendering::GeometryPool::allocateBlockVulkanPhysicalDeviceMemory(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t sizeBytes,
+    const vk::UniqueBuffer& p_logicalBuffer
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_GEOMETRY, "{} bytes", sizeBytes);
+
+    return quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemory(
+        renderingDevice,
+        p_logicalBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        {}
+    );
+}
+
+uint32_t
+quartz::rendering::GeometryPool::chooseBlockIndex(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t vertexStrideBytes,
+    const uint32_t vertexSizeBytes,
+    const uint32_t indexSizeBytes
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_GEOMETRY, "{} vertex bytes , {} index bytes", vertexSizeBytes, indexSizeBytes);
+
+    for (uint32_t i = 0; i < quartz::rendering::GeometryPool::blocks.size(); ++i) {
+        if (quartz::rendering::GeometryPool::blocks[i].canFit(vertexStrideBytes, vertexSizeBytes, indexSizeBytes)) {
+            LOG_TRACE(BUFFER_GEOMETRY, "Using existing block {}", i);
+            return i;
+        }
+    }
+
+    /**
+     * @brief If something is larger than a default block then it gets a block sized exactly to
+     *   itself. Nothing else will fit in there but it keeps the default blocks a reasonable size
+     */
+    const uint32_t vertexCapacityBytes = std::max(
+        quartz::rendering::GeometryPool::defaultBlockVertexCapacityBytes - (quartz::rendering::GeometryPool::defaultBlockVertexCapacityBytes % vertexStrideBytes),
+        vertexSizeBytes
+    );
+    const uint32_t indexCapacityBytes = std::max(
+        quartz::rendering::GeometryPool::defaultBlockIndexCapacityBytes,
+        indexSizeBytes
+    );
+
+    {
+        // Blocks are shared by many assets, each of which is charged for its share in allocate
+        const quartz::rendering::MemoryAccounting::AssetScope assetScope(quartz::rendering::MemoryAccounting::geometryPoolAssetName);
+
+        quartz::rendering::GeometryPool::blocks.emplace_back(
+            renderingDevice,
+            vertexStrideBytes,
+            vertexCapacityBytes,
+            indexCapacityBytes
+        );
+    }
+
+    const uint32_t blockIndex = quartz::rendering::GeometryPool::blocks.size() - 1;
+    LOG_INFO(BUFFER_GEOMETRY, "Created geometry block {} with {} vertex bytes and {} index bytes", blockIndex, vertexCapacityBytes, indexCapacityBytes);
+
+    return blockIndex;
+}
+
+void
+quartz::rendering::GeometryPool::populateVulkanLogicalBufferRegionWithStagedData(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t sizeBytes,
+    const void* p_bufferData,
+    const vk::UniqueBuffer& p_logicalBuffer,
+    const uint32_t destinationOffsetBytes
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_GEOMETRY, "{} bytes at offset {}", sizeBytes, destinationOffsetBytes);
+
+    quartz::rendering::UploadQueue::recordBufferUpload(
+        renderingDevice,
+        p_bufferData,
+        sizeBytes,
+        p_logicalBuffer,
+        destinationOffsetBytes
+    );
+
+    LOG_TRACE(BUFFER_GEOMETRY, "Successfully recorded upload");
+}
+
+quartz::rendering::GeometryPool::Range
+quartz::rendering::GeometryPool::allocate(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t vertexStrideBytes,
+    const uint32_t vertexCount,
+    const void* p_vertexData,
+    const std::vector<uint32_t>& indices
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_GEOMETRY, "{} vertices , {} indices", vertexCount, indices.size());
+
+    const uint32_t vertexSizeBytes = vertexStrideBytes * vertexCount;
+    const uint32_t indexSizeBytes = sizeof(uint32_t) * indices.size();
+
+    const uint32_t blockIndex = quartz::rendering::GeometryPool::chooseBlockIndex(
+        renderingDevice,
+        vertexStrideBytes,
+        vertexSizeBytes,
+        indexSizeBytes
+    );
+    quartz::rendering::GeometryPool::Block& block = quartz::rendering::GeometryPool::blocks[blockIndex];
+
+    const quartz::rendering::GeometryPool::Range range = {
+        blockIndex,
+        static_cast<int32_t>(block.m_vertexUsedBytes / vertexStrideBytes),
+        static_cast<uint32_t>(block.m_indexUsedBytes / sizeof(uint32_t)),
+        static_cast<uint32_t>(indices.size())
+    };
+
+    quartz::rendering::GeometryPool::populateVulkanLogicalBufferRegionWithStagedData(
+        renderingDevice,
+        vertexSizeBytes,
+        p_vertexData,
+        block.mp_vulkanLogicalVertexBuffer,
+        block.m_vertexUsedBytes
+    );
+    quartz::rendering::GeometryPool::populateVulkanLogicalBufferRegionWithStagedData(
+        renderingDevice,
+        indexSizeBytes,
+        indices.data(),
+        block.mp_vulkanLogicalIndexBuffer,
+        block.m_indexUsedBytes
+    );
+
+    block.claim(vertexSizeBytes, indexSizeBytes);
+    quartz::rendering::MemoryAccounting::recordGeometryPoolAllocation(vertexSizeBytes + indexSizeBytes);
+
+    LOG_TRACE(BUFFER_GEOMETRY, "Placed geometry in block {} at vertex offset {} and first index {}", range.blockIndex, range.vertexOffset, range.firstIndex);
+
+    return range;
+}
+
+void
+quartz::rendering::GeometryPool::cleanUpAllBlocks() {
+    LOG_FUNCTION_CALL_TRACE(BUFFER_GEOMETRY, "");
+
+    quartz::rendering::GeometryPool::blocks.clear();
+    quartz::rendering::MemoryAccounting::clearGeometryPoolAllocations();
+}
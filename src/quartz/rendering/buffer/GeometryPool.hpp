@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
+
+namespace quartz {
+namespace rendering {
+    class GeometryPool;
+}
+}
+
+/**
+ * @brief A master list of large device local vertex and index buffers that all primitives
+ *   sub-allocate their geometry out of. Because every primitive shares a handful of buffers
+ *   we only need to bind geometry when the block changes and can draw with offsets instead,
+ *   and we only pay for a couple of vkAllocateMemory calls per block instead of two per primitive.
+ */
+class quartz::rendering::GeometryPool {
+public: // classes
+    /**
+     * @brief Where a primitive's geometry lives within the pool. The offsets are measured in
+     *   elements (vertices and indices) so they can be handed straight to drawIndexed
+     */
+    struct Range {
+    public: // member variables
+        uint32_t blockIndex;
+        int32_t vertexOffset;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    /**
+     * @brief A single device local vertex buffer and index buffer pair. All vertices within
+     *   a block share the same stride so a vertex offset is always a whole number of vertices
+     */
+    class Block {
+    public: // member functions
+        Block(
+            const quartz::rendering::Device& renderingDevice,
+            const uint32_t vertexStrideBytes,
+            const uint32_t vertexCapacityBytes,
+            const uint32_t indexCapacityBytes
+        );
+        Block(Block&& other);
+        ~Block();
+
+        Block& operator=(Block&& other);
+
+        USE_LOGGER(BUFFER_GEOMETRY);
+
+        uint32_t getVertexStrideBytes() const { return m_vertexStrideBytes; }
+        uint32_t getVertexCapacityBytes() const { return m_vertexCapacityBytes; }
+        uint32_t getVertexUsedBytes() const { return m_vertexUsedBytes; }
+        uint32_t getIndexCapacityBytes() const { return m_indexCapacityBytes; }
+        uint32_t getIndexUsedBytes() const { return m_indexUsedBytes; }
+        const vk::UniqueBuffer& getVulkanLogicalVertexBufferPtr() const { return mp_vulkanLogicalVertexBuffer; }
+        const vk::UniqueBuffer& getVulkanLogicalIndexBufferPtr() const { return mp_vulkanLogicalIndexBuffer; }
+
+        bool canFit(
+            const uint32_t vertexStrideBytes,
+            const uint32_t vertexSizeBytes,
+            const uint32_t indexSizeBytes
+        ) const;
+
+    private: // member functions
+        void claim(const uint32_t vertexSizeBytes, const uint32_t indexSizeBytes);
+
+    private: // member variables
+        uint32_t m_vertexStrideBytes;
+        uint32_t m_vertexCapacityBytes;
+        uint32_t m_vertexUsedBytes;
+        uint32_t m_indexCapacityBytes;
+        uint32_t m_indexUsedBytes;
+
+        vk::UniqueBuffer mp_vulkanLogicalVertexBuffer;
+        quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceVertexMemoryAllocation;
+        vk::UniqueBuffer mp_vulkanLogicalIndexBuffer;
+        quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceIndexMemoryAllocation;
+
+    private: // friends
+        friend class quartz::rendering::GeometryPool;
+    };
+
+public: // static variables
+    static constexpr uint32_t defaultBlockVertexCapacityBytes = 64 * 1024 * 1024;
+    static constexpr uint32_t defaultBlockIndexCapacityBytes = 16 * 1024 * 1024;
+
+public: // static functions
+    static quartz::rendering::GeometryPool::Range allocate(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t vertexStrideBytes,
+        const uint32_t vertexCount,
+        const void* p_vertexData,
+        const std::vector<uint32_t>& indices
+    );
+    static void cleanUpAllBlocks(); // the only way ranges are ever given back, because blocks only grow
+
+    static uint32_t getNumBlocks() { return quartz::rendering::GeometryPool::blocks.size(); }
+    static const quartz::rendering::GeometryPool::Block& getBlock(const uint32_t index) { return quartz::rendering::GeometryPool::blocks[index]; }
+
+private: // static functions
+    static vk::UniqueBuffer createBlockVulkanLogicalBufferPtr(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t sizeBytes,
+        const vk::BufferUsageFlags usageFlags
+    );
+    static quartz::rendering::MemoryAllocator::Allocation allocateBlockVulkanPhysicalDeviceMemory(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t sizeBytes,
+        const vk::UniqueBuffer& p_logicalBuffer
+    );
+    static uint32_t chooseBlockIndex(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t vertexStrideBytes,
+        const uint32_t vertexSizeBytes,
+        const uint32_t indexSizeBytes
+    );
+    static void populateVulkanLogicalBufferRegionWithStagedData(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t sizeBytes,
+        const void* p_bufferData,
+        const vk::UniqueBuffer& p_logicalBuffer,
+        const uint32_t destinationOffsetBytes
+    );
+
+private: // static variables
+    static std::vector<quartz::rendering::GeometryPool::Block> blocks;
+};
@@ -9,6 +9,7 @@ quartz::rendering::ImageBuffer::ImageBuffer(
     const uint32_t imageWidth,
     const uint32_t imageHeight,
     const uint32_t layerCount,
+    const uint32_t mipLevelCount,
     const vk::ImageUsageFlags usageFlags,
     const vk::ImageCreateFlags createFlags,
     const vk::Format format,
@@ -17,6 +18,7 @@ quartz::rendering::ImageBuffer::ImageBuffer(
     m_imageWidth(imageWidth),
     m_imageHeight(imageHeight),
     m_layerCount(layerCount),
+    m_mipLevelCount(mipLevelCount),
     m_usageFlags(usageFlags),
     m_createFlags(createFlags),
     m_format(format),
@@ -27,17 +29,18 @@ quartz::rendering::ImageBuffer::ImageBuffer(
             m_imageWidth,
             m_imageHeight,
             m_layerCount,
+            m_mipLevelCount,
             m_usageFlags,
             m_createFlags,
             m_format,
             m_tiling
         )
     ),
-    mp_vulkanPhysicalDeviceMemory(
+    m_physicalDeviceMemoryAllocation(
         quartz::rendering::ImageBufferUtil::allocateVulkanPhysicalDeviceImageMemory(
-            renderingDevice.getVulkanPhysicalDevice(),
-            renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingDevice,
             mp_vulkanImage,
+            m_tiling,
             vk::MemoryPropertyFlagBits::eDeviceLocal
         )
     )
@@ -51,12 +54,13 @@ quartz::rendering::ImageBuffer::ImageBuffer(
     m_imageWidth(other.m_imageWidth),
     m_imageHeight(other.m_imageHeight),
     m_layerCount(other.m_layerCount),
+    m_mipLevelCount(other.m_mipLevelCount),
     m_usageFlags(other.m_usageFlags),
     m_createFlags(other.m_createFlags),
     m_format(other.m_format),
     m_tiling(other.m_tiling),
     mp_vulkanImage(std::move(other.mp_vulkanImage)),
-    mp_vulkanPhysicalDeviceMemory(std::move(other.mp_vulkanPhysicalDeviceMemory))
+    m_physicalDeviceMemoryAllocation(std::move(other.m_physicalDeviceMemoryAllocation))
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
@@ -74,13 +78,14 @@ quartz::rendering::ImageBuffer::operator=(
     m_imageWidth = other.m_imageWidth;
     m_imageHeight = other.m_imageHeight;
     m_layerCount = other.m_layerCount;
+    m_mipLevelCount = other.m_mipLevelCount;
     m_usageFlags = other.m_usageFlags;
     m_createFlags = other.m_createFlags;
     m_format = other.m_format;
     m_tiling = other.m_tiling;
 
     mp_vulkanImage = std::move(other.mp_vulkanImage);
-    mp_vulkanPhysicalDeviceMemory = std::move(other.mp_vulkanPhysicalDeviceMemory);
+    m_physicalDeviceMemoryAllocation = std::move(other.m_physicalDeviceMemoryAllocation);
 
     return *this;
 }
@@ -93,6 +98,6 @@ void
 quartz::rendering::ImageBuffer::reset() {
     LOG_FUNCTION_CALL_TRACEthis("");
 
-    mp_vulkanPhysicalDeviceMemory.reset();
+    m_physicalDeviceMemoryAllocation.reset();
     mp_vulkanImage.reset();
 }
\ No newline at end of file
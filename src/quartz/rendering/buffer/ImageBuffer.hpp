@@ -5,6 +5,7 @@
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/buffer/BufferUtil.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 
 namespace quartz {
 namespace rendering {
@@ -20,6 +21,7 @@ public: // member functions
         const uint32_t imageWidth,
         const uint32_t imageHeight,
         const uint32_t layerCount,
+        const uint32_t mipLevelCount,
         const vk::ImageUsageFlags usageFlags,
         const vk::ImageCreateFlags createFlags,
         const vk::Format format,
@@ -42,11 +44,12 @@ private: // member variables
     uint32_t m_imageWidth;
     uint32_t m_imageHeight;
     uint32_t m_layerCount;
+    uint32_t m_mipLevelCount;
     vk::ImageUsageFlags m_usageFlags;
     vk::ImageCreateFlags m_createFlags;
     vk::Format m_format;
     vk::ImageTiling m_tiling;
 
     vk::UniqueImage mp_vulkanImage;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceMemory;
+    quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceMemoryAllocation;
 };
\ No newline at end of file
@@ -4,25 +4,6 @@
 #include "quartz/rendering/buffer/BufferUtil.hpp"
 #include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
 
-void*
-quartz::rendering::LocallyMappedBuffer::mapVulkanPhysicalDeviceMemoryToLocalMemory(
-    const vk::UniqueDevice& p_logicalDevice,
-    const uint32_t sizeBytes,
-    const vk::UniqueDeviceMemory& p_physicalDeviceMemory
-) {
-    LOG_FUNCTION_SCOPE_TRACE(BUFFER_MAPPED, "");
-
-    LOG_TRACE(BUFFER_MAPPED, "Mapping memory from physical device memory to logical memory instance {}", static_cast<const void*>(&(*p_physicalDeviceMemory)));
-    void* p_mappedLocalMemory = p_logicalDevice->mapMemory(
-        *(p_physicalDeviceMemory),
-        0,
-        sizeBytes
-    );
-
-    LOG_TRACE(BUFFER_MAPPED, "Mapped to {}", p_mappedLocalMemory);
-    return p_mappedLocalMemory;
-}
-
 quartz::rendering::LocallyMappedBuffer::LocallyMappedBuffer(
     const quartz::rendering::Device& renderingDevice,
     const uint32_t sizeBytes,
@@ -39,24 +20,21 @@ quartz::rendering::LocallyMappedBuffer::LocallyMappedBuffer(
             m_usageFlags
         )
     ),
-    mp_vulkanPhysicalDeviceMemory(
-        quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemoryPtr(
-            renderingDevice.getVulkanPhysicalDevice(),
-            renderingDevice.getVulkanLogicalDevicePtr(),
-            m_sizeBytes,
+    m_physicalDeviceMemoryAllocation(
+        quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemory(
+            renderingDevice,
             mp_vulkanLogicalBuffer,
-            requiredMemoryProperties
+            requiredMemoryProperties,
+            vk::MemoryPropertyFlagBits::eDeviceLocal
         )
     ),
-    mp_mappedLocalMemory(
-        quartz::rendering::LocallyMappedBuffer::mapVulkanPhysicalDeviceMemoryToLocalMemory(
-            renderingDevice.getVulkanLogicalDevicePtr(),
-            m_sizeBytes,
-            mp_vulkanPhysicalDeviceMemory
-        )
-    )
+    mp_mappedLocalMemory(m_physicalDeviceMemoryAllocation.getMappedLocalMemoryPtr())
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    if (!mp_mappedLocalMemory) {
+        LOG_THROWthis(util::VulkanCreationFailedError, "Memory for a locally mapped buffer must be host visible");
+    }
 }
 
 quartz::rendering::LocallyMappedBuffer::LocallyMappedBuffer(
@@ -74,8 +52,8 @@ quartz::rendering::LocallyMappedBuffer::LocallyMappedBuffer(
     mp_vulkanLogicalBuffer(std::move(
         other.mp_vulkanLogicalBuffer
     )),
-    mp_vulkanPhysicalDeviceMemory(std::move(
-        other.mp_vulkanPhysicalDeviceMemory
+    m_physicalDeviceMemoryAllocation(std::move(
+        other.m_physicalDeviceMemoryAllocation
     )),
     mp_mappedLocalMemory(std::move(
         other.mp_mappedLocalMemory
@@ -102,7 +80,7 @@ quartz::rendering::LocallyMappedBuffer::operator=(
     m_usageFlags = other.m_usageFlags;
     m_requiredMemoryProperties = other.m_requiredMemoryProperties;
     mp_vulkanLogicalBuffer = std::move(other.mp_vulkanLogicalBuffer);
-    mp_vulkanPhysicalDeviceMemory = std::move(other.mp_vulkanPhysicalDeviceMemory);
+    m_physicalDeviceMemoryAllocation = std::move(other.m_physicalDeviceMemoryAllocation);
     mp_mappedLocalMemory = std::move(other.mp_mappedLocalMemory);
 
     return *this;
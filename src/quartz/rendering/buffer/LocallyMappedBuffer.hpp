@@ -5,6 +5,7 @@
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/buffer/BufferUtil.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 
 namespace quartz {
 namespace rendering {
@@ -30,19 +31,12 @@ public: // member functions
     const vk::UniqueBuffer& getVulkanLogicalBufferPtr() const { return mp_vulkanLogicalBuffer; }
     void* getMappedLocalMemoryPtr() { return mp_mappedLocalMemory; }
 
-private: // static functions
-    static void* mapVulkanPhysicalDeviceMemoryToLocalMemory(
-        const vk::UniqueDevice& p_logicalDevice,
-        const uint32_t bufferSizeBytes,
-        const vk::UniqueDeviceMemory& p_physicalDeviceMemory
-    );
-
 private: // member variables
     uint32_t m_sizeBytes;
     vk::BufferUsageFlags m_usageFlags;
     vk::MemoryPropertyFlags m_requiredMemoryProperties;
 
     vk::UniqueBuffer mp_vulkanLogicalBuffer;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceMemory;
-    void* mp_mappedLocalMemory;
+    quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceMemoryAllocation;
+    void* mp_mappedLocalMemory; // persistently mapped by the allocator
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/buffer/BufferUtil.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 
 namespace quartz {
 namespace rendering {
@@ -31,32 +32,18 @@ public: // member functions
     const vk::UniqueBuffer& getVulkanLogicalBufferPtr() const { return mp_vulkanLogicalBuffer; }
 
 private: // static functions
-    static void populateVulkanLogicalBufferWithStagedData(
-        const uint32_t graphicsQueueFamilyIndex,
-        const vk::UniqueDevice& p_logicalDevice,
-        const vk::Queue& graphicsQueue,
-        const uint32_t sizeBytes,
-        const vk::UniqueBuffer& p_logicalBuffer,
-        const vk::UniqueBuffer& p_logicalStagingBuffer
-    );
-    static vk::UniqueDeviceMemory allocateVulkanPhysicalDeviceDestinationMemoryPtr(
-        const vk::PhysicalDevice& physicalDevice,
-        const uint32_t graphicsQueueFamilyIndex,
-        const vk::UniqueDevice& p_logicalDevice,
-        const vk::Queue& graphicsQueue,
+    static quartz::rendering::MemoryAllocator::Allocation allocateVulkanPhysicalDeviceDestinationMemory(
+        const quartz::rendering::Device& renderingDevice,
         const uint32_t sizeBytes,
         const vk::UniqueBuffer& p_logicalBuffer,
         const vk::MemoryPropertyFlags requiredMemoryProperties,
-        const vk::UniqueBuffer& p_logicalStagingBuffer
+        const void* p_bufferData
     );
 
 private: // member variables
     uint32_t m_sizeBytes;
     vk::BufferUsageFlags m_usageFlags;
 
-    vk::UniqueBuffer mp_vulkanLogicalStagingBuffer;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceStagingMemory;
-
     vk::UniqueBuffer mp_vulkanLogicalBuffer;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceMemory;
+    quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceMemoryAllocation;
 };
@@ -5,6 +5,7 @@
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/buffer/BufferUtil.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 
 namespace quartz {
 namespace rendering {
@@ -39,35 +40,15 @@ public: // member functions
     const vk::UniqueImage& getVulkanImagePtr() const { return mp_vulkanImage; }
 
 private: // static functions
-    static void transitionImageLayout(
-        const uint32_t graphicsQueueFamilyIndex,
-        const vk::UniqueDevice& p_logicalDevice,
-        const vk::Queue& graphicsQueue,
-        const vk::UniqueImage& p_image,
-        const uint32_t layerCount,
-        const vk::ImageLayout inputLayout,
-        const vk::ImageLayout outputLayout
-    );
-    static void populateVulkanImageWithStagedData(
-        const uint32_t graphicsQueueFamilyIndex,
-        const vk::UniqueDevice& p_logicalDevice,
-        const vk::Queue& graphicsQueue,
-        const uint32_t imageWidth,
-        const uint32_t imageHeight,
-        const uint32_t layerCount,
-        const vk::UniqueBuffer& p_stagingBuffer,
-        const vk::UniqueImage& p_image
-    );
-    static vk::UniqueDeviceMemory allocateVulkanPhysicalDeviceImageMemoryAndPopulateWithStagedData(
-        const vk::PhysicalDevice& physicalDevice,
-        const uint32_t graphicsQueueFamilyIndex,
-        const vk::UniqueDevice& p_logicalDevice,
-        const vk::Queue& graphicsQueue,
+    static quartz::rendering::MemoryAllocator::Allocation allocateVulkanPhysicalDeviceImageMemoryAndPopulateWithStagedData(
+        const quartz::rendering::Device& renderingDevice,
         const uint32_t imageWidth,
         const uint32_t imageHeight,
         const uint32_t layerCount,
-        const vk::UniqueBuffer& p_stagingBuffer,
+        const uint32_t layerSizeBytes,
+        const void* p_bufferData,
         const vk::UniqueImage& p_image,
+        const vk::ImageTiling tiling,
         const vk::MemoryPropertyFlags requiredMemoryProperties
     );
 
@@ -82,9 +63,6 @@ private: // member variables
     vk::Format m_format;
     vk::ImageTiling m_tiling;
 
-    vk::UniqueBuffer mp_vulkanLogicalStagingBuffer;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceStagingMemory;
-
     vk::UniqueImage mp_vulkanImage;
-    vk::UniqueDeviceMemory mp_vulkanPhysicalDeviceMemory;
+    quartz::rendering::MemoryAllocator::Allocation m_physicalDeviceMemoryAllocation;
 };
@@ -0,0 +1,610 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/buffer/UploadQueue.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
+#include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
+
+std::optional<quartz::rendering::UploadQueue::Batch> quartz::rendering::UploadQueue::recordingBatch;
+std::deque<quartz::rendering::UploadQueue::Batch> quartz::rendering::UploadQueue::submittedBatches;
+uint64_t quartz::rendering::UploadQueue::lastSubmittedBatchId = 0;
+uint32_t quartz::rendering::UploadQueue::stagingArenaSizeBytes = quartz::rendering::UploadQueue::defaultStagingArenaSizeBytes;
+uint32_t quartz::rendering::UploadQueue::stagingArenaUsedBytes = 0;
+uint32_t quartz::rendering::UploadQueue::stagingArenaHeadBytes = 0;
+vk::UniqueBuffer quartz::rendering::UploadQueue::p_stagingArenaBuffer;
+quartz::rendering::MemoryAllocator::Allocation quartz::rendering::UploadQueue::stagingArenaMemoryAllocation;
+void* quartz::rendering::UploadQueue::p_mappedStagingArena = nullptr;
+
+quartz::rendering::UploadQueue::Batch
+quartz::rendering::UploadQueue::createBatch(
+    const quartz::rendering::Device& renderingDevice,
+    const uint64_t id
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "batch {}", id);
+
+    vk::UniqueCommandPool p_commandPool = quartz::rendering::VulkanUtil::createVulkanCommandPoolPtr(
+        renderingDevice.getGraphicsQueueFamilyIndex(),
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        vk::CommandPoolCreateFlagBits::eTransient
+    );
+
+    vk::UniqueCommandBuffer p_commandBuffer = std::move(
+        quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            p_commandPool,
+            1
+        )[0]
+    );
+
+    vk::CommandBufferBeginInfo commandBufferBeginInfo(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    );
+    p_commandBuffer->begin(commandBufferBeginInfo);
+
+    vk::FenceCreateInfo fenceCreateInfo;
+    vk::UniqueFence p_fence = renderingDevice.getVulkanLogicalDevicePtr()->createFenceUnique(fenceCreateInfo);
+
+    if (!p_fence) {
+        LOG_THROW(BUFFER_UPLOAD, util::VulkanCreationFailedError, "Failed to create vk::Fence for batch {}", id);
+    }
+
+    return {
+        id,
+        0,
+        std::move(p_commandPool),
+        std::move(p_commandBuffer),
+        std::move(p_fence)
+    };
+}
+
+quartz::rendering::UploadQueue::Batch&
+quartz::rendering::UploadQueue::getRecordingBatch(
+    const quartz::rendering::Device& renderingDevice
+) {
+    if (!quartz::rendering::UploadQueue::recordingBatch) {
+        quartz::rendering::UploadQueue::recordingBatch = quartz::rendering::UploadQueue::createBatch(
+            renderingDevice,
+            quartz::rendering::UploadQueue::lastSubmittedBatchId + 1
+        );
+    }
+
+    return *quartz::rendering::UploadQueue::recordingBatch;
+}
+
+void
+quartz::rendering::UploadQueue::createStagingArena(
+    const quartz::rendering::Device& renderingDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "{} bytes", quartz::rendering::UploadQueue::stagingArenaSizeBytes);
+
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("upload queue staging arena");
+
+    quartz::rendering::UploadQueue::p_stagingArenaBuffer = quartz::rendering::BufferUtil::createVulkanBufferPtr(
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        quartz::rendering::UploadQueue::stagingArenaSizeBytes,
+        vk::BufferUsageFlagBits::eTransferSrc
+    );
+
+    quartz::rendering::UploadQueue::stagingArenaMemoryAllocation = quartz::rendering::BufferUtil::allocateVulkanPhysicalDeviceMemory(
+        renderingDevice,
+        quartz::rendering::UploadQueue::p_stagingArenaBuffer,
+        {
+            vk::MemoryPropertyFlagBits::eHostVisible |
+            vk::MemoryPropertyFlagBits::eHostCoherent
+        },
+        {}
+    );
+
+    quartz::rendering::UploadQueue::p_mappedStagingArena = quartz::rendering::UploadQueue::stagingArenaMemoryAllocation.getMappedLocalMemoryPtr();
+
+    quartz::rendering::UploadQueue::stagingArenaUsedBytes = 0;
+    quartz::rendering::UploadQueue::stagingArenaHeadBytes = 0;
+
+    LOG_INFO(BUFFER_UPLOAD, "Created {} byte staging arena mapped to {}", quartz::rendering::UploadQueue::stagingArenaSizeBytes, quartz::rendering::UploadQueue::p_mappedStagingArena);
+}
+
+void
+quartz::rendering::UploadQueue::releaseStagingArena() {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "");
+
+    quartz::rendering::UploadQueue::p_mappedStagingArena = nullptr;
+    quartz::rendering::UploadQueue::p_stagingArenaBuffer.reset();
+    quartz::rendering::UploadQueue::stagingArenaMemoryAllocation.reset();
+
+    quartz::rendering::UploadQueue::stagingArenaUsedBytes = 0;
+    quartz::rendering::UploadQueue::stagingArenaHeadBytes = 0;
+}
+
+uint32_t
+quartz::rendering::UploadQueue::allocateStagingArenaRegion(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t sizeBytes
+) {
+    const uint32_t alignedSizeBytes = (sizeBytes + quartz::rendering::UploadQueue::stagingArenaAlignmentBytes - 1) & ~(quartz::rendering::UploadQueue::stagingArenaAlignmentBytes - 1);
+
+    if (alignedSizeBytes > quartz::rendering::UploadQueue::stagingArenaSizeBytes) {
+        LOG_THROW(BUFFER_UPLOAD, util::VulkanCreationFailedError, "Cannot stage {} bytes in a {} byte staging arena", alignedSizeBytes, quartz::rendering::UploadQueue::stagingArenaSizeBytes);
+    }
+
+    if (!quartz::rendering::UploadQueue::p_stagingArenaBuffer) {
+        quartz::rendering::UploadQueue::createStagingArena(renderingDevice);
+    }
+
+    while (true) {
+        if (quartz::rendering::UploadQueue::stagingArenaUsedBytes == 0) {
+            quartz::rendering::UploadQueue::stagingArenaHeadBytes = 0;
+        }
+
+        /**
+         * @brief Regions are handed out (and given back) in order, so everything from the head up to
+         *   the oldest region still in use is free. A region which doesn't fit before the end of the
+         *   arena starts back at the beginning instead, using up whatever was left at the end
+         */
+        const bool shouldWrap = quartz::rendering::UploadQueue::stagingArenaHeadBytes + alignedSizeBytes > quartz::rendering::UploadQueue::stagingArenaSizeBytes;
+        const uint32_t consumedBytes = shouldWrap ?
+            quartz::rendering::UploadQueue::stagingArenaSizeBytes - quartz::rendering::UploadQueue::stagingArenaHeadBytes + alignedSizeBytes :
+            alignedSizeBytes;
+
+        if (quartz::rendering::UploadQueue::stagingArenaUsedBytes + consumedBytes <= quartz::rendering::UploadQueue::stagingArenaSizeBytes) {
+            const uint32_t offsetBytes = shouldWrap ? 0 : quartz::rendering::UploadQueue::stagingArenaHeadBytes;
+
+            quartz::rendering::UploadQueue::stagingArenaHeadBytes = offsetBytes + alignedSizeBytes;
+            quartz::rendering::UploadQueue::stagingArenaUsedBytes += consumedBytes;
+            quartz::rendering::UploadQueue::getRecordingBatch(renderingDevice).stagingArenaConsumedBytes += consumedBytes;
+
+            return offsetBytes;
+        }
+
+        LOG_TRACE(BUFFER_UPLOAD, "Staging arena has {} of {} bytes in use, waiting for room for {} more", quartz::rendering::UploadQueue::stagingArenaUsedBytes, quartz::rendering::UploadQueue::stagingArenaSizeBytes, consumedBytes);
+
+        if (
+            quartz::rendering::UploadQueue::recordingBatch &&
+            quartz::rendering::UploadQueue::recordingBatch->stagingArenaConsumedBytes > 0
+        ) {
+            quartz::rendering::UploadQueue::submit(renderingDevice);
+        }
+
+        if (quartz::rendering::UploadQueue::submittedBatches.empty()) {
+            LOG_THROW(BUFFER_UPLOAD, util::VulkanCreationFailedError, "Staging arena has {} bytes in use but no batches to wait for", quartz::rendering::UploadQueue::stagingArenaUsedBytes);
+        }
+
+        quartz::rendering::UploadQueue::waitForCompletion(
+            renderingDevice,
+            quartz::rendering::UploadQueue::submittedBatches.front().id
+        );
+    }
+}
+
+void
+quartz::rendering::UploadQueue::submitIfStagingArenaIsHalfUsed(
+    const quartz::rendering::Device& renderingDevice
+) {
+    /**
+     * @brief Send off what we have so far, so the device can start copying out of one half of the
+     *   arena while we fill the other
+     */
+    if (
+        quartz::rendering::UploadQueue::recordingBatch &&
+        quartz::rendering::UploadQueue::recordingBatch->stagingArenaConsumedBytes >= quartz::rendering::UploadQueue::stagingArenaSizeBytes / 2
+    ) {
+        LOG_TRACE(BUFFER_UPLOAD, "Batch {} is using half of the staging arena, submitting it", quartz::rendering::UploadQueue::recordingBatch->id);
+        quartz::rendering::UploadQueue::submit(renderingDevice);
+    }
+}
+
+void
+quartz::rendering::UploadQueue::recordImageLayoutTransition(
+    const vk::UniqueCommandBuffer& p_commandBuffer,
+    const vk::UniqueImage& p_image,
+    const uint32_t layerCount,
+    const vk::ImageLayout inputLayout,
+    const vk::ImageLayout outputLayout
+) {
+    vk::AccessFlags sourceAccessMask;
+    vk::AccessFlags destinationAccessMask;
+    vk::PipelineStageFlags sourceStage;
+    vk::PipelineStageFlags destinationStage;
+    if (
+        inputLayout == vk::ImageLayout::eUndefined &&
+        outputLayout == vk::ImageLayout::eTransferDstOptimal
+    ) {
+        LOG_TRACE(BUFFER_UPLOAD, "Transferring image from undefined layout to optimal transfer destination layout");
+
+        destinationAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+        sourceStage = vk::PipelineStageFlagBits::eTopOfPipe;
+        destinationStage = vk::PipelineStageFlagBits::eTransfer;
+    } else if (
+        inputLayout == vk::ImageLayout::eTransferDstOptimal &&
+        outputLayout == vk::ImageLayout::eShaderReadOnlyOptimal
+    ) {
+        LOG_TRACE(BUFFER_UPLOAD, "Transferring image from optimal transfer destination layout to optimal shader read only format");
+
+        sourceAccessMask = vk::AccessFlagBits::eTransferWrite;
+        destinationAccessMask = vk::AccessFlagBits::eShaderRead;
+
+        sourceStage = vk::PipelineStageFlagBits::eTransfer;
+        destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
+    } else {
+        LOG_THROW(BUFFER_UPLOAD, util::VulkanFeatureNotSupportedError, "Unsupported image layout transition");
+    }
+
+    vk::ImageMemoryBarrier imageMemoryBarrier(
+        sourceAccessMask,
+        destinationAccessMask,
+        inputLayout,
+        outputLayout,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        *p_image,
+        {
+            vk::ImageAspectFlagBits::eColor,
+            0,
+            1,
+            0,
+            layerCount
+        }
+    );
+
+    p_commandBuffer->pipelineBarrier(
+        sourceStage,
+        destinationStage,
+        {},
+        {},
+        {},
+        imageMemoryBarrier
+    );
+}
+
+void
+quartz::rendering::UploadQueue::recordImageRegionUpload(
+    const quartz::rendering::Device& renderingDevice,
+    const void* p_data,
+    const uint32_t sizeBytes,
+    const vk::UniqueImage& p_image,
+    const uint32_t imageWidth,
+    const uint32_t firstRow,
+    const uint32_t rowCount,
+    const uint32_t baseLayer,
+    const uint32_t layerCount
+) {
+    const uint32_t stagingOffsetBytes = quartz::rendering::UploadQueue::allocateStagingArenaRegion(
+        renderingDevice,
+        sizeBytes
+    );
+
+    std::memcpy(
+        static_cast<char*>(quartz::rendering::UploadQueue::p_mappedStagingArena) + stagingOffsetBytes,
+        p_data,
+        sizeBytes
+    );
+
+    vk::BufferImageCopy bufferImageCopy(
+        stagingOffsetBytes,
+        0,
+        0,
+        {
+            vk::ImageAspectFlagBits::eColor,
+            0,
+            baseLayer,
+            layerCount
+        },
+        {
+            0,
+            static_cast<int32_t>(firstRow),
+            0
+        },
+        {
+            imageWidth,
+            rowCount,
+            1
+        }
+    );
+
+    quartz::rendering::UploadQueue::getRecordingBatch(renderingDevice).p_vulkanCommandBuffer->copyBufferToImage(
+        *(quartz::rendering::UploadQueue::p_stagingArenaBuffer),
+        *p_image,
+        vk::ImageLayout::eTransferDstOptimal,
+        bufferImageCopy
+    );
+}
+
+void
+quartz::rendering::UploadQueue::recordBufferUpload(
+    const quartz::rendering::Device& renderingDevice,
+    const void* p_data,
+    const uint32_t sizeBytes,
+    const vk::UniqueBuffer& p_destinationBuffer,
+    const uint32_t destinationOffsetBytes
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "{} bytes at offset {}", sizeBytes, destinationOffsetBytes);
+
+    uint32_t uploadedSizeBytes = 0;
+    while (uploadedSizeBytes < sizeBytes) {
+        const uint32_t chunkSizeBytes = std::min(
+            sizeBytes - uploadedSizeBytes,
+            quartz::rendering::UploadQueue::stagingArenaSizeBytes
+        );
+
+        const uint32_t stagingOffsetBytes = quartz::rendering::UploadQueue::allocateStagingArenaRegion(
+            renderingDevice,
+            chunkSizeBytes
+        );
+
+        std::memcpy(
+            static_cast<char*>(quartz::rendering::UploadQueue::p_mappedStagingArena) + stagingOffsetBytes,
+            static_cast<const char*>(p_data) + uploadedSizeBytes,
+            chunkSizeBytes
+        );
+
+        vk::BufferCopy bufferCopyRegion(
+            stagingOffsetBytes,
+            destinationOffsetBytes + uploadedSizeBytes,
+            chunkSizeBytes
+        );
+
+        quartz::rendering::UploadQueue::getRecordingBatch(renderingDevice).p_vulkanCommandBuffer->copyBuffer(
+            *(quartz::rendering::UploadQueue::p_stagingArenaBuffer),
+            *p_destinationBuffer,
+            bufferCopyRegion
+        );
+
+        uploadedSizeBytes += chunkSizeBytes;
+    }
+
+    LOG_TRACE(BUFFER_UPLOAD, "Recorded copy into batch {}", quartz::rendering::UploadQueue::lastSubmittedBatchId + 1);
+
+    quartz::rendering::UploadQueue::submitIfStagingArenaIsHalfUsed(renderingDevice);
+}
+
+void
+quartz::rendering::UploadQueue::recordImageUpload(
+    const quartz::rendering::Device& renderingDevice,
+    const void* p_data,
+    const uint32_t layerSizeBytes,
+    const vk::UniqueImage& p_image,
+    const uint32_t imageWidth,
+    const uint32_t imageHeight,
+    const uint32_t layerCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "{}x{} image with {} layers", imageWidth, imageHeight, layerCount);
+
+    quartz::rendering::UploadQueue::recordImageLayoutTransition(
+        quartz::rendering::UploadQueue::getRecordingBatch(renderingDevice).p_vulkanCommandBuffer,
+        p_image,
+        layerCount,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eTransferDstOptimal
+    );
+
+    if (layerSizeBytes * layerCount <= quartz::rendering::UploadQueue::stagingArenaSizeBytes) {
+        quartz::rendering::UploadQueue::recordImageRegionUpload(
+            renderingDevice,
+            p_data,
+            layerSizeBytes * layerCount,
+            p_image,
+            imageWidth,
+            0,
+            imageHeight,
+            0,
+            layerCount
+        );
+    } else {
+        /**
+         * @brief Too big to stage all at once, so copy as many whole rows of a layer as fit at a time.
+         *   The layout transitions stay in order around the chunks even when they end up in different batches
+         */
+        const uint32_t rowSizeBytes = layerSizeBytes / imageHeight;
+        const uint32_t maxChunkRowCount = quartz::rendering::UploadQueue::stagingArenaSizeBytes / rowSizeBytes;
+
+        if (maxChunkRowCount == 0) {
+            LOG_THROW(BUFFER_UPLOAD, util::VulkanCreationFailedError, "Cannot stage a single {} byte row of an image in a {} byte staging arena", rowSizeBytes, quartz::rendering::UploadQueue::stagingArenaSizeBytes);
+        }
+
+        LOG_TRACE(BUFFER_UPLOAD, "Staging image in chunks of {} rows", maxChunkRowCount);
+
+        for (uint32_t layer = 0; layer < layerCount; ++layer) {
+            for (uint32_t firstRow = 0; firstRow < imageHeight; firstRow += maxChunkRowCount) {
+                const uint32_t rowCount = std::min(maxChunkRowCount, imageHeight - firstRow);
+
+                quartz::rendering::UploadQueue::recordImageRegionUpload(
+                    renderingDevice,
+                    static_cast<const char*>(p_data) + (layer * layerSizeBytes) + (firstRow * rowSizeBytes),
+                    rowCount * rowSizeBytes,
+                    p_image,
+                    imageWidth,
+                    firstRow,
+                    rowCount,
+                    layer,
+                    1
+                );
+            }
+        }
+    }
+
+    quartz::rendering::UploadQueue::recordImageLayoutTransition(
+        quartz::rendering::UploadQueue::getRecordingBatch(renderingDevice).p_vulkanCommandBuffer,
+        p_image,
+        layerCount,
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageLayout::eShaderReadOnlyOptimal
+    );
+
+    LOG_TRACE(BUFFER_UPLOAD, "Recorded image copy into batch {}", quartz::rendering::UploadQueue::lastSubmittedBatchId + 1);
+
+    quartz::rendering::UploadQueue::submitIfStagingArenaIsHalfUsed(renderingDevice);
+}
+
+uint64_t
+quartz::rendering::UploadQueue::submit(
+    const quartz::rendering::Device& renderingDevice
+) {
+    quartz::rendering::UploadQueue::releaseCompletedBatches(renderingDevice);
+
+    if (!quartz::rendering::UploadQueue::recordingBatch) {
+        return quartz::rendering::UploadQueue::lastSubmittedBatchId;
+    }
+
+    quartz::rendering::UploadQueue::Batch& batch = *quartz::rendering::UploadQueue::recordingBatch;
+
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "batch {}", batch.id);
+
+    /**
+     * @brief The image copies already transitioned their images for the fragment shader. This covers the
+     *   vertex, index and storage buffers, whose readers we don't know about here
+     */
+    vk::MemoryBarrier memoryBarrier(
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eMemoryRead
+    );
+
+    batch.p_vulkanCommandBuffer->pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eAllCommands,
+        {},
+        memoryBarrier,
+        {},
+        {}
+    );
+
+    batch.p_vulkanCommandBuffer->end();
+
+    vk::SubmitInfo submitInfo(
+        0,
+        nullptr,
+        nullptr,
+        1,
+        &(*(batch.p_vulkanCommandBuffer)),
+        0,
+        nullptr
+    );
+    renderingDevice.getVulkanGraphicsQueue().submit(submitInfo, *(batch.p_vulkanFence));
+
+    LOG_DEBUG(BUFFER_UPLOAD, "Submitted batch {} using {} bytes of the staging arena", batch.id, batch.stagingArenaConsumedBytes);
+
+    quartz::rendering::UploadQueue::lastSubmittedBatchId = batch.id;
+    quartz::rendering::UploadQueue::submittedBatches.push_back(std::move(batch));
+    quartz::rendering::UploadQueue::recordingBatch.reset();
+
+    return quartz::rendering::UploadQueue::lastSubmittedBatchId;
+}
+
+bool
+quartz::rendering::UploadQueue::getIsComplete(
+    const quartz::rendering::Device& renderingDevice,
+    const uint64_t batchId
+) {
+    if (batchId > quartz::rendering::UploadQueue::lastSubmittedBatchId) {
+        return false;
+    }
+
+    for (const quartz::rendering::UploadQueue::Batch& batch : quartz::rendering::UploadQueue::submittedBatches) {
+        if (batch.id == batchId) {
+            return renderingDevice.getVulkanLogicalDevicePtr()->getFenceStatus(*(batch.p_vulkanFence)) == vk::Result::eSuccess;
+        }
+    }
+
+    // It was already released, which only happens once it completed
+    return true;
+}
+
+void
+quartz::rendering::UploadQueue::waitForCompletion(
+    const quartz::rendering::Device& renderingDevice,
+    const uint64_t batchId
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "batch {}", batchId);
+
+    if (batchId > quartz::rendering::UploadQueue::lastSubmittedBatchId) {
+        quartz::rendering::UploadQueue::submit(renderingDevice);
+    }
+
+    for (const quartz::rendering::UploadQueue::Batch& batch : quartz::rendering::UploadQueue::submittedBatches) {
+        if (batch.id != batchId) {
+            continue;
+        }
+
+        vk::Result result = renderingDevice.getVulkanLogicalDevicePtr()->waitForFences(
+            *(batch.p_vulkanFence),
+            true,
+            std::numeric_limits<uint64_t>::max()
+        );
+
+        if (result != vk::Result::eSuccess) {
+            LOG_ERROR(BUFFER_UPLOAD, "Failed to wait for batch {} to finish: {}", batchId, static_cast<uint32_t>(result));
+        }
+
+        break;
+    }
+
+    quartz::rendering::UploadQueue::releaseCompletedBatches(renderingDevice);
+}
+
+void
+quartz::rendering::UploadQueue::releaseCompletedBatches(
+    const quartz::rendering::Device& renderingDevice
+) {
+    while (
+        !quartz::rendering::UploadQueue::submittedBatches.empty() &&
+        renderingDevice.getVulkanLogicalDevicePtr()->getFenceStatus(*(quartz::rendering::UploadQueue::submittedBatches.front().p_vulkanFence)) == vk::Result::eSuccess
+    ) {
+        LOG_TRACE(BUFFER_UPLOAD, "Releasing completed batch {}", quartz::rendering::UploadQueue::submittedBatches.front().id);
+        quartz::rendering::UploadQueue::stagingArenaUsedBytes -= quartz::rendering::UploadQueue::submittedBatches.front().stagingArenaConsumedBytes;
+        quartz::rendering::UploadQueue::submittedBatches.pop_front();
+    }
+}
+
+void
+quartz::rendering::UploadQueue::cleanUpAllBatches() {
+    LOG_FUNCTION_CALL_TRACE(BUFFER_UPLOAD, "");
+
+    // Never submitted, so nothing on the device can be using it
+    quartz::rendering::UploadQueue::recordingBatch.reset();
+
+    for (const quartz::rendering::UploadQueue::Batch& batch : quartz::rendering::UploadQueue::submittedBatches) {
+        vk::Result result = batch.p_vulkanFence.getOwner().waitForFences(
+            *(batch.p_vulkanFence),
+            true,
+            std::numeric_limits<uint64_t>::max()
+        );
+
+        if (result != vk::Result::eSuccess) {
+            LOG_ERROR(BUFFER_UPLOAD, "Failed to wait for batch {} to finish: {}", batch.id, static_cast<uint32_t>(result));
+        }
+    }
+
+    quartz::rendering::UploadQueue::submittedBatches.clear();
+
+    quartz::rendering::UploadQueue::releaseStagingArena();
+}
+
+void
+quartz::rendering::UploadQueue::setStagingArenaSizeBytes(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t sizeBytes
+) {
+    LOG_FUNCTION_SCOPE_TRACE(BUFFER_UPLOAD, "{} bytes", sizeBytes);
+
+    quartz::rendering::UploadQueue::waitForCompletion(
+        renderingDevice,
+        quartz::rendering::UploadQueue::submit(renderingDevice)
+    );
+
+    quartz::rendering::UploadQueue::releaseStagingArena();
+
+    quartz::rendering::UploadQueue::stagingArenaSizeBytes = std::max(
+        sizeBytes & ~(quartz::rendering::UploadQueue::stagingArenaAlignmentBytes - 1),
+        quartz::rendering::UploadQueue::stagingArenaAlignmentBytes
+    );
+
+    LOG_INFO(BUFFER_UPLOAD, "Using a {} byte staging arena", quartz::rendering::UploadQueue::stagingArenaSizeBytes);
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
+
+namespace quartz {
+namespace rendering {
+    class UploadQueue;
+}
+}
+
+/**
+ * @brief Records the copies and layout transitions which fill device local buffers and images into one
+ *   command buffer per batch, instead of submitting (and draining the queue) once per copy. A batch is
+ *   submitted with its own fence when submit is called, when it has used up half of the staging arena,
+ *   or at the latest right before the next frame is submitted, so an upload is always on the graphics
+ *   queue ahead of the first frame which could use it.
+ *
+ * @brief Every batch ends with a barrier making its transfer writes visible to everything submitted
+ *   after it, so drawing never has to wait on the cpu for uploads. Callers who need to know when their
+ *   data has landed can poll or wait on the id which submit hands back.
+ *
+ * @brief All data is staged through a single persistently mapped staging arena which is handed out like
+ *   a ring. A batch's share of the arena is given back as soon as its fence signals, so nothing holds on
+ *   to a host visible copy of its data. Uploads larger than the arena are split into chunks which fit,
+ *   waiting for earlier batches to free up room when they need to.
+ */
+class quartz::rendering::UploadQueue {
+public: // member functions
+    UploadQueue() = delete;
+
+public: // static variables
+    static constexpr uint32_t defaultStagingArenaSizeBytes = 64 * 1024 * 1024;
+
+    /**
+     * @brief Every staged region starts on a multiple of this, which satisfies the offset requirements
+     *   of buffer to image copies for every format we upload
+     */
+    static constexpr uint32_t stagingArenaAlignmentBytes = 16;
+
+public: // static functions
+    static void recordBufferUpload(
+        const quartz::rendering::Device& renderingDevice,
+        const void* p_data,
+        const uint32_t sizeBytes,
+        const vk::UniqueBuffer& p_destinationBuffer,
+        const uint32_t destinationOffsetBytes
+    );
+    /**
+     * @brief Transitions the image (from an undefined layout) to a transfer destination, copies every
+     *   layer into it and transitions it to be read by fragment shaders. The layers are expected to be
+     *   tightly packed one after the other in p_data
+     */
+    static void recordImageUpload(
+        const quartz::rendering::Device& renderingDevice,
+        const void* p_data,
+        const uint32_t layerSizeBytes,
+        const vk::UniqueImage& p_image,
+        const uint32_t imageWidth,
+        const uint32_t imageHeight,
+        const uint32_t layerCount
+    );
+
+    /**
+     * @brief Release any batches which have completed, then submit everything recorded since the last
+     *   submission and return the id of the batch it went out in. When nothing has been recorded this
+     *   returns the id of the last batch submitted (0 if there never was one)
+     */
+    static uint64_t submit(const quartz::rendering::Device& renderingDevice);
+    static bool getIsComplete(
+        const quartz::rendering::Device& renderingDevice,
+        const uint64_t batchId
+    );
+    static void waitForCompletion(
+        const quartz::rendering::Device& renderingDevice,
+        const uint64_t batchId
+    );
+    static void releaseCompletedBatches(const quartz::rendering::Device& renderingDevice);
+    static void cleanUpAllBatches();
+
+    static uint32_t getStagingArenaSizeBytes() { return quartz::rendering::UploadQueue::stagingArenaSizeBytes; }
+    static uint32_t getStagingArenaUsedBytes() { return quartz::rendering::UploadQueue::stagingArenaUsedBytes; }
+
+    /**
+     * @brief Submits and waits for every outstanding upload, then drops the arena so it is created again
+     *   at the new size by the next upload
+     */
+    static void setStagingArenaSizeBytes(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t sizeBytes
+    );
+
+private: // classes
+    struct Batch {
+    public: // member variables
+        uint64_t id;
+        uint32_t stagingArenaConsumedBytes; // including anything skipped over when wrapping around the arena
+        vk::UniqueCommandPool p_vulkanCommandPool;
+        vk::UniqueCommandBuffer p_vulkanCommandBuffer;
+        vk::UniqueFence p_vulkanFence;
+    };
+
+private: // static functions
+    static quartz::rendering::UploadQueue::Batch createBatch(
+        const quartz::rendering::Device& renderingDevice,
+        const uint64_t id
+    );
+    static quartz::rendering::UploadQueue::Batch& getRecordingBatch(
+        const quartz::rendering::Device& renderingDevice
+    );
+    static void createStagingArena(const quartz::rendering::Device& renderingDevice);
+    static void releaseStagingArena();
+
+    /**
+     * @brief Reserve sizeBytes of the arena for the recording batch, returning the offset of the region.
+     *   When the arena is full this submits the recording batch and waits for the oldest batches to
+     *   finish until there is room
+     */
+    static uint32_t allocateStagingArenaRegion(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t sizeBytes
+    );
+    static void submitIfStagingArenaIsHalfUsed(const quartz::rendering::Device& renderingDevice);
+
+    static void recordImageLayoutTransition(
+        const vk::UniqueCommandBuffer& p_commandBuffer,
+        const vk::UniqueImage& p_image,
+        const uint32_t layerCount,
+        const vk::ImageLayout inputLayout,
+        const vk::ImageLayout outputLayout
+    );
+    static void recordImageRegionUpload(
+        const quartz::rendering::Device& renderingDevice,
+        const void* p_data,
+        const uint32_t sizeBytes,
+        const vk::UniqueImage& p_image,
+        const uint32_t imageWidth,
+        const uint32_t firstRow,
+        const uint32_t rowCount,
+        const uint32_t baseLayer,
+        const uint32_t layerCount
+    );
+
+private: // static variables
+    static std::optional<quartz::rendering::UploadQueue::Batch> recordingBatch;
+    static std::deque<quartz::rendering::UploadQueue::Batch> submittedBatches; // in submission order
+    static uint64_t lastSubmittedBatchId;
+
+    static uint32_t stagingArenaSizeBytes;
+    static uint32_t stagingArenaUsedBytes;
+    static uint32_t stagingArenaHeadBytes; // where the next region starts, unless it has to wrap around
+    static vk::UniqueBuffer p_stagingArenaBuffer;
+    static quartz::rendering::MemoryAllocator::Allocation stagingArenaMemoryAllocation;
+    static void* p_mappedStagingArena; // persistently mapped by the allocator
+};
\ No newline at end of file
@@ -1,13 +1,21 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "util/macros.hpp"
 #include "util/file_system/FileSystem.hpp"
 
 #include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/UploadQueue.hpp"
 #include "quartz/rendering/context/Context.hpp"
 #include "quartz/rendering/cube_map/CubeMap.hpp"
+#include "quartz/rendering/culling/LightCuller.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/material/Material.hpp"
+#include "quartz/rendering/model/Primitive.hpp"
 #include "quartz/rendering/pipeline/Pipeline.hpp"
-#include "quartz/rendering/pipeline/PushConstantInfo.hpp"
 #include "quartz/rendering/pipeline/UniformBufferInfo.hpp"
 #include "quartz/rendering/pipeline/UniformSamplerInfo.hpp"
 #include "quartz/rendering/pipeline/UniformTextureArrayInfo.hpp"
@@ -26,6 +34,8 @@ quartz::rendering::Context::createSkyBoxRenderingPipeline(
 ) {
     LOG_FUNCTION_SCOPE_DEBUG(CONTEXT, "");
 
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("sky box pipeline");
+
     std::vector<quartz::rendering::UniformBufferInfo> uniformBufferInfos = {
         // camera
         {
@@ -34,7 +44,7 @@ quartz::rendering::Context::createSkyBoxRenderingPipeline(
             0,
             1,
             sizeof(quartz::scene::Camera::UniformBufferObject),
-            false,
+            true,
             vk::ShaderStageFlagBits::eVertex
         }
     };
@@ -62,7 +72,8 @@ quartz::rendering::Context::createSkyBoxRenderingPipeline(
         uniformBufferInfos,
         uniformSamplerCubeInfo,
         std::nullopt,
-        std::nullopt
+        std::nullopt,
+        {}
     };
 }
 
@@ -71,26 +82,13 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
     const quartz::rendering::Device& renderingDevice,
     const quartz::rendering::Window& renderingWindow,
     const quartz::rendering::RenderPass& renderingRenderPass,
+    const quartz::rendering::LightCuller& lightCuller,
     const uint32_t maxNumFramesInFlight
 ) {
     LOG_FUNCTION_SCOPE_DEBUG(CONTEXT, "");
 
-    std::vector<quartz::rendering::PushConstantInfo> pushConstantInfos = {
-        // perObjectVertexPushConstant (for model matrix)
-        {
-            vk::ShaderStageFlagBits::eVertex,
-            0,
-            sizeof(glm::mat4)
-        },
-        // dummy
-        {
-            vk::ShaderStageFlagBits::eFragment,
-            sizeof(glm::mat4),
-            sizeof(uint32_t)
-        }
-    };
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("doodad pipeline");
 
-    const uint32_t materialByteStride = quartz::rendering::UniformBufferInfo::calculateDynamicUniformBufferByteStride(renderingDevice, sizeof(quartz::rendering::Material::UniformBufferObject));
     std::vector<quartz::rendering::UniformBufferInfo> uniformBufferInfos = {
         // the camera
         {
@@ -99,7 +97,7 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
             0,
             1,
             sizeof(quartz::scene::Camera::UniformBufferObject),
-            false,
+            true,
             vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment
         },
         // the ambient light
@@ -109,7 +107,7 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
             1,
             1,
             sizeof(quartz::scene::AmbientLight),
-            false,
+            true,
             vk::ShaderStageFlagBits::eFragment
         },
         // the directional light
@@ -119,58 +117,28 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
             2,
             1,
             sizeof(quartz::scene::DirectionalLight),
-            false,
-            vk::ShaderStageFlagBits::eFragment
-        },
-        // the number of point lights
-        {
-            sizeof(uint32_t),
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            3,
-            1,
-            sizeof(uint32_t),
-            false,
-            vk::ShaderStageFlagBits::eFragment
-        },
-        // the point lights
-        {
-            sizeof(quartz::scene::PointLight) * QUARTZ_MAX_NUMBER_POINT_LIGHTS,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            4,
-            1,
-            sizeof(quartz::scene::PointLight),
-            false,
+            true,
             vk::ShaderStageFlagBits::eFragment
         },
-        // the number of spot lights
+        // the materials
         {
-            sizeof(uint32_t),
+            sizeof(quartz::rendering::Material::UniformBufferObject) * QUARTZ_MAX_NUMBER_MATERIALS,
             vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            5,
+            9,
             1,
-            sizeof(uint32_t),
-            false,
+            sizeof(quartz::rendering::Material::UniformBufferObject),
+            vk::DescriptorType::eStorageBufferDynamic,
             vk::ShaderStageFlagBits::eFragment
         },
-        // the spot lights
+        // the per draw model matrices and material indices
         {
-            sizeof(quartz::scene::SpotLight) * QUARTZ_MAX_NUMBER_SPOT_LIGHTS,
+            sizeof(quartz::rendering::Primitive::DrawStorageBufferObject) * QUARTZ_MAX_NUMBER_DRAWS,
             vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            6,
-            1,
-            sizeof(quartz::scene::SpotLight),
-            false,
-            vk::ShaderStageFlagBits::eFragment
-        },
-        // the materials
-        {
-            materialByteStride * QUARTZ_MAX_NUMBER_MATERIALS,
-            vk::MemoryPropertyFlagBits::eHostVisible,
-            9,
+            10,
             1,
-            materialByteStride,
-            true,
-            vk::ShaderStageFlagBits::eFragment
+            sizeof(quartz::rendering::Primitive::DrawStorageBufferObject),
+            vk::DescriptorType::eStorageBufferDynamic,
+            vk::ShaderStageFlagBits::eVertex
         },
     };
 
@@ -186,10 +154,10 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
         vk::ShaderStageFlagBits::eFragment
     );
 
-    LOG_DEBUG(PIPELINE, "Using {} push constants", pushConstantInfos.size());
     LOG_DEBUG(PIPELINE, "Using {} uniform buffers", uniformBufferInfos.size());
     LOG_DEBUG(PIPELINE, "Using a uniform sampler");
     LOG_DEBUG(PIPELINE, "Using a uniform texture array");
+    LOG_DEBUG(PIPELINE, "Using the light culler's descriptor set as set 1");
 
     return {
         renderingDevice,
@@ -202,14 +170,47 @@ quartz::rendering::Context::createDoodadRenderingPipeline(
         quartz::rendering::Vertex::getVulkanVertexInputAttributeDescriptions(),
         vk::CullModeFlagBits::eBack,
         true,
-        pushConstantInfos,
+        {},
         uniformBufferInfos,
         std::nullopt,
         uniformSamplerInfo,
-        uniformTextureArrayInfo
+        uniformTextureArrayInfo,
+        { *(lightCuller.getVulkanDescriptorSetLayoutPtr()) }
     };
 }
 
+uint32_t
+quartz::rendering::Context::clampMaxNumFramesInFlight(const uint32_t maxNumFramesInFlight) {
+    const uint32_t clampedMaxNumFramesInFlight = std::clamp(
+        maxNumFramesInFlight,
+        quartz::rendering::Context::minSupportedNumFramesInFlight,
+        quartz::rendering::Context::maxSupportedNumFramesInFlight
+    );
+
+    if (clampedMaxNumFramesInFlight != maxNumFramesInFlight) {
+        LOG_WARNING(CONTEXT, "{} frames in flight is outside of the supported {} to {}, using {} instead", maxNumFramesInFlight, quartz::rendering::Context::minSupportedNumFramesInFlight, quartz::rendering::Context::maxSupportedNumFramesInFlight, clampedMaxNumFramesInFlight);
+    }
+
+    return clampedMaxNumFramesInFlight;
+}
+
+bool
+quartz::rendering::Context::getIndirectDrawingSupported(
+    const quartz::rendering::Device& renderingDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CONTEXT, "");
+
+    const vk::PhysicalDeviceFeatures& enabledPhysicalDeviceFeatures = renderingDevice.getVulkanEnabledPhysicalDeviceFeatures();
+
+    const bool indirectDrawingSupported =
+        enabledPhysicalDeviceFeatures.multiDrawIndirect &&
+        enabledPhysicalDeviceFeatures.drawIndirectFirstInstance;
+
+    LOG_DEBUG(CONTEXT, "Indirect drawing is {}supported", indirectDrawingSupported ? "" : "not ");
+
+    return indirectDrawingSupported;
+}
+
 quartz::rendering::Context::Context(
     const std::string& applicationName,
     const uint32_t applicationMajorVersion,
@@ -217,9 +218,16 @@ quartz::rendering::Context::Context(
     const uint32_t applicationPatchVersion,
     const uint32_t windowWidthPixels,
     const uint32_t windowHeightPixels,
-    const bool validationLayersEnabled
+    const bool validationLayersEnabled,
+    const uint32_t maxNumFramesInFlight,
+    const uint32_t desiredSwapchainImageCount,
+    const vk::PresentModeKHR desiredPresentMode
 ) :
-    m_maxNumFramesInFlight(2),
+    m_maxNumFramesInFlight(
+        quartz::rendering::Context::clampMaxNumFramesInFlight(
+            maxNumFramesInFlight
+        )
+    ),
     m_currentInFlightFrameIndex(0),
     m_renderingInstance(
         applicationName,
@@ -233,6 +241,7 @@ quartz::rendering::Context::Context(
         applicationName,
         windowWidthPixels,
         windowHeightPixels,
+        desiredPresentMode,
         m_renderingInstance,
         m_renderingDevice
     ),
@@ -240,6 +249,10 @@ quartz::rendering::Context::Context(
         m_renderingDevice,
         m_renderingWindow
     ),
+    m_lightCuller(
+        m_renderingDevice,
+        m_maxNumFramesInFlight
+    ),
     m_skyBoxRenderingPipeline(
         quartz::rendering::Context::createSkyBoxRenderingPipeline(
             m_renderingDevice,
@@ -253,6 +266,7 @@ quartz::rendering::Context::Context(
             m_renderingDevice,
             m_renderingWindow,
             m_renderingRenderPass,
+            m_lightCuller,
             m_maxNumFramesInFlight
         )
     ),
@@ -260,16 +274,101 @@ quartz::rendering::Context::Context(
         m_renderingDevice,
         m_renderingWindow,
         m_renderingRenderPass,
-        m_maxNumFramesInFlight
-    )
+        m_maxNumFramesInFlight,
+        desiredSwapchainImageCount
+    ),
+    m_shouldDrawIndirectly(
+        quartz::rendering::Context::getIndirectDrawingSupported(
+            m_renderingDevice
+        )
+    ),
+    m_shouldCullOnGpu(false),
+    m_shouldCullOccluded(false),
+    m_uploadedRevisions(m_maxNumFramesInFlight, quartz::rendering::Context::UploadedRevisions{}),
+    m_numSwapchainRecreations(0),
+    m_shouldRecreateSwapchain(false),
+    m_shouldMinimizeLatency(false),
+    m_hasWaitedForInFlightFrame(false)
 {
-    LOG_FUNCTION_CALL_TRACEthis("");
+    LOG_FUNCTION_CALL_TRACEthis("{} frames in flight", m_maxNumFramesInFlight);
 }
 
 quartz::rendering::Context::~Context() {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
 
+void
+quartz::rendering::Context::setShouldDrawIndirectly(const bool shouldDrawIndirectly) {
+    if (shouldDrawIndirectly && !quartz::rendering::Context::getIndirectDrawingSupported(m_renderingDevice)) {
+        LOG_WARNINGthis("Indirect drawing is not supported by the device. Continuing to draw directly");
+        m_shouldDrawIndirectly = false;
+        return;
+    }
+
+    LOG_INFOthis("Drawing doodads {}", shouldDrawIndirectly ? "indirectly" : "directly");
+    m_shouldDrawIndirectly = shouldDrawIndirectly;
+}
+
+void
+quartz::rendering::Context::setShouldCullOnGpu(const bool shouldCullOnGpu) {
+    if (shouldCullOnGpu && !m_renderingSwapchain.getGpuCullerCreated()) {
+        LOG_WARNINGthis("Gpu culling is not supported by the device. Continuing to cull on the cpu");
+        m_shouldCullOnGpu = false;
+        return;
+    }
+
+    if (shouldCullOnGpu && !m_shouldDrawIndirectly) {
+        LOG_WARNINGthis("Gpu culling only takes effect while drawing indirectly");
+    }
+
+    LOG_INFOthis("Culling doodads on the {}", shouldCullOnGpu ? "gpu" : "cpu");
+    m_shouldCullOnGpu = shouldCullOnGpu;
+}
+
+void
+quartz::rendering::Context::setShouldCullOccluded(const bool shouldCullOccluded) {
+    if (shouldCullOccluded && !m_renderingSwapchain.getGpuCullerCreated()) {
+        LOG_WARNINGthis("Occlusion culling requires gpu culling, which is not supported by the device");
+        m_shouldCullOccluded = false;
+        return;
+    }
+
+    if (shouldCullOccluded && !m_shouldCullOnGpu) {
+        LOG_WARNINGthis("Occlusion culling only takes effect while culling on the gpu");
+    }
+
+    LOG_INFOthis("{} occluded doodads", shouldCullOccluded ? "Culling" : "Not culling");
+    m_shouldCullOccluded = shouldCullOccluded;
+}
+
+void
+quartz::rendering::Context::setDesiredSwapchainImageCount(const uint32_t desiredSwapchainImageCount) {
+    LOG_INFOthis("Desiring {} swapchain images", desiredSwapchainImageCount);
+    m_renderingSwapchain.setDesiredImageCount(desiredSwapchainImageCount);
+}
+
+void
+quartz::rendering::Context::setDesiredPresentMode(const vk::PresentModeKHR desiredPresentMode) {
+    LOG_INFOthis("Desiring {} present mode", vk::to_string(desiredPresentMode));
+    m_renderingWindow.setDesiredVulkanPresentMode(desiredPresentMode);
+    m_shouldRecreateSwapchain = true;
+}
+
+void
+quartz::rendering::Context::setShouldMinimizeLatency(const bool shouldMinimizeLatency) {
+    LOG_INFOthis("{}inimizing latency", shouldMinimizeLatency ? "M" : "Not m");
+    m_shouldMinimizeLatency = shouldMinimizeLatency;
+}
+
+void
+quartz::rendering::Context::waitForInFlightFrame() {
+    m_renderingSwapchain.waitForInFlightFence(
+        m_renderingDevice,
+        m_currentInFlightFrameIndex
+    );
+    m_hasWaitedForInFlightFrame = true;
+}
+
 void
 quartz::rendering::Context::loadScene(const quartz::scene::Scene& scene) {
     LOG_FUNCTION_SCOPE_TRACEthis("");
@@ -284,27 +383,43 @@ quartz::rendering::Context::loadScene(const quartz::scene::Scene& scene) {
     m_doodadRenderingPipeline.updateTextureArrayDescriptorSets(m_renderingDevice, quartz::rendering::Texture::getMasterTextureList());
 
     m_renderingSwapchain.setScreenClearColor(scene.getScreenClearColor());
+
+    LOG_DEBUGthis("Marking every frame's scene uniforms as stale");
+    std::fill(
+        m_uploadedRevisions.begin(),
+        m_uploadedRevisions.end(),
+        quartz::rendering::Context::UploadedRevisions{}
+    );
+
+    m_renderingDevice.getMemoryAllocator().logStatistics();
+    quartz::rendering::MemoryAccounting::logAssetUsages();
+    m_renderingDevice.getMemoryAllocator().writeReportToFile(
+        util::FileSystem::getAbsoluteFilepathInBinaryDirectory(quartz::rendering::Context::memoryReportFilename)
+    );
 }
 
 void
 quartz::rendering::Context::draw(
     const quartz::scene::Scene& scene
 ) {
-    m_renderingSwapchain.waitForInFlightFence(
-        m_renderingDevice,
-        m_currentInFlightFrameIndex
-    );
+    if (!m_hasWaitedForInFlightFrame) {
+        this->waitForInFlightFrame();
+    }
+    m_hasWaitedForInFlightFrame = false;
 
-    const uint32_t availableSwapchainImageIndex = m_renderingSwapchain.getAvailableImageIndex(
+    const std::optional<uint32_t> o_availableSwapchainImageIndex = m_renderingSwapchain.getAvailableImageIndex(
         m_renderingDevice,
         m_currentInFlightFrameIndex
     );
 
-    if (m_renderingSwapchain.getShouldRecreate() || m_renderingWindow.getWasResized()) {
+    // Nothing was acquired (so nothing was signaled) and the frame's fence is still signaled, so we can just skip it
+    if (!o_availableSwapchainImageIndex) {
         recreateSwapchain();
         return;
     }
 
+    const uint32_t availableSwapchainImageIndex = *o_availableSwapchainImageIndex;
+
     // update skybox pipeline //
 
     quartz::scene::Camera::UniformBufferObject cameraUBO(scene.getCamera());
@@ -314,36 +429,36 @@ quartz::rendering::Context::draw(
 
     m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 0, &cameraUBO);
 
-    quartz::scene::AmbientLight ambientLight(scene.getAmbientLight());
-    m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 1, &ambientLight);
-
-    quartz::scene::DirectionalLight directionalLight(scene.getDirectionalLight());
-    m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 2, &directionalLight);
+    quartz::rendering::Context::UploadedRevisions& uploadedRevisions = m_uploadedRevisions[m_currentInFlightFrameIndex];
 
-    uint32_t pointLightCount = scene.getPointLights().size();
-    m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 3, &pointLightCount);
-    if (pointLightCount > 0) {
-        m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 4, const_cast<quartz::scene::PointLight*>(scene.getPointLights().data()));
+    if (uploadedRevisions.ambientLight != scene.getAmbientLightRevision()) {
+        quartz::scene::AmbientLight ambientLight(scene.getAmbientLight());
+        m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 1, &ambientLight);
+        uploadedRevisions.ambientLight = scene.getAmbientLightRevision();
     }
 
-    uint32_t spotLightCount = scene.getSpotLights().size();
-    m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 5, &spotLightCount);
-    if (spotLightCount > 0) {
-        m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 6, const_cast<quartz::scene::SpotLight*>(scene.getSpotLights().data()));
+    if (uploadedRevisions.directionalLight != scene.getDirectionalLightRevision()) {
+        quartz::scene::DirectionalLight directionalLight(scene.getDirectionalLight());
+        m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 2, &directionalLight);
+        uploadedRevisions.directionalLight = scene.getDirectionalLightRevision();
     }
 
-    std::vector<uint8_t> alignedMaterialUBOBytes(m_doodadRenderingPipeline.getUniformBufferInfo(7).getLocallyMappedBufferSize(), 0x00);
-    const uint32_t numBytesToCopy = sizeof(quartz::rendering::Material::UniformBufferObject);
-    const uint32_t objectStride = m_doodadRenderingPipeline.getUniformBufferInfo(7).getObjectStrideBytes();
-    uint8_t* p_bufferStart = alignedMaterialUBOBytes.data();
-    for (uint32_t i = 0; i < quartz::rendering::Material::getMasterMaterialList().size(); ++i) {
-        quartz::rendering::Material::UniformBufferObject materialUBO(*(quartz::rendering::Material::getMasterMaterialList()[i]));
-        const uint32_t addressOffsetBytes = objectStride * i;
-        uint8_t* p_UBODestination = p_bufferStart + addressOffsetBytes;
+    this->updateModifiedMaterials(m_currentInFlightFrameIndex);
 
-        memcpy(p_UBODestination, &materialUBO, numBytesToCopy);
-    }
-    m_doodadRenderingPipeline.updateUniformBuffer(m_currentInFlightFrameIndex, 7, alignedMaterialUBOBytes.data());
+    // update the lights binned by the light culler //
+
+    m_lightCuller.updateLights(
+        m_renderingDevice,
+        m_currentInFlightFrameIndex,
+        scene.getCamera(),
+        m_renderingWindow.getVulkanExtent(),
+        scene.getPointLights(),
+        scene.getSpotLights(),
+        uploadedRevisions.pointLights != scene.getPointLightsRevision(),
+        uploadedRevisions.spotLights != scene.getSpotLightsRevision()
+    );
+    uploadedRevisions.pointLights = scene.getPointLightsRevision();
+    uploadedRevisions.spotLights = scene.getSpotLightsRevision();
 
     // reset //
 
@@ -355,19 +470,15 @@ quartz::rendering::Context::draw(
     m_renderingSwapchain.resetAndBeginDrawingCommandBuffer(
         m_renderingWindow,
         m_renderingRenderPass,
+        m_lightCuller,
         m_currentInFlightFrameIndex,
         availableSwapchainImageIndex
     );
 
     // skybox pipeline //
 
-    m_renderingSwapchain.bindPipelineToDrawingCommandBuffer(
-        m_renderingWindow,
-        m_skyBoxRenderingPipeline,
-        m_currentInFlightFrameIndex
-    );
-
     m_renderingSwapchain.recordSkyBoxToDrawingCommandBuffer(
+        m_renderingWindow,
         m_skyBoxRenderingPipeline,
         scene.getSkyBox(),
         m_currentInFlightFrameIndex
@@ -375,23 +486,32 @@ quartz::rendering::Context::draw(
 
     // doodad drawing pipeline //
 
-    m_renderingSwapchain.bindPipelineToDrawingCommandBuffer(
+    m_renderingSwapchain.recordDoodadsToDrawingCommandBuffer(
         m_renderingWindow,
         m_doodadRenderingPipeline,
+        scene.getDoodads(),
+        scene.getCamera(),
+        4,
+        m_shouldDrawIndirectly,
+        m_shouldCullOnGpu,
+        m_shouldCullOccluded,
         m_currentInFlightFrameIndex
     );
 
-    for (const quartz::scene::Doodad& doodad : scene.getDoodads()) {
-        m_renderingSwapchain.recordDoodadToDrawingCommandBuffer(
-            m_renderingDevice,
-            m_doodadRenderingPipeline,
-            doodad,
-            m_currentInFlightFrameIndex
-        );
-    }
-
     // submit //
 
+    // Anything uploaded since the last frame has to be on the queue ahead of the frame which uses it
+    quartz::rendering::UploadQueue::submit(m_renderingDevice);
+
+    m_skyBoxRenderingPipeline.flushUniformBuffers(
+        m_renderingDevice,
+        m_currentInFlightFrameIndex
+    );
+    m_doodadRenderingPipeline.flushUniformBuffers(
+        m_renderingDevice,
+        m_currentInFlightFrameIndex
+    );
+
     m_renderingSwapchain.endAndSubmitDrawingCommandBuffer(
         m_renderingDevice,
         m_currentInFlightFrameIndex
@@ -403,7 +523,7 @@ quartz::rendering::Context::draw(
         availableSwapchainImageIndex
     );
 
-    if (m_renderingSwapchain.getShouldRecreate() || m_renderingWindow.getWasResized()) {
+    if (m_renderingSwapchain.getShouldRecreate() || m_renderingWindow.getWasResized() || m_shouldRecreateSwapchain) {
         recreateSwapchain();
         return;
     }
@@ -414,37 +534,64 @@ quartz::rendering::Context::draw(
 void
 quartz::rendering::Context::recreateSwapchain() {
     LOG_FUNCTION_SCOPE_INFOthis("");
-    m_renderingDevice.waitIdle();
-
-    m_renderingSwapchain.reset();
-    m_doodadRenderingPipeline.reset();
-    m_renderingRenderPass.reset();
-    m_renderingWindow.reset();
-
-    m_renderingWindow.recreate(
-        m_renderingInstance,
+    ++m_numSwapchainRecreations;
+    m_shouldRecreateSwapchain = false;
+
+    /**
+     * @brief The surface format and depth buffer format don't change with the window's size, so the render pass
+     *   (and the pipelines built against it, whose viewport and scissor are dynamic) stay valid. Only what is
+     *   sized to the window is replaced, and the swapchain retires the old resources instead of us waiting
+     *   for the device to go idle
+     */
+    m_renderingWindow.refreshSurfaceCapabilities(
         m_renderingDevice
     );
-    m_renderingRenderPass.recreate(
-        m_renderingDevice,
-        m_renderingWindow
-    );
-    m_skyBoxRenderingPipeline.recreate(
-        m_renderingDevice,
-        m_renderingRenderPass
-    );
-    m_doodadRenderingPipeline.recreate(
-        m_renderingDevice,
-        m_renderingRenderPass
-    );
     m_renderingSwapchain.recreate(
         m_renderingDevice,
         m_renderingWindow,
-        m_renderingRenderPass,
-        m_maxNumFramesInFlight
+        m_renderingRenderPass
     );
 }
 
+void
+quartz::rendering::Context::updateModifiedMaterials(const uint32_t inFlightFrameIndex) {
+    const uint64_t uploadedRevision = m_uploadedRevisions[inFlightFrameIndex].materials;
+    const uint64_t latestRevision = quartz::rendering::Material::getLatestRevision();
+
+    if (uploadedRevision == latestRevision) {
+        return;
+    }
+
+    /**
+     * @brief Write the modified materials straight into the mapped buffer, leaving everything that
+     *   this frame's copy already has alone
+     */
+    quartz::rendering::Material::UniformBufferObject* p_materialUBOs = reinterpret_cast<quartz::rendering::Material::UniformBufferObject*>(
+        m_doodadRenderingPipeline.getMappedUniformBufferPtr(inFlightFrameIndex, 3)
+    );
+
+    const std::vector<std::shared_ptr<quartz::rendering::Material>>& materialPtrs = quartz::rendering::Material::getMasterMaterialList();
+    const uint32_t numMaterials = std::min<uint32_t>(materialPtrs.size(), QUARTZ_MAX_NUMBER_MATERIALS);
+
+    UNUSED uint32_t numMaterialsWritten = 0;
+    for (uint32_t i = 0; i < numMaterials; ++i) {
+        if (materialPtrs[i]->getRevision() > uploadedRevision) {
+            p_materialUBOs[i] = quartz::rendering::Material::UniformBufferObject(*(materialPtrs[i]));
+            m_doodadRenderingPipeline.markUniformBufferWritten(
+                inFlightFrameIndex,
+                3,
+                i * sizeof(quartz::rendering::Material::UniformBufferObject),
+                sizeof(quartz::rendering::Material::UniformBufferObject)
+            );
+            ++numMaterialsWritten;
+        }
+    }
+
+    LOG_TRACEthis("Wrote {} of {} materials into frame {}'s material buffer", numMaterialsWritten, numMaterials, inFlightFrameIndex);
+
+    m_uploadedRevisions[inFlightFrameIndex].materials = latestRevision;
+}
+
 void
 quartz::rendering::Context::finish() {
     LOG_FUNCTION_SCOPE_TRACEthis("");
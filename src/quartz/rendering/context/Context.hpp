@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/culling/LightCuller.hpp"
 #include "quartz/rendering/device/Device.hpp"
 #include "quartz/rendering/instance/Instance.hpp"
 #include "quartz/rendering/model/Model.hpp"
@@ -31,7 +32,10 @@ public: // member functions
         const uint32_t applicationPatchVersion,
         const uint32_t windowWidthPixels,
         const uint32_t windowHeightPixels,
-        const bool validationLayersEnabled
+        const bool validationLayersEnabled,
+        const uint32_t maxNumFramesInFlight,
+        const uint32_t desiredSwapchainImageCount,
+        const vk::PresentModeKHR desiredPresentMode
     );
     ~Context();
 
@@ -40,14 +44,86 @@ public: // member functions
     const quartz::rendering::Device& getRenderingDevice() const { return m_renderingDevice; }
     const quartz::rendering::Window& getRenderingWindow() const { return m_renderingWindow; }
 
+    bool getShouldDrawIndirectly() const { return m_shouldDrawIndirectly; }
+    bool getShouldCullOnGpu() const { return m_shouldCullOnGpu; }
+    bool getShouldCullOccluded() const { return m_shouldCullOccluded; }
+    uint64_t getNumSwapchainRecreations() const { return m_numSwapchainRecreations; }
+    uint32_t getMaxNumFramesInFlight() const { return m_maxNumFramesInFlight; }
+    bool getShouldMinimizeLatency() const { return m_shouldMinimizeLatency; }
+
     quartz::rendering::Window& getRenderingWindow() { return m_renderingWindow; }
 
+    /**
+     * @brief Choose between recording one vkCmdDrawIndexedIndirect per geometry block (the default when
+     *   the device supports it) and recording one vkCmdDrawIndexed per primitive
+     */
+    void setShouldDrawIndirectly(const bool shouldDrawIndirectly);
+
+    /**
+     * @brief Choose between frustum culling on the cpu (the default) and with a compute shader whose
+     *   results are drawn with vkCmdDrawIndexedIndirectCount. This only takes effect while drawing indirectly
+     */
+    void setShouldCullOnGpu(const bool shouldCullOnGpu);
+
+    /**
+     * @brief Also skip drawing doodads hidden behind others (off by default), by testing them against a
+     *   hierarchical depth buffer built from the previous frame. This only takes effect while culling on the gpu
+     */
+    void setShouldCullOccluded(const bool shouldCullOccluded);
+
+    /**
+     * @brief Zero lets the swapchain choose. Takes effect when the swapchain is recreated after the next frame
+     */
+    void setDesiredSwapchainImageCount(const uint32_t desiredSwapchainImageCount);
+
+    /**
+     * @brief Fifo is always supported and is used in place of unsupported modes. Takes effect when the
+     *   swapchain is recreated after the next frame
+     */
+    void setDesiredPresentMode(const vk::PresentModeKHR desiredPresentMode);
+
+    /**
+     * @brief Trade throughput for input to photon latency (off by default). The application waits for the
+     *   frame's fence with waitForInFlightFrame before it samples input and updates the scene, instead of
+     *   draw waiting for it after. Pairs best with a single frame in flight
+     */
+    void setShouldMinimizeLatency(const bool shouldMinimizeLatency);
+
+    /**
+     * @brief Wait until the current frame in flight's previous submission has finished, so draw doesn't
+     *   have to. Waiting more than once before drawing is harmless
+     */
+    void waitForInFlightFrame();
+
     void loadScene(const quartz::scene::Scene& scene);
 
     void draw(const quartz::scene::Scene& scene);
     void finish();
 
+public: // static variables
+    static constexpr uint32_t minSupportedNumFramesInFlight = 1;
+    static constexpr uint32_t maxSupportedNumFramesInFlight = 4;
+    static constexpr const char* memoryReportFilename = "memory_report.json"; // in the binary directory, written whenever a scene is loaded
+
+private: // classes
+    /**
+     * @brief The revisions of the scene's lights and of the materials which were last written into a
+     *   frame in flight's buffers. Zero means nothing has been written yet
+     */
+    struct UploadedRevisions {
+    public: // member variables
+        uint64_t materials;
+        uint64_t ambientLight;
+        uint64_t directionalLight;
+        uint64_t pointLights;
+        uint64_t spotLights;
+    };
+
 private: // static functions
+    static uint32_t clampMaxNumFramesInFlight(const uint32_t maxNumFramesInFlight);
+    static bool getIndirectDrawingSupported(
+        const quartz::rendering::Device& renderingDevice
+    );
     static quartz::rendering::Pipeline createSkyBoxRenderingPipeline(
         const quartz::rendering::Device& renderingDevice,
         const quartz::rendering::Window& renderingWindow,
@@ -58,11 +134,13 @@ private: // static functions
         const quartz::rendering::Device& renderingDevice,
         const quartz::rendering::Window& renderingWindow,
         const quartz::rendering::RenderPass& renderingRenderPass,
+        const quartz::rendering::LightCuller& lightCuller,
         const uint32_t maxNumFramesInFlight
     );
 
 private: // member functions
     void recreateSwapchain();
+    void updateModifiedMaterials(const uint32_t inFlightFrameIndex);
 
 private: // member variables
     const uint32_t m_maxNumFramesInFlight;
@@ -71,7 +149,16 @@ private: // member variables
     quartz::rendering::Device m_renderingDevice;
     quartz::rendering::Window m_renderingWindow;
     quartz::rendering::RenderPass m_renderingRenderPass;
+    quartz::rendering::LightCuller m_lightCuller;
     quartz::rendering::Pipeline m_skyBoxRenderingPipeline;
     quartz::rendering::Pipeline m_doodadRenderingPipeline;
     quartz::rendering::Swapchain m_renderingSwapchain;
+    bool m_shouldDrawIndirectly;
+    bool m_shouldCullOnGpu;
+    bool m_shouldCullOccluded;
+    std::vector<quartz::rendering::Context::UploadedRevisions> m_uploadedRevisions; // one per frame in flight
+    uint64_t m_numSwapchainRecreations;
+    bool m_shouldRecreateSwapchain;
+    bool m_shouldMinimizeLatency;
+    bool m_hasWaitedForInFlightFrame;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <stb_image.h>
 
 #include "quartz/rendering/cube_map/CubeMap.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
 
 vk::VertexInputBindingDescription
@@ -42,6 +43,8 @@ quartz::rendering::CubeMap::createStagedImageBufferFromFilepaths(
 ) {
     LOG_FUNCTION_SCOPE_TRACE(CUBEMAP, "");
 
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("cube map");
+
     LOG_TRACE(CUBEMAP, "Front filepath: {}", frontFilepath);
     LOG_TRACE(CUBEMAP, "Back  filepath: {}", backFilepath);
     LOG_TRACE(CUBEMAP, "Up    filepath: {}", upFilepath);
@@ -172,6 +175,8 @@ quartz::rendering::CubeMap::createStagedVertexBuffer(
         vertices[i] = (2.0f * vertices[i]) - glm::vec3(1.0f, 1.0f, 1.0f);
     }
 
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("cube map");
+
     quartz::rendering::StagedBuffer stagedVertexBuffer(
         renderingDevice,
         sizeof(glm::vec3) * vertices.size(),
@@ -209,6 +214,8 @@ quartz::rendering::CubeMap::createStagedIndexBuffer(
         20, 23, 22,
     };
 
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("cube map");
+
     quartz::rendering::StagedBuffer indexBuffer(
         renderingDevice,
         sizeof(uint32_t) * indices.size(),
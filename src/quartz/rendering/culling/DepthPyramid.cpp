@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/file_system/FileSystem.hpp"
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/ImageBuffer.hpp"
+#include "quartz/rendering/culling/DepthPyramid.hpp"
+#include "quartz/rendering/depth_buffer/DepthBuffer.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
+
+vk::ImageAspectFlags
+quartz::rendering::DepthPyramid::getDepthBufferImageAspectFlags(
+    const vk::Format depthBufferFormat
+) {
+    // Layout transitions of a combined depth stencil image have to include both aspects
+    switch (depthBufferFormat) {
+        case vk::Format::eD16UnormS8Uint:
+        case vk::Format::eD24UnormS8Uint:
+        case vk::Format::eD32SfloatS8Uint:
+            return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+        default:
+            return vk::ImageAspectFlagBits::eDepth;
+    }
+}
+
+std::vector<vk::UniqueImageView>
+quartz::rendering::DepthPyramid::createVulkanMipImageViewPtrs(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::Image& image,
+    const uint32_t mipLevelCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} mip levels", mipLevelCount);
+
+    std::vector<vk::UniqueImageView> mipImageViewPtrs;
+    mipImageViewPtrs.reserve(mipLevelCount);
+
+    for (uint32_t i = 0; i < mipLevelCount; ++i) {
+        mipImageViewPtrs.push_back(
+            quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
+                p_logicalDevice,
+                image,
+                quartz::rendering::DepthPyramid::format,
+                {},
+                vk::ImageAspectFlagBits::eColor,
+                vk::ImageViewType::e2D,
+                i,
+                1
+            )
+        );
+    }
+
+    return mipImageViewPtrs;
+}
+
+vk::UniqueSampler
+quartz::rendering::DepthPyramid::createVulkanSamplerPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t mipLevelCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    // Never blend between texels or levels, that would no longer be the farthest depth
+    vk::SamplerCreateInfo samplerCreateInfo(
+        {},
+        vk::Filter::eNearest,
+        vk::Filter::eNearest,
+        vk::SamplerMipmapMode::eNearest,
+        vk::SamplerAddressMode::eClampToEdge,
+        vk::SamplerAddressMode::eClampToEdge,
+        vk::SamplerAddressMode::eClampToEdge,
+        0.0f,
+        false,
+        1.0f,
+        false,
+        vk::CompareOp::eAlways,
+        0.0f,
+        static_cast<float>(mipLevelCount),
+        vk::BorderColor::eFloatOpaqueWhite,
+        false
+    );
+
+    vk::UniqueSampler p_sampler = p_logicalDevice->createSamplerUnique(samplerCreateInfo);
+
+    if (!p_sampler) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::Sampler");
+    }
+
+    return p_sampler;
+}
+
+vk::UniqueDescriptorSetLayout
+quartz::rendering::DepthPyramid::createVulkanDescriptorSetLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    // the level being reduced, the level being written
+    const std::array<vk::DescriptorSetLayoutBinding, 2> layoutBindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute, {})
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutCreateInfo(
+        {},
+        layoutBindings
+    );
+
+    vk::UniqueDescriptorSetLayout p_descriptorSetLayout = p_logicalDevice->createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+    if (!p_descriptorSetLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorSetLayout");
+    }
+
+    return p_descriptorSetLayout;
+}
+
+vk::UniqueDescriptorPool
+quartz::rendering::DepthPyramid::createVulkanDescriptorPoolPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t mipLevelCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} mip levels", mipLevelCount);
+
+    const std::array<vk::DescriptorPoolSize, 2> descriptorPoolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, mipLevelCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, mipLevelCount)
+    };
+
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo(
+        {},
+        mipLevelCount,
+        descriptorPoolSizes
+    );
+
+    vk::UniqueDescriptorPool p_descriptorPool = p_logicalDevice->createDescriptorPoolUnique(descriptorPoolCreateInfo);
+
+    if (!p_descriptorPool) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorPool");
+    }
+
+    return p_descriptorPool;
+}
+
+std::vector<vk::DescriptorSet>
+quartz::rendering::DepthPyramid::allocateVulkanDescriptorSets(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t mipLevelCount,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+    const vk::UniqueDescriptorPool& p_descriptorPool
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} mip levels", mipLevelCount);
+
+    const std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(
+        mipLevelCount,
+        *p_descriptorSetLayout
+    );
+
+    vk::DescriptorSetAllocateInfo allocateInfo(
+        *p_descriptorPool,
+        descriptorSetLayouts.size(),
+        descriptorSetLayouts.data()
+    );
+
+    std::vector<vk::DescriptorSet> descriptorSets = p_logicalDevice->allocateDescriptorSets(allocateInfo);
+
+    if (descriptorSets.size() != mipLevelCount) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Allocated {} vk::DescriptorSet(s) instead of requested amount: {}", descriptorSets.size(), mipLevelCount);
+    }
+
+    return descriptorSets;
+}
+
+void
+quartz::rendering::DepthPyramid::updateVulkanDescriptorSets(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniqueImageView& p_depthBufferImageView,
+    const std::vector<vk::UniqueImageView>& mipImageViewPtrs,
+    const vk::UniqueSampler& p_sampler,
+    const std::vector<vk::DescriptorSet>& descriptorSets
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSets.size());
+
+    for (uint32_t i = 0; i < descriptorSets.size(); ++i) {
+        const vk::DescriptorImageInfo inputImageInfo = i == 0 ?
+            vk::DescriptorImageInfo(*p_sampler, *p_depthBufferImageView, vk::ImageLayout::eDepthStencilReadOnlyOptimal) :
+            vk::DescriptorImageInfo(*p_sampler, *(mipImageViewPtrs[i - 1]), vk::ImageLayout::eGeneral);
+        const vk::DescriptorImageInfo outputImageInfo(
+            {},
+            *(mipImageViewPtrs[i]),
+            vk::ImageLayout::eGeneral
+        );
+
+        const std::array<vk::WriteDescriptorSet, 2> writeDescriptorSets = {
+            vk::WriteDescriptorSet(descriptorSets[i], 0, 0, 1, vk::DescriptorType::eCombinedImageSampler, &inputImageInfo, {}, {}),
+            vk::WriteDescriptorSet(descriptorSets[i], 1, 0, 1, vk::DescriptorType::eStorageImage, &outputImageInfo, {}, {})
+        };
+
+        p_logicalDevice->updateDescriptorSets(
+            writeDescriptorSets,
+            {}
+        );
+    }
+}
+
+vk::UniquePipelineLayout
+quartz::rendering::DepthPyramid::createVulkanPipelineLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo(
+        {},
+        *p_descriptorSetLayout,
+        {}
+    );
+
+    vk::UniquePipelineLayout p_pipelineLayout = p_logicalDevice->createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+    if (!p_pipelineLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::PipelineLayout");
+    }
+
+    return p_pipelineLayout;
+}
+
+bool
+quartz::rendering::DepthPyramid::getDepthPyramidSupported(
+    const quartz::rendering::Device& renderingDevice,
+    const vk::Format depthBufferFormat
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    const vk::FormatProperties depthBufferFormatProperties = renderingDevice.getVulkanPhysicalDevice().getFormatProperties(depthBufferFormat);
+    const vk::FormatProperties pyramidFormatProperties = renderingDevice.getVulkanPhysicalDevice().getFormatProperties(quartz::rendering::DepthPyramid::format);
+
+    const vk::FormatFeatureFlags requiredPyramidFeatures = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eStorageImage;
+
+    const bool depthPyramidSupported =
+        static_cast<bool>(depthBufferFormatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage) &&
+        (pyramidFormatProperties.optimalTilingFeatures & requiredPyramidFeatures) == requiredPyramidFeatures;
+
+    LOG_DEBUG(CULLING, "Depth pyramid is {}supported", depthPyramidSupported ? "" : "not ");
+
+    return depthPyramidSupported;
+}
+
+quartz::rendering::DepthPyramid::DepthPyramid(
+    const quartz::rendering::Device& renderingDevice,
+    const quartz::rendering::DepthBuffer& depthBuffer,
+    const uint32_t depthBufferWidth,
+    const uint32_t depthBufferHeight,
+    const vk::Format depthBufferFormat
+) :
+    m_width(std::bit_floor(std::max<uint32_t>(depthBufferWidth, 1))),
+    m_height(std::bit_floor(std::max<uint32_t>(depthBufferHeight, 1))),
+    m_mipLevelCount(std::bit_width(std::max(m_width, m_height))),
+    m_vulkanDepthBufferImage(*(depthBuffer.getVulkanImagePtr())),
+    m_depthBufferImageAspectFlags(
+        quartz::rendering::DepthPyramid::getDepthBufferImageAspectFlags(
+            depthBufferFormat
+        )
+    ),
+    m_imageBuffer(
+        renderingDevice,
+        m_width,
+        m_height,
+        1,
+        m_mipLevelCount,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        {},
+        quartz::rendering::DepthPyramid::format,
+        vk::ImageTiling::eOptimal
+    ),
+    mp_vulkanImageView(
+        quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            *(m_imageBuffer.getVulkanImagePtr()),
+            quartz::rendering::DepthPyramid::format,
+            {},
+            vk::ImageAspectFlagBits::eColor,
+            vk::ImageViewType::e2D,
+            0,
+            m_mipLevelCount
+        )
+    ),
+    m_vulkanMipImageViewPtrs(
+        quartz::rendering::DepthPyramid::createVulkanMipImageViewPtrs(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            *(m_imageBuffer.getVulkanImagePtr()),
+            m_mipLevelCount
+        )
+    ),
+    mp_vulkanSampler(
+        quartz::rendering::DepthPyramid::createVulkanSamplerPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            m_mipLevelCount
+        )
+    ),
+    mp_vulkanComputeShaderModule(
+        quartz::rendering::VulkanUtil::createVulkanShaderModulePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            util::FileSystem::getCompiledShaderAbsoluteFilepath("depth_pyramid.comp")
+        )
+    ),
+    mp_vulkanDescriptorSetLayout(
+        quartz::rendering::DepthPyramid::createVulkanDescriptorSetLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr()
+        )
+    ),
+    mp_vulkanDescriptorPool(
+        quartz::rendering::DepthPyramid::createVulkanDescriptorPoolPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            m_mipLevelCount
+        )
+    ),
+    m_vulkanDescriptorSets(
+        quartz::rendering::DepthPyramid::allocateVulkanDescriptorSets(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            m_mipLevelCount,
+            mp_vulkanDescriptorSetLayout,
+            mp_vulkanDescriptorPool
+        )
+    ),
+    mp_vulkanPipelineLayout(
+        quartz::rendering::DepthPyramid::createVulkanPipelineLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDescriptorSetLayout
+        )
+    ),
+    mp_vulkanComputePipeline(
+        quartz::rendering::VulkanUtil::createVulkanComputePipelinePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingDevice.getVulkanPipelineCachePtr(),
+            mp_vulkanComputeShaderModule,
+            mp_vulkanPipelineLayout
+        )
+    )
+{
+    LOG_FUNCTION_CALL_TRACEthis("{}x{} with {} mip levels", m_width, m_height, m_mipLevelCount);
+
+    quartz::rendering::DepthPyramid::updateVulkanDescriptorSets(
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        depthBuffer.getVulkanImageViewPtr(),
+        m_vulkanMipImageViewPtrs,
+        mp_vulkanSampler,
+        m_vulkanDescriptorSets
+    );
+}
+
+quartz::rendering::DepthPyramid::DepthPyramid(
+    quartz::rendering::DepthPyramid&& other
+) :
+    m_width(other.m_width),
+    m_height(other.m_height),
+    m_mipLevelCount(other.m_mipLevelCount),
+    m_vulkanDepthBufferImage(other.m_vulkanDepthBufferImage),
+    m_depthBufferImageAspectFlags(other.m_depthBufferImageAspectFlags),
+    m_imageBuffer(std::move(other.m_imageBuffer)),
+    mp_vulkanImageView(std::move(other.mp_vulkanImageView)),
+    m_vulkanMipImageViewPtrs(std::move(other.m_vulkanMipImageViewPtrs)),
+    mp_vulkanSampler(std::move(other.mp_vulkanSampler)),
+    mp_vulkanComputeShaderModule(std::move(other.mp_vulkanComputeShaderModule)),
+    mp_vulkanDescriptorSetLayout(std::move(other.mp_vulkanDescriptorSetLayout)),
+    mp_vulkanDescriptorPool(std::move(other.mp_vulkanDescriptorPool)),
+    m_vulkanDescriptorSets(std::move(other.m_vulkanDescriptorSets)),
+    mp_vulkanPipelineLayout(std::move(other.mp_vulkanPipelineLayout)),
+    mp_vulkanComputePipeline(std::move(other.mp_vulkanComputePipeline))
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::DepthPyramid::~DepthPyramid() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+void
+quartz::rendering::DepthPyramid::recordBuildToCommandBuffer(
+    const vk::CommandBuffer& commandBuffer
+) const {
+    const vk::Image& pyramidImage = *(m_imageBuffer.getVulkanImagePtr());
+
+    // ----- make the depth readable, and discard the old pyramid once everything is done reading it ----- //
+
+    const std::array<vk::ImageMemoryBarrier, 2> buildStartBarriers = {
+        vk::ImageMemoryBarrier(
+            vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            m_vulkanDepthBufferImage,
+            vk::ImageSubresourceRange(m_depthBufferImageAspectFlags, 0, 1, 0, 1)
+        ),
+        vk::ImageMemoryBarrier(
+            {},
+            vk::AccessFlagBits::eShaderWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            pyramidImage,
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_mipLevelCount, 0, 1)
+        )
+    };
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        {},
+        {},
+        buildStartBarriers
+    );
+
+    // ----- reduce each level into the next ----- //
+
+    commandBuffer.bindPipeline(
+        vk::PipelineBindPoint::eCompute,
+        *mp_vulkanComputePipeline
+    );
+
+    for (uint32_t i = 0; i < m_mipLevelCount; ++i) {
+        const uint32_t levelWidth = std::max<uint32_t>(m_width >> i, 1);
+        const uint32_t levelHeight = std::max<uint32_t>(m_height >> i, 1);
+
+        commandBuffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eCompute,
+            *mp_vulkanPipelineLayout,
+            0,
+            m_vulkanDescriptorSets[i],
+            {}
+        );
+
+        commandBuffer.dispatch(
+            (levelWidth + quartz::rendering::DepthPyramid::workGroupSize - 1) / quartz::rendering::DepthPyramid::workGroupSize,
+            (levelHeight + quartz::rendering::DepthPyramid::workGroupSize - 1) / quartz::rendering::DepthPyramid::workGroupSize,
+            1
+        );
+
+        // The next level (and the culling shader afterwards) reads this one
+        const vk::ImageMemoryBarrier levelBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eShaderRead,
+            vk::ImageLayout::eGeneral,
+            vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            pyramidImage,
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, i, 1, 0, 1)
+        );
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eComputeShader,
+            {},
+            {},
+            {},
+            levelBarrier
+        );
+    }
+
+    // ----- hand the depth back to the render pass ----- //
+
+    const vk::ImageMemoryBarrier buildEndBarrier(
+        {},
+        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+        vk::ImageLayout::eDepthStencilAttachmentOptimal,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        m_vulkanDepthBufferImage,
+        vk::ImageSubresourceRange(m_depthBufferImageAspectFlags, 0, 1, 0, 1)
+    );
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+        {},
+        {},
+        {},
+        buildEndBarrier
+    );
+}
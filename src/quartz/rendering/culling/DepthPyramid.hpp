@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/ImageBuffer.hpp"
+#include "quartz/rendering/depth_buffer/DepthBuffer.hpp"
+#include "quartz/rendering/device/Device.hpp"
+
+namespace quartz {
+namespace rendering {
+    class DepthPyramid;
+}
+}
+
+/**
+ * @brief A mip chain (hierarchical z buffer) where every texel holds the farthest depth of the depth buffer
+ *   texels it covers, so a box is hidden if its closest depth is farther than the farthest depth under it.
+ *   The first level is the largest power of two no bigger than the depth buffer in each dimension, which
+ *   keeps every level after it an exact halving so the same uv lands on the right texel at every level.
+ *
+ * @brief The pyramid is built with a compute shader dispatch per level, each reducing the previous level
+ *   (or the depth buffer itself for the first level). The pyramid stays in the general layout, and the depth
+ *   buffer is only transitioned to be read for the duration of the build.
+ */
+class quartz::rendering::DepthPyramid {
+public: // member functions
+    DepthPyramid(
+        const quartz::rendering::Device& renderingDevice,
+        const quartz::rendering::DepthBuffer& depthBuffer,
+        const uint32_t depthBufferWidth,
+        const uint32_t depthBufferHeight,
+        const vk::Format depthBufferFormat
+    );
+    DepthPyramid(DepthPyramid&& other);
+    ~DepthPyramid();
+
+    USE_LOGGER(CULLING);
+
+    glm::vec2 getSize() const { return glm::vec2(m_width, m_height); }
+    uint32_t getMipLevelCount() const { return m_mipLevelCount; }
+    const vk::UniqueImageView& getVulkanImageViewPtr() const { return mp_vulkanImageView; }
+    const vk::UniqueSampler& getVulkanSamplerPtr() const { return mp_vulkanSampler; }
+
+    /**
+     * @brief Must be recorded outside of a render pass, after the depth buffer was written. The depth buffer
+     *   is left in the depth stencil attachment optimal layout it started in
+     */
+    void recordBuildToCommandBuffer(const vk::CommandBuffer& commandBuffer) const;
+
+public: // static functions
+    static bool getDepthPyramidSupported(
+        const quartz::rendering::Device& renderingDevice,
+        const vk::Format depthBufferFormat
+    );
+
+public: // static variables
+    static constexpr uint32_t workGroupSize = 8; // must match local_size_x and local_size_y in depth_pyramid.comp
+    static constexpr vk::Format format = vk::Format::eR32Sfloat;
+
+private: // static functions
+    static vk::ImageAspectFlags getDepthBufferImageAspectFlags(const vk::Format depthBufferFormat);
+    static std::vector<vk::UniqueImageView> createVulkanMipImageViewPtrs(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::Image& image,
+        const uint32_t mipLevelCount
+    );
+    static vk::UniqueSampler createVulkanSamplerPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t mipLevelCount
+    );
+    static vk::UniqueDescriptorSetLayout createVulkanDescriptorSetLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice
+    );
+    static vk::UniqueDescriptorPool createVulkanDescriptorPoolPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t mipLevelCount
+    );
+    static std::vector<vk::DescriptorSet> allocateVulkanDescriptorSets(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t mipLevelCount,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+        const vk::UniqueDescriptorPool& p_descriptorPool
+    );
+    static void updateVulkanDescriptorSets(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniqueImageView& p_depthBufferImageView,
+        const std::vector<vk::UniqueImageView>& mipImageViewPtrs,
+        const vk::UniqueSampler& p_sampler,
+        const std::vector<vk::DescriptorSet>& descriptorSets
+    );
+    static vk::UniquePipelineLayout createVulkanPipelineLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+    );
+
+private: // member variables
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_mipLevelCount;
+
+    vk::Image m_vulkanDepthBufferImage;
+    vk::ImageAspectFlags m_depthBufferImageAspectFlags;
+
+    quartz::rendering::ImageBuffer m_imageBuffer;
+    vk::UniqueImageView mp_vulkanImageView;
+    std::vector<vk::UniqueImageView> m_vulkanMipImageViewPtrs;
+    vk::UniqueSampler mp_vulkanSampler;
+
+    vk::UniqueShaderModule mp_vulkanComputeShaderModule;
+    vk::UniqueDescriptorSetLayout mp_vulkanDescriptorSetLayout;
+    vk::UniqueDescriptorPool mp_vulkanDescriptorPool;
+    std::vector<vk::DescriptorSet> m_vulkanDescriptorSets;
+    vk::UniquePipelineLayout mp_vulkanPipelineLayout;
+    vk::UniquePipeline mp_vulkanComputePipeline;
+};
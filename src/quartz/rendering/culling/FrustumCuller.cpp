@@ -0,0 +1,134 @@
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/culling/FrustumCuller.hpp"
+#include "quartz/rendering/draw_packet/DrawPacket.hpp"
+#include "quartz/rendering/model/Primitive.hpp"
+
+quartz::rendering::FrustumCuller::FrustumCuller() :
+    m_numTestedLastFrame(0),
+    m_numCulledLastFrame(0),
+    m_centerXs(),
+    m_centerYs(),
+    m_centerZs(),
+    m_extentXs(),
+    m_extentYs(),
+    m_extentZs(),
+    m_visibilities()
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+void
+quartz::rendering::FrustumCuller::gatherWorldBounds(
+    const std::vector<quartz::rendering::DrawPacket>& drawPackets
+) {
+    const uint32_t drawPacketCount = drawPackets.size();
+
+    m_centerXs.resize(drawPacketCount);
+    m_centerYs.resize(drawPacketCount);
+    m_centerZs.resize(drawPacketCount);
+    m_extentXs.resize(drawPacketCount);
+    m_extentYs.resize(drawPacketCount);
+    m_extentZs.resize(drawPacketCount);
+    m_visibilities.assign(drawPacketCount, 1);
+
+    for (uint32_t i = 0; i < drawPacketCount; ++i) {
+        const quartz::rendering::DrawPacket& drawPacket = drawPackets[i];
+        const quartz::rendering::Primitive::BoundingBox& boundingBox = drawPacket.getPrimitive().getBoundingBox();
+
+        const glm::mat4 modelMatrix = drawPacket.getDoodad().getTransformationMatrix() * drawPacket.getInstanceTransformationMatrix();
+
+        const glm::vec3 localCenter = (boundingBox.minimum + boundingBox.maximum) * 0.5f;
+        const glm::vec3 localExtent = (boundingBox.maximum - boundingBox.minimum) * 0.5f;
+
+        const glm::vec4 worldCenter = modelMatrix * glm::vec4(localCenter, 1.0f);
+
+        // The smallest world space box containing the transformed local box (Arvo's method)
+        m_centerXs[i] = worldCenter.x;
+        m_centerYs[i] = worldCenter.y;
+        m_centerZs[i] = worldCenter.z;
+        m_extentXs[i] =
+            std::abs(modelMatrix[0][0]) * localExtent.x +
+            std::abs(modelMatrix[1][0]) * localExtent.y +
+            std::abs(modelMatrix[2][0]) * localExtent.z;
+        m_extentYs[i] =
+            std::abs(modelMatrix[0][1]) * localExtent.x +
+            std::abs(modelMatrix[1][1]) * localExtent.y +
+            std::abs(modelMatrix[2][1]) * localExtent.z;
+        m_extentZs[i] =
+            std::abs(modelMatrix[0][2]) * localExtent.x +
+            std::abs(modelMatrix[1][2]) * localExtent.y +
+            std::abs(modelMatrix[2][2]) * localExtent.z;
+    }
+}
+
+void
+quartz::rendering::FrustumCuller::testAgainstPlane(
+    const glm::vec4& frustumPlane
+) {
+    const uint32_t count = m_visibilities.size();
+
+    const float normalX = frustumPlane.x;
+    const float normalY = frustumPlane.y;
+    const float normalZ = frustumPlane.z;
+    const float absoluteNormalX = std::abs(normalX);
+    const float absoluteNormalY = std::abs(normalY);
+    const float absoluteNormalZ = std::abs(normalZ);
+    const float planeDistance = frustumPlane.w;
+
+    const float* p_centerXs = m_centerXs.data();
+    const float* p_centerYs = m_centerYs.data();
+    const float* p_centerZs = m_centerZs.data();
+    const float* p_extentXs = m_extentXs.data();
+    const float* p_extentYs = m_extentYs.data();
+    const float* p_extentZs = m_extentZs.data();
+    uint32_t* p_visibilities = m_visibilities.data();
+
+    // A box is outside of the plane if even its corner furthest along the plane's normal is behind it
+    for (uint32_t i = 0; i < count; ++i) {
+        const float centerDistance =
+            normalX * p_centerXs[i] +
+            normalY * p_centerYs[i] +
+            normalZ * p_centerZs[i] +
+            planeDistance;
+        const float projectedRadius =
+            absoluteNormalX * p_extentXs[i] +
+            absoluteNormalY * p_extentYs[i] +
+            absoluteNormalZ * p_extentZs[i];
+
+        p_visibilities[i] &= static_cast<uint32_t>(centerDistance + projectedRadius >= 0.0f);
+    }
+}
+
+void
+quartz::rendering::FrustumCuller::cullDrawPackets(
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    std::vector<quartz::rendering::DrawPacket>& drawPackets
+) {
+    m_numTestedLastFrame = drawPackets.size();
+
+    this->gatherWorldBounds(drawPackets);
+
+    for (const glm::vec4& frustumPlane : frustumPlanes) {
+        this->testAgainstPlane(frustumPlane);
+    }
+
+    uint32_t numVisible = 0;
+    for (uint32_t i = 0; i < drawPackets.size(); ++i) {
+        if (m_visibilities[i]) {
+            drawPackets[numVisible] = drawPackets[i];
+            ++numVisible;
+        }
+    }
+    drawPackets.resize(numVisible);
+
+    m_numCulledLastFrame = m_numTestedLastFrame - numVisible;
+    LOG_TRACEthis("Culled {} of {} draw packets", m_numCulledLastFrame, m_numTestedLastFrame);
+}
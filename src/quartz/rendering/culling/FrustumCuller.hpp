@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/draw_packet/DrawPacket.hpp"
+
+namespace quartz {
+namespace rendering {
+    class FrustumCuller;
+}
+}
+
+/**
+ * @brief Removes draw packets whose bounds are entirely outside of the camera's view frustum before we
+ *   spend any time sorting or recording them.
+ *
+ * @brief The world space bounds of every packet are gathered into structure of arrays form (one array per
+ *   component) so the plane tests are simple loops over contiguous floats without any branches, which
+ *   the compiler is able to vectorize. The arrays are kept around so we are not allocating every frame
+ */
+class quartz::rendering::FrustumCuller {
+public: // member functions
+    FrustumCuller();
+
+    USE_LOGGER(CULLING);
+
+    uint32_t getNumTestedLastFrame() const { return m_numTestedLastFrame; }
+    uint32_t getNumCulledLastFrame() const { return m_numCulledLastFrame; }
+    glm::vec3 getWorldBoundsCenter(const uint32_t drawPacketIndex) const { return glm::vec3(m_centerXs[drawPacketIndex], m_centerYs[drawPacketIndex], m_centerZs[drawPacketIndex]); }
+    glm::vec3 getWorldBoundsExtent(const uint32_t drawPacketIndex) const { return glm::vec3(m_extentXs[drawPacketIndex], m_extentYs[drawPacketIndex], m_extentZs[drawPacketIndex]); }
+
+    /**
+     * @brief Remove every packet which is outside of the frustum, keeping the order of the remaining packets
+     *
+     * @param frustumPlanes The world space planes with normals pointing inwards (see Camera::getFrustumPlanes)
+     */
+    void cullDrawPackets(
+        const std::array<glm::vec4, 6>& frustumPlanes,
+        std::vector<quartz::rendering::DrawPacket>& drawPackets
+    );
+
+    /**
+     * @brief Only calculate every packet's world space bounds, without testing them. These are what the
+     *   GpuCuller tests instead when culling happens on the gpu
+     */
+    void gatherWorldBounds(const std::vector<quartz::rendering::DrawPacket>& drawPackets);
+
+private: // member functions
+    void testAgainstPlane(const glm::vec4& frustumPlane);
+
+private: // member variables
+    uint32_t m_numTestedLastFrame;
+    uint32_t m_numCulledLastFrame;
+
+    std::vector<float> m_centerXs;
+    std::vector<float> m_centerYs;
+    std::vector<float> m_centerZs;
+    std::vector<float> m_extentXs;
+    std::vector<float> m_extentYs;
+    std::vector<float> m_extentZs;
+
+    /**
+     * @brief 1 if the packet is still possibly visible and 0 otherwise. These are the same width as the
+     *   floats so the plane tests vectorize nicely
+     */
+    std::vector<uint32_t> m_visibilities;
+};
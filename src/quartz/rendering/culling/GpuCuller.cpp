@@ -0,0 +1,496 @@
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/macros.hpp"
+#include "util/file_system/FileSystem.hpp"
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/culling/DepthPyramid.hpp"
+#include "quartz/rendering/culling/GpuCuller.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
+
+std::vector<quartz::rendering::LocallyMappedBuffer>
+quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t bufferCount,
+    const uint32_t sizeBytes,
+    const vk::BufferUsageFlags usageFlags
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} buffers, {} bytes", bufferCount, sizeBytes);
+
+    std::vector<quartz::rendering::LocallyMappedBuffer> buffers;
+
+    for (uint32_t i = 0; i < bufferCount; ++i) {
+        buffers.emplace_back(
+            renderingDevice,
+            sizeBytes,
+            usageFlags,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+    }
+
+    if (buffers.size() != bufferCount) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Created {} buffers instead of expected {}", buffers.size(), bufferCount);
+    }
+
+    return buffers;
+}
+
+vk::UniqueDescriptorSetLayout
+quartz::rendering::GpuCuller::createVulkanDescriptorSetLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    // instances, draw commands, draw counts, culling uniform, occluded flags, depth pyramid
+    const std::array<vk::DescriptorSetLayoutBinding, 6> layoutBindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, {}),
+        vk::DescriptorSetLayoutBinding(5, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, {})
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutCreateInfo(
+        {},
+        layoutBindings
+    );
+
+    vk::UniqueDescriptorSetLayout p_descriptorSetLayout = p_logicalDevice->createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+    if (!p_descriptorSetLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorSetLayout");
+    }
+
+    return p_descriptorSetLayout;
+}
+
+vk::UniqueDescriptorPool
+quartz::rendering::GpuCuller::createVulkanDescriptorPoolPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t descriptorSetCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSetCount);
+
+    const std::array<vk::DescriptorPoolSize, 3> descriptorPoolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 4 * descriptorSetCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, descriptorSetCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, descriptorSetCount)
+    };
+
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo(
+        {},
+        descriptorSetCount,
+        descriptorPoolSizes
+    );
+
+    vk::UniqueDescriptorPool p_descriptorPool = p_logicalDevice->createDescriptorPoolUnique(descriptorPoolCreateInfo);
+
+    if (!p_descriptorPool) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorPool");
+    }
+
+    return p_descriptorPool;
+}
+
+std::vector<vk::DescriptorSet>
+quartz::rendering::GpuCuller::allocateVulkanDescriptorSets(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t descriptorSetCount,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+    const vk::UniqueDescriptorPool& p_descriptorPool
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSetCount);
+
+    const std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(
+        descriptorSetCount,
+        *p_descriptorSetLayout
+    );
+
+    vk::DescriptorSetAllocateInfo allocateInfo(
+        *p_descriptorPool,
+        descriptorSetLayouts.size(),
+        descriptorSetLayouts.data()
+    );
+
+    std::vector<vk::DescriptorSet> descriptorSets = p_logicalDevice->allocateDescriptorSets(allocateInfo);
+
+    if (descriptorSets.size() != descriptorSetCount) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Allocated {} vk::DescriptorSet(s) instead of requested amount: {}", descriptorSets.size(), descriptorSetCount);
+    }
+
+    for (uint32_t i = 0; i < descriptorSets.size(); ++i) {
+        if (!descriptorSets[i]) {
+            LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to allocate vk::DescriptorSet {}", i);
+        }
+    }
+
+    return descriptorSets;
+}
+
+void
+quartz::rendering::GpuCuller::updateVulkanDescriptorSets(
+    const vk::UniqueDevice& p_logicalDevice,
+    const std::vector<quartz::rendering::LocallyMappedBuffer>& instanceBuffers,
+    const std::vector<quartz::rendering::LocallyMappedBuffer>& drawCommandBuffers,
+    const std::vector<quartz::rendering::LocallyMappedBuffer>& drawCountBuffers,
+    const std::vector<quartz::rendering::LocallyMappedBuffer>& cullingUniformBuffers,
+    const std::vector<quartz::rendering::LocallyMappedBuffer>& occludedFlagBuffers,
+    const std::vector<vk::DescriptorSet>& descriptorSets
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSets.size());
+
+    for (uint32_t i = 0; i < descriptorSets.size(); ++i) {
+        const uint32_t inFlightFrameIndex = i / quartz::rendering::GpuCuller::numPhases;
+
+        const std::array<vk::DescriptorBufferInfo, 5> bufferInfos = {
+            vk::DescriptorBufferInfo(*(instanceBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr()), 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(*(drawCommandBuffers[i].getVulkanLogicalBufferPtr()), 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(*(drawCountBuffers[i].getVulkanLogicalBufferPtr()), 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(*(cullingUniformBuffers[i].getVulkanLogicalBufferPtr()), 0, VK_WHOLE_SIZE),
+            vk::DescriptorBufferInfo(*(occludedFlagBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr()), 0, VK_WHOLE_SIZE)
+        };
+
+        std::array<vk::WriteDescriptorSet, 5> writeDescriptorSets;
+        for (uint32_t j = 0; j < bufferInfos.size(); ++j) {
+            writeDescriptorSets[j] = vk::WriteDescriptorSet(
+                descriptorSets[i],
+                j,
+                0,
+                1,
+                j == 3 ? vk::DescriptorType::eUniformBuffer : vk::DescriptorType::eStorageBuffer,
+                {},
+                &(bufferInfos[j]),
+                {}
+            );
+        }
+
+        p_logicalDevice->updateDescriptorSets(
+            writeDescriptorSets,
+            {}
+        );
+    }
+}
+
+vk::UniquePipelineLayout
+quartz::rendering::GpuCuller::createVulkanPipelineLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo(
+        {},
+        *p_descriptorSetLayout,
+        {}
+    );
+
+    vk::UniquePipelineLayout p_pipelineLayout = p_logicalDevice->createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+    if (!p_pipelineLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::PipelineLayout");
+    }
+
+    return p_pipelineLayout;
+}
+
+bool
+quartz::rendering::GpuCuller::getGpuCullingSupported(
+    const quartz::rendering::Device& renderingDevice,
+    const vk::Format depthBufferFormat
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    const vk::PhysicalDeviceFeatures& enabledPhysicalDeviceFeatures = renderingDevice.getVulkanEnabledPhysicalDeviceFeatures();
+    const vk::PhysicalDeviceVulkan12Features& enabledPhysicalDeviceVulkan12Features = renderingDevice.getVulkanEnabledPhysicalDeviceVulkan12Features();
+    const vk::QueueFlags graphicsQueueFlags = renderingDevice.getVulkanPhysicalDevice().getQueueFamilyProperties()[renderingDevice.getGraphicsQueueFamilyIndex()].queueFlags;
+
+    // The culling shader always has a depth pyramid bound, even when it isn't occlusion culling
+    const bool gpuCullingSupported =
+        enabledPhysicalDeviceFeatures.multiDrawIndirect &&
+        enabledPhysicalDeviceFeatures.drawIndirectFirstInstance &&
+        enabledPhysicalDeviceVulkan12Features.drawIndirectCount &&
+        static_cast<bool>(graphicsQueueFlags & vk::QueueFlagBits::eCompute) &&
+        quartz::rendering::DepthPyramid::getDepthPyramidSupported(renderingDevice, depthBufferFormat);
+
+    LOG_DEBUG(CULLING, "Gpu culling is {}supported", gpuCullingSupported ? "" : "not ");
+
+    return gpuCullingSupported;
+}
+
+quartz::rendering::GpuCuller::GpuCuller(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t maxNumFramesInFlight
+) :
+    m_instanceBuffers(
+        quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(quartz::rendering::GpuCuller::InstanceStorageBufferObject) * QUARTZ_MAX_NUMBER_DRAWS,
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_occludedFlagBuffers(
+        quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(uint32_t) * QUARTZ_MAX_NUMBER_DRAWS,
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_drawCommandBuffers(
+        quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight * quartz::rendering::GpuCuller::numPhases,
+            sizeof(vk::DrawIndexedIndirectCommand) * QUARTZ_MAX_NUMBER_DRAWS,
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer
+        )
+    ),
+    m_drawCountBuffers(
+        quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight * quartz::rendering::GpuCuller::numPhases,
+            sizeof(uint32_t) * QUARTZ_MAX_NUMBER_DRAWS, // every draw could be its own batch
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst
+        )
+    ),
+    m_cullingUniformBuffers(
+        quartz::rendering::GpuCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight * quartz::rendering::GpuCuller::numPhases,
+            sizeof(quartz::rendering::GpuCuller::CullingUniformBufferObject),
+            vk::BufferUsageFlagBits::eUniformBuffer
+        )
+    ),
+    mp_vulkanComputeShaderModule(
+        quartz::rendering::VulkanUtil::createVulkanShaderModulePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            util::FileSystem::getCompiledShaderAbsoluteFilepath("cull.comp")
+        )
+    ),
+    mp_vulkanDescriptorSetLayout(
+        quartz::rendering::GpuCuller::createVulkanDescriptorSetLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr()
+        )
+    ),
+    mp_vulkanDescriptorPool(
+        quartz::rendering::GpuCuller::createVulkanDescriptorPoolPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            maxNumFramesInFlight * quartz::rendering::GpuCuller::numPhases
+        )
+    ),
+    m_vulkanDescriptorSets(
+        quartz::rendering::GpuCuller::allocateVulkanDescriptorSets(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            maxNumFramesInFlight * quartz::rendering::GpuCuller::numPhases,
+            mp_vulkanDescriptorSetLayout,
+            mp_vulkanDescriptorPool
+        )
+    ),
+    mp_vulkanPipelineLayout(
+        quartz::rendering::GpuCuller::createVulkanPipelineLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDescriptorSetLayout
+        )
+    ),
+    mp_vulkanComputePipeline(
+        quartz::rendering::VulkanUtil::createVulkanComputePipelinePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingDevice.getVulkanPipelineCachePtr(),
+            mp_vulkanComputeShaderModule,
+            mp_vulkanPipelineLayout
+        )
+    )
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+
+    quartz::rendering::GpuCuller::updateVulkanDescriptorSets(
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        m_instanceBuffers,
+        m_drawCommandBuffers,
+        m_drawCountBuffers,
+        m_cullingUniformBuffers,
+        m_occludedFlagBuffers,
+        m_vulkanDescriptorSets
+    );
+}
+
+quartz::rendering::GpuCuller::~GpuCuller() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+quartz::rendering::GpuCuller::InstanceStorageBufferObject*
+quartz::rendering::GpuCuller::getMappedInstancesPtr(
+    const uint32_t inFlightFrameIndex
+) {
+    return reinterpret_cast<quartz::rendering::GpuCuller::InstanceStorageBufferObject*>(
+        m_instanceBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr()
+    );
+}
+
+void
+quartz::rendering::GpuCuller::updateDepthPyramidDescriptors(
+    const quartz::rendering::Device& renderingDevice,
+    const quartz::rendering::DepthPyramid& depthPyramid,
+    const uint32_t inFlightFrameIndex
+) {
+    LOG_FUNCTION_SCOPE_TRACEthis("frame {}", inFlightFrameIndex);
+
+    const vk::DescriptorImageInfo depthPyramidImageInfo(
+        *(depthPyramid.getVulkanSamplerPtr()),
+        *(depthPyramid.getVulkanImageViewPtr()),
+        vk::ImageLayout::eGeneral
+    );
+
+    for (uint32_t i = 0; i < quartz::rendering::GpuCuller::numPhases; ++i) {
+        const vk::WriteDescriptorSet writeDescriptorSet(
+            m_vulkanDescriptorSets[inFlightFrameIndex * quartz::rendering::GpuCuller::numPhases + i],
+            5,
+            0,
+            1,
+            vk::DescriptorType::eCombinedImageSampler,
+            &depthPyramidImageInfo,
+            {},
+            {}
+        );
+
+        renderingDevice.getVulkanLogicalDevicePtr()->updateDescriptorSets(
+            writeDescriptorSet,
+            {}
+        );
+    }
+}
+
+void
+quartz::rendering::GpuCuller::recordCullingToCommandBuffer(
+    const vk::CommandBuffer& commandBuffer,
+    const uint32_t inFlightFrameIndex,
+    const quartz::rendering::GpuCuller::Phase phase,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    const std::optional<glm::mat4>& o_occlusionViewProjectionMatrix,
+    const glm::vec2& depthPyramidSize,
+    const uint32_t instanceCount,
+    const uint32_t batchCount
+) {
+    // Filling zero bytes of the counts isn't allowed, and there would be nothing to cull anyway
+    if (batchCount == 0) {
+        return;
+    }
+
+    const uint32_t phaseBufferIndex = inFlightFrameIndex * quartz::rendering::GpuCuller::numPhases + static_cast<uint32_t>(phase);
+
+    const vk::Buffer& drawCommandBuffer = *(m_drawCommandBuffers[phaseBufferIndex].getVulkanLogicalBufferPtr());
+    const vk::Buffer& drawCountBuffer = *(m_drawCountBuffers[phaseBufferIndex].getVulkanLogicalBufferPtr());
+
+    // ----- tell the shader what to test against ----- //
+
+    quartz::rendering::GpuCuller::CullingUniformBufferObject* p_cullingUniformBufferObject = reinterpret_cast<quartz::rendering::GpuCuller::CullingUniformBufferObject*>(
+        m_cullingUniformBuffers[phaseBufferIndex].getMappedLocalMemoryPtr()
+    );
+    *p_cullingUniformBufferObject = {
+        frustumPlanes,
+        o_occlusionViewProjectionMatrix.value_or(glm::mat4(1.0f)),
+        depthPyramidSize,
+        instanceCount,
+        static_cast<uint32_t>(phase),
+        o_occlusionViewProjectionMatrix.has_value()
+    };
+
+    // ----- reset every batch's counter before the shader starts appending ----- //
+
+    commandBuffer.fillBuffer(
+        drawCountBuffer,
+        0,
+        sizeof(uint32_t) * batchCount,
+        0
+    );
+
+    const vk::BufferMemoryBarrier clearedCountsBarrier(
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        drawCountBuffer,
+        0,
+        VK_WHOLE_SIZE
+    );
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        {},
+        clearedCountsBarrier,
+        {}
+    );
+
+    // ----- cull ----- //
+
+    commandBuffer.bindPipeline(
+        vk::PipelineBindPoint::eCompute,
+        *mp_vulkanComputePipeline
+    );
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        *mp_vulkanPipelineLayout,
+        0,
+        m_vulkanDescriptorSets[phaseBufferIndex],
+        {}
+    );
+
+    commandBuffer.dispatch(
+        (instanceCount + quartz::rendering::GpuCuller::workGroupSize - 1) / quartz::rendering::GpuCuller::workGroupSize,
+        1,
+        1
+    );
+
+    // ----- make the surviving draws and their counts visible to the indirect draws ----- //
+
+    const std::array<vk::BufferMemoryBarrier, 2> culledDrawsBarriers = {
+        vk::BufferMemoryBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eIndirectCommandRead,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            drawCommandBuffer,
+            0,
+            VK_WHOLE_SIZE
+        ),
+        vk::BufferMemoryBarrier(
+            vk::AccessFlagBits::eShaderWrite,
+            vk::AccessFlagBits::eIndirectCommandRead,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            drawCountBuffer,
+            0,
+            VK_WHOLE_SIZE
+        )
+    };
+
+    // The second phase reads the occluded flags written by the first
+    const vk::MemoryBarrier occludedFlagsBarrier(
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead
+    );
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader,
+        {},
+        occludedFlagsBarrier,
+        culledDrawsBarriers,
+        {}
+    );
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/culling/DepthPyramid.hpp"
+#include "quartz/rendering/device/Device.hpp"
+
+namespace quartz {
+namespace rendering {
+    class GpuCuller;
+}
+}
+
+/**
+ * @brief Frustum culls draws with a compute shader instead of on the cpu. Every frame the cpu writes
+ *   one instance (world space bounds and the draw command it would use) per draw into this frame's
+ *   instance buffer, then the compute shader tests each one and atomically appends the survivors into
+ *   the draw command buffer. These are consumed with vkCmdDrawIndexedIndirectCount, which reads the
+ *   number of survivors from the draw count buffer so the cpu never needs to know how many survived.
+ *
+ * @brief Draws are grouped into batches (runs of draws sharing a geometry pool block) because we can only
+ *   bind one vertex and index buffer per indirect draw. Each batch has its own counter in the draw count
+ *   buffer and its own region of the draw command buffer, starting at its first draw's index.
+ *
+ * @brief Optionally, draws are also occlusion culled against a DepthPyramid in two phases. The first
+ *   phase tests against the pyramid built at the end of the previous frame (projecting the bounds with
+ *   the previous frame's view projection matrix) and draws what passes. Draws failing only the occlusion
+ *   test are flagged, and once the pyramid has been rebuilt from the first phase's depth, the second phase
+ *   re-tests just the flagged draws and draws the ones which became visible. Each phase has its own draw
+ *   command and draw count buffers so the second phase doesn't disturb what the first phase drew.
+ *
+ * @brief Only core vulkan 1.2 compute and indirect count functionality is used, so this works on
+ *   software implementations like lavapipe as well.
+ */
+class quartz::rendering::GpuCuller {
+public: // classes
+    struct InstanceStorageBufferObject {
+    public: // member variables
+        alignas(16) glm::vec4 worldBoundsCenter;
+        alignas(16) glm::vec4 worldBoundsExtent;
+        alignas(4) uint32_t indexCount;
+        alignas(4) uint32_t firstIndex;
+        alignas(4) int32_t vertexOffset;
+        alignas(4) uint32_t firstInstance;
+        alignas(4) uint32_t batchIndex;
+        alignas(4) uint32_t batchFirstCommandIndex;
+    };
+
+    /**
+     * @brief A run of sorted draws sharing a geometry pool block, drawn with a single indirect count draw
+     */
+    struct Batch {
+    public: // member variables
+        uint32_t geometryBlockIndex;
+        uint32_t firstDrawIndex;
+        uint32_t drawCount;
+    };
+
+public: // enums
+    enum class Phase : uint32_t {
+        First   = 0,
+        Second  = 1
+    };
+
+public: // member functions
+    GpuCuller(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t maxNumFramesInFlight
+    );
+    ~GpuCuller();
+
+    USE_LOGGER(CULLING);
+
+    quartz::rendering::GpuCuller::InstanceStorageBufferObject* getMappedInstancesPtr(const uint32_t inFlightFrameIndex);
+    const vk::UniqueBuffer& getVulkanDrawCommandBufferPtr(const uint32_t inFlightFrameIndex, const quartz::rendering::GpuCuller::Phase phase) const { return m_drawCommandBuffers[inFlightFrameIndex * quartz::rendering::GpuCuller::numPhases + static_cast<uint32_t>(phase)].getVulkanLogicalBufferPtr(); }
+    const vk::UniqueBuffer& getVulkanDrawCountBufferPtr(const uint32_t inFlightFrameIndex, const quartz::rendering::GpuCuller::Phase phase) const { return m_drawCountBuffers[inFlightFrameIndex * quartz::rendering::GpuCuller::numPhases + static_cast<uint32_t>(phase)].getVulkanLogicalBufferPtr(); }
+
+    /**
+     * @brief Point a frame's descriptor sets at the pyramid to test against. This must be called for every
+     *   frame whenever the pyramid is recreated, while that frame's descriptor sets are not in use
+     */
+    void updateDepthPyramidDescriptors(
+        const quartz::rendering::Device& renderingDevice,
+        const quartz::rendering::DepthPyramid& depthPyramid,
+        const uint32_t inFlightFrameIndex
+    );
+
+    /**
+     * @brief Record clearing the phase's batch counters, the culling dispatch, and the barriers making the
+     *   results visible to indirect draws. The first phase must be submitted before the command buffer
+     *   drawing its results, and the second phase must be recorded after the depth pyramid was rebuilt
+     *
+     * @param o_occlusionViewProjectionMatrix The view projection matrix the depth pyramid's contents were
+     *   drawn with. Without one (or without a valid pyramid) the first phase only frustum culls
+     */
+    void recordCullingToCommandBuffer(
+        const vk::CommandBuffer& commandBuffer,
+        const uint32_t inFlightFrameIndex,
+        const quartz::rendering::GpuCuller::Phase phase,
+        const std::array<glm::vec4, 6>& frustumPlanes,
+        const std::optional<glm::mat4>& o_occlusionViewProjectionMatrix,
+        const glm::vec2& depthPyramidSize,
+        const uint32_t instanceCount,
+        const uint32_t batchCount
+    );
+
+public: // static functions
+    static bool getGpuCullingSupported(
+        const quartz::rendering::Device& renderingDevice,
+        const vk::Format depthBufferFormat
+    );
+
+public: // static variables
+    static constexpr uint32_t workGroupSize = 64; // must match local_size_x in cull.comp
+    static constexpr uint32_t numPhases = 2;
+
+private: // classes
+    /**
+     * @brief Too big for the 128 bytes of push constants we are guaranteed, so this lives in a uniform
+     *   buffer per frame in flight and phase
+     */
+    struct CullingUniformBufferObject {
+    public: // member variables
+        alignas(16) std::array<glm::vec4, 6> frustumPlanes;
+        alignas(16) glm::mat4 occlusionViewProjectionMatrix;
+        alignas(8) glm::vec2 depthPyramidSize;
+        alignas(4) uint32_t instanceCount;
+        alignas(4) uint32_t phase;
+        alignas(4) uint32_t occlusionCullingEnabled;
+    };
+
+private: // static functions
+    static std::vector<quartz::rendering::LocallyMappedBuffer> createLocallyMappedBuffers(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t bufferCount,
+        const uint32_t sizeBytes,
+        const vk::BufferUsageFlags usageFlags
+    );
+    static vk::UniqueDescriptorSetLayout createVulkanDescriptorSetLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice
+    );
+    static vk::UniqueDescriptorPool createVulkanDescriptorPoolPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t descriptorSetCount
+    );
+    static std::vector<vk::DescriptorSet> allocateVulkanDescriptorSets(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t descriptorSetCount,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+        const vk::UniqueDescriptorPool& p_descriptorPool
+    );
+    static void updateVulkanDescriptorSets(
+        const vk::UniqueDevice& p_logicalDevice,
+        const std::vector<quartz::rendering::LocallyMappedBuffer>& instanceBuffers,
+        const std::vector<quartz::rendering::LocallyMappedBuffer>& drawCommandBuffers,
+        const std::vector<quartz::rendering::LocallyMappedBuffer>& drawCountBuffers,
+        const std::vector<quartz::rendering::LocallyMappedBuffer>& cullingUniformBuffers,
+        const std::vector<quartz::rendering::LocallyMappedBuffer>& occludedFlagBuffers,
+        const std::vector<vk::DescriptorSet>& descriptorSets
+    );
+    static vk::UniquePipelineLayout createVulkanPipelineLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+    );
+
+private: // member variables
+    /**
+     * @brief The instance and occluded flag buffers are shared by both phases, so there is one per frame
+     *   in flight. Everything else is indexed by frame * numPhases + phase, as are the descriptor sets
+     */
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_instanceBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_occludedFlagBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_drawCommandBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_drawCountBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_cullingUniformBuffers;
+
+    vk::UniqueShaderModule mp_vulkanComputeShaderModule;
+    vk::UniqueDescriptorSetLayout mp_vulkanDescriptorSetLayout;
+    vk::UniqueDescriptorPool mp_vulkanDescriptorPool;
+    std::vector<vk::DescriptorSet> m_vulkanDescriptorSets;
+    vk::UniquePipelineLayout mp_vulkanPipelineLayout;
+    vk::UniquePipeline mp_vulkanComputePipeline;
+};
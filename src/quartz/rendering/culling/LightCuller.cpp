@@ -0,0 +1,482 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/matrix.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/file_system/FileSystem.hpp"
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/culling/LightCuller.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
+#include "quartz/scene/camera/Camera.hpp"
+#include "quartz/scene/light/PointLight.hpp"
+#include "quartz/scene/light/SpotLight.hpp"
+
+std::vector<quartz::rendering::LocallyMappedBuffer>
+quartz::rendering::LightCuller::createLocallyMappedBuffers(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t bufferCount,
+    const uint32_t sizeBytes,
+    const vk::BufferUsageFlags usageFlags
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} buffers, {} bytes", bufferCount, sizeBytes);
+
+    std::vector<quartz::rendering::LocallyMappedBuffer> buffers;
+
+    for (uint32_t i = 0; i < bufferCount; ++i) {
+        buffers.emplace_back(
+            renderingDevice,
+            sizeBytes,
+            usageFlags,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+    }
+
+    if (buffers.size() != bufferCount) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Created {} buffers instead of expected {}", buffers.size(), bufferCount);
+    }
+
+    return buffers;
+}
+
+vk::UniqueDescriptorSetLayout
+quartz::rendering::LightCuller::createVulkanDescriptorSetLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    const vk::ShaderStageFlags shaderStageFlags = vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eFragment;
+
+    // clustering uniform, point lights, spot lights, clusters, overflow (which only the compute shader uses)
+    const std::array<vk::DescriptorSetLayoutBinding, 5> layoutBindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, shaderStageFlags, {}),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, shaderStageFlags, {}),
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, shaderStageFlags, {}),
+        vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, shaderStageFlags, {}),
+        vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, {})
+    };
+
+    vk::DescriptorSetLayoutCreateInfo layoutCreateInfo(
+        {},
+        layoutBindings
+    );
+
+    vk::UniqueDescriptorSetLayout p_descriptorSetLayout = p_logicalDevice->createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+    if (!p_descriptorSetLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorSetLayout");
+    }
+
+    return p_descriptorSetLayout;
+}
+
+vk::UniqueDescriptorPool
+quartz::rendering::LightCuller::createVulkanDescriptorPoolPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t descriptorSetCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSetCount);
+
+    const std::array<vk::DescriptorPoolSize, 2> descriptorPoolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, descriptorSetCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 4 * descriptorSetCount)
+    };
+
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo(
+        {},
+        descriptorSetCount,
+        descriptorPoolSizes
+    );
+
+    vk::UniqueDescriptorPool p_descriptorPool = p_logicalDevice->createDescriptorPoolUnique(descriptorPoolCreateInfo);
+
+    if (!p_descriptorPool) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::DescriptorPool");
+    }
+
+    return p_descriptorPool;
+}
+
+std::vector<vk::DescriptorSet>
+quartz::rendering::LightCuller::allocateVulkanDescriptorSets(
+    const vk::UniqueDevice& p_logicalDevice,
+    const uint32_t descriptorSetCount,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+    const vk::UniqueDescriptorPool& p_descriptorPool
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "{} descriptor sets", descriptorSetCount);
+
+    const std::vector<vk::DescriptorSetLayout> descriptorSetLayouts(
+        descriptorSetCount,
+        *p_descriptorSetLayout
+    );
+
+    vk::DescriptorSetAllocateInfo allocateInfo(
+        *p_descriptorPool,
+        descriptorSetLayouts.size(),
+        descriptorSetLayouts.data()
+    );
+
+    std::vector<vk::DescriptorSet> descriptorSets = p_logicalDevice->allocateDescriptorSets(allocateInfo);
+
+    if (descriptorSets.size() != descriptorSetCount) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Allocated {} vk::DescriptorSet(s) instead of requested amount: {}", descriptorSets.size(), descriptorSetCount);
+    }
+
+    for (uint32_t i = 0; i < descriptorSets.size(); ++i) {
+        if (!descriptorSets[i]) {
+            LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to allocate vk::DescriptorSet {}", i);
+        }
+    }
+
+    return descriptorSets;
+}
+
+void
+quartz::rendering::LightCuller::updateVulkanDescriptorSet(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::DescriptorSet& descriptorSet,
+    const uint32_t bindingLocation,
+    const vk::DescriptorType descriptorType,
+    const quartz::rendering::LocallyMappedBuffer& buffer
+) {
+    const vk::DescriptorBufferInfo bufferInfo(
+        *(buffer.getVulkanLogicalBufferPtr()),
+        0,
+        VK_WHOLE_SIZE
+    );
+
+    const vk::WriteDescriptorSet writeDescriptorSet(
+        descriptorSet,
+        bindingLocation,
+        0,
+        1,
+        descriptorType,
+        {},
+        &bufferInfo,
+        {}
+    );
+
+    p_logicalDevice->updateDescriptorSets(
+        writeDescriptorSet,
+        {}
+    );
+}
+
+vk::UniquePipelineLayout
+quartz::rendering::LightCuller::createVulkanPipelineLayoutPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+) {
+    LOG_FUNCTION_SCOPE_TRACE(CULLING, "");
+
+    vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo(
+        {},
+        *p_descriptorSetLayout,
+        {}
+    );
+
+    vk::UniquePipelineLayout p_pipelineLayout = p_logicalDevice->createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+    if (!p_pipelineLayout) {
+        LOG_THROW(CULLING, util::VulkanCreationFailedError, "Failed to create vk::PipelineLayout");
+    }
+
+    return p_pipelineLayout;
+}
+
+quartz::rendering::LightCuller::LightCuller(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t maxNumFramesInFlight
+) :
+    m_clusteringUniformBuffers(
+        quartz::rendering::LightCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(quartz::rendering::LightCuller::ClusteringUniformBufferObject),
+            vk::BufferUsageFlagBits::eUniformBuffer
+        )
+    ),
+    m_pointLightBuffers(
+        quartz::rendering::LightCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(quartz::scene::PointLight) * quartz::rendering::LightCuller::initialLightCapacity,
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_spotLightBuffers(
+        quartz::rendering::LightCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(quartz::scene::SpotLight) * quartz::rendering::LightCuller::initialLightCapacity,
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_clusterBuffers(
+        quartz::rendering::LightCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(uint32_t) * (2 + quartz::rendering::LightCuller::maxNumLightsPerCluster) * quartz::rendering::LightCuller::clusterCount,
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_overflowBuffers(
+        quartz::rendering::LightCuller::createLocallyMappedBuffers(
+            renderingDevice,
+            maxNumFramesInFlight,
+            sizeof(quartz::rendering::LightCuller::OverflowStorageBufferObject),
+            vk::BufferUsageFlagBits::eStorageBuffer
+        )
+    ),
+    m_pointLightCapacities(maxNumFramesInFlight, quartz::rendering::LightCuller::initialLightCapacity),
+    m_spotLightCapacities(maxNumFramesInFlight, quartz::rendering::LightCuller::initialLightCapacity),
+    m_lastReportedOverflow({0, 0, 0}),
+    mp_vulkanComputeShaderModule(
+        quartz::rendering::VulkanUtil::createVulkanShaderModulePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            util::FileSystem::getCompiledShaderAbsoluteFilepath("light_cull.comp")
+        )
+    ),
+    mp_vulkanDescriptorSetLayout(
+        quartz::rendering::LightCuller::createVulkanDescriptorSetLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr()
+        )
+    ),
+    mp_vulkanDescriptorPool(
+        quartz::rendering::LightCuller::createVulkanDescriptorPoolPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            maxNumFramesInFlight
+        )
+    ),
+    m_vulkanDescriptorSets(
+        quartz::rendering::LightCuller::allocateVulkanDescriptorSets(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            maxNumFramesInFlight,
+            mp_vulkanDescriptorSetLayout,
+            mp_vulkanDescriptorPool
+        )
+    ),
+    mp_vulkanPipelineLayout(
+        quartz::rendering::LightCuller::createVulkanPipelineLayoutPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDescriptorSetLayout
+        )
+    ),
+    mp_vulkanComputePipeline(
+        quartz::rendering::VulkanUtil::createVulkanComputePipelinePtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingDevice.getVulkanPipelineCachePtr(),
+            mp_vulkanComputeShaderModule,
+            mp_vulkanPipelineLayout
+        )
+    )
+{
+    LOG_FUNCTION_CALL_TRACEthis("");
+
+    for (uint32_t i = 0; i < m_vulkanDescriptorSets.size(); ++i) {
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[i], 0, vk::DescriptorType::eUniformBuffer, m_clusteringUniformBuffers[i]);
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[i], 1, vk::DescriptorType::eStorageBuffer, m_pointLightBuffers[i]);
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[i], 2, vk::DescriptorType::eStorageBuffer, m_spotLightBuffers[i]);
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[i], 3, vk::DescriptorType::eStorageBuffer, m_clusterBuffers[i]);
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[i], 4, vk::DescriptorType::eStorageBuffer, m_overflowBuffers[i]);
+
+        std::memset(m_overflowBuffers[i].getMappedLocalMemoryPtr(), 0, sizeof(quartz::rendering::LightCuller::OverflowStorageBufferObject));
+    }
+}
+
+quartz::rendering::LightCuller::~LightCuller() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+}
+
+void
+quartz::rendering::LightCuller::reportAndResetOverflow(
+    const uint32_t inFlightFrameIndex
+) {
+    quartz::rendering::LightCuller::OverflowStorageBufferObject* p_overflow = reinterpret_cast<quartz::rendering::LightCuller::OverflowStorageBufferObject*>(
+        m_overflowBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr()
+    );
+
+    // Only when it changes, otherwise a scene with too many lights would warn every single frame
+    if (
+        p_overflow->droppedPointLightCount != m_lastReportedOverflow.droppedPointLightCount ||
+        p_overflow->droppedSpotLightCount != m_lastReportedOverflow.droppedSpotLightCount
+    ) {
+        if (p_overflow->droppedPointLightCount > 0 || p_overflow->droppedSpotLightCount > 0) {
+            LOG_WARNINGthis("{} clusters ran out of room for their lights. Dropped {} point lights and {} spot lights from them", p_overflow->overflowingClusterCount, p_overflow->droppedPointLightCount, p_overflow->droppedSpotLightCount);
+        } else {
+            LOG_DEBUGthis("No clusters are dropping lights anymore");
+        }
+        m_lastReportedOverflow = *p_overflow;
+    }
+
+    *p_overflow = {0, 0, 0};
+}
+
+void
+quartz::rendering::LightCuller::reserveLightCapacity(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t inFlightFrameIndex,
+    const uint32_t numPointLights,
+    const uint32_t numSpotLights
+) {
+    // Grow to the next power of two so a slowly growing scene doesn't reallocate every frame
+
+    if (numPointLights > m_pointLightCapacities[inFlightFrameIndex]) {
+        const uint32_t pointLightCapacity = std::bit_ceil(numPointLights);
+        LOG_DEBUGthis("Growing frame {}'s point light buffer from {} to {} lights", inFlightFrameIndex, m_pointLightCapacities[inFlightFrameIndex], pointLightCapacity);
+
+        m_pointLightBuffers[inFlightFrameIndex] = quartz::rendering::LocallyMappedBuffer(
+            renderingDevice,
+            sizeof(quartz::scene::PointLight) * pointLightCapacity,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+        m_pointLightCapacities[inFlightFrameIndex] = pointLightCapacity;
+
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[inFlightFrameIndex], 1, vk::DescriptorType::eStorageBuffer, m_pointLightBuffers[inFlightFrameIndex]);
+    }
+
+    if (numSpotLights > m_spotLightCapacities[inFlightFrameIndex]) {
+        const uint32_t spotLightCapacity = std::bit_ceil(numSpotLights);
+        LOG_DEBUGthis("Growing frame {}'s spot light buffer from {} to {} lights", inFlightFrameIndex, m_spotLightCapacities[inFlightFrameIndex], spotLightCapacity);
+
+        m_spotLightBuffers[inFlightFrameIndex] = quartz::rendering::LocallyMappedBuffer(
+            renderingDevice,
+            sizeof(quartz::scene::SpotLight) * spotLightCapacity,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+        m_spotLightCapacities[inFlightFrameIndex] = spotLightCapacity;
+
+        quartz::rendering::LightCuller::updateVulkanDescriptorSet(renderingDevice.getVulkanLogicalDevicePtr(), m_vulkanDescriptorSets[inFlightFrameIndex], 2, vk::DescriptorType::eStorageBuffer, m_spotLightBuffers[inFlightFrameIndex]);
+    }
+}
+
+void
+quartz::rendering::LightCuller::updateLights(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t inFlightFrameIndex,
+    const quartz::scene::Camera& camera,
+    const vk::Extent2D& screenExtent,
+    const std::vector<quartz::scene::PointLight>& pointLights,
+    const std::vector<quartz::scene::SpotLight>& spotLights,
+    const bool pointLightsChanged,
+    const bool spotLightsChanged
+) {
+    this->reportAndResetOverflow(inFlightFrameIndex);
+
+    // A buffer which grows is a new buffer, so whatever was in the old one has to be copied again
+    const bool shouldCopyPointLights = pointLightsChanged || pointLights.size() > m_pointLightCapacities[inFlightFrameIndex];
+    const bool shouldCopySpotLights = spotLightsChanged || spotLights.size() > m_spotLightCapacities[inFlightFrameIndex];
+
+    this->reserveLightCapacity(
+        renderingDevice,
+        inFlightFrameIndex,
+        pointLights.size(),
+        spotLights.size()
+    );
+
+    if (shouldCopyPointLights && !pointLights.empty()) {
+        std::memcpy(
+            m_pointLightBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr(),
+            pointLights.data(),
+            sizeof(quartz::scene::PointLight) * pointLights.size()
+        );
+    }
+
+    if (shouldCopySpotLights && !spotLights.empty()) {
+        std::memcpy(
+            m_spotLightBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr(),
+            spotLights.data(),
+            sizeof(quartz::scene::SpotLight) * spotLights.size()
+        );
+    }
+
+    quartz::rendering::LightCuller::ClusteringUniformBufferObject* p_clusteringUniformBufferObject = reinterpret_cast<quartz::rendering::LightCuller::ClusteringUniformBufferObject*>(
+        m_clusteringUniformBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr()
+    );
+    *p_clusteringUniformBufferObject = {
+        glm::inverse(camera.getProjectionMatrix()),
+        camera.getViewMatrix(),
+        glm::vec2(screenExtent.width, screenExtent.height),
+        quartz::scene::Camera::nearPlaneDistance,
+        quartz::scene::Camera::farPlaneDistance,
+        static_cast<uint32_t>(pointLights.size()),
+        static_cast<uint32_t>(spotLights.size())
+    };
+}
+
+void
+quartz::rendering::LightCuller::recordCullingToCommandBuffer(
+    const vk::CommandBuffer& commandBuffer,
+    const uint32_t inFlightFrameIndex
+) {
+    commandBuffer.bindPipeline(
+        vk::PipelineBindPoint::eCompute,
+        *mp_vulkanComputePipeline
+    );
+
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute,
+        *mp_vulkanPipelineLayout,
+        0,
+        m_vulkanDescriptorSets[inFlightFrameIndex],
+        {}
+    );
+
+    commandBuffer.dispatch(
+        (quartz::rendering::LightCuller::clusterCount + quartz::rendering::LightCuller::workGroupSize - 1) / quartz::rendering::LightCuller::workGroupSize,
+        1,
+        1
+    );
+
+    const vk::BufferMemoryBarrier clustersBarrier(
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eShaderRead,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        *(m_clusterBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr()),
+        0,
+        VK_WHOLE_SIZE
+    );
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader,
+        {},
+        {},
+        clustersBarrier,
+        {}
+    );
+
+    // The cpu reads the overflow counts back after waiting for the frame's fence
+    const vk::BufferMemoryBarrier overflowBarrier(
+        vk::AccessFlagBits::eShaderWrite,
+        vk::AccessFlagBits::eHostRead,
+        VK_QUEUE_FAMILY_IGNORED,
+        VK_QUEUE_FAMILY_IGNORED,
+        *(m_overflowBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr()),
+        0,
+        VK_WHOLE_SIZE
+    );
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eHost,
+        {},
+        {},
+        overflowBarrier,
+        {}
+    );
+}
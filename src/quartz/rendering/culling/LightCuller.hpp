@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/device/Device.hpp"
+#include "quartz/scene/camera/Camera.hpp"
+#include "quartz/scene/light/PointLight.hpp"
+#include "quartz/scene/light/SpotLight.hpp"
+
+namespace quartz {
+namespace rendering {
+    class LightCuller;
+}
+}
+
+/**
+ * @brief Bins the point and spot lights into a grid of clusters (froxels) covering the camera's view
+ *   frustum, so each fragment only shades with the lights in its own cluster instead of every light in
+ *   the scene. The grid is clusterCountX by clusterCountY tiles of the screen, each split into
+ *   clusterCountZ slices along the view direction. The slices get exponentially deeper with distance
+ *   from the camera so clusters stay roughly cube shaped.
+ *
+ * @brief Every frame the cpu copies the lights into this frame's light storage buffers (which grow when
+ *   the scene has more lights than they can hold), then a compute shader tests every light's sphere of
+ *   influence against every cluster's view space bounds and writes the indices of the lights touching
+ *   each cluster into the cluster buffer. The dispatch is recorded ahead of the render pass.
+ *
+ * @brief All of it lives in a single descriptor set per frame in flight, which the compute shader uses
+ *   as set 0 and the doodad pipeline's fragment shader uses as set 1.
+ */
+class quartz::rendering::LightCuller {
+public: // member functions
+    LightCuller(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t maxNumFramesInFlight
+    );
+    ~LightCuller();
+
+    USE_LOGGER(CULLING);
+
+    const vk::UniqueDescriptorSetLayout& getVulkanDescriptorSetLayoutPtr() const { return mp_vulkanDescriptorSetLayout; }
+    const vk::DescriptorSet& getVulkanDescriptorSet(const uint32_t inFlightFrameIndex) const { return m_vulkanDescriptorSets[inFlightFrameIndex]; }
+
+    /**
+     * @brief Copy the camera and the light counts into this frame's buffers, growing the light buffers
+     *   first if they are too small. The lights themselves are only copied when they changed since this
+     *   frame's buffers were last written (or when their buffer had to grow). This must be called after
+     *   waiting for the frame's fence, because growing replaces buffers the frame's descriptor set points at
+     */
+    void updateLights(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t inFlightFrameIndex,
+        const quartz::scene::Camera& camera,
+        const vk::Extent2D& screenExtent,
+        const std::vector<quartz::scene::PointLight>& pointLights,
+        const std::vector<quartz::scene::SpotLight>& spotLights,
+        const bool pointLightsChanged,
+        const bool spotLightsChanged
+    );
+
+    /**
+     * @brief Record the binning dispatch and the barrier making the clusters visible to fragment shaders.
+     *   This must be recorded outside of a render pass, before the draws using the clusters
+     */
+    void recordCullingToCommandBuffer(
+        const vk::CommandBuffer& commandBuffer,
+        const uint32_t inFlightFrameIndex
+    );
+
+public: // static variables
+    static constexpr uint32_t clusterCountX = 16; // must match CLUSTER_COUNT_X in light_cull.comp and shader.frag
+    static constexpr uint32_t clusterCountY = 9; // must match CLUSTER_COUNT_Y in light_cull.comp and shader.frag
+    static constexpr uint32_t clusterCountZ = 24; // must match CLUSTER_COUNT_Z in light_cull.comp and shader.frag
+    static constexpr uint32_t clusterCount = clusterCountX * clusterCountY * clusterCountZ;
+
+    /**
+     * @brief Lights past this many in a single cluster are dropped from it. Along with the cluster's two
+     *   light counts this makes every cluster exactly 512 bytes. Point lights leave up to half of the
+     *   slots for spot lights, and how many lights were dropped is logged once the frame is done
+     */
+    static constexpr uint32_t maxNumLightsPerCluster = 126; // must match MAX_NUMBER_LIGHTS_PER_CLUSTER in light_cull.comp and shader.frag
+
+    static constexpr uint32_t workGroupSize = 64; // must match local_size_x in light_cull.comp
+
+    /**
+     * @brief How many lights of each type the light buffers hold before they first need to grow
+     */
+    static constexpr uint32_t initialLightCapacity = 64;
+
+private: // classes
+    struct ClusteringUniformBufferObject {
+    public: // member variables
+        alignas(16) glm::mat4 inverseProjectionMatrix;
+        alignas(16) glm::mat4 viewMatrix;
+        alignas(8) glm::vec2 screenSize;
+        alignas(4) float nearPlaneDistance;
+        alignas(4) float farPlaneDistance;
+        alignas(4) uint32_t pointLightCount;
+        alignas(4) uint32_t spotLightCount;
+    };
+
+    struct OverflowStorageBufferObject {
+    public: // member variables
+        alignas(4) uint32_t droppedPointLightCount;
+        alignas(4) uint32_t droppedSpotLightCount;
+        alignas(4) uint32_t overflowingClusterCount;
+    };
+
+private: // static functions
+    static std::vector<quartz::rendering::LocallyMappedBuffer> createLocallyMappedBuffers(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t bufferCount,
+        const uint32_t sizeBytes,
+        const vk::BufferUsageFlags usageFlags
+    );
+    static vk::UniqueDescriptorSetLayout createVulkanDescriptorSetLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice
+    );
+    static vk::UniqueDescriptorPool createVulkanDescriptorPoolPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t descriptorSetCount
+    );
+    static std::vector<vk::DescriptorSet> allocateVulkanDescriptorSets(
+        const vk::UniqueDevice& p_logicalDevice,
+        const uint32_t descriptorSetCount,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+        const vk::UniqueDescriptorPool& p_descriptorPool
+    );
+    static void updateVulkanDescriptorSet(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::DescriptorSet& descriptorSet,
+        const uint32_t bindingLocation,
+        const vk::DescriptorType descriptorType,
+        const quartz::rendering::LocallyMappedBuffer& buffer
+    );
+    static vk::UniquePipelineLayout createVulkanPipelineLayoutPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+    );
+
+private: // member functions
+    /**
+     * @brief Log how many lights this frame's last dispatch dropped (when that changed), then zero the
+     *   counts for the next one
+     */
+    void reportAndResetOverflow(
+        const uint32_t inFlightFrameIndex
+    );
+    void reserveLightCapacity(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t inFlightFrameIndex,
+        const uint32_t numPointLights,
+        const uint32_t numSpotLights
+    );
+
+private: // member variables
+    /**
+     * @brief Everything is indexed by frame in flight. The capacities are in lights, not bytes
+     */
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_clusteringUniformBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_pointLightBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_spotLightBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_clusterBuffers;
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_overflowBuffers;
+    std::vector<uint32_t> m_pointLightCapacities;
+    std::vector<uint32_t> m_spotLightCapacities;
+    quartz::rendering::LightCuller::OverflowStorageBufferObject m_lastReportedOverflow;
+
+    vk::UniqueShaderModule mp_vulkanComputeShaderModule;
+    vk::UniqueDescriptorSetLayout mp_vulkanDescriptorSetLayout;
+    vk::UniqueDescriptorPool mp_vulkanDescriptorPool;
+    std::vector<vk::DescriptorSet> m_vulkanDescriptorSets;
+    vk::UniquePipelineLayout mp_vulkanPipelineLayout;
+    vk::UniquePipeline mp_vulkanComputePipeline;
+};
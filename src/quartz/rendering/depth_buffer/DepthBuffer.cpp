@@ -21,6 +21,7 @@ quartz::rendering::DepthBuffer::DepthBuffer(
         m_imageWidth,
         m_imageHeight,
         1,
+        1,
         usageFlags,
         {},
         format,
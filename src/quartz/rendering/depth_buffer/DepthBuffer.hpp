@@ -31,6 +31,7 @@ public: // member functions
 
     USE_LOGGER(DEPTHBUFFER);
 
+    const vk::UniqueImage& getVulkanImagePtr() const { return m_imageBuffer.getVulkanImagePtr(); }
     const vk::UniqueImageView& getVulkanImageViewPtr() const { return mp_vulkanImageView; }
 
 private: // static functions
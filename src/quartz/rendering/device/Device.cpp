@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <vulkan/vulkan.hpp>
 
+#include "util/file_system/FileSystem.hpp"
+
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 #include "quartz/rendering/instance/Instance.hpp"
 
 vk::PhysicalDevice
@@ -120,6 +129,15 @@ quartz::rendering::Device::getEnabledPhysicalDeviceExtensionNames(
             LOG_TRACE(DEVICE, "    - swapchain extension found");
             swapchainExtensionFound = true;
         }
+
+        // Optional. Lets the memory allocator report (and warn about) the driver's budget for each heap
+        if (
+            std::string(extensionProperties.extensionName) == std::string(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) &&
+            physicalDevice.getProperties().apiVersion >= VK_API_VERSION_1_1
+        ) {
+            LOG_TRACE(DEVICE, "    - memory budget extension found");
+            requiredPhysicalDeviceExtensionNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
     }
 
     if (!swapchainExtensionFound) {
@@ -129,12 +147,68 @@ quartz::rendering::Device::getEnabledPhysicalDeviceExtensionNames(
     return requiredPhysicalDeviceExtensionNames;
 }
 
+vk::PhysicalDeviceFeatures
+quartz::rendering::Device::getEnabledPhysicalDeviceFeatures(
+    const vk::PhysicalDevice& physicalDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(DEVICE, "");
+
+    const vk::PhysicalDeviceFeatures supportedPhysicalDeviceFeatures = physicalDevice.getFeatures();
+
+    vk::PhysicalDeviceFeatures enabledPhysicalDeviceFeatures;
+    enabledPhysicalDeviceFeatures.samplerAnisotropy = true;
+    /// @todo 2023/11/01 enable requestedPhysicalDeviceFeatures.depthBounds
+
+    /**
+     * @brief These are optional. Indirect drawing needs both of them, so if either is missing
+     *   we fall back to recording a draw call per primitive
+     */
+    enabledPhysicalDeviceFeatures.multiDrawIndirect = supportedPhysicalDeviceFeatures.multiDrawIndirect;
+    enabledPhysicalDeviceFeatures.drawIndirectFirstInstance = supportedPhysicalDeviceFeatures.drawIndirectFirstInstance;
+    LOG_TRACE(DEVICE, "Multi draw indirect supported          : {}", static_cast<bool>(enabledPhysicalDeviceFeatures.multiDrawIndirect));
+    LOG_TRACE(DEVICE, "Draw indirect first instance supported : {}", static_cast<bool>(enabledPhysicalDeviceFeatures.drawIndirectFirstInstance));
+
+    return enabledPhysicalDeviceFeatures;
+}
+
+vk::PhysicalDeviceVulkan12Features
+quartz::rendering::Device::getEnabledPhysicalDeviceVulkan12Features(
+    const vk::PhysicalDevice& physicalDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACE(DEVICE, "");
+
+    vk::PhysicalDeviceVulkan12Features enabledPhysicalDeviceVulkan12Features;
+
+    // We are not allowed to ask about (or enable) vulkan 1.2 features on a device which doesn't support 1.2
+    const uint32_t physicalDeviceApiVersion = physicalDevice.getProperties().apiVersion;
+    if (physicalDeviceApiVersion < VK_API_VERSION_1_2) {
+        LOG_DEBUG(DEVICE, "Device only supports vulkan {}.{}. Not enabling any vulkan 1.2 features", VK_API_VERSION_MAJOR(physicalDeviceApiVersion), VK_API_VERSION_MINOR(physicalDeviceApiVersion));
+        return enabledPhysicalDeviceVulkan12Features;
+    }
+
+    const vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features> supportedPhysicalDeviceFeatureChain =
+        physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    const vk::PhysicalDeviceVulkan12Features& supportedPhysicalDeviceVulkan12Features =
+        supportedPhysicalDeviceFeatureChain.get<vk::PhysicalDeviceVulkan12Features>();
+
+    /**
+     * @brief Optional. Culling on the gpu needs this to draw however many draws survived culling,
+     *   so if it is missing we only cull on the cpu
+     */
+    enabledPhysicalDeviceVulkan12Features.drawIndirectCount = supportedPhysicalDeviceVulkan12Features.drawIndirectCount;
+    LOG_TRACE(DEVICE, "Draw indirect count supported          : {}", static_cast<bool>(enabledPhysicalDeviceVulkan12Features.drawIndirectCount));
+
+    return enabledPhysicalDeviceVulkan12Features;
+}
+
 vk::UniqueDevice
 quartz::rendering::Device::createVulkanLogicalDevicePtr(
     const vk::PhysicalDevice& physicalDevice,
     const uint32_t graphicsQueueFamilyIndex,
     const std::vector<const char*>& validationLayerNames,
-    const std::vector<const char*>& physicalDeviceExtensionNames
+    const std::vector<const char*>& physicalDeviceExtensionNames,
+    const vk::PhysicalDeviceFeatures& enabledPhysicalDeviceFeatures,
+    const vk::PhysicalDeviceVulkan12Features& enabledPhysicalDeviceVulkan12Features
 ) {
     LOG_FUNCTION_SCOPE_TRACE(DEVICE, "graphics queue family index = {}", graphicsQueueFamilyIndex);
 
@@ -156,18 +230,21 @@ quartz::rendering::Device::createVulkanLogicalDevicePtr(
         );
     }
 
-    vk::PhysicalDeviceFeatures requestedPhysicalDeviceFeatures;
-    requestedPhysicalDeviceFeatures.samplerAnisotropy = true;
-    /// @todo 2023/11/01 enable requestedPhysicalDeviceFeatures.depthBounds
-
     vk::DeviceCreateInfo logicalDeviceCreateInfo(
         {},
         deviceQueueCreateInfos,
         validationLayerNames,
         physicalDeviceExtensionNames,
-        &requestedPhysicalDeviceFeatures
+        &enabledPhysicalDeviceFeatures
     );
 
+    // Only chain the vulkan 1.2 features if we are enabling any of them, because older devices don't know about them
+    vk::PhysicalDeviceVulkan12Features chainedPhysicalDeviceVulkan12Features = enabledPhysicalDeviceVulkan12Features;
+    chainedPhysicalDeviceVulkan12Features.pNext = nullptr;
+    if (chainedPhysicalDeviceVulkan12Features.drawIndirectCount) {
+        logicalDeviceCreateInfo.pNext = &chainedPhysicalDeviceVulkan12Features;
+    }
+
     vk::UniqueDevice uniqueLogicalDevice = physicalDevice.createDeviceUnique(logicalDeviceCreateInfo);
 
     if (!uniqueLogicalDevice) {
@@ -177,6 +254,74 @@ quartz::rendering::Device::createVulkanLogicalDevicePtr(
     return uniqueLogicalDevice;
 }
 
+std::vector<char>
+quartz::rendering::Device::readValidPipelineCacheData(
+    const vk::PhysicalDevice& physicalDevice,
+    const std::string& filepath
+) {
+    LOG_FUNCTION_SCOPE_TRACE(DEVICE, "{}", filepath);
+
+    if (!util::FileSystem::fileExists(filepath)) {
+        LOG_INFO(DEVICE, "No pipeline cache file at {}, starting with an empty pipeline cache", filepath);
+        return {};
+    }
+
+    std::vector<char> data = util::FileSystem::readBytesFromFile(filepath);
+
+    /**
+     * @brief The header (version one) every implementation starts its cache data with:
+     *   uint32_t headerSize, uint32_t headerVersion, uint32_t vendorID, uint32_t deviceID, uint8_t pipelineCacheUUID[VK_UUID_SIZE]
+     */
+    constexpr uint32_t headerSizeBytes = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (data.size() < headerSizeBytes) {
+        LOG_WARNING(DEVICE, "Pipeline cache file is only {} bytes, ignoring it", data.size());
+        return {};
+    }
+
+    uint32_t headerFields[4];
+    std::memcpy(headerFields, data.data(), sizeof(headerFields));
+    const char* p_pipelineCacheUUID = data.data() + sizeof(headerFields);
+
+    const vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+
+    if (
+        headerFields[0] < headerSizeBytes ||
+        headerFields[1] != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne) ||
+        headerFields[2] != properties.vendorID ||
+        headerFields[3] != properties.deviceID ||
+        !std::equal(p_pipelineCacheUUID, p_pipelineCacheUUID + VK_UUID_SIZE, reinterpret_cast<const char*>(properties.pipelineCacheUUID.data()))
+    ) {
+        LOG_INFO(DEVICE, "Pipeline cache file was written by a different device or driver, starting with an empty pipeline cache");
+        return {};
+    }
+
+    LOG_INFO(DEVICE, "Loaded {} bytes of pipeline cache data", data.size());
+
+    return data;
+}
+
+vk::UniquePipelineCache
+quartz::rendering::Device::createVulkanPipelineCachePtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const std::vector<char>& initialData
+) {
+    LOG_FUNCTION_SCOPE_TRACE(DEVICE, "{} bytes of initial data", initialData.size());
+
+    vk::PipelineCacheCreateInfo pipelineCacheCreateInfo(
+        {},
+        initialData.size(),
+        initialData.data()
+    );
+
+    vk::UniquePipelineCache p_pipelineCache = p_logicalDevice->createPipelineCacheUnique(pipelineCacheCreateInfo);
+
+    if (!p_pipelineCache) {
+        LOG_THROW(DEVICE, util::VulkanCreationFailedError, "Failed to create vk::PipelineCache");
+    }
+
+    return p_pipelineCache;
+}
+
 quartz::rendering::Device::Device(
     const quartz::rendering::Instance& renderingInstance
 ) :
@@ -185,6 +330,7 @@ quartz::rendering::Device::Device(
             renderingInstance.getVulkanInstancePtr()
         )
     ),
+    m_vulkanPhysicalDeviceLimits(m_vulkanPhysicalDevice.getProperties().limits),
     m_graphicsQueueFamilyIndex(
         quartz::rendering::Device::getGraphicsQueueFamilyIndex(
             m_vulkanPhysicalDevice
@@ -195,12 +341,31 @@ quartz::rendering::Device::Device(
             m_vulkanPhysicalDevice
         )
     ),
+    m_isMemoryBudgetSupported(
+        std::find_if(
+            m_physicalDeviceExtensionNames.begin(),
+            m_physicalDeviceExtensionNames.end(),
+            [](const char* extensionName) { return std::string(extensionName) == std::string(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME); }
+        ) != m_physicalDeviceExtensionNames.end()
+    ),
+    m_vulkanEnabledPhysicalDeviceFeatures(
+        quartz::rendering::Device::getEnabledPhysicalDeviceFeatures(
+            m_vulkanPhysicalDevice
+        )
+    ),
+    m_vulkanEnabledPhysicalDeviceVulkan12Features(
+        quartz::rendering::Device::getEnabledPhysicalDeviceVulkan12Features(
+            m_vulkanPhysicalDevice
+        )
+    ),
     mp_vulkanLogicalDevice(
         quartz::rendering::Device::createVulkanLogicalDevicePtr(
             m_vulkanPhysicalDevice,
             m_graphicsQueueFamilyIndex,
             renderingInstance.getValidationLayerNames(),
-            m_physicalDeviceExtensionNames
+            m_physicalDeviceExtensionNames,
+            m_vulkanEnabledPhysicalDeviceFeatures,
+            m_vulkanEnabledPhysicalDeviceVulkan12Features
         )
     ),
     m_vulkanGraphicsQueue(mp_vulkanLogicalDevice->getQueue(
@@ -210,11 +375,53 @@ quartz::rendering::Device::Device(
     m_vulkanPresentQueue(mp_vulkanLogicalDevice->getQueue(
         m_graphicsQueueFamilyIndex,
         0
-    ))
+    )),
+    m_pipelineCacheFilepath(
+        util::FileSystem::getAbsoluteFilepathInBinaryDirectory(
+            quartz::rendering::Device::pipelineCacheFilename
+        )
+    ),
+    mp_vulkanPipelineCache(
+        quartz::rendering::Device::createVulkanPipelineCachePtr(
+            mp_vulkanLogicalDevice,
+            quartz::rendering::Device::readValidPipelineCacheData(
+                m_vulkanPhysicalDevice,
+                m_pipelineCacheFilepath
+            )
+        )
+    ),
+    mp_memoryAllocator(
+        std::make_unique<quartz::rendering::MemoryAllocator>(
+            m_vulkanPhysicalDevice,
+            m_vulkanPhysicalDeviceLimits,
+            mp_vulkanLogicalDevice,
+            m_isMemoryBudgetSupported
+        )
+    )
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
 
 quartz::rendering::Device::~Device() {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    try {
+        this->writePipelineCacheToFile();
+    } catch (const std::exception& e) {
+        LOG_ERRORthis("Failed to write the pipeline cache to {}: {}", m_pipelineCacheFilepath, e.what());
+    }
+}
+
+void
+quartz::rendering::Device::writePipelineCacheToFile() const {
+    LOG_FUNCTION_SCOPE_TRACEthis("{}", m_pipelineCacheFilepath);
+
+    const std::vector<uint8_t> data = mp_vulkanLogicalDevice->getPipelineCacheData(*mp_vulkanPipelineCache);
+
+    util::FileSystem::writeBytesToFile(
+        m_pipelineCacheFilepath,
+        std::vector<char>(data.begin(), data.end())
+    );
+
+    LOG_INFOthis("Wrote {} bytes of pipeline cache data to {}", data.size(), m_pipelineCacheFilepath);
 }
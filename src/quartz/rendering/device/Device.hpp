@@ -1,8 +1,13 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <vulkan/vulkan.hpp>
 
 #include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
 #include "quartz/rendering/instance/Instance.hpp"
 
 namespace quartz {
@@ -19,13 +24,28 @@ public: // member functions
     USE_LOGGER(DEVICE);
 
     const vk::PhysicalDevice& getVulkanPhysicalDevice() const { return m_vulkanPhysicalDevice; }
+    const vk::PhysicalDeviceLimits& getVulkanPhysicalDeviceLimits() const { return m_vulkanPhysicalDeviceLimits; }
+    const vk::PhysicalDeviceFeatures& getVulkanEnabledPhysicalDeviceFeatures() const { return m_vulkanEnabledPhysicalDeviceFeatures; }
+    const vk::PhysicalDeviceVulkan12Features& getVulkanEnabledPhysicalDeviceVulkan12Features() const { return m_vulkanEnabledPhysicalDeviceVulkan12Features; }
     uint32_t getGraphicsQueueFamilyIndex() const { return m_graphicsQueueFamilyIndex; }
     const vk::UniqueDevice& getVulkanLogicalDevicePtr() const { return mp_vulkanLogicalDevice; }
     const vk::Queue& getVulkanGraphicsQueue() const { return m_vulkanGraphicsQueue; }
     const vk::Queue& getVulkanPresentQueue() const { return m_vulkanPresentQueue; }
+    const vk::UniquePipelineCache& getVulkanPipelineCachePtr() const { return mp_vulkanPipelineCache; }
+    bool getIsMemoryBudgetSupported() const { return m_isMemoryBudgetSupported; }
+    quartz::rendering::MemoryAllocator& getMemoryAllocator() const { return *mp_memoryAllocator; }
 
     void waitIdle() const { mp_vulkanLogicalDevice->waitIdle(); }
 
+    /**
+     * @brief Write everything the pipeline cache has learned back to the cache file. This happens when the
+     *   device is destroyed, but can be done earlier so a crash doesn't lose it
+     */
+    void writePipelineCacheToFile() const;
+
+public: // static variables
+    static constexpr const char* pipelineCacheFilename = "pipeline_cache.bin"; // in the binary directory
+
 private: // static functions
     static vk::PhysicalDevice getBestPhysicalDevice(
         const vk::UniqueInstance& p_instance
@@ -39,18 +59,64 @@ private: // static functions
         const vk::PhysicalDevice& physicalDevice
     );
 
+    static vk::PhysicalDeviceFeatures getEnabledPhysicalDeviceFeatures(
+        const vk::PhysicalDevice& physicalDevice
+    );
+
+    static vk::PhysicalDeviceVulkan12Features getEnabledPhysicalDeviceVulkan12Features(
+        const vk::PhysicalDevice& physicalDevice
+    );
+
     static vk::UniqueDevice createVulkanLogicalDevicePtr(
         const vk::PhysicalDevice& physicalDevice,
         const uint32_t graphicsQueueFamilyIndex,
         const std::vector<const char*>& validationLayerNames,
-        const std::vector<const char*>& physicalDeviceExtensionNames
+        const std::vector<const char*>& physicalDeviceExtensionNames,
+        const vk::PhysicalDeviceFeatures& enabledPhysicalDeviceFeatures,
+        const vk::PhysicalDeviceVulkan12Features& enabledPhysicalDeviceVulkan12Features
+    );
+
+    /**
+     * @brief Empty if there is no cache file, or if the file was written by a different device or driver
+     *   (checked against the vendor id, device id and pipeline cache uuid in the file's header)
+     */
+    static std::vector<char> readValidPipelineCacheData(
+        const vk::PhysicalDevice& physicalDevice,
+        const std::string& filepath
+    );
+
+    static vk::UniquePipelineCache createVulkanPipelineCachePtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const std::vector<char>& initialData
     );
 
 private: // member variables
     vk::PhysicalDevice m_vulkanPhysicalDevice;
+
+    /**
+     * @brief Queried once up front because vkGetPhysicalDeviceProperties copies out the entire (large)
+     *   properties struct every time it is called
+     */
+    const vk::PhysicalDeviceLimits m_vulkanPhysicalDeviceLimits;
     const uint32_t m_graphicsQueueFamilyIndex;
     const std::vector<const char*> m_physicalDeviceExtensionNames;
+    const bool m_isMemoryBudgetSupported; // VK_EXT_memory_budget is optional
+    const vk::PhysicalDeviceFeatures m_vulkanEnabledPhysicalDeviceFeatures;
+    const vk::PhysicalDeviceVulkan12Features m_vulkanEnabledPhysicalDeviceVulkan12Features;
     vk::UniqueDevice mp_vulkanLogicalDevice;
     vk::Queue m_vulkanGraphicsQueue;
     vk::Queue m_vulkanPresentQueue;
+
+    /**
+     * @brief Shared by the creation of every graphics and compute pipeline, so pipelines compiled by an
+     *   earlier run (or earlier in this run) don't have to be compiled again
+     */
+    const std::string m_pipelineCacheFilepath;
+    vk::UniquePipelineCache mp_vulkanPipelineCache;
+
+    /**
+     * @brief Everything which allocates device memory only has a const reference to the device, so the
+     *   allocator lives behind a pointer. Declared after the logical device so it is destroyed first
+     */
+    std::unique_ptr<quartz::rendering::MemoryAllocator> mp_memoryAllocator;
 };
\ No newline at end of file
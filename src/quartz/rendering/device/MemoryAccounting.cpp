@@ -0,0 +1,176 @@
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
+
+std::vector<std::string> quartz::rendering::MemoryAccounting::assetNameStack;
+std::map<std::string, quartz::rendering::MemoryAccounting::AssetUsage> quartz::rendering::MemoryAccounting::assetUsages;
+
+quartz::rendering::MemoryAccounting::AssetScope::AssetScope(
+    const std::string& assetName
+) {
+    quartz::rendering::MemoryAccounting::assetNameStack.push_back(assetName);
+}
+
+quartz::rendering::MemoryAccounting::AssetScope::~AssetScope() {
+    quartz::rendering::MemoryAccounting::assetNameStack.pop_back();
+}
+
+quartz::rendering::MemoryAccounting::HostAllocation::HostAllocation() :
+    m_assetName(),
+    m_sizeBytes(0)
+{}
+
+quartz::rendering::MemoryAccounting::HostAllocation::HostAllocation(
+    const std::size_t sizeBytes
+) :
+    m_assetName(quartz::rendering::MemoryAccounting::getCurrentAssetName()),
+    m_sizeBytes(sizeBytes)
+{
+    if (m_sizeBytes == 0) {
+        return;
+    }
+
+    quartz::rendering::MemoryAccounting::getAssetUsage(m_assetName).hostBytes += m_sizeBytes;
+}
+
+quartz::rendering::MemoryAccounting::HostAllocation::HostAllocation(
+    quartz::rendering::MemoryAccounting::HostAllocation&& other
+) :
+    m_assetName(std::move(other.m_assetName)),
+    m_sizeBytes(other.m_sizeBytes)
+{
+    other.m_sizeBytes = 0;
+}
+
+quartz::rendering::MemoryAccounting::HostAllocation::~HostAllocation() {
+    this->reset();
+}
+
+quartz::rendering::MemoryAccounting::HostAllocation&
+quartz::rendering::MemoryAccounting::HostAllocation::operator=(
+    quartz::rendering::MemoryAccounting::HostAllocation&& other
+) {
+    if (this == &other) {
+        return *this;
+    }
+
+    this->reset();
+
+    m_assetName = std::move(other.m_assetName);
+    m_sizeBytes = other.m_sizeBytes;
+    other.m_sizeBytes = 0;
+
+    return *this;
+}
+
+void
+quartz::rendering::MemoryAccounting::HostAllocation::reset() {
+    if (m_sizeBytes == 0) {
+        return;
+    }
+
+    quartz::rendering::MemoryAccounting::getAssetUsage(m_assetName).hostBytes -= m_sizeBytes;
+    quartz::rendering::MemoryAccounting::eraseAssetUsageIfEmpty(m_assetName);
+
+    m_sizeBytes = 0;
+}
+
+quartz::rendering::MemoryAccounting::AssetUsage&
+quartz::rendering::MemoryAccounting::getAssetUsage(
+    const std::string& assetName
+) {
+    // Value initialized, so a new entry starts with everything at 0
+    return quartz::rendering::MemoryAccounting::assetUsages[assetName];
+}
+
+void
+quartz::rendering::MemoryAccounting::eraseAssetUsageIfEmpty(
+    const std::string& assetName
+) {
+    const std::map<std::string, quartz::rendering::MemoryAccounting::AssetUsage>::iterator it = quartz::rendering::MemoryAccounting::assetUsages.find(assetName);
+    if (it == quartz::rendering::MemoryAccounting::assetUsages.end()) {
+        return;
+    }
+
+    const quartz::rendering::MemoryAccounting::AssetUsage& assetUsage = it->second;
+    if (
+        assetUsage.deviceBytes == 0 &&
+        assetUsage.deviceAllocationCount == 0 &&
+        assetUsage.geometryPoolBytes == 0 &&
+        assetUsage.hostBytes == 0
+    ) {
+        quartz::rendering::MemoryAccounting::assetUsages.erase(it);
+    }
+}
+
+const std::string&
+quartz::rendering::MemoryAccounting::getCurrentAssetName() {
+    static const std::string unassignedAssetNameString = quartz::rendering::MemoryAccounting::unassignedAssetName;
+
+    if (quartz::rendering::MemoryAccounting::assetNameStack.empty()) {
+        return unassignedAssetNameString;
+    }
+
+    return quartz::rendering::MemoryAccounting::assetNameStack.back();
+}
+
+void
+quartz::rendering::MemoryAccounting::recordDeviceAllocation(
+    const std::string& assetName,
+    const vk::DeviceSize sizeBytes
+) {
+    quartz::rendering::MemoryAccounting::AssetUsage& assetUsage = quartz::rendering::MemoryAccounting::getAssetUsage(assetName);
+    assetUsage.deviceBytes += sizeBytes;
+    ++assetUsage.deviceAllocationCount;
+}
+
+void
+quartz::rendering::MemoryAccounting::recordDeviceFree(
+    const std::string& assetName,
+    const vk::DeviceSize sizeBytes
+) {
+    quartz::rendering::MemoryAccounting::AssetUsage& assetUsage = quartz::rendering::MemoryAccounting::getAssetUsage(assetName);
+    assetUsage.deviceBytes -= sizeBytes;
+    --assetUsage.deviceAllocationCount;
+
+    quartz::rendering::MemoryAccounting::eraseAssetUsageIfEmpty(assetName);
+}
+
+void
+quartz::rendering::MemoryAccounting::recordGeometryPoolAllocation(
+    const vk::DeviceSize sizeBytes
+) {
+    quartz::rendering::MemoryAccounting::getAssetUsage(
+        quartz::rendering::MemoryAccounting::getCurrentAssetName()
+    ).geometryPoolBytes += sizeBytes;
+}
+
+void
+quartz::rendering::MemoryAccounting::clearGeometryPoolAllocations() {
+    LOG_FUNCTION_SCOPE_TRACE(MEMORY, "");
+
+    for (auto it = quartz::rendering::MemoryAccounting::assetUsages.begin(); it != quartz::rendering::MemoryAccounting::assetUsages.end();) {
+        it->second.geometryPoolBytes = 0;
+
+        const std::string assetName = it->first;
+        ++it;
+        quartz::rendering::MemoryAccounting::eraseAssetUsageIfEmpty(assetName);
+    }
+}
+
+void
+quartz::rendering::MemoryAccounting::logAssetUsages() {
+    LOG_INFO(MEMORY, "Memory used by {} assets:", quartz::rendering::MemoryAccounting::assetUsages.size());
+
+    for (const std::pair<const std::string, quartz::rendering::MemoryAccounting::AssetUsage>& entry : quartz::rendering::MemoryAccounting::assetUsages) {
+        const quartz::rendering::MemoryAccounting::AssetUsage& assetUsage = entry.second;
+        LOG_INFO(MEMORY, "  - {} : {} device bytes ( {} allocations ), {} geometry pool bytes, {} host bytes", entry.first, assetUsage.deviceBytes, assetUsage.deviceAllocationCount, assetUsage.geometryPoolBytes, assetUsage.hostBytes);
+    }
+}
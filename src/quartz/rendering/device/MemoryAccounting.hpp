@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+
+namespace quartz {
+namespace rendering {
+    class MemoryAccounting;
+}
+}
+
+/**
+ * @brief Keeps track of how much memory each asset (a model, a texture, a pipeline, ...) is holding on to,
+ *   so content can be planned against real numbers. Device memory handed out by the memory allocator is
+ *   charged to whichever asset scope is innermost when it is allocated, and given back when it is freed.
+ *   Host memory is charged the same way by holding a HostAllocation next to the container it accounts for.
+ *
+ * @brief Geometry lives in shared geometry pool blocks, which are charged to the geometry pool itself.
+ *   Each asset's share of those blocks is tracked separately so it isn't counted twice.
+ */
+class quartz::rendering::MemoryAccounting {
+public: // classes
+    /**
+     * @brief Everything allocated while this is alive is charged to the asset, unless a scope opened
+     *   inside of it names another asset
+     */
+    class AssetScope {
+    public: // member functions
+        AssetScope(const std::string& assetName);
+        AssetScope(const AssetScope& other) = delete;
+        ~AssetScope();
+
+        AssetScope& operator=(const AssetScope& other) = delete;
+    };
+
+    /**
+     * @brief Charges sizeBytes of host memory to the asset whose scope is current when it is created, for
+     *   as long as it is alive
+     */
+    class HostAllocation {
+    public: // member functions
+        HostAllocation();
+        HostAllocation(const std::size_t sizeBytes);
+        HostAllocation(HostAllocation&& other);
+        ~HostAllocation();
+
+        HostAllocation& operator=(HostAllocation&& other);
+
+        std::size_t getSizeBytes() const { return m_sizeBytes; }
+
+        void reset();
+
+    private: // member variables
+        std::string m_assetName;
+        std::size_t m_sizeBytes;
+    };
+
+    struct AssetUsage {
+    public: // member variables
+        vk::DeviceSize deviceBytes;
+        uint32_t deviceAllocationCount;
+        vk::DeviceSize geometryPoolBytes; // this asset's share of the geometry pool's blocks
+        std::size_t hostBytes;
+    };
+
+public: // member functions
+    MemoryAccounting() = delete;
+
+public: // static variables
+    static constexpr const char* unassignedAssetName = "unassigned"; // charged when no scope is open
+    static constexpr const char* geometryPoolAssetName = "geometry pool";
+
+public: // static functions
+    static const std::string& getCurrentAssetName();
+    static const std::map<std::string, quartz::rendering::MemoryAccounting::AssetUsage>& getAssetUsages() { return quartz::rendering::MemoryAccounting::assetUsages; }
+
+    static void recordDeviceAllocation(
+        const std::string& assetName,
+        const vk::DeviceSize sizeBytes
+    );
+    static void recordDeviceFree(
+        const std::string& assetName,
+        const vk::DeviceSize sizeBytes
+    );
+
+    /**
+     * @brief Geometry pool ranges are never given back on their own, only all at once when the pool's
+     *   blocks are cleaned up
+     */
+    static void recordGeometryPoolAllocation(const vk::DeviceSize sizeBytes);
+    static void clearGeometryPoolAllocations();
+
+    static void logAssetUsages();
+
+private: // static functions
+    static quartz::rendering::MemoryAccounting::AssetUsage& getAssetUsage(const std::string& assetName);
+    static void eraseAssetUsageIfEmpty(const std::string& assetName);
+
+private: // static variables
+    static std::vector<std::string> assetNameStack;
+    static std::map<std::string, quartz::rendering::MemoryAccounting::AssetUsage> assetUsages;
+};
\ No newline at end of file
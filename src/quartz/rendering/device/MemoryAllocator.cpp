@@ -0,0 +1,714 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "util/file_system/FileSystem.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
+#include "quartz/rendering/device/MemoryAllocator.hpp"
+
+quartz::rendering::MemoryAllocator::Allocation::Allocation() :
+    mp_allocator(nullptr),
+    mp_block(nullptr),
+    m_vulkanDeviceMemory(),
+    m_offsetBytes(0),
+    m_sizeBytes(0),
+    m_order(0),
+    m_vulkanMemoryPropertyFlags(),
+    mp_mappedLocalMemory(nullptr),
+    m_assetName()
+{}
+
+quartz::rendering::MemoryAllocator::Allocation::Allocation(
+    quartz::rendering::MemoryAllocator& allocator,
+    quartz::rendering::MemoryAllocator::Block& block,
+    const vk::DeviceSize offsetBytes,
+    const vk::DeviceSize sizeBytes,
+    const uint32_t order
+) :
+    mp_allocator(&allocator),
+    mp_block(&block),
+    m_vulkanDeviceMemory(*block.p_vulkanDeviceMemory),
+    m_offsetBytes(offsetBytes),
+    m_sizeBytes(sizeBytes),
+    m_order(order),
+    m_vulkanMemoryPropertyFlags(allocator.m_vulkanMemoryProperties.memoryTypes[block.memoryTypeIndex].propertyFlags),
+    mp_mappedLocalMemory(
+        block.p_mappedLocalMemory ?
+            static_cast<char*>(block.p_mappedLocalMemory) + offsetBytes :
+            nullptr
+    ),
+    m_assetName(quartz::rendering::MemoryAccounting::getCurrentAssetName())
+{
+    quartz::rendering::MemoryAccounting::recordDeviceAllocation(m_assetName, m_sizeBytes);
+}
+
+quartz::rendering::MemoryAllocator::Allocation::Allocation(
+    quartz::rendering::MemoryAllocator::Allocation&& other
+) :
+    mp_allocator(other.mp_allocator),
+    mp_block(other.mp_block),
+    m_vulkanDeviceMemory(other.m_vulkanDeviceMemory),
+    m_offsetBytes(other.m_offsetBytes),
+    m_sizeBytes(other.m_sizeBytes),
+    m_order(other.m_order),
+    m_vulkanMemoryPropertyFlags(other.m_vulkanMemoryPropertyFlags),
+    mp_mappedLocalMemory(other.mp_mappedLocalMemory),
+    m_assetName(std::move(other.m_assetName))
+{
+    other.mp_allocator = nullptr;
+    other.reset();
+}
+
+quartz::rendering::MemoryAllocator::Allocation::~Allocation() {
+    this->reset();
+}
+
+quartz::rendering::MemoryAllocator::Allocation&
+quartz::rendering::MemoryAllocator::Allocation::operator=(
+    quartz::rendering::MemoryAllocator::Allocation&& other
+) {
+    if (this == &other) {
+        return *this;
+    }
+
+    this->reset();
+
+    mp_allocator = other.mp_allocator;
+    mp_block = other.mp_block;
+    m_vulkanDeviceMemory = other.m_vulkanDeviceMemory;
+    m_offsetBytes = other.m_offsetBytes;
+    m_sizeBytes = other.m_sizeBytes;
+    m_order = other.m_order;
+    m_vulkanMemoryPropertyFlags = other.m_vulkanMemoryPropertyFlags;
+    mp_mappedLocalMemory = other.mp_mappedLocalMemory;
+    m_assetName = std::move(other.m_assetName);
+
+    other.mp_allocator = nullptr;
+    other.reset();
+
+    return *this;
+}
+
+bool
+quartz::rendering::MemoryAllocator::Allocation::getIsDedicated() const {
+    return mp_block && mp_block->isDedicated;
+}
+
+void
+quartz::rendering::MemoryAllocator::Allocation::reset() {
+    if (mp_allocator) {
+        mp_allocator->free(*mp_block, m_offsetBytes, m_sizeBytes, m_order);
+        quartz::rendering::MemoryAccounting::recordDeviceFree(m_assetName, m_sizeBytes);
+    }
+
+    mp_allocator = nullptr;
+    mp_block = nullptr;
+    m_vulkanDeviceMemory = vk::DeviceMemory();
+    m_offsetBytes = 0;
+    m_sizeBytes = 0;
+    m_order = 0;
+    m_vulkanMemoryPropertyFlags = vk::MemoryPropertyFlags();
+    mp_mappedLocalMemory = nullptr;
+    m_assetName.clear();
+}
+
+std::string
+quartz::rendering::MemoryAllocator::escapeJsonString(
+    const std::string& string
+) {
+    std::string escapedString;
+    escapedString.reserve(string.size());
+
+    for (const char character : string) {
+        if (character == '"' || character == '\\') {
+            escapedString += '\\';
+            escapedString += character;
+        } else if (static_cast<unsigned char>(character) < 0x20) {
+            escapedString += fmt::format("\\u{:04x}", static_cast<uint32_t>(character));
+        } else {
+            escapedString += character;
+        }
+    }
+
+    return escapedString;
+}
+
+uint32_t
+quartz::rendering::MemoryAllocator::calculateOrder(
+    const vk::DeviceSize sizeBytes
+) {
+    uint32_t order = 0;
+    vk::DeviceSize nodeSizeBytes = quartz::rendering::MemoryAllocator::minNodeSizeBytes;
+
+    while (nodeSizeBytes < sizeBytes) {
+        nodeSizeBytes <<= 1;
+        ++order;
+    }
+
+    return order;
+}
+
+vk::DeviceSize
+quartz::rendering::MemoryAllocator::calculateBlockSizeBytes(
+    const vk::PhysicalDeviceMemoryProperties& memoryProperties,
+    const uint32_t memoryTypeIndex
+) {
+    const vk::DeviceSize heapSizeBytes = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+
+    if (heapSizeBytes > quartz::rendering::MemoryAllocator::smallHeapSizeBytes) {
+        return quartz::rendering::MemoryAllocator::defaultBlockSizeBytes;
+    }
+
+    // Small heaps (such as the 256 MiB of device local host visible memory without resizable BAR) would
+    // be used up by a handful of default sized blocks, so use an eighth of the heap instead
+    vk::DeviceSize blockSizeBytes = quartz::rendering::MemoryAllocator::minNodeSizeBytes;
+    while (blockSizeBytes * 2 <= heapSizeBytes / 8) {
+        blockSizeBytes *= 2;
+    }
+
+    return std::min(blockSizeBytes, quartz::rendering::MemoryAllocator::defaultBlockSizeBytes);
+}
+
+std::optional<vk::DeviceSize>
+quartz::rendering::MemoryAllocator::allocateNode(
+    quartz::rendering::MemoryAllocator::Block& block,
+    const uint32_t order
+) {
+    // Find the smallest free node which is large enough
+    uint32_t freeOrder = order;
+    while (freeOrder <= block.maxOrder && block.freeOffsetsByOrder[freeOrder].empty()) {
+        ++freeOrder;
+    }
+
+    if (freeOrder > block.maxOrder) {
+        return std::nullopt;
+    }
+
+    const vk::DeviceSize offsetBytes = *block.freeOffsetsByOrder[freeOrder].begin();
+    block.freeOffsetsByOrder[freeOrder].erase(block.freeOffsetsByOrder[freeOrder].begin());
+
+    // Split it in half until it is the size we want, freeing the upper half each time
+    while (freeOrder > order) {
+        --freeOrder;
+        block.freeOffsetsByOrder[freeOrder].insert(offsetBytes + (quartz::rendering::MemoryAllocator::minNodeSizeBytes << freeOrder));
+    }
+
+    return offsetBytes;
+}
+
+void
+quartz::rendering::MemoryAllocator::freeNode(
+    quartz::rendering::MemoryAllocator::Block& block,
+    const vk::DeviceSize offsetBytes,
+    const uint32_t order
+) {
+    vk::DeviceSize mergedOffsetBytes = offsetBytes;
+    uint32_t mergedOrder = order;
+
+    // Merge with our buddy for as long as it is free too
+    while (mergedOrder < block.maxOrder) {
+        const vk::DeviceSize buddyOffsetBytes = mergedOffsetBytes ^ (quartz::rendering::MemoryAllocator::minNodeSizeBytes << mergedOrder);
+
+        std::set<vk::DeviceSize>& freeOffsets = block.freeOffsetsByOrder[mergedOrder];
+        const std::set<vk::DeviceSize>::iterator buddyIterator = freeOffsets.find(buddyOffsetBytes);
+        if (buddyIterator == freeOffsets.end()) {
+            break;
+        }
+
+        freeOffsets.erase(buddyIterator);
+        mergedOffsetBytes = std::min(mergedOffsetBytes, buddyOffsetBytes);
+        ++mergedOrder;
+    }
+
+    block.freeOffsetsByOrder[mergedOrder].insert(mergedOffsetBytes);
+}
+
+std::vector<uint32_t>
+quartz::rendering::MemoryAllocator::getCandidateMemoryTypeIndices(
+    const uint32_t memoryTypeBits,
+    const vk::MemoryPropertyFlags requiredMemoryProperties,
+    const vk::MemoryPropertyFlags preferredMemoryProperties
+) const {
+    std::vector<uint32_t> preferredMemoryTypeIndices;
+    std::vector<uint32_t> otherMemoryTypeIndices;
+
+    for (uint32_t i = 0; i < m_vulkanMemoryProperties.memoryTypeCount; ++i) {
+        const vk::MemoryPropertyFlags propertyFlags = m_vulkanMemoryProperties.memoryTypes[i].propertyFlags;
+
+        if (
+            !(memoryTypeBits & (1 << i)) ||
+            (propertyFlags & requiredMemoryProperties) != requiredMemoryProperties
+        ) {
+            continue;
+        }
+
+        if ((propertyFlags & preferredMemoryProperties) == preferredMemoryProperties) {
+            preferredMemoryTypeIndices.push_back(i);
+        } else {
+            otherMemoryTypeIndices.push_back(i);
+        }
+    }
+
+    preferredMemoryTypeIndices.insert(
+        preferredMemoryTypeIndices.end(),
+        otherMemoryTypeIndices.begin(),
+        otherMemoryTypeIndices.end()
+    );
+
+    return preferredMemoryTypeIndices;
+}
+
+void
+quartz::rendering::MemoryAllocator::warnIfOverBudget(
+    const uint32_t memoryTypeIndex,
+    const vk::DeviceSize sizeBytes
+) const {
+    if (!m_isMemoryBudgetSupported) {
+        return;
+    }
+
+    const uint32_t heapIndex = m_vulkanMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    const quartz::rendering::MemoryAllocator::HeapUsage heapUsage = this->getHeapUsages()[heapIndex];
+
+    if (heapUsage.driverUsageBytes + sizeBytes > heapUsage.budgetBytes) {
+        LOG_WARNINGthis("Allocating {} bytes from heap {} goes over its budget ( {} of {} bytes already used )", sizeBytes, heapIndex, heapUsage.driverUsageBytes, heapUsage.budgetBytes);
+    }
+}
+
+std::unique_ptr<quartz::rendering::MemoryAllocator::Block>
+quartz::rendering::MemoryAllocator::createBlock(
+    const uint32_t memoryTypeIndex,
+    const bool isLinear,
+    const bool isDedicated,
+    const vk::DeviceSize sizeBytes
+) {
+    LOG_FUNCTION_SCOPE_TRACEthis("memory type {}, {} bytes, linear = {}, dedicated = {}", memoryTypeIndex, sizeBytes, isLinear, isDedicated);
+
+    this->warnIfOverBudget(memoryTypeIndex, sizeBytes);
+
+    vk::MemoryAllocateInfo memoryAllocateInfo(
+        sizeBytes,
+        memoryTypeIndex
+    );
+
+    vk::UniqueDeviceMemory p_vulkanDeviceMemory = m_vulkanLogicalDevice.allocateMemoryUnique(memoryAllocateInfo);
+
+    if (!p_vulkanDeviceMemory) {
+        LOG_THROWthis(util::VulkanCreationFailedError, "Failed to allocate {} bytes of vk::DeviceMemory", sizeBytes);
+    }
+
+    ++m_vulkanAllocationCount;
+    if (m_vulkanAllocationCount > m_maxVulkanAllocationCount) {
+        LOG_WARNINGthis("{} vulkan allocations are alive, the device only guarantees {}", m_vulkanAllocationCount, m_maxVulkanAllocationCount);
+    }
+
+    void* p_mappedLocalMemory = nullptr;
+    if (m_vulkanMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+        p_mappedLocalMemory = m_vulkanLogicalDevice.mapMemory(
+            *p_vulkanDeviceMemory,
+            0,
+            VK_WHOLE_SIZE
+        );
+
+        if (!p_mappedLocalMemory) {
+            LOG_THROWthis(util::VulkanCreationFailedError, "Failed to map vk::DeviceMemory to local memory");
+        }
+    }
+
+    std::unique_ptr<quartz::rendering::MemoryAllocator::Block> p_block = std::make_unique<quartz::rendering::MemoryAllocator::Block>();
+    p_block->memoryTypeIndex = memoryTypeIndex;
+    p_block->isLinear = isLinear;
+    p_block->isDedicated = isDedicated;
+    p_block->sizeBytes = sizeBytes;
+    p_block->maxOrder = quartz::rendering::MemoryAllocator::calculateOrder(sizeBytes);
+    p_block->p_vulkanDeviceMemory = std::move(p_vulkanDeviceMemory);
+    p_block->p_mappedLocalMemory = p_mappedLocalMemory;
+    p_block->allocationCount = 0;
+    p_block->allocatedBytes = 0;
+
+    if (!isDedicated) {
+        p_block->freeOffsetsByOrder.resize(p_block->maxOrder + 1);
+        p_block->freeOffsetsByOrder[p_block->maxOrder].insert(0);
+    }
+
+    return p_block;
+}
+
+quartz::rendering::MemoryAllocator::Allocation
+quartz::rendering::MemoryAllocator::allocateFromMemoryType(
+    const uint32_t memoryTypeIndex,
+    const vk::MemoryRequirements& memoryRequirements,
+    const bool isLinear
+) {
+    const vk::MemoryPropertyFlags propertyFlags = m_vulkanMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+
+    vk::DeviceSize sizeBytes = memoryRequirements.size;
+    vk::DeviceSize alignmentBytes = std::max<vk::DeviceSize>(memoryRequirements.alignment, 1);
+
+    // Ranges of non coherent memory are flushed in whole atoms, so keep allocations from sharing any
+    if (
+        (propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) &&
+        !(propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent)
+    ) {
+        alignmentBytes = std::max(alignmentBytes, m_nonCoherentAtomSizeBytes);
+        sizeBytes = (sizeBytes + m_nonCoherentAtomSizeBytes - 1) / m_nonCoherentAtomSizeBytes * m_nonCoherentAtomSizeBytes;
+    }
+
+    const vk::DeviceSize blockSizeBytes = quartz::rendering::MemoryAllocator::calculateBlockSizeBytes(
+        m_vulkanMemoryProperties,
+        memoryTypeIndex
+    );
+
+    if (std::max(sizeBytes, alignmentBytes) > blockSizeBytes / 2) {
+        LOG_TRACEthis("Using a dedicated allocation for {} bytes from memory type {}", sizeBytes, memoryTypeIndex);
+
+        m_dedicatedBlockPtrs.push_back(
+            this->createBlock(memoryTypeIndex, isLinear, true, sizeBytes)
+        );
+        quartz::rendering::MemoryAllocator::Block& block = *m_dedicatedBlockPtrs.back();
+        block.allocationCount = 1;
+        block.allocatedBytes = sizeBytes;
+
+        return quartz::rendering::MemoryAllocator::Allocation(*this, block, 0, sizeBytes, 0);
+    }
+
+    const uint32_t order = quartz::rendering::MemoryAllocator::calculateOrder(
+        std::max(sizeBytes, alignmentBytes)
+    );
+
+    std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>>& blockPtrs = m_blockPtrsByPool[memoryTypeIndex * 2 + isLinear];
+
+    for (std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block : blockPtrs) {
+        const std::optional<vk::DeviceSize> offsetBytes = quartz::rendering::MemoryAllocator::allocateNode(*p_block, order);
+        if (!offsetBytes) {
+            continue;
+        }
+
+        ++p_block->allocationCount;
+        p_block->allocatedBytes += sizeBytes;
+
+        return quartz::rendering::MemoryAllocator::Allocation(*this, *p_block, *offsetBytes, sizeBytes, order);
+    }
+
+    LOG_TRACEthis("No room for {} bytes in the {} blocks of memory type {}, creating another", sizeBytes, blockPtrs.size(), memoryTypeIndex);
+
+    blockPtrs.push_back(
+        this->createBlock(memoryTypeIndex, isLinear, false, blockSizeBytes)
+    );
+    quartz::rendering::MemoryAllocator::Block& block = *blockPtrs.back();
+
+    const vk::DeviceSize offsetBytes = *quartz::rendering::MemoryAllocator::allocateNode(block, order);
+    ++block.allocationCount;
+    block.allocatedBytes += sizeBytes;
+
+    return quartz::rendering::MemoryAllocator::Allocation(*this, block, offsetBytes, sizeBytes, order);
+}
+
+void
+quartz::rendering::MemoryAllocator::free(
+    quartz::rendering::MemoryAllocator::Block& block,
+    const vk::DeviceSize offsetBytes,
+    const vk::DeviceSize sizeBytes,
+    const uint32_t order
+) {
+    --block.allocationCount;
+    block.allocatedBytes -= sizeBytes;
+
+    if (block.isDedicated) {
+        m_dedicatedBlockPtrs.erase(std::find_if(
+            m_dedicatedBlockPtrs.begin(),
+            m_dedicatedBlockPtrs.end(),
+            [&block](const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block) { return p_block.get() == &block; }
+        ));
+        --m_vulkanAllocationCount;
+        return;
+    }
+
+    quartz::rendering::MemoryAllocator::freeNode(block, offsetBytes, order);
+
+    if (block.allocationCount > 0) {
+        return;
+    }
+
+    // Keep the last block of each pool around even when it is empty, so a resource which is recreated
+    // over and over (such as anything sized to the swapchain) doesn't reallocate a block every time
+    std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>>& blockPtrs = m_blockPtrsByPool[block.memoryTypeIndex * 2 + block.isLinear];
+    if (blockPtrs.size() == 1) {
+        return;
+    }
+
+    blockPtrs.erase(std::find_if(
+        blockPtrs.begin(),
+        blockPtrs.end(),
+        [&block](const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block) { return p_block.get() == &block; }
+    ));
+    --m_vulkanAllocationCount;
+}
+
+quartz::rendering::MemoryAllocator::MemoryAllocator(
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::PhysicalDeviceLimits& physicalDeviceLimits,
+    const vk::UniqueDevice& p_logicalDevice,
+    const bool isMemoryBudgetSupported
+) :
+    m_vulkanPhysicalDevice(physicalDevice),
+    m_vulkanLogicalDevice(*p_logicalDevice),
+    m_isMemoryBudgetSupported(isMemoryBudgetSupported),
+    m_vulkanMemoryProperties(physicalDevice.getMemoryProperties()),
+    m_nonCoherentAtomSizeBytes(std::max<vk::DeviceSize>(physicalDeviceLimits.nonCoherentAtomSize, 1)),
+    m_maxVulkanAllocationCount(physicalDeviceLimits.maxMemoryAllocationCount),
+    m_vulkanAllocationCount(0),
+    m_blockPtrsByPool(m_vulkanMemoryProperties.memoryTypeCount * 2),
+    m_dedicatedBlockPtrs()
+{
+    LOG_FUNCTION_CALL_TRACEthis("memory budget supported = {}", m_isMemoryBudgetSupported);
+
+    for (uint32_t i = 0; i < m_vulkanMemoryProperties.memoryTypeCount; ++i) {
+        const vk::MemoryType& memoryType = m_vulkanMemoryProperties.memoryTypes[i];
+        LOG_DEBUGthis("Memory type {} : heap {} ( {} MiB ), {}", i, memoryType.heapIndex, m_vulkanMemoryProperties.memoryHeaps[memoryType.heapIndex].size / (1024 * 1024), vk::to_string(memoryType.propertyFlags));
+    }
+}
+
+quartz::rendering::MemoryAllocator::~MemoryAllocator() {
+    LOG_FUNCTION_CALL_TRACEthis("");
+
+    const quartz::rendering::MemoryAllocator::Statistics statistics = this->getStatistics();
+    if (statistics.allocationCount > 0) {
+        LOG_ERRORthis("{} allocations ( {} bytes ) are still alive while destroying the allocator", statistics.allocationCount, statistics.allocatedBytes);
+    }
+}
+
+quartz::rendering::MemoryAllocator::Allocation
+quartz::rendering::MemoryAllocator::allocate(
+    const vk::MemoryRequirements& memoryRequirements,
+    const vk::MemoryPropertyFlags requiredMemoryProperties,
+    const vk::MemoryPropertyFlags preferredMemoryProperties,
+    const bool isLinear
+) {
+    LOG_FUNCTION_SCOPE_TRACEthis("{} bytes aligned to {}, linear = {}", memoryRequirements.size, memoryRequirements.alignment, isLinear);
+
+    const std::vector<uint32_t> memoryTypeIndices = this->getCandidateMemoryTypeIndices(
+        memoryRequirements.memoryTypeBits,
+        requiredMemoryProperties,
+        preferredMemoryProperties
+    );
+
+    if (memoryTypeIndices.empty()) {
+        LOG_THROWthis(util::VulkanFeatureNotSupportedError, "No memory type has the required properties ( {} )", vk::to_string(requiredMemoryProperties));
+    }
+
+    for (const uint32_t memoryTypeIndex : memoryTypeIndices) {
+        try {
+            return this->allocateFromMemoryType(
+                memoryTypeIndex,
+                memoryRequirements,
+                isLinear
+            );
+        } catch (const vk::OutOfDeviceMemoryError& e) {
+            LOG_WARNINGthis("Memory type {} is out of memory ( {} ), trying the next suitable memory type", memoryTypeIndex, e.what());
+        }
+    }
+
+    LOG_THROWthis(util::VulkanCreationFailedError, "Failed to allocate {} bytes from any suitable memory type", memoryRequirements.size);
+}
+
+quartz::rendering::MemoryAllocator::Statistics
+quartz::rendering::MemoryAllocator::getStatistics() const {
+    quartz::rendering::MemoryAllocator::Statistics statistics = {};
+    statistics.vulkanAllocationCount = m_vulkanAllocationCount;
+    statistics.dedicatedAllocationCount = m_dedicatedBlockPtrs.size();
+
+    vk::DeviceSize largestFreeRangeBytesSum = 0;
+
+    for (const std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>>& blockPtrs : m_blockPtrsByPool) {
+        for (const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block : blockPtrs) {
+            vk::DeviceSize blockFreeBytes = 0;
+            vk::DeviceSize blockLargestFreeRangeBytes = 0;
+
+            for (uint32_t order = 0; order <= p_block->maxOrder; ++order) {
+                const vk::DeviceSize nodeSizeBytes = quartz::rendering::MemoryAllocator::minNodeSizeBytes << order;
+                const std::set<vk::DeviceSize>& freeOffsets = p_block->freeOffsetsByOrder[order];
+
+                blockFreeBytes += freeOffsets.size() * nodeSizeBytes;
+                if (!freeOffsets.empty()) {
+                    blockLargestFreeRangeBytes = nodeSizeBytes;
+                }
+            }
+
+            ++statistics.blockCount;
+            statistics.allocationCount += p_block->allocationCount;
+            statistics.reservedBytes += p_block->sizeBytes;
+            statistics.allocatedBytes += p_block->allocatedBytes;
+            statistics.wastedBytes += p_block->sizeBytes - blockFreeBytes - p_block->allocatedBytes;
+            statistics.freeBytes += blockFreeBytes;
+            statistics.largestFreeRangeBytes = std::max(statistics.largestFreeRangeBytes, blockLargestFreeRangeBytes);
+            largestFreeRangeBytesSum += blockLargestFreeRangeBytes;
+        }
+    }
+
+    for (const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block : m_dedicatedBlockPtrs) {
+        statistics.allocationCount += p_block->allocationCount;
+        statistics.reservedBytes += p_block->sizeBytes;
+        statistics.allocatedBytes += p_block->allocatedBytes;
+    }
+
+    statistics.fragmentation = statistics.freeBytes > 0 ?
+        1.0f - static_cast<float>(largestFreeRangeBytesSum) / static_cast<float>(statistics.freeBytes) :
+        0.0f;
+
+    return statistics;
+}
+
+void
+quartz::rendering::MemoryAllocator::logStatistics() const {
+    const quartz::rendering::MemoryAllocator::Statistics statistics = this->getStatistics();
+
+    LOG_INFOthis("Device memory:");
+    LOG_INFOthis("  - vulkan allocations  : {} ( {} blocks, {} dedicated, {} guaranteed )", statistics.vulkanAllocationCount, statistics.blockCount, statistics.dedicatedAllocationCount, m_maxVulkanAllocationCount);
+    LOG_INFOthis("  - allocations         : {}", statistics.allocationCount);
+    LOG_INFOthis("  - reserved bytes      : {}", statistics.reservedBytes);
+    LOG_INFOthis("  - allocated bytes     : {}", statistics.allocatedBytes);
+    LOG_INFOthis("  - wasted bytes        : {}", statistics.wastedBytes);
+    LOG_INFOthis("  - free bytes          : {}", statistics.freeBytes);
+    LOG_INFOthis("  - largest free range  : {}", statistics.largestFreeRangeBytes);
+    LOG_INFOthis("  - fragmentation       : {:.3f}", statistics.fragmentation);
+
+    const std::vector<quartz::rendering::MemoryAllocator::HeapUsage> heapUsages = this->getHeapUsages();
+    for (uint32_t i = 0; i < heapUsages.size(); ++i) {
+        const quartz::rendering::MemoryAllocator::HeapUsage& heapUsage = heapUsages[i];
+
+        if (m_isMemoryBudgetSupported) {
+            LOG_INFOthis("  - heap {}              : {} of {} bytes reserved, driver reports {} of {} budgeted bytes used", i, heapUsage.reservedBytes, heapUsage.sizeBytes, heapUsage.driverUsageBytes, heapUsage.budgetBytes);
+        } else {
+            LOG_INFOthis("  - heap {}              : {} of {} bytes reserved", i, heapUsage.reservedBytes, heapUsage.sizeBytes);
+        }
+    }
+}
+
+std::vector<quartz::rendering::MemoryAllocator::HeapUsage>
+quartz::rendering::MemoryAllocator::getHeapUsages() const {
+    std::vector<quartz::rendering::MemoryAllocator::HeapUsage> heapUsages(m_vulkanMemoryProperties.memoryHeapCount);
+
+    for (uint32_t i = 0; i < m_vulkanMemoryProperties.memoryHeapCount; ++i) {
+        heapUsages[i].sizeBytes = m_vulkanMemoryProperties.memoryHeaps[i].size;
+        heapUsages[i].vulkanMemoryHeapFlags = m_vulkanMemoryProperties.memoryHeaps[i].flags;
+    }
+
+    for (const std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>>& blockPtrs : m_blockPtrsByPool) {
+        for (const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block : blockPtrs) {
+            quartz::rendering::MemoryAllocator::HeapUsage& heapUsage = heapUsages[m_vulkanMemoryProperties.memoryTypes[p_block->memoryTypeIndex].heapIndex];
+            heapUsage.reservedBytes += p_block->sizeBytes;
+            heapUsage.allocatedBytes += p_block->allocatedBytes;
+        }
+    }
+
+    for (const std::unique_ptr<quartz::rendering::MemoryAllocator::Block>& p_block : m_dedicatedBlockPtrs) {
+        quartz::rendering::MemoryAllocator::HeapUsage& heapUsage = heapUsages[m_vulkanMemoryProperties.memoryTypes[p_block->memoryTypeIndex].heapIndex];
+        heapUsage.reservedBytes += p_block->sizeBytes;
+        heapUsage.allocatedBytes += p_block->allocatedBytes;
+    }
+
+    if (m_isMemoryBudgetSupported) {
+        // The budget changes as other things on the system allocate, so ask for it every time
+        const vk::StructureChain<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT> memoryPropertiesChain =
+            m_vulkanPhysicalDevice.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2, vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+        const vk::PhysicalDeviceMemoryBudgetPropertiesEXT& memoryBudgetProperties =
+            memoryPropertiesChain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+        for (uint32_t i = 0; i < m_vulkanMemoryProperties.memoryHeapCount; ++i) {
+            heapUsages[i].budgetBytes = memoryBudgetProperties.heapBudget[i];
+            heapUsages[i].driverUsageBytes = memoryBudgetProperties.heapUsage[i];
+        }
+    }
+
+    return heapUsages;
+}
+
+std::string
+quartz::rendering::MemoryAllocator::getReportJson() const {
+    const quartz::rendering::MemoryAllocator::Statistics statistics = this->getStatistics();
+    const std::vector<quartz::rendering::MemoryAllocator::HeapUsage> heapUsages = this->getHeapUsages();
+    const std::map<std::string, quartz::rendering::MemoryAccounting::AssetUsage>& assetUsages = quartz::rendering::MemoryAccounting::getAssetUsages();
+
+    std::string json = "{\n";
+
+    json += fmt::format("  \"memoryBudgetSupported\": {},\n", m_isMemoryBudgetSupported);
+
+    json += "  \"allocator\": {\n";
+    json += fmt::format("    \"vulkanAllocationCount\": {},\n", statistics.vulkanAllocationCount);
+    json += fmt::format("    \"maxVulkanAllocationCount\": {},\n", m_maxVulkanAllocationCount);
+    json += fmt::format("    \"blockCount\": {},\n", statistics.blockCount);
+    json += fmt::format("    \"dedicatedAllocationCount\": {},\n", statistics.dedicatedAllocationCount);
+    json += fmt::format("    \"allocationCount\": {},\n", statistics.allocationCount);
+    json += fmt::format("    \"reservedBytes\": {},\n", statistics.reservedBytes);
+    json += fmt::format("    \"allocatedBytes\": {},\n", statistics.allocatedBytes);
+    json += fmt::format("    \"wastedBytes\": {},\n", statistics.wastedBytes);
+    json += fmt::format("    \"freeBytes\": {},\n", statistics.freeBytes);
+    json += fmt::format("    \"largestFreeRangeBytes\": {},\n", statistics.largestFreeRangeBytes);
+    json += fmt::format("    \"fragmentation\": {:.4f}\n", statistics.fragmentation);
+    json += "  },\n";
+
+    json += "  \"heaps\": [\n";
+    for (uint32_t i = 0; i < heapUsages.size(); ++i) {
+        const quartz::rendering::MemoryAllocator::HeapUsage& heapUsage = heapUsages[i];
+
+        json += "    {\n";
+        json += fmt::format("      \"index\": {},\n", i);
+        json += fmt::format("      \"deviceLocal\": {},\n", static_cast<bool>(heapUsage.vulkanMemoryHeapFlags & vk::MemoryHeapFlagBits::eDeviceLocal));
+        json += fmt::format("      \"sizeBytes\": {},\n", heapUsage.sizeBytes);
+        json += fmt::format("      \"reservedBytes\": {},\n", heapUsage.reservedBytes);
+        json += fmt::format("      \"allocatedBytes\": {},\n", heapUsage.allocatedBytes);
+        if (m_isMemoryBudgetSupported) {
+            json += fmt::format("      \"budgetBytes\": {},\n", heapUsage.budgetBytes);
+            json += fmt::format("      \"driverUsageBytes\": {}\n", heapUsage.driverUsageBytes);
+        } else {
+            json += "      \"budgetBytes\": null,\n";
+            json += "      \"driverUsageBytes\": null\n";
+        }
+        json += fmt::format("    }}{}\n", i + 1 < heapUsages.size() ? "," : "");
+    }
+    json += "  ],\n";
+
+    json += "  \"assets\": [\n";
+    uint32_t assetIndex = 0;
+    for (const std::pair<const std::string, quartz::rendering::MemoryAccounting::AssetUsage>& entry : assetUsages) {
+        const quartz::rendering::MemoryAccounting::AssetUsage& assetUsage = entry.second;
+
+        json += "    {\n";
+        json += fmt::format("      \"name\": \"{}\",\n", quartz::rendering::MemoryAllocator::escapeJsonString(entry.first));
+        json += fmt::format("      \"deviceBytes\": {},\n", assetUsage.deviceBytes);
+        json += fmt::format("      \"deviceAllocationCount\": {},\n", assetUsage.deviceAllocationCount);
+        json += fmt::format("      \"geometryPoolBytes\": {},\n", assetUsage.geometryPoolBytes);
+        json += fmt::format("      \"hostBytes\": {}\n", assetUsage.hostBytes);
+        json += fmt::format("    }}{}\n", ++assetIndex < assetUsages.size() ? "," : "");
+    }
+    json += "  ]\n";
+
+    json += "}\n";
+
+    return json;
+}
+
+void
+quartz::rendering::MemoryAllocator::writeReportToFile(
+    const std::string& filepath
+) const {
+    LOG_FUNCTION_SCOPE_TRACEthis("{}", filepath);
+
+    const std::string json = this->getReportJson();
+
+    util::FileSystem::writeBytesToFile(
+        filepath,
+        std::vector<char>(json.begin(), json.end())
+    );
+
+    LOG_INFOthis("Wrote memory report to {}", filepath);
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+
+namespace quartz {
+namespace rendering {
+    class MemoryAllocator;
+}
+}
+
+/**
+ * @brief Hands out device memory for buffers and images from a few large blocks per memory type, instead
+ *   of calling vkAllocateMemory once per resource. Those calls are slow and drivers cap how many can be
+ *   alive at once (maxMemoryAllocationCount, commonly 4096). Each block is carved up with a buddy
+ *   allocator, so every allocation is a power of two sized node whose offset is a multiple of its size.
+ *   That satisfies any alignment up to the node size, and the non coherent atom size, for free.
+ *
+ * @brief Linear resources (buffers and linearly tiled images) and optimally tiled images never share a
+ *   block, so neighbouring resources can't violate bufferImageGranularity. Anything larger than half of a
+ *   block gets a dedicated vkAllocateMemory of its own. Host visible blocks are mapped once when they are
+ *   created and stay mapped, since a vk::DeviceMemory can only be mapped once at a time.
+ *
+ * @brief Every allocation is charged to the current memory accounting asset scope. When the device has
+ *   VK_EXT_memory_budget, the driver's budget for each heap is reported alongside what we have allocated
+ *   from it, and we warn before creating a block which would go over it.
+ *
+ * @brief This is not thread safe. Everything allocates from the thread which drives the device.
+ */
+class quartz::rendering::MemoryAllocator {
+private: // classes
+    struct Block;
+
+public: // classes
+    /**
+     * @brief A range of device memory, given back to the allocator when destroyed or reset. Charged to
+     *   the memory accounting asset scope which was current when it was allocated
+     */
+    class Allocation {
+    public: // member functions
+        Allocation();
+        Allocation(Allocation&& other);
+        ~Allocation();
+
+        Allocation& operator=(Allocation&& other);
+
+        const vk::DeviceMemory& getVulkanDeviceMemory() const { return m_vulkanDeviceMemory; }
+        vk::DeviceSize getOffsetBytes() const { return m_offsetBytes; }
+        vk::DeviceSize getSizeBytes() const { return m_sizeBytes; }
+        vk::MemoryPropertyFlags getVulkanMemoryPropertyFlags() const { return m_vulkanMemoryPropertyFlags; }
+        void* getMappedLocalMemoryPtr() const { return mp_mappedLocalMemory; }
+        const std::string& getAssetName() const { return m_assetName; }
+        bool getIsDedicated() const;
+
+        void reset();
+
+    private: // member functions
+        Allocation(
+            quartz::rendering::MemoryAllocator& allocator,
+            quartz::rendering::MemoryAllocator::Block& block,
+            const vk::DeviceSize offsetBytes,
+            const vk::DeviceSize sizeBytes,
+            const uint32_t order
+        );
+
+    private: // member variables
+        quartz::rendering::MemoryAllocator* mp_allocator;
+        quartz::rendering::MemoryAllocator::Block* mp_block;
+        vk::DeviceMemory m_vulkanDeviceMemory;
+        vk::DeviceSize m_offsetBytes;
+        vk::DeviceSize m_sizeBytes;
+        uint32_t m_order;
+        vk::MemoryPropertyFlags m_vulkanMemoryPropertyFlags;
+        void* mp_mappedLocalMemory;
+        std::string m_assetName;
+
+    private: // friends
+        friend class quartz::rendering::MemoryAllocator;
+    };
+
+    struct Statistics {
+    public: // member variables
+        uint32_t vulkanAllocationCount; // blocks and dedicated allocations
+        uint32_t blockCount;
+        uint32_t dedicatedAllocationCount;
+        uint32_t allocationCount;
+        vk::DeviceSize reservedBytes; // everything allocated from vulkan
+        vk::DeviceSize allocatedBytes; // everything handed out, as requested
+        vk::DeviceSize wastedBytes; // lost to rounding allocations up to a power of two sized node
+        vk::DeviceSize freeBytes;
+        vk::DeviceSize largestFreeRangeBytes;
+
+        /**
+         * @brief 0 when each block's free memory is one contiguous range, approaching 1 as it is split
+         *   into more and smaller ranges
+         */
+        float fragmentation;
+    };
+
+    struct HeapUsage {
+    public: // member variables
+        vk::DeviceSize sizeBytes;
+        vk::MemoryHeapFlags vulkanMemoryHeapFlags;
+        vk::DeviceSize reservedBytes; // blocks and dedicated allocations made from this heap
+        vk::DeviceSize allocatedBytes;
+
+        /**
+         * @brief From VK_EXT_memory_budget, 0 when the device doesn't have it. The driver's usage covers
+         *   everything in the process (and the budget accounts for other processes), not just us
+         */
+        vk::DeviceSize budgetBytes;
+        vk::DeviceSize driverUsageBytes;
+    };
+
+public: // member functions
+    MemoryAllocator(
+        const vk::PhysicalDevice& physicalDevice,
+        const vk::PhysicalDeviceLimits& physicalDeviceLimits,
+        const vk::UniqueDevice& p_logicalDevice,
+        const bool isMemoryBudgetSupported
+    );
+    MemoryAllocator(const MemoryAllocator& other) = delete;
+    ~MemoryAllocator();
+
+    MemoryAllocator& operator=(const MemoryAllocator& other) = delete;
+
+    USE_LOGGER(MEMORY);
+
+    /**
+     * @brief The memory type must have all of the required properties. Types which also have the preferred
+     *   properties are tried first, falling back to the rest when they run out of memory. Asking for
+     *   device local memory as a preference on top of host visible memory picks up resizable BAR memory
+     *   when the device has it
+     */
+    quartz::rendering::MemoryAllocator::Allocation allocate(
+        const vk::MemoryRequirements& memoryRequirements,
+        const vk::MemoryPropertyFlags requiredMemoryProperties,
+        const vk::MemoryPropertyFlags preferredMemoryProperties,
+        const bool isLinear
+    );
+
+    quartz::rendering::MemoryAllocator::Statistics getStatistics() const;
+    std::vector<quartz::rendering::MemoryAllocator::HeapUsage> getHeapUsages() const;
+    bool getIsMemoryBudgetSupported() const { return m_isMemoryBudgetSupported; }
+    void logStatistics() const;
+
+    /**
+     * @brief The statistics, every heap's usage and budget, and every asset's usage from memory accounting
+     */
+    std::string getReportJson() const;
+    void writeReportToFile(const std::string& filepath) const;
+
+public: // static variables
+    static constexpr vk::DeviceSize defaultBlockSizeBytes = 64 * 1024 * 1024;
+    static constexpr vk::DeviceSize smallHeapSizeBytes = 1024 * 1024 * 1024; // heaps this size or smaller get smaller blocks
+    static constexpr vk::DeviceSize minNodeSizeBytes = 256;
+
+private: // classes
+    struct Block {
+    public: // member variables
+        uint32_t memoryTypeIndex;
+        bool isLinear;
+        bool isDedicated;
+        vk::DeviceSize sizeBytes;
+        uint32_t maxOrder; // a node of order n is minNodeSizeBytes << n bytes
+        vk::UniqueDeviceMemory p_vulkanDeviceMemory;
+        void* p_mappedLocalMemory;
+        std::vector<std::set<vk::DeviceSize>> freeOffsetsByOrder; // empty for dedicated allocations
+        uint32_t allocationCount;
+        vk::DeviceSize allocatedBytes;
+    };
+
+private: // static functions
+    static std::string escapeJsonString(const std::string& string);
+    static uint32_t calculateOrder(const vk::DeviceSize sizeBytes);
+    static vk::DeviceSize calculateBlockSizeBytes(
+        const vk::PhysicalDeviceMemoryProperties& memoryProperties,
+        const uint32_t memoryTypeIndex
+    );
+    static std::optional<vk::DeviceSize> allocateNode(
+        quartz::rendering::MemoryAllocator::Block& block,
+        const uint32_t order
+    );
+    static void freeNode(
+        quartz::rendering::MemoryAllocator::Block& block,
+        const vk::DeviceSize offsetBytes,
+        const uint32_t order
+    );
+
+private: // member functions
+    std::vector<uint32_t> getCandidateMemoryTypeIndices(
+        const uint32_t memoryTypeBits,
+        const vk::MemoryPropertyFlags requiredMemoryProperties,
+        const vk::MemoryPropertyFlags preferredMemoryProperties
+    ) const;
+    void warnIfOverBudget(
+        const uint32_t memoryTypeIndex,
+        const vk::DeviceSize sizeBytes
+    ) const;
+    std::unique_ptr<quartz::rendering::MemoryAllocator::Block> createBlock(
+        const uint32_t memoryTypeIndex,
+        const bool isLinear,
+        const bool isDedicated,
+        const vk::DeviceSize sizeBytes
+    );
+    quartz::rendering::MemoryAllocator::Allocation allocateFromMemoryType(
+        const uint32_t memoryTypeIndex,
+        const vk::MemoryRequirements& memoryRequirements,
+        const bool isLinear
+    );
+    void free(
+        quartz::rendering::MemoryAllocator::Block& block,
+        const vk::DeviceSize offsetBytes,
+        const vk::DeviceSize sizeBytes,
+        const uint32_t order
+    );
+
+private: // member variables
+    vk::PhysicalDevice m_vulkanPhysicalDevice;
+    vk::Device m_vulkanLogicalDevice;
+    const bool m_isMemoryBudgetSupported;
+    const vk::PhysicalDeviceMemoryProperties m_vulkanMemoryProperties;
+    const vk::DeviceSize m_nonCoherentAtomSizeBytes;
+    const uint32_t m_maxVulkanAllocationCount;
+    uint32_t m_vulkanAllocationCount;
+
+    std::vector<std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>>> m_blockPtrsByPool; // indexed by memory type index * 2 + is linear
+    std::vector<std::unique_ptr<quartz::rendering::MemoryAllocator::Block>> m_dedicatedBlockPtrs;
+};
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
+#include "quartz/rendering/draw_packet/DrawPacket.hpp"
+#include "quartz/rendering/material/Material.hpp"
+#include "quartz/rendering/model/Node.hpp"
+
+uint32_t
+quartz::rendering::DrawPacket::toSortableDepth(
+    const float distanceSquared,
+    const bool isTranslucent
+) {
+    /**
+     * @brief The bits of a non-negative float compare the same way the float does when treated as an
+     *   unsigned integer, so we can use them directly. Flip them to sort translucent draws back to front
+     */
+    uint32_t depthBits;
+    std::memcpy(&depthBits, &distanceSquared, sizeof(uint32_t));
+
+    return isTranslucent ? ~depthBits : depthBits;
+}
+
+uint64_t
+quartz::rendering::DrawPacket::createSortKey(
+    const quartz::scene::Doodad& doodad,
+    const glm::mat4& instanceTransformationMatrix,
+    const quartz::rendering::Primitive& primitive,
+    const uint32_t lodLevel,
+    const glm::vec3& cameraWorldPosition
+) {
+    // Use the origin of the instance as the primitive's position
+    const glm::vec3 worldPosition = glm::vec3(doodad.getTransformationMatrix() * instanceTransformationMatrix[3]);
+    const glm::vec3 cameraToPrimitive = worldPosition - cameraWorldPosition;
+    const float distanceSquared = glm::dot(cameraToPrimitive, cameraToPrimitive);
+
+    const uint32_t materialMasterIndex = primitive.getMaterialMasterIndex();
+    const bool isTranslucent =
+        quartz::rendering::Material::getMasterMaterialList()[materialMasterIndex]->getAlphaMode() ==
+        quartz::rendering::Material::AlphaMode::Blend;
+
+    const quartz::rendering::GeometryPool::Range& geometryRange = primitive.getLodGeometryRange(lodLevel);
+
+    const uint64_t translucencyBits = isTranslucent ? 1 : 0;
+    const uint64_t geometryBlockBits = geometryRange.blockIndex & 0x7FFF;
+    const uint64_t materialBits = materialMasterIndex & 0xFFFF;
+    const uint64_t depthBits = quartz::rendering::DrawPacket::toSortableDepth(distanceSquared, isTranslucent);
+
+    /**
+     * @brief Blended draws have to be drawn back to front no matter which block or material they use,
+     *   so their depth goes right under the translucency bit and the state only breaks ties
+     */
+    if (isTranslucent) {
+        return
+            (translucencyBits << 63) |
+            (depthBits << 31) |
+            (geometryBlockBits << 16) |
+            materialBits;
+    }
+
+    /**
+     * @brief A block holds at most defaultBlockIndexCapacityBytes worth of indices, which is 22 bits
+     *   worth of first indices
+     */
+    const uint64_t lowBits = ((geometryRange.firstIndex & 0x3FFFFF) << 10) | (depthBits >> 22);
+
+    return
+        (translucencyBits << 63) |
+        (geometryBlockBits << 48) |
+        (materialBits << 32) |
+        lowBits;
+}
+
+quartz::rendering::DrawPacket::DrawPacket() :
+    m_sortKey(0),
+    mp_doodad(nullptr),
+    mp_drawEntry(nullptr),
+    mp_primitive(nullptr),
+    m_instanceIndex(0),
+    m_lodLevel(0)
+{}
+
+quartz::rendering::DrawPacket::DrawPacket(
+    const quartz::scene::Doodad& doodad,
+    const quartz::rendering::Model::DrawEntry& drawEntry,
+    const quartz::rendering::Primitive& primitive,
+    const uint32_t instanceIndex,
+    const uint32_t lodLevel,
+    const glm::vec3& cameraWorldPosition
+) :
+    m_sortKey(0),
+    mp_doodad(&doodad),
+    mp_drawEntry(&drawEntry),
+    mp_primitive(&primitive),
+    m_instanceIndex(instanceIndex),
+    m_lodLevel(std::min(lodLevel, primitive.getLodCount() - 1))
+{
+    m_sortKey = quartz::rendering::DrawPacket::createSortKey(
+        doodad,
+        this->getInstanceTransformationMatrix(),
+        primitive,
+        m_lodLevel,
+        cameraWorldPosition
+    );
+}
+
+glm::mat4
+quartz::rendering::DrawPacket::getInstanceTransformationMatrix() const {
+    const std::vector<glm::mat4>& instanceTransformationMatrices = mp_drawEntry->p_node->getInstanceTransformationMatrices();
+
+    if (instanceTransformationMatrices.empty()) {
+        return mp_drawEntry->transformationMatrix;
+    }
+
+    return mp_drawEntry->transformationMatrix * instanceTransformationMatrices[m_instanceIndex];
+}
+
+void
+quartz::rendering::DrawPacket::radixSort(
+    std::vector<quartz::rendering::DrawPacket>& packets,
+    std::vector<quartz::rendering::DrawPacket>& scratchPackets
+) {
+    constexpr uint32_t numBitsPerDigit = 8;
+    constexpr uint32_t numBuckets = 1 << numBitsPerDigit;
+    constexpr uint32_t numDigits = (sizeof(uint64_t) * 8) / numBitsPerDigit;
+
+    if (packets.size() < 2) {
+        return;
+    }
+
+    // ----- build the histogram for every digit in a single pass ----- //
+
+    std::array<std::array<uint32_t, numBuckets>, numDigits> histograms = {};
+    for (const quartz::rendering::DrawPacket& packet : packets) {
+        for (uint32_t digit = 0; digit < numDigits; ++digit) {
+            ++histograms[digit][(packet.m_sortKey >> (digit * numBitsPerDigit)) & (numBuckets - 1)];
+        }
+    }
+
+    // ----- scatter back and forth between the packets and the scratch packets ----- //
+
+    scratchPackets.resize(packets.size());
+
+    std::vector<quartz::rendering::DrawPacket>* p_sourcePackets = &packets;
+    std::vector<quartz::rendering::DrawPacket>* p_destinationPackets = &scratchPackets;
+
+    for (uint32_t digit = 0; digit < numDigits; ++digit) {
+        const uint32_t shift = digit * numBitsPerDigit;
+        std::array<uint32_t, numBuckets>& histogram = histograms[digit];
+
+        const uint32_t firstBucket = (p_sourcePackets->front().m_sortKey >> shift) & (numBuckets - 1);
+        if (histogram[firstBucket] == packets.size()) {
+            continue;
+        }
+
+        uint32_t bucketOffset = 0;
+        for (uint32_t bucket = 0; bucket < numBuckets; ++bucket) {
+            const uint32_t bucketCount = histogram[bucket];
+            histogram[bucket] = bucketOffset;
+            bucketOffset += bucketCount;
+        }
+
+        for (const quartz::rendering::DrawPacket& packet : *p_sourcePackets) {
+            const uint32_t bucket = (packet.m_sortKey >> shift) & (numBuckets - 1);
+            (*p_destinationPackets)[histogram[bucket]++] = packet;
+        }
+
+        std::swap(p_sourcePackets, p_destinationPackets);
+    }
+
+    if (p_sourcePackets != &packets) {
+        packets.swap(scratchPackets);
+    }
+}
+
+uint32_t
+quartz::rendering::DrawPacket::countGeometryBinds(
+    const std::vector<quartz::rendering::DrawPacket>& packets
+) {
+    uint32_t numGeometryBinds = 0;
+
+    for (uint32_t i = 0; i < packets.size(); ++i) {
+        if (
+            i == 0 ||
+            packets[i].getGeometryRange().blockIndex != packets[i - 1].getGeometryRange().blockIndex
+        ) {
+            ++numGeometryBinds;
+        }
+    }
+
+    return numGeometryBinds;
+}
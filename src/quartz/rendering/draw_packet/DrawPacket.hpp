@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
+#include "quartz/rendering/model/Model.hpp"
+#include "quartz/rendering/model/Primitive.hpp"
+#include "quartz/scene/doodad/Doodad.hpp"
+
+namespace quartz {
+namespace rendering {
+    class DrawPacket;
+}
+}
+
+/**
+ * @brief Everything needed to record a single instance of a primitive of a doodad, along with a key
+ *   which sorts the packets so draws sharing state end up next to each other and we only change state
+ *   when the key changes instead of whenever the scene order says so. Neighbouring packets of the same
+ *   primitive are recorded as a single instanced draw.
+ *
+ * @brief OPAQUE SORT KEY (most significant bits first)
+ *    1 bit  : translucency, 0
+ *   15 bits : geometry pool block index
+ *   16 bits : material master index
+ *   22 bits : the first index of the primitive's level of detail (which tells primitives, and the
+ *             levels of a primitive, within a block apart) so every copy of a primitive at the same
+ *             level ends up together and can be instanced
+ *   10 bits : the top of the squared distance from the camera so those copies are roughly front to back
+ *
+ * @brief TRANSLUCENT SORT KEY (most significant bits first)
+ *    1 bit  : translucency, 1. Blended draws come after everything else
+ *   32 bits : the full squared distance from the camera, back to front across every block and material
+ *   15 bits : geometry pool block index
+ *   16 bits : material master index
+ */
+class quartz::rendering::DrawPacket {
+public: // member functions
+    DrawPacket();
+    DrawPacket(
+        const quartz::scene::Doodad& doodad,
+        const quartz::rendering::Model::DrawEntry& drawEntry,
+        const quartz::rendering::Primitive& primitive,
+        const uint32_t instanceIndex,
+        const uint32_t lodLevel,
+        const glm::vec3& cameraWorldPosition
+    );
+
+    USE_LOGGER(DRAW_PACKET);
+
+    uint64_t getSortKey() const { return m_sortKey; }
+    bool getIsTranslucent() const { return (m_sortKey >> 63) != 0; }
+    const quartz::scene::Doodad& getDoodad() const { return *mp_doodad; }
+    const quartz::rendering::Model::DrawEntry& getDrawEntry() const { return *mp_drawEntry; }
+    const quartz::rendering::Primitive& getPrimitive() const { return *mp_primitive; }
+    uint32_t getInstanceIndex() const { return m_instanceIndex; }
+    uint32_t getLodLevel() const { return m_lodLevel; }
+
+    /**
+     * @brief The indices of the primitive at the packet's level of detail
+     */
+    const quartz::rendering::GeometryPool::Range& getGeometryRange() const { return mp_primitive->getLodGeometryRange(m_lodLevel); }
+
+    /**
+     * @brief The transformation matrix of the instance relative to the doodad, which includes the
+     *   node's transformation matrix as well as the instance's own matrix if the node is instanced
+     */
+    glm::mat4 getInstanceTransformationMatrix() const;
+
+public: // static functions
+    /**
+     * @brief A least significant digit radix sort on the sort keys. Digits every packet agrees on are
+     *   skipped, which is most of them for scenes that only use a few blocks and materials.
+     *   scratchPackets is only used as storage so it can be reused across frames
+     */
+    static void radixSort(
+        std::vector<quartz::rendering::DrawPacket>& packets,
+        std::vector<quartz::rendering::DrawPacket>& scratchPackets
+    );
+
+    /**
+     * @brief The number of times we need to bind vertex and index buffers to record the packets in order
+     */
+    static uint32_t countGeometryBinds(
+        const std::vector<quartz::rendering::DrawPacket>& packets
+    );
+
+private: // static functions
+    static uint32_t toSortableDepth(
+        const float distanceSquared,
+        const bool isTranslucent
+    );
+    static uint64_t createSortKey(
+        const quartz::scene::Doodad& doodad,
+        const glm::mat4& instanceTransformationMatrix,
+        const quartz::rendering::Primitive& primitive,
+        const uint32_t lodLevel,
+        const glm::vec3& cameraWorldPosition
+    );
+
+private: // member variables
+    uint64_t m_sortKey;
+    const quartz::scene::Doodad* mp_doodad;
+    const quartz::rendering::Model::DrawEntry* mp_drawEntry;
+    const quartz::rendering::Primitive* mp_primitive;
+    uint32_t m_instanceIndex;
+    uint32_t m_lodLevel;
+};
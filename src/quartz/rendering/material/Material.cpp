@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include <glm/vec4.hpp>
 #include "util/logger/Logger.hpp"
 
@@ -6,6 +9,7 @@
 
 uint32_t quartz::rendering::Material::defaultMaterialMasterIndex = 0;
 std::vector<std::shared_ptr<quartz::rendering::Material>> quartz::rendering::Material::masterMaterialList;
+uint64_t quartz::rendering::Material::latestRevision = 0;
 
 quartz::rendering::Material::UniformBufferObject::UniformBufferObject(
     const uint32_t baseColorTextureMasterIndex_,
@@ -13,6 +17,11 @@ quartz::rendering::Material::UniformBufferObject::UniformBufferObject(
     const uint32_t normalTextureMasterIndex_,
     const uint32_t emissionTextureMasterIndex_,
     const uint32_t occlusionTextureMasterIndex_,
+    const uint32_t baseColorTextureCoordinateSlot_,
+    const uint32_t metallicRoughnessTextureCoordinateSlot_,
+    const uint32_t normalTextureCoordinateSlot_,
+    const uint32_t emissionTextureCoordinateSlot_,
+    const uint32_t occlusionTextureCoordinateSlot_,
     const glm::vec4& baseColorFactor_,
     const glm::vec3& emissiveFactor_,
     const float metallicFactor_,
@@ -26,6 +35,11 @@ quartz::rendering::Material::UniformBufferObject::UniformBufferObject(
     normalTextureMasterIndex(normalTextureMasterIndex_),
     emissionTextureMasterIndex(emissionTextureMasterIndex_),
     occlusionTextureMasterIndex(occlusionTextureMasterIndex_),
+    baseColorTextureCoordinateSlot(baseColorTextureCoordinateSlot_),
+    metallicRoughnessTextureCoordinateSlot(metallicRoughnessTextureCoordinateSlot_),
+    normalTextureCoordinateSlot(normalTextureCoordinateSlot_),
+    emissionTextureCoordinateSlot(emissionTextureCoordinateSlot_),
+    occlusionTextureCoordinateSlot(occlusionTextureCoordinateSlot_),
     baseColorFactor(baseColorFactor_),
     emissiveFactor(emissiveFactor_),
     metallicFactor(metallicFactor_),
@@ -43,6 +57,11 @@ quartz::rendering::Material::UniformBufferObject::UniformBufferObject(
     normalTextureMasterIndex(material.m_normalTextureMasterIndex),
     emissionTextureMasterIndex(material.m_emissionTextureMasterIndex),
     occlusionTextureMasterIndex(material.m_occlusionTextureMasterIndex),
+    baseColorTextureCoordinateSlot(material.m_baseColorTextureCoordinateSlot),
+    metallicRoughnessTextureCoordinateSlot(material.m_metallicRoughnessTextureCoordinateSlot),
+    normalTextureCoordinateSlot(material.m_normalTextureCoordinateSlot),
+    emissionTextureCoordinateSlot(material.m_emissionTextureCoordinateSlot),
+    occlusionTextureCoordinateSlot(material.m_occlusionTextureCoordinateSlot),
     baseColorFactor(material.m_baseColorFactor),
     emissiveFactor(material.m_emissiveFactor),
     metallicFactor(material.m_metallicFactor),
@@ -89,6 +108,11 @@ quartz::rendering::Material::createMaterial(
     const uint32_t normalTextureMasterIndex,
     const uint32_t emissionTextureMasterIndex,
     const uint32_t occlusionTextureMasterIndex,
+    const uint32_t baseColorTextureCoordinateSet,
+    const uint32_t metallicRoughnessTextureCoordinateSet,
+    const uint32_t normalTextureCoordinateSet,
+    const uint32_t emissionTextureCoordinateSet,
+    const uint32_t occlusionTextureCoordinateSet,
     const glm::vec4& baseColorFactor,
     const glm::vec3& emissiveFactor,
     const float metallicFactor,
@@ -111,6 +135,11 @@ quartz::rendering::Material::createMaterial(
         normalTextureMasterIndex,
         emissionTextureMasterIndex,
         occlusionTextureMasterIndex,
+        baseColorTextureCoordinateSet,
+        metallicRoughnessTextureCoordinateSet,
+        normalTextureCoordinateSet,
+        emissionTextureCoordinateSet,
+        occlusionTextureCoordinateSet,
         baseColorFactor,
         emissiveFactor,
         metallicFactor,
@@ -151,6 +180,12 @@ quartz::rendering::Material::initializeMasterMaterialList(const quartz::renderin
         quartz::rendering::Texture::getEmissionDefaultMasterIndex(),
         quartz::rendering::Texture::getOcclusionDefaultMasterIndex(),
 
+        0,
+        0,
+        0,
+        0,
+        0,
+
         glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),
         glm::vec3(0.0f, 0.0f, 0.0f),
         1.0f,
@@ -173,12 +208,43 @@ quartz::rendering::Material::cleanUpAllMaterials() {
     quartz::rendering::Material::masterMaterialList.clear();
 }
 
+uint32_t
+quartz::rendering::Material::assignTextureCoordinateSlot(
+    std::vector<uint32_t>& textureCoordinateSets,
+    const uint32_t textureMasterIndex,
+    const uint32_t defaultTextureMasterIndex,
+    const uint32_t textureCoordinateSet
+) {
+    if (textureMasterIndex == defaultTextureMasterIndex) {
+        return 0;
+    }
+
+    const std::vector<uint32_t>::const_iterator it = std::find(textureCoordinateSets.begin(), textureCoordinateSets.end(), textureCoordinateSet);
+    if (it != textureCoordinateSets.end()) {
+        return it - textureCoordinateSets.begin();
+    }
+
+    if (textureCoordinateSets.size() >= quartz::rendering::Material::maxTextureCoordinateSetCount) {
+        LOG_WARNING(MATERIAL, "Material already uses {} texture coordinate sets, which is as many as vertices have room for. Texture with master index {} will sample TEXCOORD_{} instead of TEXCOORD_{}", textureCoordinateSets.size(), textureMasterIndex, textureCoordinateSets[0], textureCoordinateSet);
+        return 0;
+    }
+
+    textureCoordinateSets.push_back(textureCoordinateSet);
+
+    return textureCoordinateSets.size() - 1;
+}
+
 quartz::rendering::Material::Material() :
     m_baseColorTextureMasterIndex(quartz::rendering::Texture::getBaseColorDefaultMasterIndex()),
     m_metallicRoughnessTextureMasterIndex(quartz::rendering::Texture::getMetallicRoughnessDefaultMasterIndex()),
     m_normalTextureMasterIndex(quartz::rendering::Texture::getNormalDefaultMasterIndex()),
     m_emissionTextureMasterIndex(quartz::rendering::Texture::getEmissionDefaultMasterIndex()),
     m_occlusionTextureMasterIndex(quartz::rendering::Texture::getOcclusionDefaultMasterIndex()),
+    m_baseColorTextureCoordinateSlot(0),
+    m_metallicRoughnessTextureCoordinateSlot(0),
+    m_normalTextureCoordinateSlot(0),
+    m_emissionTextureCoordinateSlot(0),
+    m_occlusionTextureCoordinateSlot(0),
     m_baseColorFactor(1.0f, 1.0f, 1.0f, 1.0f),
     m_emissiveFactor(0.0f, 0.0f, 0.0f),
     m_metallicFactor(1.0f),
@@ -186,7 +252,9 @@ quartz::rendering::Material::Material() :
     m_alphaMode(quartz::rendering::Material::AlphaMode::Opaque),
     m_alphaCutoff(0.5f),
     m_doubleSided(false),
-    m_name("A_Default_Material")
+    m_textureCoordinateSets(),
+    m_name("A_Default_Material"),
+    m_revision(++quartz::rendering::Material::latestRevision)
 {
     LOG_FUNCTION_SCOPE_TRACEthis("");
     LOG_TRACEthis("Using all default texture indices");
@@ -196,6 +264,8 @@ quartz::rendering::Material::Material() :
     LOG_TRACEthis("Normal             master index: {}", m_normalTextureMasterIndex);
     LOG_TRACEthis("Emission           master index: {}", m_emissionTextureMasterIndex);
     LOG_TRACEthis("Occlusion          master index: {}", m_occlusionTextureMasterIndex);
+    LOG_TRACEthis("Texture coordinate sets used: {}", m_textureCoordinateSets.size());
+    LOG_TRACEthis("Texture coordinate slots: base color {}, metallic roughness {}, normal {}, emission {}, occlusion {}", m_baseColorTextureCoordinateSlot, m_metallicRoughnessTextureCoordinateSlot, m_normalTextureCoordinateSlot, m_emissionTextureCoordinateSlot, m_occlusionTextureCoordinateSlot);
     LOG_TRACEthis("Base color factor: {}, {}, {}, {}", m_baseColorFactor.r, m_baseColorFactor.g, m_baseColorFactor.b, m_baseColorFactor.a);
     LOG_TRACEthis("Emissive   factor: {}, {}, {}", m_emissiveFactor.r, m_emissiveFactor.g, m_emissiveFactor.b);
     LOG_TRACEthis("Metallic   factor: {}", m_metallicFactor);
@@ -212,6 +282,11 @@ quartz::rendering::Material::Material(
     const uint32_t normalTextureMasterIndex,
     const uint32_t emissionTextureMasterIndex,
     const uint32_t occlusionTextureMasterIndex,
+    const uint32_t baseColorTextureCoordinateSet,
+    const uint32_t metallicRoughnessTextureCoordinateSet,
+    const uint32_t normalTextureCoordinateSet,
+    const uint32_t emissionTextureCoordinateSet,
+    const uint32_t occlusionTextureCoordinateSet,
     const glm::vec4& baseColorFactor,
     const glm::vec3& emissiveFactor,
     const float metallicFactor,
@@ -225,6 +300,11 @@ quartz::rendering::Material::Material(
     m_normalTextureMasterIndex(normalTextureMasterIndex),
     m_emissionTextureMasterIndex(emissionTextureMasterIndex),
     m_occlusionTextureMasterIndex(occlusionTextureMasterIndex),
+    m_baseColorTextureCoordinateSlot(0),
+    m_metallicRoughnessTextureCoordinateSlot(0),
+    m_normalTextureCoordinateSlot(0),
+    m_emissionTextureCoordinateSlot(0),
+    m_occlusionTextureCoordinateSlot(0),
     m_baseColorFactor(baseColorFactor),
     m_emissiveFactor(emissiveFactor),
     m_metallicFactor(metallicFactor),
@@ -232,15 +312,27 @@ quartz::rendering::Material::Material(
     m_alphaMode(alphaMode),
     m_alphaCutoff(alphaCutoff),
     m_doubleSided(doubleSided),
-    m_name(name)
+    m_textureCoordinateSets(),
+    m_name(name),
+    m_revision(++quartz::rendering::Material::latestRevision)
 {
     LOG_FUNCTION_SCOPE_TRACEthis("");
+
+    // Base color goes first, so it lands in the first slot whenever it has a texture
+    m_baseColorTextureCoordinateSlot = quartz::rendering::Material::assignTextureCoordinateSlot(m_textureCoordinateSets, m_baseColorTextureMasterIndex, quartz::rendering::Texture::getBaseColorDefaultMasterIndex(), baseColorTextureCoordinateSet);
+    m_metallicRoughnessTextureCoordinateSlot = quartz::rendering::Material::assignTextureCoordinateSlot(m_textureCoordinateSets, m_metallicRoughnessTextureMasterIndex, quartz::rendering::Texture::getMetallicRoughnessDefaultMasterIndex(), metallicRoughnessTextureCoordinateSet);
+    m_normalTextureCoordinateSlot = quartz::rendering::Material::assignTextureCoordinateSlot(m_textureCoordinateSets, m_normalTextureMasterIndex, quartz::rendering::Texture::getNormalDefaultMasterIndex(), normalTextureCoordinateSet);
+    m_emissionTextureCoordinateSlot = quartz::rendering::Material::assignTextureCoordinateSlot(m_textureCoordinateSets, m_emissionTextureMasterIndex, quartz::rendering::Texture::getEmissionDefaultMasterIndex(), emissionTextureCoordinateSet);
+    m_occlusionTextureCoordinateSlot = quartz::rendering::Material::assignTextureCoordinateSlot(m_textureCoordinateSets, m_occlusionTextureMasterIndex, quartz::rendering::Texture::getOcclusionDefaultMasterIndex(), occlusionTextureCoordinateSet);
+
     LOG_TRACEthis("Name: {}", m_name);
     LOG_TRACEthis("Base Color         master index: {}", m_baseColorTextureMasterIndex);
     LOG_TRACEthis("Metallic Roughness master index: {}", m_metallicRoughnessTextureMasterIndex);
     LOG_TRACEthis("Normal             master index: {}", m_normalTextureMasterIndex);
     LOG_TRACEthis("Emission           master index: {}", m_emissionTextureMasterIndex);
     LOG_TRACEthis("Occlusion          master index: {}", m_occlusionTextureMasterIndex);
+    LOG_TRACEthis("Texture coordinate sets used: {}", m_textureCoordinateSets.size());
+    LOG_TRACEthis("Texture coordinate slots: base color {}, metallic roughness {}, normal {}, emission {}, occlusion {}", m_baseColorTextureCoordinateSlot, m_metallicRoughnessTextureCoordinateSlot, m_normalTextureCoordinateSlot, m_emissionTextureCoordinateSlot, m_occlusionTextureCoordinateSlot);
     LOG_TRACEthis("Base color factor: {}, {}, {}, {}", m_baseColorFactor.r, m_baseColorFactor.g, m_baseColorFactor.b, m_baseColorFactor.a);
     LOG_TRACEthis("Emissive   factor: {}, {}, {}", m_emissiveFactor.r, m_emissiveFactor.g, m_emissiveFactor.b);
     LOG_TRACEthis("Metallic   factor: {}", m_metallicFactor);
@@ -258,6 +350,11 @@ quartz::rendering::Material::Material(
     m_normalTextureMasterIndex(other.m_normalTextureMasterIndex),
     m_emissionTextureMasterIndex(other.m_emissionTextureMasterIndex),
     m_occlusionTextureMasterIndex(other.m_occlusionTextureMasterIndex),
+    m_baseColorTextureCoordinateSlot(other.m_baseColorTextureCoordinateSlot),
+    m_metallicRoughnessTextureCoordinateSlot(other.m_metallicRoughnessTextureCoordinateSlot),
+    m_normalTextureCoordinateSlot(other.m_normalTextureCoordinateSlot),
+    m_emissionTextureCoordinateSlot(other.m_emissionTextureCoordinateSlot),
+    m_occlusionTextureCoordinateSlot(other.m_occlusionTextureCoordinateSlot),
     m_baseColorFactor(other.m_baseColorFactor),
     m_emissiveFactor(other.m_emissiveFactor),
     m_metallicFactor(other.m_metallicFactor),
@@ -265,7 +362,9 @@ quartz::rendering::Material::Material(
     m_alphaMode(other.m_alphaMode),
     m_alphaCutoff(other.m_alphaCutoff),
     m_doubleSided(other.m_doubleSided),
-    m_name(other.m_name)
+    m_textureCoordinateSets(other.m_textureCoordinateSets),
+    m_name(other.m_name),
+    m_revision(++quartz::rendering::Material::latestRevision)
 {
     LOG_FUNCTION_SCOPE_TRACEthis("");
     LOG_TRACEthis("Name: {}", m_name);
@@ -274,6 +373,8 @@ quartz::rendering::Material::Material(
     LOG_TRACEthis("Normal             master index: {}", m_normalTextureMasterIndex);
     LOG_TRACEthis("Emission           master index: {}", m_emissionTextureMasterIndex);
     LOG_TRACEthis("Occlusion          master index: {}", m_occlusionTextureMasterIndex);
+    LOG_TRACEthis("Texture coordinate sets used: {}", m_textureCoordinateSets.size());
+    LOG_TRACEthis("Texture coordinate slots: base color {}, metallic roughness {}, normal {}, emission {}, occlusion {}", m_baseColorTextureCoordinateSlot, m_metallicRoughnessTextureCoordinateSlot, m_normalTextureCoordinateSlot, m_emissionTextureCoordinateSlot, m_occlusionTextureCoordinateSlot);
     LOG_TRACEthis("Base color factor: {}, {}, {}, {}", m_baseColorFactor.r, m_baseColorFactor.g, m_baseColorFactor.b, m_baseColorFactor.a);
     LOG_TRACEthis("Emissive   factor: {}, {}, {}", m_emissiveFactor.r, m_emissiveFactor.g, m_emissiveFactor.b);
     LOG_TRACEthis("Metallic   factor: {}", m_metallicFactor);
@@ -291,6 +392,11 @@ quartz::rendering::Material::Material(
     m_normalTextureMasterIndex(other.m_normalTextureMasterIndex),
     m_emissionTextureMasterIndex(other.m_emissionTextureMasterIndex),
     m_occlusionTextureMasterIndex(other.m_occlusionTextureMasterIndex),
+    m_baseColorTextureCoordinateSlot(other.m_baseColorTextureCoordinateSlot),
+    m_metallicRoughnessTextureCoordinateSlot(other.m_metallicRoughnessTextureCoordinateSlot),
+    m_normalTextureCoordinateSlot(other.m_normalTextureCoordinateSlot),
+    m_emissionTextureCoordinateSlot(other.m_emissionTextureCoordinateSlot),
+    m_occlusionTextureCoordinateSlot(other.m_occlusionTextureCoordinateSlot),
     m_baseColorFactor(other.m_baseColorFactor),
     m_emissiveFactor(other.m_emissiveFactor),
     m_metallicFactor(other.m_metallicFactor),
@@ -298,7 +404,9 @@ quartz::rendering::Material::Material(
     m_alphaMode(other.m_alphaMode),
     m_alphaCutoff(other.m_alphaCutoff),
     m_doubleSided(other.m_doubleSided),
-    m_name(other.m_name)
+    m_textureCoordinateSets(other.m_textureCoordinateSets),
+    m_name(other.m_name),
+    m_revision(++quartz::rendering::Material::latestRevision)
 {
     LOG_FUNCTION_SCOPE_TRACEthis("");
     LOG_TRACEthis("Name: {}", m_name);
@@ -307,6 +415,8 @@ quartz::rendering::Material::Material(
     LOG_TRACEthis("Normal             master index: {}", m_normalTextureMasterIndex);
     LOG_TRACEthis("Emission           master index: {}", m_emissionTextureMasterIndex);
     LOG_TRACEthis("Occlusion          master index: {}", m_occlusionTextureMasterIndex);
+    LOG_TRACEthis("Texture coordinate sets used: {}", m_textureCoordinateSets.size());
+    LOG_TRACEthis("Texture coordinate slots: base color {}, metallic roughness {}, normal {}, emission {}, occlusion {}", m_baseColorTextureCoordinateSlot, m_metallicRoughnessTextureCoordinateSlot, m_normalTextureCoordinateSlot, m_emissionTextureCoordinateSlot, m_occlusionTextureCoordinateSlot);
     LOG_TRACEthis("Base color factor: {}, {}, {}, {}", m_baseColorFactor.r, m_baseColorFactor.g, m_baseColorFactor.b, m_baseColorFactor.a);
     LOG_TRACEthis("Emissive   factor: {}, {}, {}", m_emissiveFactor.r, m_emissiveFactor.g, m_emissiveFactor.b);
     LOG_TRACEthis("Metallic   factor: {}", m_metallicFactor);
@@ -342,6 +452,11 @@ quartz::rendering::Material::operator=(
     m_normalTextureMasterIndex = other.m_normalTextureMasterIndex;
     m_emissionTextureMasterIndex = other.m_emissionTextureMasterIndex;
     m_occlusionTextureMasterIndex = other.m_occlusionTextureMasterIndex;
+    m_baseColorTextureCoordinateSlot = other.m_baseColorTextureCoordinateSlot;
+    m_metallicRoughnessTextureCoordinateSlot = other.m_metallicRoughnessTextureCoordinateSlot;
+    m_normalTextureCoordinateSlot = other.m_normalTextureCoordinateSlot;
+    m_emissionTextureCoordinateSlot = other.m_emissionTextureCoordinateSlot;
+    m_occlusionTextureCoordinateSlot = other.m_occlusionTextureCoordinateSlot;
     m_baseColorFactor = other.m_baseColorFactor;
     m_emissiveFactor = other.m_emissiveFactor;
     m_metallicFactor = other.m_metallicFactor;
@@ -349,7 +464,45 @@ quartz::rendering::Material::operator=(
     m_alphaMode = other.m_alphaMode;
     m_alphaCutoff = other.m_alphaCutoff;
     m_doubleSided = other.m_doubleSided;
+    m_textureCoordinateSets = other.m_textureCoordinateSets;
     m_name = other.m_name;
 
+    this->markModified();
+
     return *this;
 }
+
+void
+quartz::rendering::Material::markModified() {
+    m_revision = ++quartz::rendering::Material::latestRevision;
+}
+
+void
+quartz::rendering::Material::setBaseColorFactor(const glm::vec4& baseColorFactor) {
+    m_baseColorFactor = baseColorFactor;
+    this->markModified();
+}
+
+void
+quartz::rendering::Material::setEmissiveFactor(const glm::vec3& emissiveFactor) {
+    m_emissiveFactor = emissiveFactor;
+    this->markModified();
+}
+
+void
+quartz::rendering::Material::setMetallicFactor(const float metallicFactor) {
+    m_metallicFactor = metallicFactor;
+    this->markModified();
+}
+
+void
+quartz::rendering::Material::setRoughnessFactor(const float roughnessFactor) {
+    m_roughnessFactor = roughnessFactor;
+    this->markModified();
+}
+
+void
+quartz::rendering::Material::setAlphaCutoff(const float alphaCutoff) {
+    m_alphaCutoff = alphaCutoff;
+    this->markModified();
+}
@@ -36,6 +36,11 @@ public: // classes
             const uint32_t normalTextureMasterIndex_,
             const uint32_t emissionTextureMasterIndex_,
             const uint32_t occlusionTextureMasterIndex_,
+            const uint32_t baseColorTextureCoordinateSlot_,
+            const uint32_t metallicRoughnessTextureCoordinateSlot_,
+            const uint32_t normalTextureCoordinateSlot_,
+            const uint32_t emissionTextureCoordinateSlot_,
+            const uint32_t occlusionTextureCoordinateSlot_,
             const glm::vec4& baseColorFactor_,
             const glm::vec3& emissiveFactor_,
             const float metallicFactor_,
@@ -53,6 +58,12 @@ public: // classes
         alignas(4) uint32_t emissionTextureMasterIndex;
         alignas(4) uint32_t occlusionTextureMasterIndex;
 
+        alignas(4) uint32_t baseColorTextureCoordinateSlot;
+        alignas(4) uint32_t metallicRoughnessTextureCoordinateSlot;
+        alignas(4) uint32_t normalTextureCoordinateSlot;
+        alignas(4) uint32_t emissionTextureCoordinateSlot;
+        alignas(4) uint32_t occlusionTextureCoordinateSlot;
+
         alignas(16) glm::vec4 baseColorFactor;
         alignas(16) glm::vec3 emissiveFactor;
         alignas(4) float metallicFactor;
@@ -72,6 +83,13 @@ public: // enums
 
 // -----+++++===== Static Interface =====+++++----- //
 
+public: // static variables
+    /**
+     * @brief How many distinct TEXCOORD_n sets a material's textures can sample with, which is how many
+     *   texture coordinates every vertex has room for
+     */
+    static constexpr uint32_t maxTextureCoordinateSetCount = 2;
+
 public: // static functions
     static std::string getAlphaModeGLTFString(const quartz::rendering::Material::AlphaMode mode);
     static quartz::rendering::Material::AlphaMode getAlphaModeFromGLTFString(const std::string& modeString);
@@ -84,6 +102,11 @@ public: // static functions
         const uint32_t normalTextureMasterIndex,
         const uint32_t emissionTextureMasterIndex,
         const uint32_t occlusionTextureMasterIndex,
+        const uint32_t baseColorTextureCoordinateSet,
+        const uint32_t metallicRoughnessTextureCoordinateSet,
+        const uint32_t normalTextureCoordinateSet,
+        const uint32_t emissionTextureCoordinateSet,
+        const uint32_t occlusionTextureCoordinateSet,
         const glm::vec4& baseColorFactor,
         const glm::vec3& emissiveFactor,
         const float metallicFactor,
@@ -101,11 +124,29 @@ public: // static functions
     static std::shared_ptr<quartz::rendering::Material> getMaterialPtr(const uint32_t index) { return quartz::rendering::Material::masterMaterialList[index]; }
     static const std::vector<std::shared_ptr<quartz::rendering::Material>>& getMasterMaterialList() { return quartz::rendering::Material::masterMaterialList; }
 
+    /**
+     * @brief Bumped every time any material is created or modified. Compare it against the revision a
+     *   buffer was last written at to know if any material needs to be written again, then compare each
+     *   material's own revision against it to know which ones
+     */
+    static uint64_t getLatestRevision() { return quartz::rendering::Material::latestRevision; }
+
 private: // static functions
+    /**
+     * @brief The slot of textureCoordinateSets holding the texture's set, adding the set if it isn't there
+     *   yet. Default textures are a single texel so they don't reference a set at all
+     */
+    static uint32_t assignTextureCoordinateSlot(
+        std::vector<uint32_t>& textureCoordinateSets,
+        const uint32_t textureMasterIndex,
+        const uint32_t defaultTextureMasterIndex,
+        const uint32_t textureCoordinateSet
+    );
 
 private: // static variables
     static uint32_t defaultMaterialMasterIndex;
     static std::vector<std::shared_ptr<Material>> masterMaterialList;
+    static uint64_t latestRevision;
 
 // -----+++++===== Instance Interface =====+++++----- //
 
@@ -118,6 +159,11 @@ public: // member functions
         const uint32_t normalTextureMasterIndex,
         const uint32_t emissionTextureMasterIndex,
         const uint32_t occlusionTextureMasterIndex,
+        const uint32_t baseColorTextureCoordinateSet,
+        const uint32_t metallicRoughnessTextureCoordinateSet,
+        const uint32_t normalTextureCoordinateSet,
+        const uint32_t emissionTextureCoordinateSet,
+        const uint32_t occlusionTextureCoordinateSet,
         const glm::vec4& baseColorFactor,
         const glm::vec3& emissiveFactor,
         const float metallicFactor,
@@ -140,6 +186,17 @@ public: // member functions
     uint32_t getEmissionTextureMasterIndex() const { return m_emissionTextureMasterIndex; }
     uint32_t getOcclusionTextureMasterIndex() const { return m_occlusionTextureMasterIndex; }
 
+    /**
+     * @brief The distinct TEXCOORD_n sets this material's textures reference, in the order of the vertex
+     *   texture coordinate slots they are loaded into
+     */
+    const std::vector<uint32_t>& getTextureCoordinateSets() const { return m_textureCoordinateSets; }
+    uint32_t getBaseColorTextureCoordinateSlot() const { return m_baseColorTextureCoordinateSlot; }
+    uint32_t getMetallicRoughnessTextureCoordinateSlot() const { return m_metallicRoughnessTextureCoordinateSlot; }
+    uint32_t getNormalTextureCoordinateSlot() const { return m_normalTextureCoordinateSlot; }
+    uint32_t getEmissionTextureCoordinateSlot() const { return m_emissionTextureCoordinateSlot; }
+    uint32_t getOcclusionTextureCoordinateSlot() const { return m_occlusionTextureCoordinateSlot; }
+
     const glm::vec4& getBaseColorFactor() const { return m_baseColorFactor; }
     const glm::vec3& getEmissiveFactor() const { return m_emissiveFactor; }
     float getMetallicFactor() const { return m_metallicFactor; }
@@ -151,6 +208,17 @@ public: // member functions
 
     const std::string& getName() const { return m_name; }
 
+    uint64_t getRevision() const { return m_revision; }
+
+    void setBaseColorFactor(const glm::vec4& baseColorFactor);
+    void setEmissiveFactor(const glm::vec3& emissiveFactor);
+    void setMetallicFactor(const float metallicFactor);
+    void setRoughnessFactor(const float roughnessFactor);
+    void setAlphaCutoff(const float alphaCutoff);
+
+private: // member functions
+    void markModified();
+
 private: // member variables
     // 20 bytes of texture indices
     alignas(4) uint32_t m_baseColorTextureMasterIndex;
@@ -159,6 +227,13 @@ private: // member variables
     alignas(4) uint32_t m_emissionTextureMasterIndex;
     alignas(4) uint32_t m_occlusionTextureMasterIndex;
 
+    // 20 bytes of texture coordinate slots
+    alignas(4) uint32_t m_baseColorTextureCoordinateSlot;
+    alignas(4) uint32_t m_metallicRoughnessTextureCoordinateSlot;
+    alignas(4) uint32_t m_normalTextureCoordinateSlot;
+    alignas(4) uint32_t m_emissionTextureCoordinateSlot;
+    alignas(4) uint32_t m_occlusionTextureCoordinateSlot;
+
     // 40 bytes of factors
     alignas(16) glm::vec4 m_baseColorFactor;
     alignas(16) glm::vec3 m_emissiveFactor;
@@ -170,6 +245,12 @@ private: // member variables
     alignas(4) float m_alphaCutoff;
     alignas(4) bool m_doubleSided;
 
+    // the sets in each texture coordinate slot
+    std::vector<uint32_t> m_textureCoordinateSets;
+
     // name
     std::string m_name;
+
+    // the latest revision at the time this was last modified
+    uint64_t m_revision;
 };
\ No newline at end of file
@@ -1,16 +1,114 @@
+#include <limits>
+#include <optional>
 #include <vector>
 
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtx/string_cast.hpp>
+
 #include <tiny_gltf.h>
 
 #include "quartz/rendering/model/Mesh.hpp"
 #include "quartz/rendering/model/Primitive.hpp"
+#include "quartz/rendering/model/Vertex.hpp"
+
+std::optional<quartz::rendering::Vertex::PositionQuantization>
+quartz::rendering::Mesh::determineIntegerGridPositionQuantization(
+    const tinygltf::Accessor& accessor
+) {
+    /**
+     * @brief Using the accessor's own integer grid as the range maps every one of its values exactly onto
+     *   one of our 16 bit values, so they pass through unchanged and are dequantized in the vertex shader
+     *   instead. The node's transformation still takes care of the model's own dequantization
+     */
+    switch (accessor.componentType) {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            return quartz::rendering::Vertex::PositionQuantization{glm::vec3(0.0f), glm::vec3(accessor.normalized ? 1.0f : 65535.0f)};
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            return accessor.normalized ?
+                quartz::rendering::Vertex::PositionQuantization{glm::vec3(-32768.0f / 32767.0f), glm::vec3(65535.0f / 32767.0f)} :
+                quartz::rendering::Vertex::PositionQuantization{glm::vec3(-32768.0f), glm::vec3(65535.0f)};
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            return quartz::rendering::Vertex::PositionQuantization{glm::vec3(0.0f), glm::vec3(accessor.normalized ? 1.0f : 255.0f)};
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            return accessor.normalized ?
+                quartz::rendering::Vertex::PositionQuantization{glm::vec3(-128.0f / 127.0f), glm::vec3(255.0f / 127.0f)} :
+                quartz::rendering::Vertex::PositionQuantization{glm::vec3(-128.0f), glm::vec3(255.0f)};
+        default:
+            return std::nullopt;
+    }
+}
+
+quartz::rendering::Vertex::PositionQuantization
+quartz::rendering::Mesh::loadPositionQuantization(
+    const tinygltf::Model& gltfModel,
+    const tinygltf::Mesh& gltfMesh
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_MESH, "");
+
+    std::vector<const tinygltf::Primitive*> gltfPrimitivePtrs;
+    for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+        if (gltfPrimitive.indices > -1) {
+            gltfPrimitivePtrs.push_back(&gltfPrimitive);
+        }
+    }
+
+    if (gltfPrimitivePtrs.empty()) {
+        LOG_TRACE(MODEL_MESH, "No primitives to quantize positions for");
+        return {glm::vec3(0.0f), glm::vec3(1.0f)};
+    }
+
+    // ----- pass quantized positions through, as long as every primitive uses the same grid ----- //
+
+    const tinygltf::Accessor& firstAccessor = gltfModel.accessors[gltfPrimitivePtrs[0]->attributes.find("POSITION")->second];
+    const std::optional<quartz::rendering::Vertex::PositionQuantization> o_integerGridPositionQuantization = quartz::rendering::Mesh::determineIntegerGridPositionQuantization(firstAccessor);
+
+    bool allOnSameIntegerGrid = o_integerGridPositionQuantization.has_value();
+    for (const tinygltf::Primitive* p_gltfPrimitive : gltfPrimitivePtrs) {
+        const tinygltf::Accessor& accessor = gltfModel.accessors[p_gltfPrimitive->attributes.find("POSITION")->second];
+        allOnSameIntegerGrid = allOnSameIntegerGrid &&
+            accessor.componentType == firstAccessor.componentType &&
+            accessor.normalized == firstAccessor.normalized;
+    }
+
+    if (allOnSameIntegerGrid) {
+        LOG_TRACE(MODEL_MESH, "Passing through quantized positions of component type {} ({}normalized)", firstAccessor.componentType, firstAccessor.normalized ? "" : "not ");
+        return *o_integerGridPositionQuantization;
+    }
+
+    // ----- otherwise quantize to the bounds of every position in the mesh, so none of them get clamped ----- //
+
+    quartz::rendering::Primitive::BoundingBox meshBoundingBox = {
+        glm::vec3(std::numeric_limits<float>::max()),
+        glm::vec3(std::numeric_limits<float>::lowest())
+    };
+    for (const tinygltf::Primitive* p_gltfPrimitive : gltfPrimitivePtrs) {
+        const quartz::rendering::Primitive::BoundingBox boundingBox = quartz::rendering::Primitive::calculateBoundingBox(
+            gltfModel,
+            *p_gltfPrimitive
+        );
+        meshBoundingBox.minimum = glm::min(meshBoundingBox.minimum, boundingBox.minimum);
+        meshBoundingBox.maximum = glm::max(meshBoundingBox.maximum, boundingBox.maximum);
+    }
+
+    // A flat mesh still needs something to divide by on its flat axis
+    const glm::vec3 extent = meshBoundingBox.maximum - meshBoundingBox.minimum;
+    const quartz::rendering::Vertex::PositionQuantization positionQuantization = {
+        meshBoundingBox.minimum,
+        glm::max(extent, glm::vec3(std::numeric_limits<float>::min()))
+    };
+    LOG_TRACE(MODEL_MESH, "Quantizing the positions of {} primitives to their bounding box, offset {} and scale {}", gltfPrimitivePtrs.size(), glm::to_string(positionQuantization.offset), glm::to_string(positionQuantization.scale));
+
+    return positionQuantization;
+}
 
 std::vector<quartz::rendering::Primitive>
 quartz::rendering::Mesh::loadPrimitives(
     const quartz::rendering::Device& renderingDevice,
     const tinygltf::Model& gltfModel,
     const tinygltf::Mesh& gltfMesh,
-    const std::vector<uint32_t>& materialMasterIndices
+    const std::vector<uint32_t>& materialMasterIndices,
+    const quartz::rendering::Vertex::PositionQuantization& positionQuantization
 ) {
     LOG_FUNCTION_SCOPE_TRACE(MODEL_MESH, "");
 
@@ -30,7 +128,8 @@ quartz::rendering::Mesh::loadPrimitives(
             renderingDevice,
             gltfModel,
             gltfPrimitive,
-            materialMasterIndices
+            materialMasterIndices,
+            positionQuantization
         );
     }
 
@@ -43,12 +142,19 @@ quartz::rendering::Mesh::Mesh(
     const tinygltf::Mesh& gltfMesh,
     const std::vector<uint32_t>& materialMasterIndices
 ) :
+    m_positionQuantization(
+        quartz::rendering::Mesh::loadPositionQuantization(
+            gltfModel,
+            gltfMesh
+        )
+    ),
     m_primitives(
         quartz::rendering::Mesh::loadPrimitives(
             renderingDevice,
             gltfModel,
             gltfMesh,
-            materialMasterIndices
+            materialMasterIndices,
+            m_positionQuantization
         )
     )
 {
@@ -58,6 +164,7 @@ quartz::rendering::Mesh::Mesh(
 quartz::rendering::Mesh::Mesh(
     quartz::rendering::Mesh&& other
 ) :
+    m_positionQuantization(other.m_positionQuantization),
     m_primitives(std::move(other.m_primitives))
 {
     LOG_FUNCTION_CALL_TRACEthis("");
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include <tiny_gltf.h>
 
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/model/Primitive.hpp"
+#include "quartz/rendering/model/Vertex.hpp"
 
 namespace quartz {
 namespace rendering {
@@ -28,14 +30,32 @@ public: // member functions
 
     const std::vector<quartz::rendering::Primitive>& getPrimitives() const { return m_primitives; }
 
+    const quartz::rendering::Vertex::PositionQuantization& getPositionQuantization() const { return m_positionQuantization; }
+
 private: // static functions
+    /**
+     * @brief The integer grid of positions quantized with KHR_mesh_quantization, if they are
+     */
+    static std::optional<quartz::rendering::Vertex::PositionQuantization> determineIntegerGridPositionQuantization(
+        const tinygltf::Accessor& accessor
+    );
+    /**
+     * @brief One range for every primitive in the mesh, so the vertices along an edge two primitives
+     *   share land on the same grid and decode identically in both of them
+     */
+    static quartz::rendering::Vertex::PositionQuantization loadPositionQuantization(
+        const tinygltf::Model& gltfModel,
+        const tinygltf::Mesh& gltfMesh
+    );
     std::vector<quartz::rendering::Primitive> loadPrimitives(
         const quartz::rendering::Device& renderingDevice,
         const tinygltf::Model& gltfModel,
         const tinygltf::Mesh& gltfMesh,
-        const std::vector<uint32_t>& materialMasterIndices
+        const std::vector<uint32_t>& materialMasterIndices,
+        const quartz::rendering::Vertex::PositionQuantization& positionQuantization
     );
 
 private: // member variables
+    quartz::rendering::Vertex::PositionQuantization m_positionQuantization;
     std::vector<quartz::rendering::Primitive> m_primitives;
 };
\ No newline at end of file
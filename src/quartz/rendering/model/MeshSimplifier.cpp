@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "util/logger/Logger.hpp"
+
+#include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/model/MeshSimplifier.hpp"
+
+quartz::rendering::MeshSimplifier::Quadric&
+quartz::rendering::MeshSimplifier::Quadric::operator+=(
+    const quartz::rendering::MeshSimplifier::Quadric& other
+) {
+    for (uint32_t i = 0; i < coefficients.size(); ++i) {
+        coefficients[i] += other.coefficients[i];
+    }
+    weight += other.weight;
+
+    return *this;
+}
+
+quartz::rendering::MeshSimplifier::Quadric
+quartz::rendering::MeshSimplifier::createPlaneQuadric(
+    const glm::vec3& normal,
+    const float distance,
+    const float weight
+) {
+    const double a = normal.x;
+    const double b = normal.y;
+    const double c = normal.z;
+    const double d = distance;
+
+    return {
+        {
+            weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+                            weight * b * b, weight * b * c, weight * b * d,
+                                            weight * c * c, weight * c * d,
+                                                            weight * d * d
+        },
+        weight
+    };
+}
+
+double
+quartz::rendering::MeshSimplifier::evaluateQuadric(
+    const quartz::rendering::MeshSimplifier::Quadric& quadric,
+    const glm::vec3& position
+) {
+    const double x = position.x;
+    const double y = position.y;
+    const double z = position.z;
+    const std::array<double, 10>& q = quadric.coefficients;
+
+    const double weightedSquaredDistance =
+        q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+                             q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+                                                  q[7] * z * z + 2.0 * q[8] * z +
+                                                                       q[9];
+
+    // Normalize by the total area so the error is a mean squared distance, regardless of triangle size
+    if (quadric.weight <= 0.0) {
+        return 0.0;
+    }
+
+    return std::max(weightedSquaredDistance / quadric.weight, 0.0);
+}
+
+std::vector<bool>
+quartz::rendering::MeshSimplifier::determineLockedVertices(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices
+) {
+    std::vector<bool> lockedVertices(positions.size(), false);
+
+    // ----- seams, where several vertices share a position but not their other attributes ----- //
+
+    std::vector<uint32_t> sortedVertexIndices(positions.size());
+    std::iota(sortedVertexIndices.begin(), sortedVertexIndices.end(), 0);
+
+    const auto positionLess = [&](const uint32_t lhs, const uint32_t rhs) {
+        const glm::vec3& a = positions[lhs];
+        const glm::vec3& b = positions[rhs];
+        return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+    };
+    std::sort(sortedVertexIndices.begin(), sortedVertexIndices.end(), positionLess);
+
+    uint32_t numSeamVertices = 0;
+    for (uint32_t i = 1; i < sortedVertexIndices.size(); ++i) {
+        if (positions[sortedVertexIndices[i]] == positions[sortedVertexIndices[i - 1]]) {
+            numSeamVertices += lockedVertices[sortedVertexIndices[i - 1]] ? 1 : 2;
+            lockedVertices[sortedVertexIndices[i - 1]] = true;
+            lockedVertices[sortedVertexIndices[i]] = true;
+        }
+    }
+
+    // ----- borders (edges with one triangle) and non-manifold edges (edges with more than two) ----- //
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(indices.size());
+
+    for (uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            const uint32_t a = indices[i + j];
+            const uint32_t b = indices[i + (j + 1) % 3];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    uint32_t numBorderEdges = 0;
+    for (uint32_t i = 0; i < edges.size();) {
+        uint32_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) {
+            ++j;
+        }
+
+        if (j - i != 2) {
+            lockedVertices[edges[i].first] = true;
+            lockedVertices[edges[i].second] = true;
+            ++numBorderEdges;
+        }
+
+        i = j;
+    }
+
+    LOG_TRACE(MODEL_PRIMITIVE, "Locked {} seam vertices and the vertices of {} border edges", numSeamVertices, numBorderEdges);
+
+    return lockedVertices;
+}
+
+std::vector<quartz::rendering::MeshSimplifier::Quadric>
+quartz::rendering::MeshSimplifier::calculateVertexQuadrics(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices
+) {
+    std::vector<quartz::rendering::MeshSimplifier::Quadric> quadrics(
+        positions.size(),
+        quartz::rendering::MeshSimplifier::Quadric{{}, 0.0}
+    );
+
+    for (uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& p0 = positions[indices[i]];
+        const glm::vec3& p1 = positions[indices[i + 1]];
+        const glm::vec3& p2 = positions[indices[i + 2]];
+
+        const glm::vec3 scaledNormal = glm::cross(p1 - p0, p2 - p0);
+        const float doubleArea = glm::length(scaledNormal);
+        if (doubleArea <= 0.0f) {
+            continue;
+        }
+
+        const glm::vec3 normal = scaledNormal / doubleArea;
+        const quartz::rendering::MeshSimplifier::Quadric planeQuadric = quartz::rendering::MeshSimplifier::createPlaneQuadric(
+            normal,
+            -glm::dot(normal, p0),
+            doubleArea * 0.5f
+        );
+
+        quadrics[indices[i]] += planeQuadric;
+        quadrics[indices[i + 1]] += planeQuadric;
+        quadrics[indices[i + 2]] += planeQuadric;
+    }
+
+    return quadrics;
+}
+
+bool
+quartz::rendering::MeshSimplifier::collapseFlipsTriangles(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices,
+    const std::vector<uint32_t>& vertexTriangleOffsets,
+    const std::vector<uint32_t>& vertexTriangles,
+    const quartz::rendering::MeshSimplifier::Collapse& collapse
+) {
+    const glm::vec3& keptPosition = positions[collapse.keptVertexIndex];
+
+    for (uint32_t i = vertexTriangleOffsets[collapse.removedVertexIndex]; i < vertexTriangleOffsets[collapse.removedVertexIndex + 1]; ++i) {
+        const uint32_t firstIndex = vertexTriangles[i] * 3;
+        const std::array<uint32_t, 3> triangle = {indices[firstIndex], indices[firstIndex + 1], indices[firstIndex + 2]};
+
+        // These are the triangles the collapse removes entirely
+        if (
+            triangle[0] == collapse.keptVertexIndex ||
+            triangle[1] == collapse.keptVertexIndex ||
+            triangle[2] == collapse.keptVertexIndex
+        ) {
+            continue;
+        }
+
+        std::array<glm::vec3, 3> trianglePositions = {positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]};
+        const glm::vec3 normalBefore = glm::cross(trianglePositions[1] - trianglePositions[0], trianglePositions[2] - trianglePositions[0]);
+
+        for (uint32_t j = 0; j < 3; ++j) {
+            if (triangle[j] == collapse.removedVertexIndex) {
+                trianglePositions[j] = keptPosition;
+            }
+        }
+        const glm::vec3 normalAfter = glm::cross(trianglePositions[1] - trianglePositions[0], trianglePositions[2] - trianglePositions[0]);
+
+        if (glm::dot(normalBefore, normalAfter) <= 0.0f) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<uint32_t>
+quartz::rendering::MeshSimplifier::simplify(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<uint32_t>& indices,
+    const uint32_t targetIndexCount,
+    const float maxError
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "{} indices, {} target indices, {} max error", indices.size(), targetIndexCount, maxError);
+
+    std::vector<uint32_t> simplifiedIndices(indices);
+    if (simplifiedIndices.size() <= targetIndexCount) {
+        return simplifiedIndices;
+    }
+
+    const std::vector<bool> lockedVertices = quartz::rendering::MeshSimplifier::determineLockedVertices(positions, simplifiedIndices);
+    std::vector<quartz::rendering::MeshSimplifier::Quadric> quadrics = quartz::rendering::MeshSimplifier::calculateVertexQuadrics(positions, simplifiedIndices);
+    const double maxErrorSquared = static_cast<double>(maxError) * static_cast<double>(maxError);
+
+    std::vector<uint32_t> vertexTriangleOffsets(positions.size() + 1);
+    std::vector<uint32_t> vertexTriangles;
+    std::vector<quartz::rendering::MeshSimplifier::Collapse> collapses;
+    std::vector<uint32_t> remappedVertexIndices(positions.size());
+    std::vector<bool> touchedVertices(positions.size());
+
+    /**
+     * @brief Every pass gathers and sorts the cheapest collapse of every edge, then applies as many as it
+     *   can from cheapest to most expensive. Collapses touching a vertex an earlier collapse of the same pass
+     *   already changed are left for the next pass, so every collapse is judged on the mesh it actually changes
+     */
+    uint32_t numPasses = 0;
+    while (simplifiedIndices.size() > targetIndexCount) {
+        ++numPasses;
+        const uint32_t triangleCount = simplifiedIndices.size() / 3;
+
+        // ----- which triangles use each vertex ----- //
+
+        std::fill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end(), 0);
+        for (const uint32_t index : simplifiedIndices) {
+            ++vertexTriangleOffsets[index + 1];
+        }
+        std::partial_sum(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end(), vertexTriangleOffsets.begin());
+
+        vertexTriangles.resize(simplifiedIndices.size());
+        std::vector<uint32_t> vertexTriangleCursors(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+        for (uint32_t i = 0; i < simplifiedIndices.size(); ++i) {
+            vertexTriangles[vertexTriangleCursors[simplifiedIndices[i]]++] = i / 3;
+        }
+
+        // ----- the cheapest direction to collapse every edge in ----- //
+
+        collapses.clear();
+        for (uint32_t i = 0; i < simplifiedIndices.size(); i += 3) {
+            for (uint32_t j = 0; j < 3; ++j) {
+                const uint32_t a = simplifiedIndices[i + j];
+                const uint32_t b = simplifiedIndices[i + (j + 1) % 3];
+
+                // Interior edges show up once in each direction, so only look at them once
+                if (a > b || (lockedVertices[a] && lockedVertices[b])) {
+                    continue;
+                }
+
+                quartz::rendering::MeshSimplifier::Quadric combinedQuadric = quadrics[a];
+                combinedQuadric += quadrics[b];
+
+                quartz::rendering::MeshSimplifier::Collapse collapse = {a, b, std::numeric_limits<double>::max()};
+                if (!lockedVertices[a]) {
+                    collapse.error = quartz::rendering::MeshSimplifier::evaluateQuadric(combinedQuadric, positions[b]);
+                }
+                if (!lockedVertices[b]) {
+                    const double reverseError = quartz::rendering::MeshSimplifier::evaluateQuadric(combinedQuadric, positions[a]);
+                    if (reverseError < collapse.error) {
+                        collapse = {b, a, reverseError};
+                    }
+                }
+
+                if (collapse.error <= maxErrorSquared) {
+                    collapses.push_back(collapse);
+                }
+            }
+        }
+
+        if (collapses.empty()) {
+            break;
+        }
+
+        std::sort(
+            collapses.begin(),
+            collapses.end(),
+            [](const quartz::rendering::MeshSimplifier::Collapse& lhs, const quartz::rendering::MeshSimplifier::Collapse& rhs) {
+                return lhs.error < rhs.error;
+            }
+        );
+
+        // ----- apply the cheapest collapses which don't interfere with each other ----- //
+
+        std::iota(remappedVertexIndices.begin(), remappedVertexIndices.end(), 0);
+        std::fill(touchedVertices.begin(), touchedVertices.end(), false);
+
+        const uint32_t numTrianglesToRemove = triangleCount - targetIndexCount / 3;
+        uint32_t numTrianglesRemoved = 0;
+        uint32_t numCollapsesApplied = 0;
+
+        for (const quartz::rendering::MeshSimplifier::Collapse& collapse : collapses) {
+            if (numTrianglesRemoved >= numTrianglesToRemove) {
+                break;
+            }
+
+            if (touchedVertices[collapse.removedVertexIndex] || touchedVertices[collapse.keptVertexIndex]) {
+                continue;
+            }
+
+            if (quartz::rendering::MeshSimplifier::collapseFlipsTriangles(positions, simplifiedIndices, vertexTriangleOffsets, vertexTriangles, collapse)) {
+                continue;
+            }
+
+            remappedVertexIndices[collapse.removedVertexIndex] = collapse.keptVertexIndex;
+            quadrics[collapse.keptVertexIndex] += quadrics[collapse.removedVertexIndex];
+            ++numCollapsesApplied;
+
+            for (uint32_t i = vertexTriangleOffsets[collapse.removedVertexIndex]; i < vertexTriangleOffsets[collapse.removedVertexIndex + 1]; ++i) {
+                const uint32_t firstIndex = vertexTriangles[i] * 3;
+                bool usesKeptVertex = false;
+
+                for (uint32_t j = 0; j < 3; ++j) {
+                    touchedVertices[simplifiedIndices[firstIndex + j]] = true;
+                    usesKeptVertex |= simplifiedIndices[firstIndex + j] == collapse.keptVertexIndex;
+                }
+
+                numTrianglesRemoved += usesKeptVertex ? 1 : 0;
+            }
+        }
+
+        if (numCollapsesApplied == 0) {
+            break;
+        }
+
+        // ----- rewrite the triangles, throwing away the ones which collapsed into lines ----- //
+
+        uint32_t writeIndex = 0;
+        for (uint32_t i = 0; i < simplifiedIndices.size(); i += 3) {
+            const uint32_t a = remappedVertexIndices[simplifiedIndices[i]];
+            const uint32_t b = remappedVertexIndices[simplifiedIndices[i + 1]];
+            const uint32_t c = remappedVertexIndices[simplifiedIndices[i + 2]];
+
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+
+            simplifiedIndices[writeIndex++] = a;
+            simplifiedIndices[writeIndex++] = b;
+            simplifiedIndices[writeIndex++] = c;
+        }
+        simplifiedIndices.resize(writeIndex);
+    }
+
+    LOG_TRACE(MODEL_PRIMITIVE, "Simplified {} indices down to {} in {} passes", indices.size(), simplifiedIndices.size(), numPasses);
+
+    return simplifiedIndices;
+}
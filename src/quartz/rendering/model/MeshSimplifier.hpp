@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace quartz {
+namespace rendering {
+    class MeshSimplifier;
+}
+}
+
+/**
+ * @brief Reduces the number of triangles in an indexed triangle list by repeatedly collapsing the edge
+ *   whose removal changes the surface the least, measured with quadric error metrics (Garland & Heckbert).
+ *   Every edge is collapsed onto one of its existing vertices, so the simplified indices keep referencing
+ *   the original vertices and every level of detail can share a single vertex buffer.
+ *
+ * @brief Vertices on the border of the mesh and vertices on attribute seams (several vertices sharing
+ *   a position) are never removed, so the outline of open meshes stays put and textures don't tear.
+ */
+class quartz::rendering::MeshSimplifier {
+public: // static functions
+    /**
+     * @brief Collapse edges until at most targetIndexCount indices remain or the next collapse would move
+     *   the surface further than maxError (in the same units as the positions), whichever comes first
+     */
+    static std::vector<uint32_t> simplify(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<uint32_t>& indices,
+        const uint32_t targetIndexCount,
+        const float maxError
+    );
+
+public: // member functions
+    MeshSimplifier() = delete;
+
+private: // classes
+    /**
+     * @brief The upper triangle of a symmetric 4x4 matrix, summing the squared distances to a set of planes
+     *   weighted by the area of the triangle each plane came from, along with the total weight
+     */
+    struct Quadric {
+    public: // member functions
+        Quadric& operator+=(const Quadric& other);
+
+    public: // member variables
+        std::array<double, 10> coefficients;
+        double weight;
+    };
+
+    struct Collapse {
+    public: // member variables
+        uint32_t removedVertexIndex;
+        uint32_t keptVertexIndex;
+        double error;
+    };
+
+private: // static functions
+    static quartz::rendering::MeshSimplifier::Quadric createPlaneQuadric(
+        const glm::vec3& normal,
+        const float distance,
+        const float weight
+    );
+    static double evaluateQuadric(
+        const quartz::rendering::MeshSimplifier::Quadric& quadric,
+        const glm::vec3& position
+    );
+    static std::vector<bool> determineLockedVertices(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<uint32_t>& indices
+    );
+    static std::vector<quartz::rendering::MeshSimplifier::Quadric> calculateVertexQuadrics(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<uint32_t>& indices
+    );
+    static bool collapseFlipsTriangles(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<uint32_t>& indices,
+        const std::vector<uint32_t>& vertexTriangleOffsets,
+        const std::vector<uint32_t>& vertexTriangles,
+        const quartz::rendering::MeshSimplifier::Collapse& collapse
+    );
+};
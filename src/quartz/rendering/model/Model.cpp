@@ -1,14 +1,31 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <system_error>
 #include <queue>
+#include <utility>
 
+#include <glm/common.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
 #include <tiny_gltf.h>
 
 #include "util/file_system/FileSystem.hpp"
 
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/model/Model.hpp"
 
+std::map<
+    std::pair<std::string, std::filesystem::file_time_type>,
+    std::weak_ptr<const quartz::rendering::Model>
+> quartz::rendering::Model::modelCache;
+bool quartz::rendering::Model::shouldRetainCpuData = false;
+
 tinygltf::Model
 quartz::rendering::Model::loadGLTFModel(
     const std::string& filepath
@@ -60,6 +77,23 @@ quartz::rendering::Model::loadGLTFModel(
     return gltfModel;
 }
 
+std::size_t
+quartz::rendering::Model::calculateGLTFModelSizeBytes(
+    const tinygltf::Model& gltfModel
+) {
+    std::size_t sizeBytes = 0;
+
+    for (const tinygltf::Buffer& gltfBuffer : gltfModel.buffers) {
+        sizeBytes += gltfBuffer.data.size();
+    }
+
+    for (const tinygltf::Image& gltfImage : gltfModel.images) {
+        sizeBytes += gltfImage.image.size();
+    }
+
+    return sizeBytes;
+}
+
 std::vector<uint32_t>
 quartz::rendering::Model::loadTextures(
     const quartz::rendering::Device& renderingDevice,
@@ -188,6 +222,34 @@ quartz::rendering::Model::getTextureMasterIndex(
     return masterIndex;
 }
 
+uint32_t
+quartz::rendering::Model::getTextureCoordinateSet(
+    const tinygltf::Material& gltfMaterial,
+    const quartz::rendering::Texture::Type textureType
+) {
+    int32_t textureCoordinateSet = 0; // The n in the TEXCOORD_n attribute the texture is sampled with
+
+    switch(textureType) {
+        case quartz::rendering::Texture::Type::BaseColor:
+            textureCoordinateSet = gltfMaterial.pbrMetallicRoughness.baseColorTexture.texCoord;
+            break;
+        case quartz::rendering::Texture::Type::MetallicRoughness:
+            textureCoordinateSet = gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.texCoord;
+            break;
+        case quartz::rendering::Texture::Type::Normal:
+            textureCoordinateSet = gltfMaterial.normalTexture.texCoord;
+            break;
+        case quartz::rendering::Texture::Type::Emission:
+            textureCoordinateSet = gltfMaterial.emissiveTexture.texCoord;
+            break;
+        case quartz::rendering::Texture::Type::Occlusion:
+            textureCoordinateSet = gltfMaterial.occlusionTexture.texCoord;
+            break;
+    }
+
+    return std::max(textureCoordinateSet, 0);
+}
+
 std::vector<uint32_t>
 quartz::rendering::Model::loadMaterialMasterIndices(
     const quartz::rendering::Device& renderingDevice,
@@ -259,6 +321,12 @@ quartz::rendering::Model::loadMaterialMasterIndices(
 
         const double roughnessFactor = gltfMaterial.pbrMetallicRoughness.roughnessFactor;
 
+        const uint32_t baseColorTextureCoordinateSet = quartz::rendering::Model::getTextureCoordinateSet(gltfMaterial, quartz::rendering::Texture::Type::BaseColor);
+        const uint32_t metallicRoughnessTextureCoordinateSet = quartz::rendering::Model::getTextureCoordinateSet(gltfMaterial, quartz::rendering::Texture::Type::MetallicRoughness);
+        const uint32_t normalTextureCoordinateSet = quartz::rendering::Model::getTextureCoordinateSet(gltfMaterial, quartz::rendering::Texture::Type::Normal);
+        const uint32_t emissionTextureCoordinateSet = quartz::rendering::Model::getTextureCoordinateSet(gltfMaterial, quartz::rendering::Texture::Type::Emission);
+        const uint32_t occlusionTextureCoordinateSet = quartz::rendering::Model::getTextureCoordinateSet(gltfMaterial, quartz::rendering::Texture::Type::Occlusion);
+
         const quartz::rendering::Material::AlphaMode alphaMode = quartz::rendering::Material::getAlphaModeFromGLTFString(gltfMaterial.alphaMode);
 
         const float alphaCutoff = gltfMaterial.alphaCutoff;
@@ -271,6 +339,7 @@ quartz::rendering::Model::loadMaterialMasterIndices(
         LOG_TRACE(MODEL, "  Normal             : {}", normalMasterIndex);
         LOG_TRACE(MODEL, "  Emission           : {}", emissionMasterIndex);
         LOG_TRACE(MODEL, "  Occlusion          : {}", occlusionMasterIndex);
+        LOG_TRACE(MODEL, "Using texture coordinate sets {}, {}, {}, {}, {}", baseColorTextureCoordinateSet, metallicRoughnessTextureCoordinateSet, normalTextureCoordinateSet, emissionTextureCoordinateSet, occlusionTextureCoordinateSet);
 
         uint32_t currentMaterialMasterIndex = quartz::rendering::Material::createMaterial(
             renderingDevice,
@@ -280,6 +349,11 @@ quartz::rendering::Model::loadMaterialMasterIndices(
             normalMasterIndex,
             emissionMasterIndex,
             occlusionMasterIndex,
+            baseColorTextureCoordinateSet,
+            metallicRoughnessTextureCoordinateSet,
+            normalTextureCoordinateSet,
+            emissionTextureCoordinateSet,
+            occlusionTextureCoordinateSet,
             baseColorFactor,
             emissiveFactor,
             metallicFactor,
@@ -332,13 +406,101 @@ quartz::rendering::Model::loadScenes(
     return scenes;
 }
 
+std::vector<quartz::rendering::Model::DrawEntry>
+quartz::rendering::Model::loadDrawEntries(
+    const quartz::rendering::Scene& scene
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL, "");
+
+    std::vector<quartz::rendering::Model::DrawEntry> drawEntries;
+
+    std::queue<const quartz::rendering::Node*> nodeQueue;
+    for (const std::shared_ptr<quartz::rendering::Node>& p_rootNode : scene.getRootNodePtrs()) {
+        nodeQueue.push(p_rootNode.get());
+    }
+
+    while (!nodeQueue.empty()) {
+        const quartz::rendering::Node* p_node = nodeQueue.front();
+        nodeQueue.pop();
+
+        for (const std::shared_ptr<quartz::rendering::Node>& p_child : p_node->getChildrenNodePtrs()) {
+            nodeQueue.push(p_child.get());
+        }
+
+        if (!p_node->getMeshPtr() || p_node->getMeshPtr()->getPrimitives().empty()) {
+            continue;
+        }
+
+        const std::vector<quartz::rendering::Primitive>& primitives = p_node->getMeshPtr()->getPrimitives();
+
+        drawEntries.push_back({
+            p_node->getTransformationMatrix(),
+            primitives.data(),
+            static_cast<uint32_t>(primitives.size()),
+            p_node
+        });
+    }
+
+    LOG_TRACE(MODEL, "Flattened scene into {} draw entries", drawEntries.size());
+
+    return drawEntries;
+}
+
+quartz::rendering::Primitive::BoundingBox
+quartz::rendering::Model::calculateBoundingBox(
+    const std::vector<quartz::rendering::Model::DrawEntry>& drawEntries
+) {
+    quartz::rendering::Primitive::BoundingBox boundingBox = {
+        glm::vec3(std::numeric_limits<float>::max()),
+        glm::vec3(std::numeric_limits<float>::lowest())
+    };
+
+    const std::vector<glm::mat4> identityInstanceTransformationMatrices = { glm::mat4(1.0f) };
+
+    for (const quartz::rendering::Model::DrawEntry& drawEntry : drawEntries) {
+        const std::vector<glm::mat4>& instanceTransformationMatrices = drawEntry.p_node->getInstanceTransformationMatrices().empty() ?
+            identityInstanceTransformationMatrices :
+            drawEntry.p_node->getInstanceTransformationMatrices();
+
+        for (const glm::mat4& instanceTransformationMatrix : instanceTransformationMatrices) {
+            const glm::mat4 transformationMatrix = drawEntry.transformationMatrix * instanceTransformationMatrix;
+
+            for (uint32_t i = 0; i < drawEntry.primitiveCount; ++i) {
+                const quartz::rendering::Primitive::BoundingBox& primitiveBoundingBox = drawEntry.p_primitives[i].getBoundingBox();
+
+                const glm::vec3 localCenter = (primitiveBoundingBox.minimum + primitiveBoundingBox.maximum) * 0.5f;
+                const glm::vec3 localExtent = (primitiveBoundingBox.maximum - primitiveBoundingBox.minimum) * 0.5f;
+
+                const glm::vec3 center = glm::vec3(transformationMatrix * glm::vec4(localCenter, 1.0f));
+                glm::vec3 extent(0.0f);
+                for (uint32_t column = 0; column < 3; ++column) {
+                    extent += glm::abs(glm::vec3(transformationMatrix[column])) * localExtent[column];
+                }
+
+                boundingBox.minimum = glm::min(boundingBox.minimum, center - extent);
+                boundingBox.maximum = glm::max(boundingBox.maximum, center + extent);
+            }
+        }
+    }
+
+    if (drawEntries.empty()) {
+        boundingBox = { glm::vec3(0.0f), glm::vec3(0.0f) };
+    }
+
+    return boundingBox;
+}
+
 quartz::rendering::Model::Model(
     const quartz::rendering::Device& renderingDevice,
     const std::string& objectFilepath
 ) :
+    m_isRetainingCpuData(quartz::rendering::Model::shouldRetainCpuData),
     m_gltfModel(
         quartz::rendering::Model::loadGLTFModel(objectFilepath)
     ),
+    m_gltfModelHostAllocation(
+        quartz::rendering::Model::calculateGLTFModelSizeBytes(m_gltfModel)
+    ),
     m_materialMasterIndices(
         quartz::rendering::Model::loadMaterialMasterIndices(
             renderingDevice,
@@ -356,19 +518,101 @@ quartz::rendering::Model::Model(
             m_gltfModel,
             m_materialMasterIndices
         )
+    ),
+    m_drawEntries(
+        quartz::rendering::Model::loadDrawEntries(
+            m_scenes[m_defaultSceneIndex]
+        )
+    ),
+    m_boundingBox(
+        quartz::rendering::Model::calculateBoundingBox(m_drawEntries)
     )
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    if (m_isRetainingCpuData) {
+        return;
+    }
+
+    /**
+     * @brief Every upload copies its data into the upload queue's staging arena when it is recorded, so
+     *   nothing on the gpu side needs the document anymore
+     */
+    LOG_TRACEthis("Releasing {} bytes of glTF buffer and image data", m_gltfModelHostAllocation.getSizeBytes());
+    m_gltfModel = tinygltf::Model();
+    m_gltfModelHostAllocation.reset();
 }
 
 quartz::rendering::Model::Model(quartz::rendering::Model&& other) :
-    m_gltfModel(other.m_gltfModel),
+    m_isRetainingCpuData(other.m_isRetainingCpuData),
+    m_gltfModel(std::move(other.m_gltfModel)),
+    m_gltfModelHostAllocation(std::move(other.m_gltfModelHostAllocation)),
+    m_materialMasterIndices(std::move(other.m_materialMasterIndices)),
     m_defaultSceneIndex(other.m_defaultSceneIndex),
-    m_scenes(std::move(other.m_scenes))
+    m_scenes(std::move(other.m_scenes)),
+    m_drawEntries(std::move(other.m_drawEntries)),
+    m_boundingBox(other.m_boundingBox)
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
 
 quartz::rendering::Model::~Model() {
     LOG_FUNCTION_CALL_TRACEthis("");
-}
\ No newline at end of file
+}
+
+std::shared_ptr<const quartz::rendering::Model>
+quartz::rendering::Model::loadModel(
+    const quartz::rendering::Device& renderingDevice,
+    const std::string& objectFilepath
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL, "{}", objectFilepath);
+
+    std::error_code errorCode;
+
+    const std::filesystem::path canonicalFilepath = std::filesystem::canonical(objectFilepath, errorCode);
+    if (errorCode) {
+        LOG_THROW(MODEL, util::AssetLoadFailedError, "Failed to get canonical filepath of model at {} ({})", objectFilepath, errorCode.message());
+    }
+
+    const std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(canonicalFilepath, errorCode);
+    if (errorCode) {
+        LOG_THROW(MODEL, util::AssetLoadFailedError, "Failed to get last write time of model at {} ({})", canonicalFilepath.string(), errorCode.message());
+    }
+
+    // Forget about the models nobody is using anymore so the cache doesn't grow forever
+    for (auto it = quartz::rendering::Model::modelCache.begin(); it != quartz::rendering::Model::modelCache.end();) {
+        if (it->second.expired()) {
+            it = quartz::rendering::Model::modelCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const std::pair<std::string, std::filesystem::file_time_type> cacheKey(canonicalFilepath.string(), lastWriteTime);
+
+    const auto cacheIt = quartz::rendering::Model::modelCache.find(cacheKey);
+    if (cacheIt != quartz::rendering::Model::modelCache.end()) {
+        // A model which already let go of its cpu data can't be reused by someone who wants it retained
+        std::shared_ptr<const quartz::rendering::Model> p_cachedModel = cacheIt->second.lock();
+        if (
+            p_cachedModel &&
+            (p_cachedModel->getIsRetainingCpuData() || !quartz::rendering::Model::shouldRetainCpuData)
+        ) {
+            LOG_TRACE(MODEL, "Reusing already loaded model at {} ({} handles)", cacheKey.first, p_cachedModel.use_count());
+            return p_cachedModel;
+        }
+    }
+
+    LOG_TRACE(MODEL, "Model at {} is not loaded. Loading it", cacheKey.first);
+
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("model " + cacheKey.first);
+
+    std::shared_ptr<const quartz::rendering::Model> p_model = std::make_shared<const quartz::rendering::Model>(
+        renderingDevice,
+        cacheKey.first
+    );
+
+    quartz::rendering::Model::modelCache[cacheKey] = p_model;
+
+    return p_model;
+}
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <filesystem>
+#include <map>
+#include <memory>
 #include <queue>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <glm/mat4x4.hpp>
+
 #include <tiny_gltf.h>
 
 #include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/material/Material.hpp"
 #include "quartz/rendering/model/Scene.hpp"
 #include "quartz/rendering/texture/Texture.hpp"
@@ -79,6 +87,22 @@ namespace rendering {
  */
 
 class quartz::rendering::Model {
+public: // classes
+    /**
+     * @brief A flattened entry for every node in the default scene which contains a mesh.
+     *   These are built once when the model is loaded so recording a model is a linear scan
+     *   over contiguous memory instead of a walk through the node hierarchy every frame.
+     *   Models are shared and immutable once loaded, so the entries (and their transformation
+     *   matrices) never change. Doodads move with their own transformation instead.
+     */
+    struct DrawEntry {
+    public: // member variables
+        glm::mat4 transformationMatrix;
+        const quartz::rendering::Primitive* p_primitives;
+        uint32_t primitiveCount;
+        const quartz::rendering::Node* p_node;
+    };
+
 public: // member functions
     Model(
         const quartz::rendering::Device& renderingDevice,
@@ -90,9 +114,49 @@ public: // member functions
     USE_LOGGER(MODEL);
 
     const quartz::rendering::Scene& getDefaultScene() const { return m_scenes[m_defaultSceneIndex]; }
+    const std::vector<quartz::rendering::Model::DrawEntry>& getDrawEntries() const { return m_drawEntries; }
+
+    /**
+     * @brief Contains every primitive of every draw entry (and every instance of it), in model space
+     */
+    const quartz::rendering::Primitive::BoundingBox& getBoundingBox() const { return m_boundingBox; }
+
+    /**
+     * @brief The parsed glTF document is only kept (and is otherwise empty) when the model was loaded
+     *   while cpu data was being retained
+     */
+    bool getIsRetainingCpuData() const { return m_isRetainingCpuData; }
+    const tinygltf::Model& getGLTFModel() const { return m_gltfModel; }
+
+public: // static functions
+    /**
+     * @brief Get a handle to the model loaded from the file at objectFilepath. Every handle to the same
+     *   file (by canonical path and last write time) shares a single model, so placing an asset many
+     *   times only parses it and uploads its geometry and textures once. The model is destroyed once
+     *   the last handle to it goes away, and a file which changed on disk is loaded again.
+     *   Its geometry is not reclaimed then though. The geometry pool only ever grows, so the vertices
+     *   and indices of every level of detail stay in their block until the scene unloads and calls
+     *   GeometryPool::cleanUpAllBlocks. Each reload of a changed file costs that much pool space again
+     */
+    static std::shared_ptr<const quartz::rendering::Model> loadModel(
+        const quartz::rendering::Device& renderingDevice,
+        const std::string& objectFilepath
+    );
+
+    /**
+     * @brief By default a model lets go of its glTF document (every buffer and every decoded image) and
+     *   its primitives let go of their indices as soon as they have been handed to the upload queue,
+     *   keeping only counts and metadata. Tools which need to read geometry back on the cpu can have
+     *   models loaded from now on retain all of it
+     */
+    static void setShouldRetainCpuData(const bool shouldRetainCpuData) { quartz::rendering::Model::shouldRetainCpuData = shouldRetainCpuData; }
+    static bool getShouldRetainCpuData() { return quartz::rendering::Model::shouldRetainCpuData; }
+
+    static uint32_t getNumCachedModels() { return quartz::rendering::Model::modelCache.size(); }
 
 private: // static functions
     static tinygltf::Model loadGLTFModel(const std::string& filepath);
+    static std::size_t calculateGLTFModelSizeBytes(const tinygltf::Model& gltfModel); // buffer and decoded image data
     static std::vector<uint32_t> loadTextures(
         const quartz::rendering::Device& renderingDevice,
         const tinygltf::Model& gltfModel
@@ -107,6 +171,10 @@ private: // static functions
         const std::vector<uint32_t>& masterIndices,
         const quartz::rendering::Texture::Type textureType
     );
+    static uint32_t getTextureCoordinateSet(
+        const tinygltf::Material& gltfMaterial,
+        const quartz::rendering::Texture::Type textureType
+    );
     static std::vector<uint32_t> loadMaterialMasterIndices(
         const quartz::rendering::Device& renderingDevice,
         const tinygltf::Model& gltfModel
@@ -116,12 +184,35 @@ private: // static functions
         const tinygltf::Model& gltfModel,
         const std::vector<uint32_t>& materialMasterIndices
     );
+    static std::vector<quartz::rendering::Model::DrawEntry> loadDrawEntries(
+        const quartz::rendering::Scene& scene
+    );
+    static quartz::rendering::Primitive::BoundingBox calculateBoundingBox(
+        const std::vector<quartz::rendering::Model::DrawEntry>& drawEntries
+    );
+
+private: // static variables
+    /**
+     * @brief Keyed by canonical filepath and the file's last write time. We only hold weak handles so
+     *   the cache never keeps a model alive by itself
+     */
+    static std::map<
+        std::pair<std::string, std::filesystem::file_time_type>,
+        std::weak_ptr<const quartz::rendering::Model>
+    > modelCache;
+
+    static bool shouldRetainCpuData;
 
 private: // member variables
-    const tinygltf::Model m_gltfModel;
+    const bool m_isRetainingCpuData;
+    tinygltf::Model m_gltfModel;
+    quartz::rendering::MemoryAccounting::HostAllocation m_gltfModelHostAllocation;
 
     std::vector<uint32_t> m_materialMasterIndices;
 
     uint32_t m_defaultSceneIndex;
     std::vector<quartz::rendering::Scene> m_scenes;
+
+    std::vector<quartz::rendering::Model::DrawEntry> m_drawEntries;
+    quartz::rendering::Primitive::BoundingBox m_boundingBox;
 };
\ No newline at end of file
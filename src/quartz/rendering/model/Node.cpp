@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glm/vec3.hpp>
@@ -117,6 +120,130 @@ quartz::rendering::Node::loadMeshPtr(
     );
 }
 
+const float*
+quartz::rendering::Node::getInstanceAttributeDataPtr(
+    const tinygltf::Model& gltfModel,
+    const tinygltf::Value& gltfAttributes,
+    const std::string& attributeName,
+    const int32_t expectedType,
+    uint32_t& instanceCount,
+    uint32_t& strideFloats
+) {
+    if (!gltfAttributes.Has(attributeName)) {
+        LOG_TRACE(MODEL_NODE, "No {} instance attribute", attributeName);
+        return nullptr;
+    }
+
+    const int32_t accessorIndex = gltfAttributes.Get(attributeName).GetNumberAsInt();
+    if (accessorIndex < 0 || static_cast<uint32_t>(accessorIndex) >= gltfModel.accessors.size()) {
+        LOG_WARNING(MODEL_NODE, "Ignoring {} instance attribute with invalid accessor index {}", attributeName, accessorIndex);
+        return nullptr;
+    }
+
+    const tinygltf::Accessor& accessor = gltfModel.accessors[accessorIndex];
+    if (
+        accessor.type != expectedType ||
+        accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT ||
+        accessor.bufferView < 0
+    ) {
+        /**
+         * @todo 2024/06/10 Support normalized integer rotations and scales, which the extension
+         *   allows along with floats
+         */
+        LOG_WARNING(MODEL_NODE, "Ignoring {} instance attribute with unsupported type {} and component type {}", attributeName, accessor.type, accessor.componentType);
+        return nullptr;
+    }
+
+    const tinygltf::BufferView& bufferView = gltfModel.bufferViews[accessor.bufferView];
+    const tinygltf::Buffer& buffer = gltfModel.buffers[bufferView.buffer];
+
+    instanceCount = std::min<uint32_t>(instanceCount, accessor.count);
+    strideFloats = accessor.ByteStride(bufferView) / sizeof(float);
+    LOG_TRACE(MODEL_NODE, "Using {} {} instance attributes with a stride of {} floats", accessor.count, attributeName, strideFloats);
+
+    return reinterpret_cast<const float*>(buffer.data.data() + bufferView.byteOffset + accessor.byteOffset);
+}
+
+std::vector<glm::mat4>
+quartz::rendering::Node::loadInstanceTransformationMatrices(
+    const tinygltf::Model& gltfModel,
+    const tinygltf::Node& gltfNode
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_NODE, "");
+
+    const auto extensionIt = gltfNode.extensions.find("EXT_mesh_gpu_instancing");
+    if (extensionIt == gltfNode.extensions.end()) {
+        LOG_TRACE(MODEL_NODE, "Node is not instanced");
+        return {};
+    }
+
+    if (!extensionIt->second.Has("attributes") || !extensionIt->second.Get("attributes").IsObject()) {
+        LOG_WARNING(MODEL_NODE, "Node's EXT_mesh_gpu_instancing extension does not contain any attributes. Not instancing it");
+        return {};
+    }
+    const tinygltf::Value& gltfAttributes = extensionIt->second.Get("attributes");
+
+    uint32_t instanceCount = std::numeric_limits<uint32_t>::max();
+    uint32_t translationStrideFloats = 0;
+    uint32_t rotationStrideFloats = 0;
+    uint32_t scaleStrideFloats = 0;
+
+    const float* p_translations = quartz::rendering::Node::getInstanceAttributeDataPtr(
+        gltfModel,
+        gltfAttributes,
+        "TRANSLATION",
+        TINYGLTF_TYPE_VEC3,
+        instanceCount,
+        translationStrideFloats
+    );
+    const float* p_rotations = quartz::rendering::Node::getInstanceAttributeDataPtr(
+        gltfModel,
+        gltfAttributes,
+        "ROTATION",
+        TINYGLTF_TYPE_VEC4,
+        instanceCount,
+        rotationStrideFloats
+    );
+    const float* p_scales = quartz::rendering::Node::getInstanceAttributeDataPtr(
+        gltfModel,
+        gltfAttributes,
+        "SCALE",
+        TINYGLTF_TYPE_VEC3,
+        instanceCount,
+        scaleStrideFloats
+    );
+
+    if (!p_translations && !p_rotations && !p_scales) {
+        LOG_WARNING(MODEL_NODE, "Node's EXT_mesh_gpu_instancing extension has no usable attributes. Not instancing it");
+        return {};
+    }
+
+    LOG_TRACE(MODEL_NODE, "Loading {} instances", instanceCount);
+
+    std::vector<glm::mat4> instanceTransformationMatrices;
+    instanceTransformationMatrices.reserve(instanceCount);
+
+    for (uint32_t i = 0; i < instanceCount; ++i) {
+        glm::mat4 transformationMatrix = glm::mat4(1.0f);
+
+        if (p_translations) {
+            transformationMatrix = glm::translate(transformationMatrix, glm::make_vec3(&p_translations[i * translationStrideFloats]));
+        }
+
+        if (p_rotations) {
+            transformationMatrix = transformationMatrix * glm::mat4(glm::make_quat(&p_rotations[i * rotationStrideFloats]));
+        }
+
+        if (p_scales) {
+            transformationMatrix = glm::scale(transformationMatrix, glm::make_vec3(&p_scales[i * scaleStrideFloats]));
+        }
+
+        instanceTransformationMatrices.push_back(transformationMatrix);
+    }
+
+    return instanceTransformationMatrices;
+}
+
 quartz::rendering::Node::Node(
     const quartz::rendering::Device& renderingDevice,
     const tinygltf::Model& gltfModel,
@@ -138,6 +265,7 @@ quartz::rendering::Node::Node(
             gltfNode
         )
     ),
+    m_transformationMatrix(m_localTransformationMatrix),
     mp_mesh(
         quartz::rendering::Node::loadMeshPtr(
             renderingDevice,
@@ -145,6 +273,12 @@ quartz::rendering::Node::Node(
             gltfNode,
             materialMasterIndices
         )
+    ),
+    m_instanceTransformationMatrices(
+        quartz::rendering::Node::loadInstanceTransformationMatrices(
+            gltfModel,
+            gltfNode
+        )
     )
 {
     LOG_FUNCTION_CALL_TRACEthis("");
@@ -160,9 +294,15 @@ quartz::rendering::Node::Node(
     mp_parent(std::move(other.mp_parent)),
     m_childrenPtrs(std::move(other.m_childrenPtrs)),
     m_localTransformationMatrix(std::move(other.m_localTransformationMatrix)),
-    mp_mesh(std::move(other.mp_mesh))
+    m_transformationMatrix(std::move(other.m_transformationMatrix)),
+    mp_mesh(std::move(other.mp_mesh)),
+    m_instanceTransformationMatrices(std::move(other.m_instanceTransformationMatrices))
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    for (const std::shared_ptr<quartz::rendering::Node>& p_node : m_childrenPtrs) {
+        p_node->setParentPtr(this);
+    }
 }
 
 quartz::rendering::Node::~Node() {
@@ -170,19 +310,18 @@ quartz::rendering::Node::~Node() {
 }
 
 /**
- * @todo 2023/12/07 We should store the overarching transformation matrix as a member
- *   variable as well as the local transformation matrix. We don't want to be computing
- *   this matrix every time we want to use it.
- *   Instead we should calculate the initial transformation matrix upon construction,
- *   then whenever we update our local transformation matrix we should update the
- *   transformation matrix as well.
+ * @brief 2023/12/07 We cache the overarching transformation matrix so we are not walking
+ *   up to the root node every time we want to use it. Children are constructed before
+ *   their parent pointers are set, so the owning scene kicks this off from the root nodes
+ *   once the whole tree exists, updating this node's matrix as well as all of its
+ *   descendants' matrices. Nothing changes them after that.
  */
-glm::mat4
-quartz::rendering::Node::getTransformationMatrix() const {
-    glm::mat4 transformationMatrix = m_localTransformationMatrix;
+void
+quartz::rendering::Node::updateTransformationMatrix() {
+    m_transformationMatrix = m_localTransformationMatrix;
 
     if (mp_parent) {
-        transformationMatrix = mp_parent->getTransformationMatrix() * m_localTransformationMatrix;
+        m_transformationMatrix = mp_parent->getTransformationMatrix() * m_localTransformationMatrix;
     } else {
 
         /**
@@ -201,8 +340,10 @@ quartz::rendering::Node::getTransformationMatrix() const {
             glm::vec3(0.0f, 0.0f, 1.0f)
         );
 
-        transformationMatrix = rotationMatrix * transformationMatrix;
+        m_transformationMatrix = rotationMatrix * m_transformationMatrix;
     }
 
-    return transformationMatrix;
-}
\ No newline at end of file
+    for (const std::shared_ptr<quartz::rendering::Node>& p_child : m_childrenPtrs) {
+        p_child->updateTransformationMatrix();
+    }
+}
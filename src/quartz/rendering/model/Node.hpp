@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <glm/vec3.hpp>
@@ -34,9 +35,11 @@ public: // member functions
     const Node* getParentPtr() const { return mp_parent; }
     const std::vector<std::shared_ptr<Node>>& getChildrenNodePtrs() const { return m_childrenPtrs; }
     const glm::mat4& getLocalTransformationMatrix() const { return m_localTransformationMatrix; }
+    const glm::mat4& getTransformationMatrix() const { return m_transformationMatrix; }
     const std::shared_ptr<quartz::rendering::Mesh>& getMeshPtr() const { return mp_mesh; }
+    const std::vector<glm::mat4>& getInstanceTransformationMatrices() const { return m_instanceTransformationMatrices; }
 
-    glm::mat4 getTransformationMatrix() const;
+    void updateTransformationMatrix(); // only while loading. the model is immutable once it is loaded
 
 private: // static functions
     std::vector<std::shared_ptr<quartz::rendering::Node>> loadChildrenNodePtrs(
@@ -57,6 +60,24 @@ private: // static functions
         const std::vector<uint32_t>& materialMasterIndices
     );
 
+    /**
+     * @brief Load the per instance TRS properties from the node's EXT_mesh_gpu_instancing extension.
+     *   These are relative to the node, so an instance's transformation matrix is the node's
+     *   transformation matrix multiplied by the instance's. Empty if the node is not instanced
+     */
+    static std::vector<glm::mat4> loadInstanceTransformationMatrices(
+        const tinygltf::Model& gltfModel,
+        const tinygltf::Node& gltfNode
+    );
+    static const float* getInstanceAttributeDataPtr(
+        const tinygltf::Model& gltfModel,
+        const tinygltf::Value& gltfAttributes,
+        const std::string& attributeName,
+        const int32_t expectedType,
+        uint32_t& instanceCount,
+        uint32_t& strideFloats
+    );
+
 private: // member functions
     void setParentPtr(const Node* p_parent) { mp_parent = p_parent; }
 
@@ -75,6 +96,9 @@ private: // member variables
     const Node* mp_parent;
     std::vector<std::shared_ptr<Node>> m_childrenPtrs;
     glm::mat4 m_localTransformationMatrix;
+    glm::mat4 m_transformationMatrix;
 
     std::shared_ptr<quartz::rendering::Mesh> mp_mesh;
+
+    std::vector<glm::mat4> m_instanceTransformationMatrices;
 };
\ No newline at end of file
@@ -1,29 +1,103 @@
+#include <algorithm>
+#include <limits>
+#include <string>
 #include <vector>
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/string_cast.hpp>
 
 #include <tiny_gltf.h>
 
 #include "quartz/rendering/Loggers.hpp"
-#include "quartz/rendering/buffer/StagedBuffer.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
 #include "quartz/rendering/device/Device.hpp"
 #include "quartz/rendering/material/Material.hpp"
+#include "quartz/rendering/model/MeshSimplifier.hpp"
+#include "quartz/rendering/model/Model.hpp"
 #include "quartz/rendering/model/Primitive.hpp"
 #include "quartz/rendering/model/TangentCalculator.hpp"
 #include "quartz/rendering/model/Vertex.hpp"
-#include "quartz/rendering/texture/Texture.hpp"
+
+std::vector<quartz::rendering::Primitive::LodDescription> quartz::rendering::Primitive::lodDescriptions = {
+    {0.5f,  0.01f, 0.3f},
+    {0.25f, 0.02f, 0.15f},
+    {0.1f,  0.04f, 0.05f}
+};
+
+void
+quartz::rendering::Primitive::setLodDescriptions(
+    const std::vector<quartz::rendering::Primitive::LodDescription>& lodDescriptions
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "{} levels", lodDescriptions.size());
+
+    quartz::rendering::Primitive::lodDescriptions = lodDescriptions;
+
+    const auto isCoarserThan = [](
+        const quartz::rendering::Primitive::LodDescription& a,
+        const quartz::rendering::Primitive::LodDescription& b
+    ) {
+        return a.maxScreenSize > b.maxScreenSize;
+    };
+
+    if (!std::is_sorted(quartz::rendering::Primitive::lodDescriptions.begin(), quartz::rendering::Primitive::lodDescriptions.end(), isCoarserThan)) {
+        LOG_WARNING(MODEL_PRIMITIVE, "Levels of detail are not ordered from the largest screen size to the smallest. Sorting them");
+        std::stable_sort(quartz::rendering::Primitive::lodDescriptions.begin(), quartz::rendering::Primitive::lodDescriptions.end(), isCoarserThan);
+    }
+}
+
+uint32_t
+quartz::rendering::Primitive::selectLodLevel(
+    const float screenSize
+) {
+    uint32_t lodLevel = 0;
+
+    while (
+        lodLevel < quartz::rendering::Primitive::lodDescriptions.size() &&
+        screenSize < quartz::rendering::Primitive::lodDescriptions[lodLevel].maxScreenSize
+    ) {
+        ++lodLevel;
+    }
+
+    return lodLevel;
+}
+
+std::string
+quartz::rendering::Primitive::determineAttributeGltfString(
+    const std::shared_ptr<quartz::rendering::Material>& p_material,
+    const quartz::rendering::Vertex::AttributeType attributeType
+) {
+    switch (attributeType) {
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate: {
+            const uint32_t textureCoordinateSlot = quartz::rendering::Vertex::getTextureCoordinateSlot(attributeType);
+            const std::vector<uint32_t>& textureCoordinateSets = p_material->getTextureCoordinateSets();
+            if (textureCoordinateSlot < textureCoordinateSets.size()) {
+                return "TEXCOORD_" + std::to_string(textureCoordinateSets[textureCoordinateSlot]);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return quartz::rendering::Vertex::getAttributeGLTFString(attributeType);
+}
 
 bool
 quartz::rendering::Primitive::handleMissingVertexAttribute(
     std::vector<quartz::rendering::Vertex>& verticesToPopulate,
     const tinygltf::Model& gltfModel,
     const tinygltf::Primitive& gltfPrimitive,
+    const std::shared_ptr<quartz::rendering::Material>& p_material,
     const std::vector<uint32_t>& indices,
     const quartz::rendering::Vertex::AttributeType attributeType
 ) {
     const std::string attributeNameString = quartz::rendering::Vertex::getAttributeNameString(attributeType);
-    const std::string attributeGltfString = quartz::rendering::Vertex::getAttributeGLTFString(attributeType);
+    const std::string attributeGltfString = quartz::rendering::Primitive::determineAttributeGltfString(p_material, attributeType);
 
     if (gltfPrimitive.attributes.find(attributeGltfString) != gltfPrimitive.attributes.end()) {
         return false;
@@ -37,109 +111,112 @@ quartz::rendering::Primitive::handleMissingVertexAttribute(
 
         case quartz::rendering::Vertex::AttributeType::Tangent:
             LOG_TRACE(MODEL_PRIMITIVE, "Manually calculating vertex tangents. We're operating under the assumption that the other attributes are already populated");
-            quartz::rendering::TangentCalculator::populateVerticesWithTangents(gltfModel, gltfPrimitive, indices, verticesToPopulate);
+            quartz::rendering::TangentCalculator::populateVerticesWithTangents(
+                gltfModel,
+                gltfPrimitive,
+                indices,
+                quartz::rendering::Vertex::getTextureCoordinateAttributeType(p_material->getNormalTextureCoordinateSlot()),
+                verticesToPopulate
+            );
             return true;
 
         case quartz::rendering::Vertex::AttributeType::Color:
             LOG_TRACE(MODEL_PRIMITIVE, "Using default vertex color of r: {}, g: {}, b: {}", verticesToPopulate[0].color.r, verticesToPopulate[0].color.g, verticesToPopulate[0].color.b);
             return true;
 
-        case quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate:
-            LOG_TRACE(MODEL_PRIMITIVE, "Using default base color texture coordinates of {},{}", verticesToPopulate[0].baseColorTextureCoordinate.x, verticesToPopulate[0].baseColorTextureCoordinate.y);
-            return true;
-        case quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate:
-            LOG_TRACE(MODEL_PRIMITIVE, "Using default metallic roughness texture coordinates of {},{}", verticesToPopulate[0].metallicRoughnessTextureCoordinate.x, verticesToPopulate[0].metallicRoughnessTextureCoordinate.y);
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
+            LOG_TRACE(MODEL_PRIMITIVE, "Using default first texture coordinates of {},{}", verticesToPopulate[0].firstTextureCoordinate.x, verticesToPopulate[0].firstTextureCoordinate.y);
             return true;
-        case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate:
-            LOG_TRACE(MODEL_PRIMITIVE, "Using default normal texture coordinates of {},{}", verticesToPopulate[0].normalTextureCoordinate.x, verticesToPopulate[0].normalTextureCoordinate.y);
-            return true;
-        case quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate:
-            LOG_TRACE(MODEL_PRIMITIVE, "Using default emission texture coordinates of {},{}", verticesToPopulate[0].emissionTextureCoordinate.x, verticesToPopulate[0].emissionTextureCoordinate.y);
-            return true;
-        case quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate:
-            LOG_TRACE(MODEL_PRIMITIVE, "Using default occlusion texture coordinates of {},{}", verticesToPopulate[0].occlusionTextureCoordinate.x, verticesToPopulate[0].occlusionTextureCoordinate.y);
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate:
+            LOG_TRACE(MODEL_PRIMITIVE, "Using default second texture coordinates of {},{}", verticesToPopulate[0].secondTextureCoordinate.x, verticesToPopulate[0].secondTextureCoordinate.y);
             return true;
     }
 }
 
 bool
-quartz::rendering::Primitive::handleDefaultTextureAttribute(
-    UNUSED std::vector<quartz::rendering::Vertex>& verticesToPopulate,
+quartz::rendering::Primitive::handleUnusedTextureCoordinateAttribute(
     const std::shared_ptr<quartz::rendering::Material>& p_material,
     const quartz::rendering::Vertex::AttributeType attributeType
 ) {
     switch (attributeType) {
-        case quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate:
-            if (p_material->getBaseColorTextureMasterIndex() == quartz::rendering::Texture::getBaseColorDefaultMasterIndex()) {
-                LOG_TRACE(MODEL_PRIMITIVE, "Using default base color texture, so leaving coordinates to be {},{}", verticesToPopulate[0].baseColorTextureCoordinate.x, verticesToPopulate[0].baseColorTextureCoordinate.y);
-                return true;
-            }
-            break;
-
-        case quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate:
-            if (p_material->getMetallicRoughnessTextureMasterIndex() == quartz::rendering::Texture::getMetallicRoughnessDefaultMasterIndex()) {
-                LOG_TRACE(MODEL_PRIMITIVE, "Using default metallic roughness texture, so leaving coordinates to be {},{}", verticesToPopulate[0].metallicRoughnessTextureCoordinate.x, verticesToPopulate[0].metallicRoughnessTextureCoordinate.y);
-                return true;
-            }
-            break;
-
-        case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate:
-            if (p_material->getNormalTextureMasterIndex() == quartz::rendering::Texture::getNormalDefaultMasterIndex()) {
-                LOG_TRACE(MODEL_PRIMITIVE, "Using default normal texture, so leaving coordinates to be {},{}", verticesToPopulate[0].normalTextureCoordinate.x, verticesToPopulate[0].normalTextureCoordinate.y);
-                return true;
-            }
-            break;
-
-        case quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate:
-            if (p_material->getEmissionTextureMasterIndex() == quartz::rendering::Texture::getEmissionDefaultMasterIndex()) {
-                LOG_TRACE(MODEL_PRIMITIVE, "Using default emission texture, so leaving coordinates to be {},{}", verticesToPopulate[0].emissionTextureCoordinate.x, verticesToPopulate[0].emissionTextureCoordinate.y);
-                return true;
-            }
-            break;
-
-        case quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate:
-            if (p_material->getOcclusionTextureMasterIndex() == quartz::rendering::Texture::getOcclusionDefaultMasterIndex()) {
-                LOG_TRACE(MODEL_PRIMITIVE, "Using default occlusion texture, so leaving coordinates to be {},{}", verticesToPopulate[0].occlusionTextureCoordinate.x, verticesToPopulate[0].occlusionTextureCoordinate.y);
-                return true;
-            }
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate:
             break;
 
         default:
-            break;
+            return false;
     }
 
-    return false;
+    const uint32_t textureCoordinateSlot = quartz::rendering::Vertex::getTextureCoordinateSlot(attributeType);
+    if (textureCoordinateSlot < p_material->getTextureCoordinateSets().size()) {
+        return false;
+    }
+
+    LOG_TRACE(MODEL_PRIMITIVE, "Material only references {} texture coordinate sets, so not loading texture coordinate slot {}", p_material->getTextureCoordinateSets().size(), textureCoordinateSlot);
+
+    return true;
 }
 
 uint32_t
 quartz::rendering::Primitive::determineGltfAccessorByteStride(
-    const quartz::rendering::Vertex::AttributeType attributeType,
     const tinygltf::Accessor& accessor,
     const tinygltf::BufferView& bufferView
 ) {
-    const std::string attributeNameString = quartz::rendering::Vertex::getAttributeNameString(attributeType);
-    const std::string attributeGltfString = quartz::rendering::Vertex::getAttributeGLTFString(attributeType);
-
-    uint32_t tinygltfVecType = TINYGLTF_TYPE_VEC3;
-    if (
-        attributeType == quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate ||
-        attributeType == quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate ||
-        attributeType == quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate ||
-        attributeType == quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate ||
-        attributeType == quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate
-    ) {
-        LOG_TRACE(MODEL_PRIMITIVE, "{} attribute ({}) attribute uses vector2", attributeNameString, attributeGltfString);
-        tinygltfVecType = TINYGLTF_TYPE_VEC2;
+    // Tightly packed unless the buffer view says otherwise. Negative when the accessor is malformed
+    const int32_t byteStride = accessor.ByteStride(bufferView);
+    if (byteStride <= 0) {
+        LOG_THROW(MODEL_PRIMITIVE, util::AssetLoadFailedError, "Accessor has an invalid byte stride ({}) for component type {} and type {}", byteStride, accessor.componentType, accessor.type);
     }
 
-    const uint32_t byteStride = accessor.ByteStride(bufferView) ?
-        accessor.ByteStride(bufferView) / sizeof (float) :
-        tinygltf::GetNumComponentsInType(tinygltfVecType);
-    LOG_TRACE(MODEL_PRIMITIVE, "Using a byte stride of {}", byteStride);
-
     return byteStride;
 }
 
+glm::vec4
+quartz::rendering::Primitive::readGltfAccessorElement(
+    const tinygltf::Accessor& accessor,
+    const uint8_t* p_element
+) {
+    const int32_t componentCount = std::min(tinygltf::GetNumComponentsInType(accessor.type), 4);
+    glm::vec4 element(0.0f, 0.0f, 0.0f, 1.0f);
+
+    /**
+     * @brief Anything other than floats comes from KHR_mesh_quantization (or vertex colors). Normalized
+     *   integers map onto [0, 1] or [-1, 1], everything else is used as it is. Only positions keep their
+     *   quantized values on the gpu. Every other attribute is re-encoded into Vertex::Packed's own formats
+     */
+    for (int32_t i = 0; i < componentCount; ++i) {
+        switch (accessor.componentType) {
+            case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                element[i] = reinterpret_cast<const float*>(p_element)[i];
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+                const uint16_t value = reinterpret_cast<const uint16_t*>(p_element)[i];
+                element[i] = accessor.normalized ? value / 65535.0f : value;
+                break;
+            }
+            case TINYGLTF_COMPONENT_TYPE_SHORT: {
+                const int16_t value = reinterpret_cast<const int16_t*>(p_element)[i];
+                element[i] = accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+                break;
+            }
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+                const uint8_t value = p_element[i];
+                element[i] = accessor.normalized ? value / 255.0f : value;
+                break;
+            }
+            case TINYGLTF_COMPONENT_TYPE_BYTE: {
+                const int8_t value = reinterpret_cast<const int8_t*>(p_element)[i];
+                element[i] = accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+                break;
+            }
+            default:
+                LOG_THROW(MODEL_PRIMITIVE, util::AssetLoadFailedError, "Unsupported vertex attribute component type {}", accessor.componentType);
+        }
+    }
+
+    return element;
+}
+
 uint32_t
 quartz::rendering::Primitive::loadMaterialMasterIndex(
     const tinygltf::Primitive& gltfPrimitive,
@@ -235,14 +312,14 @@ quartz::rendering::Primitive::populateVerticesWithAttribute(
     const quartz::rendering::Vertex::AttributeType attributeType
 ) {
     const std::string attributeNameString = quartz::rendering::Vertex::getAttributeNameString(attributeType);
-    const std::string attributeGltfString = quartz::rendering::Vertex::getAttributeGLTFString(attributeType);
+    const std::string attributeGltfString = quartz::rendering::Primitive::determineAttributeGltfString(p_material, attributeType);
     LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "{} ({})", attributeNameString, attributeGltfString);
 
-    if (quartz::rendering::Primitive::handleMissingVertexAttribute(verticesToPopulate, gltfModel, gltfPrimitive, indices, attributeType)) {
+    if (quartz::rendering::Primitive::handleUnusedTextureCoordinateAttribute(p_material, attributeType)) {
         return;
     }
 
-    if (quartz::rendering::Primitive::handleDefaultTextureAttribute(verticesToPopulate, p_material, attributeType)) {
+    if (quartz::rendering::Primitive::handleMissingVertexAttribute(verticesToPopulate, gltfModel, gltfPrimitive, p_material, indices, attributeType)) {
         return;
     }
 
@@ -263,59 +340,172 @@ quartz::rendering::Primitive::populateVerticesWithAttribute(
     const uint8_t* bufferDataStartAddress = bufferData.data();
     const uint8_t* desiredDataStartAddress = bufferDataStartAddress + accessorByteOffset + bufferViewByteOffset;
 
-    const float* p_data = reinterpret_cast<const float*>(desiredDataStartAddress);
+    const uint32_t byteStride = quartz::rendering::Primitive::determineGltfAccessorByteStride(accessor, bufferView);
+    LOG_TRACE(MODEL_PRIMITIVE, "Using component type {} ({}normalized) with a byte stride of {}", accessor.componentType, accessor.normalized ? "" : "not ", byteStride);
 
-    const uint32_t byteStride = quartz::rendering::Primitive::determineGltfAccessorByteStride(attributeType, accessor, bufferView);
+    // Half floats only have 11 significant bits, so 16 bit texture coordinates come out coarser than they went in
+    if (
+        (
+            attributeType == quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate ||
+            attributeType == quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate
+        ) &&
+        (
+            accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ||
+            accessor.componentType == TINYGLTF_COMPONENT_TYPE_SHORT
+        )
+    ) {
+        LOG_WARNING(MODEL_PRIMITIVE, "{} ({}) is stored as 16 bit integers. Storing it as half floats loses precision", attributeNameString, attributeGltfString);
+    }
 
     for (uint32_t i = 0; i < verticesToPopulate.size(); ++i) {
+        const glm::vec4 element = quartz::rendering::Primitive::readGltfAccessorElement(
+            accessor,
+            desiredDataStartAddress + i * byteStride
+        );
+
         switch (attributeType) {
             case quartz::rendering::Vertex::AttributeType::Position: {
-                verticesToPopulate[i].position = glm::make_vec3(&p_data[i * byteStride]);
+                verticesToPopulate[i].position = glm::vec3(element);
                 break;
             }
             case quartz::rendering::Vertex::AttributeType::Normal: {
-                verticesToPopulate[i].normal = glm::make_vec3(&p_data[i * byteStride]);
+                verticesToPopulate[i].normal = glm::vec3(element);
                 break;
             }
             case quartz::rendering::Vertex::AttributeType::Tangent: {
-                verticesToPopulate[i].tangent = glm::make_vec3(&p_data[i * byteStride]);
+                verticesToPopulate[i].tangent = glm::vec3(element);
+                verticesToPopulate[i].tangentHandedness = element.w < 0.0f ? -1.0f : 1.0f;
                 break;
             }
             case quartz::rendering::Vertex::AttributeType::Color: {
-                verticesToPopulate[i].color = glm::make_vec3(&p_data[i * byteStride]);
-                break;
-            }
-            case quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate: {
-                verticesToPopulate[i].baseColorTextureCoordinate = glm::make_vec2(&p_data[i * byteStride]);
+                verticesToPopulate[i].color = glm::vec3(element);
                 break;
             }
-            case quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate: {
-                verticesToPopulate[i].metallicRoughnessTextureCoordinate = glm::make_vec2(&p_data[i * byteStride]);
+            case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate: {
+                verticesToPopulate[i].firstTextureCoordinate = glm::vec2(element);
                 break;
             }
-            case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate: {
-                verticesToPopulate[i].normalTextureCoordinate = glm::make_vec2(&p_data[i * byteStride]);
-                break;
-            }
-            case quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate: {
-                verticesToPopulate[i].emissionTextureCoordinate = glm::make_vec2(&p_data[i * byteStride]);
-                break;
-            }
-            case quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate: {
-                verticesToPopulate[i].occlusionTextureCoordinate = glm::make_vec2(&p_data[i * byteStride]);
+            case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate: {
+                verticesToPopulate[i].secondTextureCoordinate = glm::vec2(element);
                 break;
             }
         }
     }
 }
 
-quartz::rendering::StagedBuffer
-quartz::rendering::Primitive::createStagedVertexBuffer(
+quartz::rendering::Primitive::BoundingBox
+quartz::rendering::Primitive::loadBoundingBox(
+    const tinygltf::Model& gltfModel,
+    const tinygltf::Primitive& gltfPrimitive
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "");
+
+    const uint32_t accessorIndex = gltfPrimitive.attributes.find("POSITION")->second;
+    const tinygltf::Accessor& accessor = gltfModel.accessors[accessorIndex];
+
+    /**
+     * @brief The spec requires POSITION accessors to have min and max, but not every exporter listens.
+     *   Quantized positions have them in the accessor's own (not normalized) units, so work those out too
+     */
+    if (
+        accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT &&
+        accessor.minValues.size() == 3 &&
+        accessor.maxValues.size() == 3
+    ) {
+        const quartz::rendering::Primitive::BoundingBox boundingBox = {
+            glm::vec3(glm::make_vec3(accessor.minValues.data())),
+            glm::vec3(glm::make_vec3(accessor.maxValues.data()))
+        };
+        LOG_TRACE(MODEL_PRIMITIVE, "Using bounding box from accessor: {} -> {}", glm::to_string(boundingBox.minimum), glm::to_string(boundingBox.maximum));
+
+        return boundingBox;
+    }
+
+    return quartz::rendering::Primitive::calculateBoundingBox(
+        gltfModel,
+        gltfPrimitive
+    );
+}
+
+quartz::rendering::Primitive::BoundingBox
+quartz::rendering::Primitive::calculateBoundingBox(
+    const tinygltf::Model& gltfModel,
+    const tinygltf::Primitive& gltfPrimitive
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "");
+
+    const uint32_t accessorIndex = gltfPrimitive.attributes.find("POSITION")->second;
+    const tinygltf::Accessor& accessor = gltfModel.accessors[accessorIndex];
+
+    const tinygltf::BufferView& bufferView = gltfModel.bufferViews[accessor.bufferView];
+    const tinygltf::Buffer& buffer = gltfModel.buffers[bufferView.buffer];
+    const uint8_t* desiredDataStartAddress = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
+    const uint32_t byteStride = quartz::rendering::Primitive::determineGltfAccessorByteStride(accessor, bufferView);
+
+    quartz::rendering::Primitive::BoundingBox boundingBox = {
+        glm::vec3(std::numeric_limits<float>::max()),
+        glm::vec3(std::numeric_limits<float>::lowest())
+    };
+    for (uint32_t i = 0; i < accessor.count; ++i) {
+        const glm::vec3 position = glm::vec3(quartz::rendering::Primitive::readGltfAccessorElement(accessor, desiredDataStartAddress + i * byteStride));
+        boundingBox.minimum = glm::min(boundingBox.minimum, position);
+        boundingBox.maximum = glm::max(boundingBox.maximum, position);
+    }
+    LOG_TRACE(MODEL_PRIMITIVE, "Calculated bounding box from {} positions: {} -> {}", accessor.count, glm::to_string(boundingBox.minimum), glm::to_string(boundingBox.maximum));
+
+    return boundingBox;
+}
+
+std::vector<std::vector<uint32_t>>
+quartz::rendering::Primitive::generateLodIndices(
+    const std::vector<quartz::rendering::Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    const quartz::rendering::Primitive::BoundingBox& boundingBox
+) {
+    LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "{} levels", quartz::rendering::Primitive::lodDescriptions.size());
+
+    std::vector<glm::vec3> positions(vertices.size());
+    for (uint32_t i = 0; i < vertices.size(); ++i) {
+        positions[i] = vertices[i].position;
+    }
+
+    const float diagonalLength = glm::length(boundingBox.maximum - boundingBox.minimum);
+
+    std::vector<std::vector<uint32_t>> lodIndices;
+
+    for (const quartz::rendering::Primitive::LodDescription& lodDescription : quartz::rendering::Primitive::lodDescriptions) {
+        const std::vector<uint32_t>& previousIndices = lodIndices.empty() ? indices : lodIndices.back();
+        const uint32_t targetIndexCount = static_cast<uint32_t>(indices.size() * lodDescription.indexRatio) / 3 * 3;
+
+        std::vector<uint32_t> simplifiedIndices = quartz::rendering::MeshSimplifier::simplify(
+            positions,
+            previousIndices,
+            targetIndexCount,
+            lodDescription.maxError * diagonalLength
+        );
+
+        // Not worth a level of its own if the error bound stopped it from getting meaningfully simpler
+        if (simplifiedIndices.empty() || simplifiedIndices.size() * 10 > previousIndices.size() * 9) {
+            LOG_TRACE(MODEL_PRIMITIVE, "Stopping at {} levels of detail. Could only simplify {} indices down to {}", lodIndices.size() + 1, previousIndices.size(), simplifiedIndices.size());
+            break;
+        }
+
+        LOG_TRACE(MODEL_PRIMITIVE, "Level of detail {} uses {} indices (aimed for {})", lodIndices.size() + 1, simplifiedIndices.size(), targetIndexCount);
+        lodIndices.push_back(std::move(simplifiedIndices));
+    }
+
+    return lodIndices;
+}
+
+std::vector<quartz::rendering::GeometryPool::Range>
+quartz::rendering::Primitive::loadLodGeometryRanges(
     const quartz::rendering::Device& renderingDevice,
     const tinygltf::Model& gltfModel,
     const tinygltf::Primitive& gltfPrimitive,
     const std::shared_ptr<quartz::rendering::Material>& p_material,
-    const std::vector<uint32_t>& indices
+    const std::vector<uint32_t>& indices,
+    const quartz::rendering::Primitive::BoundingBox& boundingBox,
+    const quartz::rendering::Vertex::PositionQuantization& positionQuantization
 ) {
     LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "");
 
@@ -328,11 +518,8 @@ quartz::rendering::Primitive::createStagedVertexBuffer(
         quartz::rendering::Vertex::AttributeType::Position,
         quartz::rendering::Vertex::AttributeType::Normal,
         quartz::rendering::Vertex::AttributeType::Color,
-        quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate,
-        quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate,
-        quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate,
-        quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate,
-        quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate,
+        quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate, // only the slots the material references are loaded
+        quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate,
         quartz::rendering::Vertex::AttributeType::Tangent, // needs to go last. uses other attributes in calculations if not provided by model
     };
 
@@ -349,23 +536,56 @@ quartz::rendering::Primitive::createStagedVertexBuffer(
 
     LOG_TRACE(MODEL_PRIMITIVE, "Successfully populated {} vertices", vertexCount);
 
-    quartz::rendering::StagedBuffer stagedVertexBuffer(
+    // ----- every level's indices go into the pool together, right after the full resolution ones ----- //
+
+    const std::vector<std::vector<uint32_t>> lodIndices = quartz::rendering::Primitive::generateLodIndices(
+        vertices,
+        indices,
+        boundingBox
+    );
+
+    std::vector<uint32_t> allIndices(indices);
+    for (const std::vector<uint32_t>& levelIndices : lodIndices) {
+        allIndices.insert(allIndices.end(), levelIndices.begin(), levelIndices.end());
+    }
+
+    // ----- only the packed vertices go to the gpu ----- //
+
+    std::vector<quartz::rendering::Vertex::Packed> packedVertices;
+    packedVertices.reserve(vertices.size());
+    for (const quartz::rendering::Vertex& vertex : vertices) {
+        packedVertices.emplace_back(vertex, positionQuantization);
+    }
+
+    const quartz::rendering::GeometryPool::Range geometryRange = quartz::rendering::GeometryPool::allocate(
         renderingDevice,
-        sizeof(quartz::rendering::Vertex) * vertices.size(),
-        vk::BufferUsageFlagBits::eVertexBuffer,
-        vertices.data()
+        sizeof(quartz::rendering::Vertex::Packed),
+        packedVertices.size(),
+        packedVertices.data(),
+        allIndices
     );
 
-    LOG_INFO(MODEL_PRIMITIVE, "Successfully created staged vertex buffer for {} vertices", vertexCount);
+    std::vector<quartz::rendering::GeometryPool::Range> lodGeometryRanges = {
+        {geometryRange.blockIndex, geometryRange.vertexOffset, geometryRange.firstIndex, static_cast<uint32_t>(indices.size())}
+    };
+
+    uint32_t firstIndex = geometryRange.firstIndex + indices.size();
+    for (const std::vector<uint32_t>& levelIndices : lodIndices) {
+        lodGeometryRanges.push_back({geometryRange.blockIndex, geometryRange.vertexOffset, firstIndex, static_cast<uint32_t>(levelIndices.size())});
+        firstIndex += levelIndices.size();
+    }
 
-    return stagedVertexBuffer;
+    LOG_INFO(MODEL_PRIMITIVE, "Successfully placed {} vertices and {} indices ({} levels of detail) into geometry block {}", vertexCount, allIndices.size(), lodGeometryRanges.size(), geometryRange.blockIndex);
+
+    return lodGeometryRanges;
 }
 
 quartz::rendering::Primitive::Primitive(
     const quartz::rendering::Device& renderingDevice,
     const tinygltf::Model& gltfModel,
     const tinygltf::Primitive& gltfPrimitive,
-    const std::vector<uint32_t>& materialMasterIndices
+    const std::vector<uint32_t>& materialMasterIndices,
+    const quartz::rendering::Vertex::PositionQuantization& positionQuantization
 ) :
     m_materialMasterIndex(
         quartz::rendering::Primitive::loadMaterialMasterIndex(
@@ -379,25 +599,33 @@ quartz::rendering::Primitive::Primitive(
             gltfPrimitive
         )
     ),
-    m_stagedVertexBuffer(
-        quartz::rendering::Primitive::createStagedVertexBuffer(
-            renderingDevice,
+    m_indicesHostAllocation(sizeof(uint32_t) * m_indices.size()),
+    m_boundingBox(
+        quartz::rendering::Primitive::loadBoundingBox(
             gltfModel,
-            gltfPrimitive,
-            quartz::rendering::Material::getMaterialPtr(m_materialMasterIndex),
-            m_indices
+            gltfPrimitive
         )
     ),
-    m_stagedIndexBuffer(
-        quartz::rendering::StagedBuffer(
+    m_positionQuantization(positionQuantization),
+    m_lodGeometryRanges(
+        quartz::rendering::Primitive::loadLodGeometryRanges(
             renderingDevice,
-            sizeof(uint32_t) * m_indices.size(),
-            vk::BufferUsageFlagBits::eIndexBuffer,
-            m_indices.data()
+            gltfModel,
+            gltfPrimitive,
+            quartz::rendering::Material::getMaterialPtr(m_materialMasterIndex),
+            m_indices,
+            m_boundingBox,
+            m_positionQuantization
         )
     )
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    // The index count lives in the geometry ranges, so nothing else needs the indices once they are uploaded
+    if (!quartz::rendering::Model::getShouldRetainCpuData()) {
+        m_indices = std::vector<uint32_t>();
+        m_indicesHostAllocation.reset();
+    }
 }
 
 quartz::rendering::Primitive::Primitive(
@@ -405,8 +633,10 @@ quartz::rendering::Primitive::Primitive(
 ) :
     m_materialMasterIndex(other.m_materialMasterIndex),
     m_indices(std::move(other.m_indices)),
-    m_stagedVertexBuffer(std::move(other.m_stagedVertexBuffer)),
-    m_stagedIndexBuffer(std::move(other.m_stagedIndexBuffer))
+    m_indicesHostAllocation(std::move(other.m_indicesHostAllocation)),
+    m_boundingBox(other.m_boundingBox),
+    m_positionQuantization(other.m_positionQuantization),
+    m_lodGeometryRanges(std::move(other.m_lodGeometryRanges))
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
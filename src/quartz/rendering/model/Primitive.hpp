@@ -1,10 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
 #include <tiny_gltf.h>
 
 #include "quartz/rendering/Loggers.hpp"
-#include "quartz/rendering/buffer/StagedBuffer.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/material/Material.hpp"
 #include "quartz/rendering/model/Vertex.hpp"
 
@@ -15,42 +24,123 @@ namespace rendering {
 }
 
 class quartz::rendering::Primitive {
+public: // classes
+    /**
+     * @brief Everything the shaders need to know about a single instance of a primitive. These live in
+     *   a storage buffer which the vertex shader indexes into with gl_InstanceIndex (the draw's
+     *   firstInstance plus the instance) so we never need to push constants or rebind descriptor sets
+     *   between draws
+     */
+    struct DrawStorageBufferObject {
+    public: // member variables
+        alignas(16) glm::mat4 modelMatrix;
+        alignas(16) glm::vec3 positionQuantizationOffset; // the mesh's, for decoding packed vertex positions
+        alignas(16) glm::vec3 positionQuantizationScale;
+        alignas(4) uint32_t materialMasterIndex;
+    };
+
+    /**
+     * @brief The axis aligned bounds of the primitive's vertices in the primitive's local space
+     */
+    struct BoundingBox {
+    public: // member variables
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+    };
+
+    /**
+     * @brief How to simplify a primitive into one more level of detail when it is loaded, and when to draw
+     *   that level. Each level is simplified from the one before it
+     */
+    struct LodDescription {
+    public: // member variables
+        float indexRatio; // how many of the full resolution indices to aim for
+        float maxError; // how far the surface may move, as a fraction of the bounding box's diagonal
+        float maxScreenSize; // drawn once the doodad covers less than this fraction of the screen's height
+    };
+
 public: // member functions
     Primitive(
         const quartz::rendering::Device& renderingDevice,
         const tinygltf::Model& gltfModel,
         const tinygltf::Primitive& gltfPrimitive,
-        const std::vector<uint32_t>& materialMasterIndices
+        const std::vector<uint32_t>& materialMasterIndices,
+        const quartz::rendering::Vertex::PositionQuantization& positionQuantization
     );
     Primitive(Primitive&& other);
     ~Primitive();
 
     USE_LOGGER(MODEL_PRIMITIVE);
 
-    uint32_t getIndexCount() const { return m_indices.size(); }
-    const quartz::rendering::StagedBuffer& getStagedVertexBuffer() const { return m_stagedVertexBuffer; }
-    const quartz::rendering::StagedBuffer& getStagedIndexBuffer() const { return m_stagedIndexBuffer; }
+    uint32_t getIndexCount() const { return m_lodGeometryRanges[0].indexCount; }
+    const quartz::rendering::GeometryPool::Range& getGeometryRange() const { return m_lodGeometryRanges[0]; }
     uint32_t getMaterialMasterIndex() const { return m_materialMasterIndex; }
+    const quartz::rendering::Primitive::BoundingBox& getBoundingBox() const { return m_boundingBox; }
+    const quartz::rendering::Vertex::PositionQuantization& getPositionQuantization() const { return m_positionQuantization; }
+
+    /**
+     * @brief The full resolution indices. Empty unless the model was loaded while retaining cpu data
+     */
+    const std::vector<uint32_t>& getIndices() const { return m_indices; }
+
+    /**
+     * @brief Level 0 is the full resolution geometry. Every level shares the same vertices and only uses
+     *   fewer of them, so they all live in the same geometry pool block
+     */
+    uint32_t getLodCount() const { return m_lodGeometryRanges.size(); }
+    const quartz::rendering::GeometryPool::Range& getLodGeometryRange(const uint32_t lodLevel) const { return m_lodGeometryRanges[std::min<uint32_t>(lodLevel, m_lodGeometryRanges.size() - 1)]; }
+
+public: // static functions
+    /**
+     * @brief The levels every primitive loaded from now on is simplified into, which must be ordered from
+     *   the largest maxScreenSize to the smallest. Primitives which can't be simplified within a level's
+     *   error bound stop at the level before it
+     */
+    static void setLodDescriptions(const std::vector<quartz::rendering::Primitive::LodDescription>& lodDescriptions);
+    static const std::vector<quartz::rendering::Primitive::LodDescription>& getLodDescriptions() { return quartz::rendering::Primitive::lodDescriptions; }
+
+    /**
+     * @brief The level of detail to draw something covering screenSize of the screen's height with
+     */
+    static uint32_t selectLodLevel(const float screenSize);
+
+    /**
+     * @brief The bounds of the primitive's actual positions, ignoring whatever the accessor claims
+     */
+    static quartz::rendering::Primitive::BoundingBox calculateBoundingBox(
+        const tinygltf::Model& gltfModel,
+        const tinygltf::Primitive& gltfPrimitive
+    );
 
 private: // static functions
     // These are helper functions
+    /**
+     * @brief Texture coordinate slots are loaded from whichever TEXCOORD_n set the material put in them
+     */
+    static std::string determineAttributeGltfString(
+        const std::shared_ptr<quartz::rendering::Material>& p_material,
+        const quartz::rendering::Vertex::AttributeType attributeType
+    );
     static bool handleMissingVertexAttribute(
         std::vector<quartz::rendering::Vertex>& verticesToPopulate,
         const tinygltf::Model& gltfModel,
         const tinygltf::Primitive& gltfPrimitive,
+        const std::shared_ptr<quartz::rendering::Material>& p_material,
         const std::vector<uint32_t>& indices,
         const quartz::rendering::Vertex::AttributeType attributeType
     );
-    static bool handleDefaultTextureAttribute(
-        std::vector<quartz::rendering::Vertex>& verticesToPopulate,
+    static bool handleUnusedTextureCoordinateAttribute(
         const std::shared_ptr<quartz::rendering::Material>& p_material,
         const quartz::rendering::Vertex::AttributeType attributeType
     );
     static uint32_t determineGltfAccessorByteStride(
-        const quartz::rendering::Vertex::AttributeType attributeType,
         const tinygltf::Accessor& accessor,
         const tinygltf::BufferView& bufferView
     );
+    static glm::vec4 readGltfAccessorElement(
+        const tinygltf::Accessor& accessor,
+        const uint8_t* p_element
+    );
 
     // These functions are the actual meat and potatoes
     static uint32_t loadMaterialMasterIndex(
@@ -69,17 +159,33 @@ private: // static functions
         const std::vector<uint32_t>& indices,
         const quartz::rendering::Vertex::AttributeType attributeType
     );
-    static quartz::rendering::StagedBuffer createStagedVertexBuffer(
+    static quartz::rendering::Primitive::BoundingBox loadBoundingBox(
+        const tinygltf::Model& gltfModel,
+        const tinygltf::Primitive& gltfPrimitive
+    );
+    static std::vector<std::vector<uint32_t>> generateLodIndices(
+        const std::vector<quartz::rendering::Vertex>& vertices,
+        const std::vector<uint32_t>& indices,
+        const quartz::rendering::Primitive::BoundingBox& boundingBox
+    );
+    static std::vector<quartz::rendering::GeometryPool::Range> loadLodGeometryRanges(
         const quartz::rendering::Device& renderingDevice,
         const tinygltf::Model& gltfModel,
         const tinygltf::Primitive& gltfPrimitive,
         const std::shared_ptr<quartz::rendering::Material>& p_material,
-        const std::vector<uint32_t>& indices
+        const std::vector<uint32_t>& indices,
+        const quartz::rendering::Primitive::BoundingBox& boundingBox,
+        const quartz::rendering::Vertex::PositionQuantization& positionQuantization
     );
 
+private: // static variables
+    static std::vector<quartz::rendering::Primitive::LodDescription> lodDescriptions;
+
 private: // member variables
     uint32_t m_materialMasterIndex;
     std::vector<uint32_t> m_indices;
-    quartz::rendering::StagedBuffer m_stagedVertexBuffer;
-    quartz::rendering::StagedBuffer m_stagedIndexBuffer;
+    quartz::rendering::MemoryAccounting::HostAllocation m_indicesHostAllocation;
+    quartz::rendering::Primitive::BoundingBox m_boundingBox;
+    quartz::rendering::Vertex::PositionQuantization m_positionQuantization;
+    std::vector<quartz::rendering::GeometryPool::Range> m_lodGeometryRanges;
 };
\ No newline at end of file
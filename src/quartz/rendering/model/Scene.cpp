@@ -53,6 +53,10 @@ quartz::rendering::Scene::Scene(
     )
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    for (const std::shared_ptr<quartz::rendering::Node>& p_rootNode : m_rootNodePtrs) {
+        p_rootNode->updateTransformationMatrix();
+    }
 }
 
 quartz::rendering::Scene::Scene(
@@ -13,14 +13,16 @@ quartz::rendering::TangentCalculator::Information::Information(
     const uint32_t* p_indices_,
     const uint32_t indexCount_,
     quartz::rendering::Vertex* p_verticesToPopulate_,
-    const uint32_t vertexCount_
+    const uint32_t vertexCount_,
+    const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType_
 ) :
     p_gltfModel(p_gltfModel_),
     p_gltfPrimitive(p_gltfPrimitive_),
     p_indices(p_indices_),
     indexCount(indexCount_),
     p_verticesToPopulate(p_verticesToPopulate_),
-    vertexCount(vertexCount_)
+    vertexCount(vertexCount_),
+    textureCoordinateAttributeType(textureCoordinateAttributeType_)
 {}
 
 void
@@ -28,6 +30,7 @@ quartz::rendering::TangentCalculator::populateVerticesWithTangents(
     const tinygltf::Model& gltfModel,
     const tinygltf::Primitive& gltfPrimitive,
     const std::vector<uint32_t>& indices,
+    const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType,
     std::vector<quartz::rendering::Vertex>& verticesToPopulate
 ) {
     LOG_FUNCTION_SCOPE_TRACE(MODEL_PRIMITIVE, "");
@@ -47,7 +50,8 @@ quartz::rendering::TangentCalculator::populateVerticesWithTangents(
         indices.data(),
         indices.size(),
         verticesToPopulate.data(),
-        verticesToPopulate.size()
+        verticesToPopulate.size(),
+        textureCoordinateAttributeType
     );
 
     SMikkTSpaceContext mikktspaceContext;
@@ -111,8 +115,10 @@ quartz::rendering::TangentCalculator::getVertexAttribute(
             return vertex.position;
         case quartz::rendering::Vertex::AttributeType::Normal:
             return vertex.normal;
-        case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate:
-            return {vertex.normalTextureCoordinate.x, vertex.normalTextureCoordinate.y, 0.0f};
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
+            return {vertex.firstTextureCoordinate.x, vertex.firstTextureCoordinate.y, 0.0f};
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate:
+            return {vertex.secondTextureCoordinate.x, vertex.secondTextureCoordinate.y, 0.0f};
         default:
             LOG_ERROR(MODEL_PRIMITIVE, "  Not getting vertex attribute {}", quartz::rendering::Vertex::getAttributeGLTFString(type));
             return {0.0f, 0.0f, 0.0f};
@@ -186,11 +192,14 @@ quartz::rendering::TangentCalculator::getTextureCoordinate(
     UNUSED int32_t faceIndex,
     UNUSED int32_t faceLocalVertexIndex
 ) {
+    const quartz::rendering::TangentCalculator::Information* p_information =
+        static_cast<quartz::rendering::TangentCalculator::Information*>(p_mikktspaceContext->m_pUserData);
+
     const glm::vec3 vertexAttribute = quartz::rendering::TangentCalculator::getVertexAttribute(
         p_mikktspaceContext,
         faceIndex,
         faceLocalVertexIndex,
-        quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate
+        p_information->textureCoordinateAttributeType
     );
 
     textureCoordinateToPopulate2[0] = vertexAttribute.x;
@@ -201,7 +210,7 @@ void
 quartz::rendering::TangentCalculator::setTangentSpaceBasic(
     const SMikkTSpaceContext *p_mikktspaceContext,
     const float populatedTangent3[],
-    UNUSED float fSign,
+    float fSign,
     int32_t faceIndex,
     int32_t faceLocalVertexIndex
 ) {
@@ -221,21 +230,9 @@ quartz::rendering::TangentCalculator::setTangentSpaceBasic(
 
     quartz::rendering::Vertex& vertex = p_information->p_verticesToPopulate[masterVertexIndex];
 
-    /**
-     * @brief We are ignoring the fSign value for now. It seems that it might be needed for calculating
-     *   bitangent vectors using the equation `bitangent = fSign * cross(normal, tangent)` but we are
-     *   handling this in the shader and we might not actually need this value to do so? Maybe we are
-     *   okay without this because we are normalizing the tangent with respect to the normal in the
-     *   vertex shader?
-     *
-     * @todo 2023/12/17 Look into if we need to (or should) be passing fsign with the tangent to the
-     *   vertex shader for calculation of the bitangent. Maybe calculating `bitangent = fSign * cross(normal, tangent)`
-     *   is faster than doing it the way we are doing currently? But this will require an extra float (4 bytes)
-     *   to be passed to the vertex shader.
-     */
-
+    // The vertex shader decodes the bitangent as fSign * cross(normal, tangent), same as glTF's tangent.w
     vertex.tangent.x = populatedTangent3[0];
     vertex.tangent.y = populatedTangent3[1];
     vertex.tangent.z = populatedTangent3[2];
-//    vertex.tangent.w = fSign;
+    vertex.tangentHandedness = fSign < 0.0f ? -1.0f : 1.0f;
 }
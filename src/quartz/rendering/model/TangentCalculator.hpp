@@ -26,7 +26,8 @@ public: // classes and enums
             const uint32_t* p_indices_,
             const uint32_t indexCount_,
             quartz::rendering::Vertex* p_verticesToPopulate_,
-            const uint32_t vertexCount_
+            const uint32_t vertexCount_,
+            const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType_
         );
 
         const tinygltf::Model* p_gltfModel;
@@ -35,6 +36,7 @@ public: // classes and enums
         const uint32_t indexCount;
         quartz::rendering::Vertex* p_verticesToPopulate;
         const uint32_t vertexCount;
+        const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType; // the slot the normal texture samples with
     };
 
 public: // static functions
@@ -43,6 +45,7 @@ public: // static functions
         const tinygltf::Model& gltfModel,
         const tinygltf::Primitive& gltfPrimitive,
         const std::vector<uint32_t>& indices,
+        const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType,
         std::vector<quartz::rendering::Vertex>& verticesToPopulate
     );
 
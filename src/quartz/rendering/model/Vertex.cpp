@@ -1,4 +1,8 @@
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <vulkan/vulkan.hpp>
 
@@ -17,16 +21,10 @@ quartz::rendering::Vertex::getAttributeNameString(
             return "Tangent";
         case quartz::rendering::Vertex::AttributeType::Color:
             return "Color";
-        case quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate:
-            return "Base Color Texture Coordinate";
-        case quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate:
-            return "Metallic Roughness Texture Coordinate";
-        case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate:
-            return "Normal Texture Coordinate";
-        case quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate:
-            return "Emission Texture Coordinate";
-        case quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate:
-            return "Occlusion Texture Coordinate";
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
+            return "First Texture Coordinate";
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate:
+            return "Second Texture Coordinate";
     }
 }
 
@@ -43,20 +41,35 @@ quartz::rendering::Vertex::getAttributeGLTFString(
             return "TANGENT";
         case quartz::rendering::Vertex::AttributeType::Color:
             return "COLOR_0";
-        case quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate:
-        case quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate:
-        case quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate:
-        case quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate:
-        case quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate:
+        // The set actually loaded into each slot depends on the material, see Material::getTextureCoordinateSets
+        case quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate:
             return "TEXCOORD_0";
+        case quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate:
+            return "TEXCOORD_1";
     }
 }
 
+quartz::rendering::Vertex::AttributeType
+quartz::rendering::Vertex::getTextureCoordinateAttributeType(
+    const uint32_t textureCoordinateSlot
+) {
+    return static_cast<quartz::rendering::Vertex::AttributeType>(
+        static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate) + textureCoordinateSlot
+    );
+}
+
+uint32_t
+quartz::rendering::Vertex::getTextureCoordinateSlot(
+    const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType
+) {
+    return static_cast<uint32_t>(textureCoordinateAttributeType) - static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate);
+}
+
 vk::VertexInputBindingDescription
 quartz::rendering::Vertex::getVulkanVertexInputBindingDescription() {
     vk::VertexInputBindingDescription vertexInputBindingDescription(
         0,
-        sizeof(quartz::rendering::Vertex),
+        sizeof(quartz::rendering::Vertex::Packed),
         vk::VertexInputRate::eVertex
     );
 
@@ -69,91 +82,112 @@ quartz::rendering::Vertex::getVulkanVertexInputAttributeDescriptions() {
         vk::VertexInputAttributeDescription(
             static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::Position),
             0,
-            vk::Format::eR32G32B32Sfloat,
-            offsetof(quartz::rendering::Vertex, position)
+            vk::Format::eR16G16B16A16Unorm,
+            offsetof(quartz::rendering::Vertex::Packed, position)
         ),
         vk::VertexInputAttributeDescription(
             static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::Normal),
             0,
-            vk::Format::eR32G32B32Sfloat,
-            offsetof(quartz::rendering::Vertex, normal)
+            vk::Format::eR16G16Snorm,
+            offsetof(quartz::rendering::Vertex::Packed, normal)
         ),
         vk::VertexInputAttributeDescription(
             static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::Tangent),
             0,
-            vk::Format::eR32G32B32Sfloat,
-            offsetof(quartz::rendering::Vertex, tangent)
+            vk::Format::eR16G16Snorm,
+            offsetof(quartz::rendering::Vertex::Packed, tangent)
         ),
         vk::VertexInputAttributeDescription(
             static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::Color),
             0,
-            vk::Format::eR32G32B32Sfloat,
-            offsetof(quartz::rendering::Vertex, color)
-        ),
-        vk::VertexInputAttributeDescription(
-            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::BaseColorTextureCoordinate),
-            0,
-            vk::Format::eR32G32Sfloat,
-            offsetof(quartz::rendering::Vertex, baseColorTextureCoordinate)
-        ),
-        vk::VertexInputAttributeDescription(
-            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::MetallicRoughnessTextureCoordinate),
-            0,
-            vk::Format::eR32G32Sfloat,
-            offsetof(quartz::rendering::Vertex, metallicRoughnessTextureCoordinate)
-        ),
-        vk::VertexInputAttributeDescription(
-            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::NormalTextureCoordinate),
-            0,
-            vk::Format::eR32G32Sfloat,
-            offsetof(quartz::rendering::Vertex, normalTextureCoordinate)
+            vk::Format::eR8G8B8A8Unorm,
+            offsetof(quartz::rendering::Vertex::Packed, color)
         ),
         vk::VertexInputAttributeDescription(
-            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::EmissionTextureCoordinate),
+            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::FirstTextureCoordinate),
             0,
-            vk::Format::eR32G32Sfloat,
-            offsetof(quartz::rendering::Vertex, emissionTextureCoordinate)
+            vk::Format::eR16G16Sfloat,
+            offsetof(quartz::rendering::Vertex::Packed, firstTextureCoordinate)
         ),
         vk::VertexInputAttributeDescription(
-            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::OcclusionTextureCoordinate),
+            static_cast<uint32_t>(quartz::rendering::Vertex::AttributeType::SecondTextureCoordinate),
             0,
-            vk::Format::eR32G32Sfloat,
-            offsetof(quartz::rendering::Vertex, occlusionTextureCoordinate)
+            vk::Format::eR16G16Sfloat,
+            offsetof(quartz::rendering::Vertex::Packed, secondTextureCoordinate)
         )
     };
 
     return vertexInputAttributeDescriptions;
 }
 
+glm::vec2
+quartz::rendering::Vertex::encodeOctahedral(
+    const glm::vec3& unitVector
+) {
+    const float manhattanLength = glm::abs(unitVector.x) + glm::abs(unitVector.y) + glm::abs(unitVector.z);
+    if (manhattanLength == 0.0f) {
+        return glm::vec2(0.0f, 0.0f);
+    }
+
+    const glm::vec3 octahedronPoint = unitVector / manhattanLength;
+    if (octahedronPoint.z >= 0.0f) {
+        return glm::vec2(octahedronPoint.x, octahedronPoint.y);
+    }
+
+    // Fold the lower half of the octahedron out over the corners of the square
+    return glm::vec2(
+        (1.0f - glm::abs(octahedronPoint.y)) * (octahedronPoint.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - glm::abs(octahedronPoint.x)) * (octahedronPoint.y >= 0.0f ? 1.0f : -1.0f)
+    );
+}
+
+quartz::rendering::Vertex::Packed::Packed(
+    const quartz::rendering::Vertex& vertex,
+    const quartz::rendering::Vertex::PositionQuantization& positionQuantization
+) :
+    // The quantization covers every position in the mesh, so the clamp only catches rounding
+    position(
+        glm::u16vec3(glm::round(
+            glm::clamp((vertex.position - positionQuantization.offset) / positionQuantization.scale, 0.0f, 1.0f) * 65535.0f
+        )),
+        vertex.tangentHandedness < 0.0f ? 0xFFFF : 0
+    ),
+    normal(glm::round(
+        glm::clamp(quartz::rendering::Vertex::encodeOctahedral(vertex.normal), -1.0f, 1.0f) * 32767.0f
+    )),
+    tangent(glm::round(
+        glm::clamp(quartz::rendering::Vertex::encodeOctahedral(vertex.tangent), -1.0f, 1.0f) * 32767.0f
+    )),
+    color(
+        glm::u8vec3(glm::round(glm::clamp(vertex.color, 0.0f, 1.0f) * 255.0f)),
+        0xFF
+    ),
+    firstTextureCoordinate(glm::packHalf(vertex.firstTextureCoordinate)),
+    secondTextureCoordinate(glm::packHalf(vertex.secondTextureCoordinate))
+{}
+
 quartz::rendering::Vertex::Vertex() :
     position(0.0f, 0.0f, 0.0f),
     normal(0.0f, 0.0f, 0.0f),
+    tangentHandedness(1.0f),
     color(1.0f, 1.0f, 1.0f),
-    baseColorTextureCoordinate(0.0f, 0.0f),
-    metallicRoughnessTextureCoordinate(0.0f, 0.0f),
-    normalTextureCoordinate(0.0f, 0.0f),
-    emissionTextureCoordinate(0.0f, 0.0f),
-    occlusionTextureCoordinate(0.0f, 0.0f)
+    firstTextureCoordinate(0.0f, 0.0f),
+    secondTextureCoordinate(0.0f, 0.0f)
 {}
 
 quartz::rendering::Vertex::Vertex(
     const glm::vec3& position_,
     const glm::vec3& normal_,
     const glm::vec3& color_,
-    const glm::vec2& baseColorTextureCoordinate_,
-    const glm::vec2& metallicRoughnessTextureCoordinate_,
-    const glm::vec2& normalTextureCoordinate_,
-    const glm::vec2& emissionTextureCoordinate_,
-    const glm::vec2& occlusionTextureCoordinate_
+    const glm::vec2& firstTextureCoordinate_,
+    const glm::vec2& secondTextureCoordinate_
 ) :
     position(position_),
     normal(normal_),
+    tangentHandedness(1.0f),
     color(color_),
-    baseColorTextureCoordinate(baseColorTextureCoordinate_),
-    metallicRoughnessTextureCoordinate(metallicRoughnessTextureCoordinate_),
-    normalTextureCoordinate(normalTextureCoordinate_),
-    emissionTextureCoordinate(emissionTextureCoordinate_),
-    occlusionTextureCoordinate(occlusionTextureCoordinate_)
+    firstTextureCoordinate(firstTextureCoordinate_),
+    secondTextureCoordinate(secondTextureCoordinate_)
 {}
 
 bool
@@ -173,19 +207,10 @@ quartz::rendering::Vertex::operator==(
         color.y == other.color.y &&
         color.z == other.color.z &&
 
-        baseColorTextureCoordinate.x == other.baseColorTextureCoordinate.x &&
-        baseColorTextureCoordinate.y == other.baseColorTextureCoordinate.y &&
-
-        metallicRoughnessTextureCoordinate.x == other.metallicRoughnessTextureCoordinate.x &&
-        metallicRoughnessTextureCoordinate.y == other.metallicRoughnessTextureCoordinate.y &&
-
-        normalTextureCoordinate.x == other.normalTextureCoordinate.x &&
-        normalTextureCoordinate.y == other.normalTextureCoordinate.y &&
-
-        emissionTextureCoordinate.x == other.emissionTextureCoordinate.x &&
-        emissionTextureCoordinate.y == other.emissionTextureCoordinate.y &&
+        firstTextureCoordinate.x == other.firstTextureCoordinate.x &&
+        firstTextureCoordinate.y == other.firstTextureCoordinate.y &&
 
-        occlusionTextureCoordinate.x == other.occlusionTextureCoordinate.x &&
-        occlusionTextureCoordinate.y == other.occlusionTextureCoordinate.y
+        secondTextureCoordinate.x == other.secondTextureCoordinate.x &&
+        secondTextureCoordinate.y == other.secondTextureCoordinate.y
     );
 }
\ No newline at end of file
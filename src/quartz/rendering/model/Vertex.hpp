@@ -2,6 +2,7 @@
 
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <vulkan/vulkan.hpp>
 
@@ -19,11 +20,49 @@ public: // enums
         Tangent     = 2,
         Color       = 3,
 
-        BaseColorTextureCoordinate          = 4,
-        MetallicRoughnessTextureCoordinate  = 5,
-        NormalTextureCoordinate             = 6,
-        EmissionTextureCoordinate           = 7,
-        OcclusionTextureCoordinate          = 8
+        /**
+         * @brief Texture coordinate slots rather than GLTF's TEXCOORD_n sets. Each material decides which
+         *   of its sets go in which slot, and which slot each of its textures samples with
+         */
+        FirstTextureCoordinate  = 4,
+        SecondTextureCoordinate = 5
+    };
+
+public: // classes
+    /**
+     * @brief Decoded position = offset + scale * quantized position, where the quantized position is in
+     *   [0, 1] on every axis. Chosen per mesh, so an edge shared by two of its primitives decodes to
+     *   the same positions in both
+     */
+    struct PositionQuantization {
+    public: // member variables
+        glm::vec3 offset;
+        glm::vec3 scale;
+    };
+
+    /**
+     * @brief The layout vertices are stored in on the gpu, 28 bytes instead of the 68 of a full precision
+     *   vertex. Positions are 16 bit normalized integers relative to their mesh's position
+     *   quantization, normals and tangents are octahedral encoded into two 16 bit normalized integers,
+     *   colors are 8 bit normalized integers and texture coordinates are half floats. Only positions from
+     *   KHR_mesh_quantization come through unchanged. Its normals and tangents are re-encoded, and its
+     *   16 bit texture coordinates lose precision as half floats, which have 11 significant bits
+     */
+    struct Packed {
+    public: // member functions
+        Packed(
+            const quartz::rendering::Vertex& vertex,
+            const quartz::rendering::Vertex::PositionQuantization& positionQuantization
+        );
+
+    public: // member variables
+        glm::u16vec4 position; // w is 0xFFFF when the tangent's handedness is negative
+        glm::i16vec2 normal;
+        glm::i16vec2 tangent;
+        glm::u8vec4 color;
+
+        glm::u16vec2 firstTextureCoordinate;
+        glm::u16vec2 secondTextureCoordinate;
     };
 
 public: // member functions
@@ -32,31 +71,33 @@ public: // member functions
         const glm::vec3& position_,
         const glm::vec3& normal_,
         const glm::vec3& color_,
-        const glm::vec2& baseColorTextureCoordinate_,
-        const glm::vec2& metallicRoughnessTextureCoordinate_,
-        const glm::vec2& normalTextureCoordinate_,
-        const glm::vec2& emissionTextureCoordinate_,
-        const glm::vec2& occlusionTextureCoordinate_
+        const glm::vec2& firstTextureCoordinate_,
+        const glm::vec2& secondTextureCoordinate_
     );
     bool operator==(const Vertex& other) const;
 
 public: // static functions
     static std::string getAttributeNameString(const quartz::rendering::Vertex::AttributeType attributeType);
     static std::string getAttributeGLTFString(const quartz::rendering::Vertex::AttributeType type);
+    static quartz::rendering::Vertex::AttributeType getTextureCoordinateAttributeType(const uint32_t textureCoordinateSlot);
+    static uint32_t getTextureCoordinateSlot(const quartz::rendering::Vertex::AttributeType textureCoordinateAttributeType);
     static vk::VertexInputBindingDescription getVulkanVertexInputBindingDescription();
     static std::vector<vk::VertexInputAttributeDescription> getVulkanVertexInputAttributeDescriptions();
 
+    /**
+     * @brief Map the unit vector onto an octahedron and unfold that onto the [-1, 1] square
+     */
+    static glm::vec2 encodeOctahedral(const glm::vec3& unitVector);
+
 public: // member variables
     glm::vec3 position;
     glm::vec3 normal;
     glm::vec3 tangent;
+    float tangentHandedness; // 1 or -1. bitangent = tangentHandedness * cross(normal, tangent)
     glm::vec3 color;
 
-    glm::vec2 baseColorTextureCoordinate;
-    glm::vec2 metallicRoughnessTextureCoordinate;
-    glm::vec2 normalTextureCoordinate;
-    glm::vec2 emissionTextureCoordinate;
-    glm::vec2 occlusionTextureCoordinate;
+    glm::vec2 firstTextureCoordinate;
+    glm::vec2 secondTextureCoordinate;
 };
 
 template <> struct std::hash<quartz::rendering::Vertex> {
@@ -66,13 +107,10 @@ template <> struct std::hash<quartz::rendering::Vertex> {
         std::vector<float> values = {
             vertex.position.x, vertex.position.y, vertex.position.z,
             vertex.normal.x,   vertex.normal.y,   vertex.normal.z,
-            vertex.tangent.x,  vertex.tangent.y,  vertex.tangent.z,
+            vertex.tangent.x,  vertex.tangent.y,  vertex.tangent.z,  vertex.tangentHandedness,
             vertex.color.x,    vertex.color.y,    vertex.color.z,
-            vertex.baseColorTextureCoordinate.x,         vertex.baseColorTextureCoordinate.y,
-            vertex.metallicRoughnessTextureCoordinate.x, vertex.metallicRoughnessTextureCoordinate.y,
-            vertex.normalTextureCoordinate.x,            vertex.normalTextureCoordinate.y,
-            vertex.emissionTextureCoordinate.x,          vertex.emissionTextureCoordinate.y,
-            vertex.occlusionTextureCoordinate.x,         vertex.occlusionTextureCoordinate.y
+            vertex.firstTextureCoordinate.x,  vertex.firstTextureCoordinate.y,
+            vertex.secondTextureCoordinate.x, vertex.secondTextureCoordinate.y
         };
 
         for (const float value : values) {
@@ -7,7 +7,8 @@
 #include "util/logger/Logger.hpp"
 
 #include "quartz/rendering/Loggers.hpp"
-#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/buffer/BufferUtil.hpp"
+#include "quartz/rendering/buffer/FrameRingBuffer.hpp"
 #include "quartz/rendering/device/Device.hpp"
 #include "quartz/rendering/pipeline/Pipeline.hpp"
 #include "quartz/rendering/window/Window.hpp"
@@ -38,39 +39,102 @@ quartz::rendering::Pipeline::createVulkanShaderModulePtr(
     return p_shaderModule;
 }
 
-std::vector<quartz::rendering::LocallyMappedBuffer>
-quartz::rendering::Pipeline::createLocallyMappedBuffers(
+quartz::rendering::FrameRingBuffer
+quartz::rendering::Pipeline::createUniformRingBuffer(
     const quartz::rendering::Device& renderingDevice,
     const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
     const uint32_t maxNumFramesInFlight
 ) {
     LOG_FUNCTION_SCOPE_TRACE(PIPELINE, "{} frames in flight, {} buffer infos", maxNumFramesInFlight, uniformBufferInfos.size());
 
-    LOG_TRACE(PIPELINE, "{} frames in flight", maxNumFramesInFlight);
-    LOG_TRACE(PIPELINE, "{} buffer infos", uniformBufferInfos.size());
-    LOG_TRACE(PIPELINE, "{} total locally mapped buffers", maxNumFramesInFlight * uniformBufferInfos.size());
-    LOG_TRACE(PIPELINE, "because we need one buffer per uniform buffer per frame in flight");
+    const uint32_t alignmentBytes = quartz::rendering::FrameRingBuffer::calculateAlignmentBytes(
+        renderingDevice
+    );
+
+    uint32_t frameRegionSizeBytes = 0;
+    vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eUniformBuffer;
+    vk::MemoryPropertyFlags memoryPropertyFlags = vk::MemoryPropertyFlagBits::eHostVisible;
+
+    for (const quartz::rendering::UniformBufferInfo& uniformBufferInfo : uniformBufferInfos) {
+        frameRegionSizeBytes += (uniformBufferInfo.getLocallyMappedBufferSize() + alignmentBytes - 1) & ~(alignmentBytes - 1);
+        usageFlags |= uniformBufferInfo.getLocallyMappedBufferVulkanUsageFlags();
+        memoryPropertyFlags |= uniformBufferInfo.getLocallyMappedBufferVulkanPropertyFlags();
+    }
+
+    LOG_TRACE(PIPELINE, "Using {} bytes per frame in flight", frameRegionSizeBytes);
+    LOG_TRACE(PIPELINE, "Using usage flags {}", quartz::rendering::BufferUtil::getUsageFlagsString(usageFlags));
+
+    return {
+        renderingDevice,
+        frameRegionSizeBytes,
+        maxNumFramesInFlight,
+        usageFlags,
+        memoryPropertyFlags
+    };
+}
 
-    std::vector<quartz::rendering::LocallyMappedBuffer> buffers;
+std::vector<uint32_t>
+quartz::rendering::Pipeline::allocateUniformBufferOffsets(
+    quartz::rendering::FrameRingBuffer& uniformRingBuffer,
+    const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
+    const uint32_t maxNumFramesInFlight
+) {
+    LOG_FUNCTION_SCOPE_TRACE(PIPELINE, "{} frames in flight, {} buffer infos", maxNumFramesInFlight, uniformBufferInfos.size());
+
+    /**
+     * @brief Each uniform buffer gets the same spot in every frame's region for the lifetime of the
+     *   pipeline, so frames can skip rewriting whatever has not changed since they last wrote it
+     */
+    std::vector<uint32_t> uniformBufferOffsets;
+    uniformBufferOffsets.reserve(maxNumFramesInFlight * uniformBufferInfos.size());
 
     for (uint32_t i = 0; i < maxNumFramesInFlight; ++i) {
         for (const quartz::rendering::UniformBufferInfo& uniformBufferInfo : uniformBufferInfos) {
-            buffers.emplace_back(
-                renderingDevice,
-                uniformBufferInfo.getLocallyMappedBufferSize(),
-                uniformBufferInfo.getLocallyMappedBufferVulkanUsageFlags(),
-                uniformBufferInfo.getLocallyMappedBufferVulkanPropertyFlags()
+            uniformBufferOffsets.push_back(
+                uniformRingBuffer.allocate(i, uniformBufferInfo.getLocallyMappedBufferSize())
             );
         }
     }
 
-    LOG_TRACE(PIPELINE, "Created {} locally mapped buffers", buffers.size());
+    LOG_TRACE(PIPELINE, "Allocated {} uniform buffers", uniformBufferOffsets.size());
+
+    return uniformBufferOffsets;
+}
+
+std::vector<std::vector<uint32_t>>
+quartz::rendering::Pipeline::createDynamicOffsets(
+    const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
+    const std::vector<uint32_t>& uniformBufferOffsets,
+    const uint32_t maxNumFramesInFlight
+) {
+    LOG_FUNCTION_SCOPE_TRACE(PIPELINE, "{} frames in flight", maxNumFramesInFlight);
+
+    std::vector<uint32_t> dynamicUniformBufferIndices;
+    for (uint32_t i = 0; i < uniformBufferInfos.size(); ++i) {
+        if (uniformBufferInfos[i].isDynamic()) {
+            dynamicUniformBufferIndices.push_back(i);
+        }
+    }
+
+    std::sort(
+        dynamicUniformBufferIndices.begin(),
+        dynamicUniformBufferIndices.end(),
+        [&uniformBufferInfos](const uint32_t a, const uint32_t b) {
+            return uniformBufferInfos[a].getBindingLocation() < uniformBufferInfos[b].getBindingLocation();
+        }
+    );
+
+    LOG_TRACE(PIPELINE, "{} of {} uniform buffers are dynamic", dynamicUniformBufferIndices.size(), uniformBufferInfos.size());
+
+    std::vector<std::vector<uint32_t>> dynamicOffsets(maxNumFramesInFlight);
 
-    if (buffers.size() != maxNumFramesInFlight * uniformBufferInfos.size()) {
-        LOG_THROW(PIPELINE, util::VulkanCreationFailedError, "Created {} locally mapped buffers instead of expected {}", buffers.size(), maxNumFramesInFlight * uniformBufferInfos.size());
+    for (uint32_t i = 0; i < maxNumFramesInFlight; ++i) {
+        for (const uint32_t uniformBufferIndex : dynamicUniformBufferIndices) {
+            dynamicOffsets[i].push_back(uniformBufferOffsets[i * uniformBufferInfos.size() + uniformBufferIndex]);
+        }
     }
 
-    return buffers;
+    return dynamicOffsets;
 }
 
 vk::UniqueDescriptorSetLayout
@@ -259,7 +323,8 @@ void
 quartz::rendering::Pipeline::updateUniformBufferDescriptorSets(
     const vk::UniqueDevice& p_logicalDevice,
     const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
-    const std::vector<quartz::rendering::LocallyMappedBuffer>& locallyMappedBuffers,
+    const quartz::rendering::FrameRingBuffer& uniformRingBuffer,
+    const std::vector<uint32_t>& uniformBufferOffsets,
     const std::vector<vk::DescriptorSet>& descriptorSets
 ) {
     LOG_FUNCTION_SCOPE_TRACE(PIPELINE, "");
@@ -275,17 +340,26 @@ quartz::rendering::Pipeline::updateUniformBufferDescriptorSets(
         uniformBufferDescriptorInfos.reserve(uniformBufferInfos.size()); // Everything breaks if we don't reserve the space ahead of time
 
         for (uint32_t j = 0; j < uniformBufferInfos.size(); ++j) {
-            const uint32_t locallyMappedBufferIndex = i * uniformBufferInfos.size() + j;
+            const uint32_t uniformBufferOffsetIndex = i * uniformBufferInfos.size() + j;
             LOG_TRACE(PIPELINE, "    Using uniform buffer info {}", j);
             LOG_TRACE(PIPELINE, "      destination binding    = {}", uniformBufferInfos[j].getBindingLocation());
             LOG_TRACE(PIPELINE, "      descriptor count       = {}", uniformBufferInfos[j].getDescriptorCount());
             LOG_TRACE(PIPELINE, "      object stride in bytes = {}", uniformBufferInfos[j].getObjectStrideBytes());
             LOG_TRACE(PIPELINE, "      vulkan descriptor type = {}", quartz::rendering::VulkanUtil::toString(uniformBufferInfos[j].getVulkanDescriptorType()));
 
+            /**
+             * @brief Storage buffers are indexed into by the shader so they need to see the whole
+             *   buffer, whereas (dynamic) uniform buffers only ever see a single object at a time.
+             *   Dynamic buffers get their offset when the descriptor set is bound instead of here
+             */
             uniformBufferDescriptorInfos.emplace_back(
-                *(locallyMappedBuffers[locallyMappedBufferIndex].getVulkanLogicalBufferPtr()),
-                0,
-                uniformBufferInfos[j].getObjectStrideBytes()
+                *(uniformRingBuffer.getVulkanLogicalBufferPtr()),
+                uniformBufferInfos[j].isDynamic() ?
+                    0 :
+                    uniformBufferOffsets[uniformBufferOffsetIndex],
+                uniformBufferInfos[j].isStorageBuffer() ?
+                    uniformBufferInfos[j].getLocallyMappedBufferSize() :
+                    uniformBufferInfos[j].getObjectStrideBytes()
             );
             vk::WriteDescriptorSet writeDescriptorSet(
                 descriptorSet,
@@ -482,7 +556,8 @@ vk::UniquePipelineLayout
 quartz::rendering::Pipeline::createVulkanPipelineLayoutPtr(
     const vk::UniqueDevice& p_logicalDevice,
     UNUSED const std::vector<quartz::rendering::PushConstantInfo>& pushConstantInfos,
-    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+    const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+    const std::vector<vk::DescriptorSetLayout>& externalDescriptorSetLayouts
 ) {
     LOG_FUNCTION_SCOPE_TRACE(PIPELINE, "");
 
@@ -503,9 +578,18 @@ quartz::rendering::Pipeline::createVulkanPipelineLayoutPtr(
         );
     }
 
+    LOG_TRACE(PIPELINE, "Using {} external descriptor set layouts", externalDescriptorSetLayouts.size());
+
+    std::vector<vk::DescriptorSetLayout> descriptorSetLayouts = { *p_descriptorSetLayout };
+    descriptorSetLayouts.insert(
+        descriptorSetLayouts.end(),
+        externalDescriptorSetLayouts.begin(),
+        externalDescriptorSetLayouts.end()
+    );
+
     vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo(
         {},
-        *p_descriptorSetLayout,
+        descriptorSetLayouts,
         pushConstantRanges
     );
 
@@ -521,6 +605,7 @@ quartz::rendering::Pipeline::createVulkanPipelineLayoutPtr(
 vk::UniquePipeline
 quartz::rendering::Pipeline::createVulkanGraphicsPipelinePtr(
     const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniquePipelineCache& p_pipelineCache,
     const vk::VertexInputBindingDescription vertexInputBindingDescriptions,
     const std::vector<vk::VertexInputAttributeDescription> vertexInputAttributeDescriptions,
     const std::vector<vk::Viewport> viewports,
@@ -678,7 +763,7 @@ quartz::rendering::Pipeline::createVulkanGraphicsPipelinePtr(
     );
 
     vk::ResultValue<vk::UniquePipeline> graphicsPipelineCreationResult = p_logicalDevice->createGraphicsPipelineUnique(
-        VK_NULL_HANDLE,
+        *p_pipelineCache,
         graphicsPipelineCreateInfo
     );
 
@@ -704,7 +789,8 @@ quartz::rendering::Pipeline::Pipeline(
     const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
     const std::optional<quartz::rendering::UniformSamplerCubeInfo>& o_uniformSamplerCubeInfo,
     const std::optional<quartz::rendering::UniformSamplerInfo>& o_uniformSamplerInfo,
-    const std::optional<quartz::rendering::UniformTextureArrayInfo>& o_uniformTextureArrayInfo
+    const std::optional<quartz::rendering::UniformTextureArrayInfo>& o_uniformTextureArrayInfo,
+    const std::vector<vk::DescriptorSetLayout>& externalVulkanDescriptorSetLayouts
 ) :
     m_vulkanVertexInputBindingDescriptions(vertexInputBindingDescription),
     m_vulkanVertexInputAttributeDescriptions(vertexInputAttributeDescriptions),
@@ -764,13 +850,28 @@ quartz::rendering::Pipeline::Pipeline(
     mo_uniformSamplerCubeInfo(o_uniformSamplerCubeInfo),
     mo_uniformSamplerInfo(o_uniformSamplerInfo),
     mo_uniformTextureArrayInfo(o_uniformTextureArrayInfo),
-    m_locallyMappedBuffers(
-        quartz::rendering::Pipeline::createLocallyMappedBuffers(
+    m_externalVulkanDescriptorSetLayouts(externalVulkanDescriptorSetLayouts),
+    m_uniformRingBuffer(
+        quartz::rendering::Pipeline::createUniformRingBuffer(
             renderingDevice,
             m_uniformBufferInfos,
             maxNumFramesInFlight
         )
     ),
+    m_uniformBufferOffsets(
+        quartz::rendering::Pipeline::allocateUniformBufferOffsets(
+            m_uniformRingBuffer,
+            m_uniformBufferInfos,
+            maxNumFramesInFlight
+        )
+    ),
+    m_dynamicOffsets(
+        quartz::rendering::Pipeline::createDynamicOffsets(
+            m_uniformBufferInfos,
+            m_uniformBufferOffsets,
+            maxNumFramesInFlight
+        )
+    ),
     mp_vulkanDescriptorSetLayout(
         quartz::rendering::Pipeline::createVulkanDescriptorSetLayoutPtr(
             renderingDevice.getVulkanLogicalDevicePtr(),
@@ -802,12 +903,14 @@ quartz::rendering::Pipeline::Pipeline(
         quartz::rendering::Pipeline::createVulkanPipelineLayoutPtr(
             renderingDevice.getVulkanLogicalDevicePtr(),
             m_pushConstantInfos,
-            mp_vulkanDescriptorSetLayout
+            mp_vulkanDescriptorSetLayout,
+            m_externalVulkanDescriptorSetLayouts
         )
     ),
     mp_vulkanGraphicsPipeline(
         quartz::rendering::Pipeline::createVulkanGraphicsPipelinePtr(
             renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingDevice.getVulkanPipelineCachePtr(),
             m_vulkanVertexInputBindingDescriptions,
             m_vulkanVertexInputAttributeDescriptions,
             m_vulkanViewports,
@@ -848,10 +951,12 @@ quartz::rendering::Pipeline::recreate(
     mp_vulkanPipelineLayout = quartz::rendering::Pipeline::createVulkanPipelineLayoutPtr(
         renderingDevice.getVulkanLogicalDevicePtr(),
         m_pushConstantInfos,
-        mp_vulkanDescriptorSetLayout
+        mp_vulkanDescriptorSetLayout,
+        m_externalVulkanDescriptorSetLayouts
     );
     mp_vulkanGraphicsPipeline = quartz::rendering::Pipeline::createVulkanGraphicsPipelinePtr(
         renderingDevice.getVulkanLogicalDevicePtr(),
+        renderingDevice.getVulkanPipelineCachePtr(),
         m_vulkanVertexInputBindingDescriptions,
         m_vulkanVertexInputAttributeDescriptions,
         m_vulkanViewports,
@@ -874,7 +979,8 @@ quartz::rendering::Pipeline::updateUniformBufferDescriptorSets(
     quartz::rendering::Pipeline::updateUniformBufferDescriptorSets(
         renderingDevice.getVulkanLogicalDevicePtr(),
         m_uniformBufferInfos,
-        m_locallyMappedBuffers,
+        m_uniformRingBuffer,
+        m_uniformBufferOffsets,
         m_vulkanDescriptorSets
     );
 }
@@ -928,11 +1034,55 @@ quartz::rendering::Pipeline::updateUniformBuffer(
 ) {
     const quartz::rendering::UniformBufferInfo& uniformBufferInfo = m_uniformBufferInfos[uniformIndex];
 
-    const uint32_t locallyMappedBufferIndex = currentInFlightFrameIndex * m_uniformBufferInfos.size() + uniformIndex;
+    const uint32_t uniformBufferOffsetIndex = currentInFlightFrameIndex * m_uniformBufferInfos.size() + uniformIndex;
+    const uint32_t uniformBufferOffset = m_uniformBufferOffsets[uniformBufferOffsetIndex];
 
     memcpy(
-        m_locallyMappedBuffers[locallyMappedBufferIndex].getMappedLocalMemoryPtr(),
+        m_uniformRingBuffer.getMappedLocalMemoryPtr(uniformBufferOffset),
         p_dataToCopy,
         uniformBufferInfo.getLocallyMappedBufferSize()
     );
+
+    m_uniformRingBuffer.markWritten(
+        currentInFlightFrameIndex,
+        uniformBufferOffset,
+        uniformBufferInfo.getLocallyMappedBufferSize()
+    );
+}
+
+void*
+quartz::rendering::Pipeline::getMappedUniformBufferPtr(
+    const uint32_t currentInFlightFrameIndex,
+    const uint32_t uniformIndex
+) {
+    const uint32_t uniformBufferOffsetIndex = currentInFlightFrameIndex * m_uniformBufferInfos.size() + uniformIndex;
+
+    return m_uniformRingBuffer.getMappedLocalMemoryPtr(m_uniformBufferOffsets[uniformBufferOffsetIndex]);
+}
+
+void
+quartz::rendering::Pipeline::markUniformBufferWritten(
+    const uint32_t currentInFlightFrameIndex,
+    const uint32_t uniformIndex,
+    const uint32_t offsetBytes,
+    const uint32_t sizeBytes
+) {
+    const uint32_t uniformBufferOffsetIndex = currentInFlightFrameIndex * m_uniformBufferInfos.size() + uniformIndex;
+
+    m_uniformRingBuffer.markWritten(
+        currentInFlightFrameIndex,
+        m_uniformBufferOffsets[uniformBufferOffsetIndex] + offsetBytes,
+        sizeBytes
+    );
+}
+
+void
+quartz::rendering::Pipeline::flushUniformBuffers(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t currentInFlightFrameIndex
+) {
+    m_uniformRingBuffer.flush(
+        renderingDevice,
+        currentInFlightFrameIndex
+    );
 }
@@ -8,7 +8,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include "quartz/rendering/Loggers.hpp"
-#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/buffer/FrameRingBuffer.hpp"
 #include "quartz/rendering/device/Device.hpp"
 #include "quartz/rendering/pipeline/PushConstantInfo.hpp"
 #include "quartz/rendering/pipeline/UniformBufferInfo.hpp"
@@ -48,7 +48,8 @@ public: // member functions
         const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
         const std::optional<quartz::rendering::UniformSamplerCubeInfo>& o_uniformSamplerCubeInfo,
         const std::optional<quartz::rendering::UniformSamplerInfo>& o_uniformSamplerInfo,
-        const std::optional<quartz::rendering::UniformTextureArrayInfo>& o_uniformTextureArrayInfo
+        const std::optional<quartz::rendering::UniformTextureArrayInfo>& o_uniformTextureArrayInfo,
+        const std::vector<vk::DescriptorSetLayout>& externalVulkanDescriptorSetLayouts
     );
     ~Pipeline();
 
@@ -93,16 +94,58 @@ public: // member functions
         void* p_dataToCopy
     );
 
+    /**
+     * @brief Get the mapped memory backing a uniform buffer for a given frame so large buffers
+     *   (like the per draw storage buffer) can be written into piece by piece instead of
+     *   being staged in a separate cpu side array and copied over wholesale. Anything written
+     *   through this must be passed to markUniformBufferWritten afterwards
+     */
+    void* getMappedUniformBufferPtr(
+        const uint32_t currentInFlightFrameIndex,
+        const uint32_t uniformIndex
+    );
+    void markUniformBufferWritten(
+        const uint32_t currentInFlightFrameIndex,
+        const uint32_t uniformIndex,
+        const uint32_t offsetBytes,
+        const uint32_t sizeBytes
+    );
+
+    /**
+     * @brief Make everything written into the frame's uniform buffers visible to the device, in a
+     *   single flush. This must be called before submitting the frame's command buffer
+     */
+    void flushUniformBuffers(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t currentInFlightFrameIndex
+    );
+
+    /**
+     * @brief The offsets into the uniform ring buffer for the frame's dynamic uniform and storage
+     *   buffers, ordered by binding location like vkCmdBindDescriptorSets wants them
+     */
+    const std::vector<uint32_t>& getDynamicOffsets(const uint32_t currentInFlightFrameIndex) const { return m_dynamicOffsets[currentInFlightFrameIndex]; }
+
 private: // static functions
     static vk::UniqueShaderModule createVulkanShaderModulePtr(
         const vk::UniqueDevice& p_logicalDevice,
         const std::string& filepath
     );
-    static std::vector<quartz::rendering::LocallyMappedBuffer> createLocallyMappedBuffers(
+    static quartz::rendering::FrameRingBuffer createUniformRingBuffer(
         const quartz::rendering::Device& renderingDevice,
         const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
         const uint32_t maxNumFramesInFlight
     );
+    static std::vector<uint32_t> allocateUniformBufferOffsets(
+        quartz::rendering::FrameRingBuffer& uniformRingBuffer,
+        const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
+        const uint32_t maxNumFramesInFlight
+    );
+    static std::vector<std::vector<uint32_t>> createDynamicOffsets(
+        const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
+        const std::vector<uint32_t>& uniformBufferOffsets,
+        const uint32_t maxNumFramesInFlight
+    );
     static vk::UniqueDescriptorSetLayout createVulkanDescriptorSetLayoutPtr(
         const vk::UniqueDevice& p_logicalDevice,
         const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
@@ -127,7 +170,8 @@ private: // static functions
     static void updateUniformBufferDescriptorSets(
         const vk::UniqueDevice& p_logicalDevice,
         const std::vector<quartz::rendering::UniformBufferInfo>& uniformBufferInfos,
-        const std::vector<quartz::rendering::LocallyMappedBuffer>& locallyMappedBuffers,
+        const quartz::rendering::FrameRingBuffer& uniformRingBuffer,
+        const std::vector<uint32_t>& uniformBufferOffsets,
         const std::vector<vk::DescriptorSet>& descriptorSets
     );
     static void updateUniformSamplerCubeDescriptorSets(
@@ -152,10 +196,12 @@ private: // static functions
     static vk::UniquePipelineLayout createVulkanPipelineLayoutPtr(
         const vk::UniqueDevice& p_logicalDevice,
         const std::vector<quartz::rendering::PushConstantInfo>& pushConstantInfos,
-        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout
+        const vk::UniqueDescriptorSetLayout& p_descriptorSetLayout,
+        const std::vector<vk::DescriptorSetLayout>& externalDescriptorSetLayouts
     );
     static vk::UniquePipeline createVulkanGraphicsPipelinePtr(
         const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniquePipelineCache& p_pipelineCache,
         const vk::VertexInputBindingDescription vertexInputBindingDescriptions,
         const std::vector<vk::VertexInputAttributeDescription> vertexInputAttributeDescriptions,
         const std::vector<vk::Viewport> viewports,
@@ -173,6 +219,11 @@ private: // static functions
 private: // member variables
     vk::VertexInputBindingDescription m_vulkanVertexInputBindingDescriptions;
     std::vector<vk::VertexInputAttributeDescription> m_vulkanVertexInputAttributeDescriptions;
+
+    /**
+     * @brief The viewport and scissor are dynamic state set whenever the pipeline is bound, so these only
+     *   tell the pipeline how many there are. The window's size at creation doesn't matter after a resize
+     */
     std::vector<vk::Viewport> m_vulkanViewports;
     std::vector<vk::Rect2D> m_vulkanScissorRectangles;
     vk::CullModeFlags m_vulkanCullModeFlags;
@@ -189,7 +240,20 @@ private: // member variables
     std::optional<quartz::rendering::UniformSamplerInfo> mo_uniformSamplerInfo;
     std::optional<quartz::rendering::UniformTextureArrayInfo> mo_uniformTextureArrayInfo;
 
-    std::vector<quartz::rendering::LocallyMappedBuffer> m_locallyMappedBuffers;
+    /**
+     * @brief Layouts of descriptor sets owned by something else (like the light culler's clusters) which
+     *   are bound right after this pipeline's own descriptor set, as set 1 onwards
+     */
+    std::vector<vk::DescriptorSetLayout> m_externalVulkanDescriptorSetLayouts;
+
+    /**
+     * @brief Every uniform buffer of every frame lives in this one buffer. The offsets are indexed by
+     *   frame in flight then uniform buffer info, and dynamic uniform buffers are bound using them
+     *   as dynamic offsets instead of having them baked into the descriptor sets
+     */
+    quartz::rendering::FrameRingBuffer m_uniformRingBuffer;
+    std::vector<uint32_t> m_uniformBufferOffsets;
+    std::vector<std::vector<uint32_t>> m_dynamicOffsets;
     vk::UniqueDescriptorSetLayout mp_vulkanDescriptorSetLayout;
     vk::UniqueDescriptorPool m_vulkanDescriptorPoolPtr; /** @todo 2024/06/07 Do we need to track this? It is only used when allocating descriptor sets */
     std::vector<vk::DescriptorSet> m_vulkanDescriptorSets;
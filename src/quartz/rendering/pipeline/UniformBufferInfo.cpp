@@ -8,7 +8,7 @@ quartz::rendering::UniformBufferInfo::calculateDynamicUniformBufferByteStride(
     const quartz::rendering::Device& renderingDevice,
     const uint32_t uniformBufferObjectSizeBytes
 ) {
-    const uint32_t minUniformBufferOffsetAlignment = renderingDevice.getVulkanPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+    const uint32_t minUniformBufferOffsetAlignment = renderingDevice.getVulkanPhysicalDeviceLimits().minUniformBufferOffsetAlignment;
 
     const uint32_t byteStride = minUniformBufferOffsetAlignment > 0 ?
         (uniformBufferObjectSizeBytes + minUniformBufferOffsetAlignment - 1) & ~(minUniformBufferOffsetAlignment - 1) :
@@ -17,6 +17,20 @@ quartz::rendering::UniformBufferInfo::calculateDynamicUniformBufferByteStride(
     return byteStride;
 }
 
+vk::BufferUsageFlags
+quartz::rendering::UniformBufferInfo::getVulkanUsageFlags(
+    const vk::DescriptorType descriptorType
+) {
+    if (
+        descriptorType == vk::DescriptorType::eStorageBuffer ||
+        descriptorType == vk::DescriptorType::eStorageBufferDynamic
+    ) {
+        return vk::BufferUsageFlagBits::eStorageBuffer;
+    }
+
+    return vk::BufferUsageFlagBits::eUniformBuffer;
+}
+
 quartz::rendering::UniformBufferInfo::UniformBufferInfo(
     const uint32_t locallyMappedBufferSizeBytes,
     const vk::MemoryPropertyFlags locallyMappedBufferPropertyFlags,
@@ -25,14 +39,34 @@ quartz::rendering::UniformBufferInfo::UniformBufferInfo(
     const uint32_t objectStrideBytes,
     const bool isDynamic,
     const vk::ShaderStageFlags shaderStageFlags
+) :
+    quartz::rendering::UniformBufferInfo(
+        locallyMappedBufferSizeBytes,
+        locallyMappedBufferPropertyFlags,
+        bindingLocation,
+        descriptorCount,
+        objectStrideBytes,
+        isDynamic ? vk::DescriptorType::eUniformBufferDynamic : vk::DescriptorType::eUniformBuffer,
+        shaderStageFlags
+    )
+{}
+
+quartz::rendering::UniformBufferInfo::UniformBufferInfo(
+    const uint32_t locallyMappedBufferSizeBytes,
+    const vk::MemoryPropertyFlags locallyMappedBufferPropertyFlags,
+    const uint32_t bindingLocation,
+    const uint32_t descriptorCount,
+    const uint32_t objectStrideBytes,
+    const vk::DescriptorType descriptorType,
+    const vk::ShaderStageFlags shaderStageFlags
 ) :
     m_locallyMappedBufferSize(locallyMappedBufferSizeBytes),
-    m_locallyMappedBufferVulkanUsageFlags(vk::BufferUsageFlagBits::eUniformBuffer),
+    m_locallyMappedBufferVulkanUsageFlags(quartz::rendering::UniformBufferInfo::getVulkanUsageFlags(descriptorType)),
     m_locallyMappedBufferVulkanPropertyFlags(locallyMappedBufferPropertyFlags),
     m_bindingLocation(bindingLocation),
     m_descriptorCount(descriptorCount),
     m_objectStrideBytes(objectStrideBytes),
-    m_vulkanDescriptorType(isDynamic ? vk::DescriptorType::eUniformBufferDynamic : vk::DescriptorType::eUniformBuffer),
+    m_vulkanDescriptorType(descriptorType),
     m_vulkanShaderStageFlags(shaderStageFlags)
 {}
 
@@ -64,6 +98,20 @@ quartz::rendering::UniformBufferInfo::UniformBufferInfo(
 
 quartz::rendering::UniformBufferInfo::~UniformBufferInfo() {}
 
+bool
+quartz::rendering::UniformBufferInfo::isStorageBuffer() const {
+    return
+        m_vulkanDescriptorType == vk::DescriptorType::eStorageBuffer ||
+        m_vulkanDescriptorType == vk::DescriptorType::eStorageBufferDynamic;
+}
+
+bool
+quartz::rendering::UniformBufferInfo::isDynamic() const {
+    return
+        m_vulkanDescriptorType == vk::DescriptorType::eUniformBufferDynamic ||
+        m_vulkanDescriptorType == vk::DescriptorType::eStorageBufferDynamic;
+}
+
 quartz::rendering::UniformBufferInfo&
 quartz::rendering::UniformBufferInfo::operator=(
     const quartz::rendering::UniformBufferInfo& other
@@ -22,6 +22,15 @@ public: // member functions
         const bool isDynamic,
         const vk::ShaderStageFlags shaderStageFlags
     );
+    UniformBufferInfo(
+        const uint32_t locallyMappedBufferSizeBytes,
+        const vk::MemoryPropertyFlags locallyMappedBufferPropertyFlags,
+        const uint32_t bindingLocation,
+        const uint32_t descriptorCount,
+        const uint32_t objectStrideBytes,
+        const vk::DescriptorType descriptorType,
+        const vk::ShaderStageFlags shaderStageFlags
+    );
     UniformBufferInfo(const UniformBufferInfo& other);
     UniformBufferInfo(UniformBufferInfo&& other);
     ~UniformBufferInfo();
@@ -40,12 +49,18 @@ public: // member functions
     vk::DescriptorType getVulkanDescriptorType() const { return m_vulkanDescriptorType; }
     vk::ShaderStageFlags getVulkanShaderStageFlags() const { return m_vulkanShaderStageFlags; }
 
+    bool isStorageBuffer() const;
+    bool isDynamic() const;
+
 public: // static functions
     static uint32_t calculateDynamicUniformBufferByteStride(
         const quartz::rendering::Device& renderingDevice,
         const uint32_t uniformBufferObjectSizeBytes
     );
 
+private: // static functions
+    static vk::BufferUsageFlags getVulkanUsageFlags(const vk::DescriptorType descriptorType);
+
 private: // member variables
     uint32_t m_locallyMappedBufferSize;
     vk::BufferUsageFlags m_locallyMappedBufferVulkanUsageFlags;
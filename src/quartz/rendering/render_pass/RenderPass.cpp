@@ -5,19 +5,20 @@ vk::UniqueRenderPass
 quartz::rendering::RenderPass::createVulkanRenderPassPtr(
     const vk::UniqueDevice& p_logicalDevice,
     const vk::SurfaceFormatKHR& surfaceFormat,
-    const vk::Format& depthFormat
+    const vk::Format& depthFormat,
+    const bool continuesPreviousRenderPass
 ) {
-    LOG_FUNCTION_CALL_TRACE(RENDERPASS, "");
+    LOG_FUNCTION_CALL_TRACE(RENDERPASS, "{}", continuesPreviousRenderPass ? "continuation" : "regular");
 
     vk::AttachmentDescription colorAttachment(
         {},
         surfaceFormat.format,
         vk::SampleCountFlagBits::e1,
-        vk::AttachmentLoadOp::eClear,
+        continuesPreviousRenderPass ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear,
         vk::AttachmentStoreOp::eStore,
         vk::AttachmentLoadOp::eDontCare,
         vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined,
+        continuesPreviousRenderPass ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eUndefined,
         vk::ImageLayout::ePresentSrcKHR
     );
     vk::AttachmentReference colorAttachmentRef(
@@ -25,15 +26,16 @@ quartz::rendering::RenderPass::createVulkanRenderPassPtr(
         vk::ImageLayout::eColorAttachmentOptimal
     );
 
+    // Depth is stored so it can be downsampled into the occlusion culling depth pyramid afterwards
     vk::AttachmentDescription depthAttachment(
         {},
         depthFormat,
         vk::SampleCountFlagBits::e1,
-        vk::AttachmentLoadOp::eClear,
-        vk::AttachmentStoreOp::eDontCare,
+        continuesPreviousRenderPass ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear,
+        vk::AttachmentStoreOp::eStore,
         vk::AttachmentLoadOp::eDontCare,
         vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined,
+        continuesPreviousRenderPass ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eUndefined,
         vk::ImageLayout::eDepthStencilAttachmentOptimal
     );
     vk::AttachmentReference depthAttachmentRef(
@@ -51,20 +53,29 @@ quartz::rendering::RenderPass::createVulkanRenderPassPtr(
         {}
     );
 
+    // A continuation also has to wait for the previous render pass' writes before loading them
     vk::SubpassDependency subpassDependency(
         VK_SUBPASS_EXTERNAL,
         0,
         (
             vk::PipelineStageFlagBits::eColorAttachmentOutput |
-            vk::PipelineStageFlagBits::eEarlyFragmentTests
+            vk::PipelineStageFlagBits::eEarlyFragmentTests |
+            vk::PipelineStageFlagBits::eLateFragmentTests
         ),
         (
             vk::PipelineStageFlagBits::eColorAttachmentOutput |
             vk::PipelineStageFlagBits::eEarlyFragmentTests
         ),
-        {},
+        continuesPreviousRenderPass ?
+            (
+                vk::AccessFlagBits::eColorAttachmentWrite |
+                vk::AccessFlagBits::eDepthStencilAttachmentWrite
+            ) :
+            vk::AccessFlags(),
         (
+            vk::AccessFlagBits::eColorAttachmentRead |
             vk::AccessFlagBits::eColorAttachmentWrite |
+            vk::AccessFlagBits::eDepthStencilAttachmentRead |
             vk::AccessFlagBits::eDepthStencilAttachmentWrite
         ),
         {}
@@ -98,7 +109,16 @@ quartz::rendering::RenderPass::RenderPass(
         quartz::rendering::RenderPass::createVulkanRenderPassPtr(
             renderingDevice.getVulkanLogicalDevicePtr(),
             renderingWindow.getVulkanSurfaceFormat(),
-            renderingWindow.getVulkanDepthBufferFormat()
+            renderingWindow.getVulkanDepthBufferFormat(),
+            false
+        )
+    ),
+    mp_vulkanContinuationRenderPass(
+        quartz::rendering::RenderPass::createVulkanRenderPassPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            renderingWindow.getVulkanSurfaceFormat(),
+            renderingWindow.getVulkanDepthBufferFormat(),
+            true
         )
     )
 {
@@ -113,6 +133,7 @@ void
 quartz::rendering::RenderPass::reset() {
     LOG_FUNCTION_SCOPE_TRACEthis("");
 
+    mp_vulkanContinuationRenderPass.reset();
     mp_vulkanRenderPass.reset();
 }
 
@@ -126,6 +147,13 @@ quartz::rendering::RenderPass::recreate(
     mp_vulkanRenderPass = quartz::rendering::RenderPass::createVulkanRenderPassPtr(
         renderingDevice.getVulkanLogicalDevicePtr(),
         renderingWindow.getVulkanSurfaceFormat(),
-        renderingWindow.getVulkanDepthBufferFormat()
+        renderingWindow.getVulkanDepthBufferFormat(),
+        false
+    );
+    mp_vulkanContinuationRenderPass = quartz::rendering::RenderPass::createVulkanRenderPassPtr(
+        renderingDevice.getVulkanLogicalDevicePtr(),
+        renderingWindow.getVulkanSurfaceFormat(),
+        renderingWindow.getVulkanDepthBufferFormat(),
+        true
     );
 }
\ No newline at end of file
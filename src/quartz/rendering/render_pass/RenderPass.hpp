@@ -29,14 +29,23 @@ public: // member functions
     USE_LOGGER(RENDERPASS);
 
     const vk::UniqueRenderPass& getVulkanRenderPassPtr() const { return mp_vulkanRenderPass; }
+    const vk::UniqueRenderPass& getVulkanContinuationRenderPassPtr() const { return mp_vulkanContinuationRenderPass; }
 
 private: // static functions
+    /**
+     * @param continuesPreviousRenderPass Load the color and depth attachments left behind by the regular
+     *   render pass instead of clearing them, so we can draw more after doing work outside of a render pass
+     *   (such as occlusion culling against the depth drawn so far). Both render passes are compatible so
+     *   the same pipelines and framebuffers are used with either
+     */
     static vk::UniqueRenderPass createVulkanRenderPassPtr(
         const vk::UniqueDevice& p_logicalDevice,
         const vk::SurfaceFormatKHR& surfaceFormat,
-        const vk::Format& depthFormat
+        const vk::Format& depthFormat,
+        const bool continuesPreviousRenderPass
     );
 
 private: // member variables
     vk::UniqueRenderPass mp_vulkanRenderPass;
+    vk::UniqueRenderPass mp_vulkanContinuationRenderPass;
 };
\ No newline at end of file
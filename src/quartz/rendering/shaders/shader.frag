@@ -5,8 +5,10 @@
 #define MAX_NUMBER_TEXTURES -1
 #define MAX_NUMBER_MATERIALS -1
 
-#define MAX_NUMBER_POINT_LIGHTS -1
-#define MAX_NUMBER_SPOT_LIGHTS -1
+#define CLUSTER_COUNT_X 16
+#define CLUSTER_COUNT_Y 9
+#define CLUSTER_COUNT_Z 24
+#define MAX_NUMBER_LIGHTS_PER_CLUSTER 126
 
 // ........ math constants ........ //
 
@@ -35,11 +37,17 @@ layout(binding = 2) uniform DirectionalLight {
     vec3 direction;
 } directionalLight;
 
-// point lights //
+// point and spot lights, binned into clusters by light_cull.comp //
 
-layout(binding = 3) uniform PointLightMetadata {
-    uint count; // @todo 2024/05/29 We can probably put this in the PointLights uniform? //
-} pointLightMetadata;
+layout(std140, set = 1, binding = 0) uniform ClusteringUniform {
+    mat4 inverseProjectionMatrix;
+    mat4 viewMatrix;
+    vec2 screenSize;
+    float nearPlaneDistance;
+    float farPlaneDistance;
+    uint pointLightCount;
+    uint spotLightCount;
+} clusteringUniform;
 
 struct PointLight {
     vec3 color;
@@ -48,16 +56,10 @@ struct PointLight {
     float attenuationQuadraticFactor;
 };
 
-layout(binding = 4) uniform PointLights {
-    PointLight array[MAX_NUMBER_POINT_LIGHTS];
+layout(std430, set = 1, binding = 1) readonly buffer PointLights {
+    PointLight array[];
 } pointLights;
 
-// spot lights //
-
-layout(binding = 5) uniform SpotLightMetadata {
-    uint count;
-} spotLightMetadata;
-
 struct SpotLight {
     vec3 color;
     vec3 position;
@@ -68,22 +70,43 @@ struct SpotLight {
     float attenuationQuadraticFactor;
 };
 
-layout(binding = 6) uniform SpotLights {
-    SpotLight array[MAX_NUMBER_SPOT_LIGHTS];
+layout(std430, set = 1, binding = 2) readonly buffer SpotLights {
+    SpotLight array[];
 } spotLights;
 
+/**
+ * @brief The first pointLightCount indices are into the point lights, the spotLightCount after them are
+ *   into the spot lights
+ */
+struct LightCluster {
+    uint pointLightCount;
+    uint spotLightCount;
+    uint lightIndices[MAX_NUMBER_LIGHTS_PER_CLUSTER];
+};
+
+layout(std430, set = 1, binding = 3) readonly buffer LightClusters {
+    LightCluster array[];
+} lightClusters;
+
 // ........ object level things ........ //
 
 layout(binding = 7) uniform sampler rgbaTextureSampler;
 layout(binding = 8) uniform texture2D textureArray[MAX_NUMBER_TEXTURES];
 
-layout(binding = 9) uniform Material {
+struct Material {
     uint baseColorTextureMasterIndex;
     uint metallicRoughnessTextureMasterIndex;
     uint normalTextureMasterIndex;
     uint emissionTextureMasterIndex;
     uint occlusionTextureMasterIndex;
 
+    /** @brief Which of the vertex's texture coordinate slots each texture samples with */
+    uint baseColorTextureCoordinateSlot;
+    uint metallicRoughnessTextureCoordinateSlot;
+    uint normalTextureCoordinateSlot;
+    uint emissionTextureCoordinateSlot;
+    uint occlusionTextureCoordinateSlot;
+
     vec4 baseColorFactor;
     vec3 emissiveFactor;
     float metallicFactor;
@@ -92,23 +115,26 @@ layout(binding = 9) uniform Material {
     uint alphaMode;     /** 0 = Opaque , 1 = Mask , 2 = Blend | https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#alpha-coverage */
     float alphaCutoff;   /** Only used when alpha mode is Mask */
     uint doubleSided;
-} material;
+};
+
+layout(std430, binding = 9) readonly buffer Materials {
+    Material array[MAX_NUMBER_MATERIALS];
+} materials;
 
-/** @brief 2024/05/16 This isn't actually used for anything and is just here as an example of using a push constant in the fragment shader */
-layout(push_constant) uniform perObjectFragmentPushConstant {
-    layout(offset = 64) uint materialMasterIndex; // offset of 64 because vertex shader uses mat4 push constant for model matrix
-} pushConstant;
+/** @brief The material of the primitive being drawn. Set at the start of main so the helpers can use it like before */
+Material material;
+
+/** @brief The index of the cluster this fragment is in. Set at the start of main along with the material */
+uint clusterIndex;
 
 // --------------------====================================== Input from vertex shader =======================================-------------------- //
 
 layout(location = 0) in vec3 in_fragmentPosition;
 layout(location = 1) in mat3 in_TBN; /** @brief Tangent, Bi-Tangent, Normal vectors. All normalized */
 layout(location = 4) in vec3 in_vertexColor;
-layout(location = 5) in vec2 in_baseColorTextureCoordinate;
-layout(location = 6) in vec2 in_metallicRoughnessTextureCoordinate;
-layout(location = 7) in vec2 in_normalTextureCoordinate;
-layout(location = 8) in vec2 in_emissionTextureCoordinate;
-layout(location = 9) in vec2 in_occlusionTextureCoordinate;
+layout(location = 5) in vec2 in_firstTextureCoordinate;
+layout(location = 6) in vec2 in_secondTextureCoordinate;
+layout(location = 7) flat in uint in_materialMasterIndex;
 
 // --------------------====================================== Output =======================================-------------------- //
 
@@ -129,6 +155,8 @@ vec3 specularBRDF(vec3 baseColor, vec3 v, vec3 l, vec3 n, vec3 h, float metallic
 
 // The only parameters these functions take in are ones that are calculated within the main function. Everything else used is a global variable
 
+uint calculateClusterIndex();
+vec2 selectTextureCoordinate(uint textureCoordinateSlot);
 float getOcclusionScale();
 vec3 getMetallicRoughnessVector();
 vec3 calculateFragmentBaseColor(float roughnessValue, float metallicValue);
@@ -143,6 +171,9 @@ vec4 calculateFinalColor(vec3 ambientLightContribution,  vec3 directionalLightCo
 // --------------------====================================== Main logic =======================================-------------------- //
 
 void main() {
+    material = materials.array[in_materialMasterIndex];
+    clusterIndex = calculateClusterIndex();
+
     float occlusionScale = getOcclusionScale();
     vec3 metallicRoughnessVector = getMetallicRoughnessVector();
     float roughnessValue = metallicRoughnessVector.g;
@@ -304,6 +335,32 @@ vec3 specularBRDF(
     return (F * D * G) / denominator;
 }
 
+// --------------------------------------------------------------------------------
+// Find the cluster containing the fragment. Must match how light_cull.comp lays out the clusters
+// --------------------------------------------------------------------------------
+
+uint calculateClusterIndex() {
+    uvec2 tile = uvec2(
+        (gl_FragCoord.xy / clusteringUniform.screenSize) * vec2(CLUSTER_COUNT_X, CLUSTER_COUNT_Y)
+    );
+    tile = min(tile, uvec2(CLUSTER_COUNT_X - 1, CLUSTER_COUNT_Y - 1));
+
+    float viewDepth = -(clusteringUniform.viewMatrix * vec4(in_fragmentPosition, 1.0)).z;
+    float sliceFactor = log(max(viewDepth, clusteringUniform.nearPlaneDistance) / clusteringUniform.nearPlaneDistance) /
+        log(clusteringUniform.farPlaneDistance / clusteringUniform.nearPlaneDistance);
+    uint slice = min(uint(sliceFactor * CLUSTER_COUNT_Z), CLUSTER_COUNT_Z - 1);
+
+    return tile.x + (tile.y * CLUSTER_COUNT_X) + (slice * CLUSTER_COUNT_X * CLUSTER_COUNT_Y);
+}
+
+// --------------------------------------------------------------------------------
+// Get the texture coordinate in one of the material's texture coordinate slots
+// --------------------------------------------------------------------------------
+
+vec2 selectTextureCoordinate(uint textureCoordinateSlot) {
+    return textureCoordinateSlot == 0 ? in_firstTextureCoordinate : in_secondTextureCoordinate;
+}
+
 // --------------------------------------------------------------------------------
 // Get the diffuse occlusion scale (0.0 to 1.0)
 // --------------------------------------------------------------------------------
@@ -311,7 +368,7 @@ vec3 specularBRDF(
 float getOcclusionScale() {
     float occlusionScale = texture(
         sampler2D(textureArray[material.occlusionTextureMasterIndex], rgbaTextureSampler),
-        in_occlusionTextureCoordinate
+        selectTextureCoordinate(material.occlusionTextureCoordinateSlot)
     ).r;
 
     return occlusionScale;
@@ -326,7 +383,7 @@ float getOcclusionScale() {
 vec3 getMetallicRoughnessVector() {
     vec3 metallicRoughnessVector = texture(
         sampler2D(textureArray[material.metallicRoughnessTextureMasterIndex], rgbaTextureSampler),
-        in_metallicRoughnessTextureCoordinate
+        selectTextureCoordinate(material.metallicRoughnessTextureCoordinateSlot)
     ).rgb; // roughness in g, metallic in b
 
     return vec3(
@@ -347,7 +404,7 @@ vec3 calculateFragmentBaseColor(float roughnessValue, float metallicValue) {
 
     vec3 fragmentBaseColor = texture(
         sampler2D(textureArray[material.baseColorTextureMasterIndex], rgbaTextureSampler),
-        in_baseColorTextureCoordinate
+        selectTextureCoordinate(material.baseColorTextureCoordinateSlot)
     ).rgb;
     fragmentBaseColor *= in_vertexColor;
     fragmentBaseColor *= material.baseColorFactor.rgb;
@@ -362,7 +419,7 @@ vec3 calculateFragmentBaseColor(float roughnessValue, float metallicValue) {
 vec3 calculateFragmentNormal() {
     vec3 normalDisplacement = texture(
         sampler2D(textureArray[material.normalTextureMasterIndex], rgbaTextureSampler),
-        in_normalTextureCoordinate
+        selectTextureCoordinate(material.normalTextureCoordinateSlot)
     ).rgb;
 
     normalDisplacement = normalize((normalDisplacement * 2.0) - 1.0); // convert it to range [-1, 1] from range [0, 1]
@@ -439,9 +496,9 @@ vec3 calculatePointLightContribution(
     vec3 n = fragmentNormal;
 
     vec3 result = vec3(0.0, 0.0, 0.0);
-    uint pointLightCount = min(pointLightMetadata.count, MAX_NUMBER_POINT_LIGHTS);
+    uint pointLightCount = lightClusters.array[clusterIndex].pointLightCount;
     for (uint i = 0; i < pointLightCount; ++i) {
-        PointLight pointLight = pointLights.array[i];
+        PointLight pointLight = pointLights.array[lightClusters.array[clusterIndex].lightIndices[i]];
         vec3 l = normalize(pointLight.position - in_fragmentPosition);
         vec3 h = normalize(l + v);
 
@@ -483,9 +540,10 @@ vec3 calculateSpotLightContribution(
     vec3 n = fragmentNormal;
 
     vec3 result = vec3(0.0, 0.0, 0.0);
-    uint spotLightCount = min(spotLightMetadata.count, MAX_NUMBER_SPOT_LIGHTS);
+    uint pointLightCount = lightClusters.array[clusterIndex].pointLightCount;
+    uint spotLightCount = lightClusters.array[clusterIndex].spotLightCount;
     for (uint i = 0; i < spotLightCount; ++i) {
-        SpotLight spotLight = spotLights.array[i];
+        SpotLight spotLight = spotLights.array[lightClusters.array[clusterIndex].lightIndices[pointLightCount + i]];
         vec3 l = normalize(spotLight.position - in_fragmentPosition);
         vec3 h = normalize(l + v);
 
@@ -519,7 +577,7 @@ vec3 calculateSpotLightContribution(
 vec3 calculateEmissiveColorContribution() {
     vec3 emissiveColor = texture(
         sampler2D(textureArray[material.emissionTextureMasterIndex], rgbaTextureSampler),
-        in_emissionTextureCoordinate
+        selectTextureCoordinate(material.emissionTextureCoordinateSlot)
     ).rgb;
 
     return vec3(
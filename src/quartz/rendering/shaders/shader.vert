@@ -10,80 +10,106 @@ layout(binding = 0) uniform CameraUniformBufferObject {
     mat4 projectionMatrix;
 } camera;
 
-// ... mesh level things ... //
+// ... draw level things ... //
 
-layout(push_constant) uniform perObjectVertexPushConstant {
+/**
+ * @brief Every draw's firstInstance is the index of its first instance in this buffer and its other
+ *   instances follow it, so gl_InstanceIndex tells us which instance we belong to regardless of
+ *   whether the draw was issued directly or indirectly
+ */
+struct PerDraw {
     mat4 modelMatrix;
-} pushConstant;
+    vec3 positionQuantizationOffset;
+    vec3 positionQuantizationScale;
+    uint materialMasterIndex;
+};
+
+layout(std430, binding = 10) readonly buffer PerDrawStorageBufferObject {
+    PerDraw array[];
+} perDraws;
 
 // -----==== Inputs =====----- //
 
 /**
- *  @todo 2024/05/15 Can all of these texture coordinates be consolidated into one thing?
- *    We'd be sending less data to GPU but we would have to enforce all textures to be of
- *    the same dimensions, so we would have more image data, ad we wouldn't be able to
- *    combine multiple textures into one image
+ * @brief Vertices are packed (see quartz::rendering::Vertex::Packed). The position is normalized within
+ *   its mesh's quantization range, and its w is 1 when the tangent's handedness is negative. The
+ *   normal and tangent are octahedral encoded
  */
-
-layout(location = 0) in vec3 in_vertexPosition;
-layout(location = 1) in vec3 in_vertexNormal;
-layout(location = 2) in vec3 in_vertexTangent;
-layout(location = 3) in vec3 in_vertexColor;
-layout(location = 4) in vec2 in_baseColorTextureCoordinate;
-layout(location = 5) in vec2 in_metallicRoughnessTextureCoordinate;
-layout(location = 6) in vec2 in_vertexNormalTextureCoordinate;
-layout(location = 7) in vec2 in_emissionTextureCoordinate;
-layout(location = 8) in vec2 in_occlusionTextureCoordinate;
+layout(location = 0) in vec4 in_vertexPosition;
+layout(location = 1) in vec2 in_vertexNormal;
+layout(location = 2) in vec2 in_vertexTangent;
+layout(location = 3) in vec4 in_vertexColor;
+layout(location = 4) in vec2 in_firstTextureCoordinate; /** @brief The material's texture coordinate slots. Its textures pick one each */
+layout(location = 5) in vec2 in_secondTextureCoordinate;
 
 // -----==== Outputs to fragment shader =====----- //
 
 layout(location = 0) out vec3 out_fragmentPosition;
 layout(location = 1) out mat3 out_TBN;
 layout(location = 4) out vec3 out_vertexColor;
-layout(location = 5) out vec2 out_baseColorTextureCoordinate;
-layout(location = 6) out vec2 out_metallicRoughnessTextureCoordinate;
-layout(location = 7) out vec2 out_normalTextureCoordinate;
-layout(location = 8) out vec2 out_emissionTextureCoordinate;
-layout(location = 9) out vec2 out_occlusionTextureCoordinate;
+layout(location = 5) out vec2 out_firstTextureCoordinate;
+layout(location = 6) out vec2 out_secondTextureCoordinate;
+layout(location = 7) flat out uint out_materialMasterIndex;
+
+// -----==== Helper functions =====----- //
+
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 unitVector = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    // Unfold the lower half of the octahedron back from the corners of the square
+    float t = max(-unitVector.z, 0.0);
+    unitVector.x += unitVector.x >= 0.0 ? -t : t;
+    unitVector.y += unitVector.y >= 0.0 ? -t : t;
+
+    return normalize(unitVector);
+}
 
 // -----==== Logic =====----- //
 
 void main() {
+    mat4 modelMatrix = perDraws.array[gl_InstanceIndex].modelMatrix;
+
+    // ----- Decode the packed vertex ----- //
+
+    vec3 vertexPosition =
+        perDraws.array[gl_InstanceIndex].positionQuantizationOffset +
+        perDraws.array[gl_InstanceIndex].positionQuantizationScale * in_vertexPosition.xyz;
+    float tangentHandedness = in_vertexPosition.w > 0.5 ? -1.0 : 1.0;
+    vec3 vertexNormal = decodeOctahedral(in_vertexNormal);
+    vec3 vertexTangent = decodeOctahedral(in_vertexTangent);
 
     // ----- Set the position of the vertex in clip space ----- //
 
     gl_Position =
         camera.projectionMatrix *
         camera.viewMatrix *
-        pushConstant.modelMatrix *
-        vec4(in_vertexPosition, 1.0);
+        modelMatrix *
+        vec4(vertexPosition, 1.0);
 
     // ----- Calculate the position of the fragment ----- //
 
-    out_fragmentPosition = vec3(pushConstant.modelMatrix * vec4(in_vertexPosition, 1.0));
+    out_fragmentPosition = vec3(modelMatrix * vec4(vertexPosition, 1.0));
 
     // ----- Calculate the TBN matrix ----- //
 
     vec3 T = normalize(vec3(
-        pushConstant.modelMatrix * vec4(in_vertexTangent, 0.0)
+        modelMatrix * vec4(vertexTangent, 0.0)
     ));
 
     vec3 N = normalize(vec3(
-        pushConstant.modelMatrix * vec4(in_vertexNormal, 0.0)
+        modelMatrix * vec4(vertexNormal, 0.0)
     ));
 
     T = normalize(T - dot(T, N) * N); // Re-orthogonalize T w.r.t N
 
-    vec3 B = normalize(cross(N, T));
+    vec3 B = tangentHandedness * normalize(cross(N, T));
 
     out_TBN = mat3(T, B, N);
 
     // ----- set output for fragment shader to use as input ----- //
 
-    out_vertexColor = in_vertexColor;
-    out_baseColorTextureCoordinate = in_baseColorTextureCoordinate;
-    out_metallicRoughnessTextureCoordinate = in_metallicRoughnessTextureCoordinate;
-    out_normalTextureCoordinate = in_vertexNormalTextureCoordinate;
-    out_emissionTextureCoordinate = in_emissionTextureCoordinate;
-    out_occlusionTextureCoordinate = in_occlusionTextureCoordinate;
+    out_vertexColor = in_vertexColor.rgb;
+    out_firstTextureCoordinate = in_firstTextureCoordinate;
+    out_secondTextureCoordinate = in_secondTextureCoordinate;
+    out_materialMasterIndex = perDraws.array[gl_InstanceIndex].materialMasterIndex;
 }
\ No newline at end of file
@@ -1,13 +1,23 @@
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <set>
-#include <queue>
+#include <thread>
 #include <vector>
 
+#include <glm/geometric.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/gtx/string_cast.hpp>
 
 #include <vulkan/vulkan.hpp>
 
+#include "util/macros.hpp"
+
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/model/Primitive.hpp"
 #include "quartz/rendering/swapchain/Swapchain.hpp"
 #include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
 #include "quartz/rendering/window/Window.hpp"
@@ -20,14 +30,30 @@ quartz::rendering::Swapchain::createVulkanSwapchainPtr(
     const vk::SurfaceCapabilitiesKHR& surfaceCapabilities,
     const vk::SurfaceFormatKHR& surfaceFormat,
     const vk::PresentModeKHR& presentMode,
-    const vk::Extent2D& swapchainExtent
+    const vk::Extent2D& swapchainExtent,
+    const uint32_t desiredImageCount,
+    const vk::SwapchainKHR& oldSwapchain
 ) {
-    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "");
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "{} x {} , {} desired images", swapchainExtent.width, swapchainExtent.height, desiredImageCount);
+
+    uint32_t imageCount;
+    if (desiredImageCount == 0) {
+        imageCount = (surfaceCapabilities.maxImageCount != 0) ?
+            surfaceCapabilities.maxImageCount :
+            surfaceCapabilities.minImageCount + 1
+        ;
+    } else {
+        // A max image count of 0 means there is no maximum
+        imageCount = std::max(desiredImageCount, surfaceCapabilities.minImageCount);
+        if (surfaceCapabilities.maxImageCount != 0) {
+            imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
+        }
 
-    uint32_t imageCount = (surfaceCapabilities.maxImageCount != 0) ?
-        surfaceCapabilities.maxImageCount :
-        surfaceCapabilities.minImageCount + 1
-    ;
+        if (imageCount != desiredImageCount) {
+            LOG_WARNING(SWAPCHAIN, "Desired {} images is outside of the supported {} to {}, using {} instead", desiredImageCount, surfaceCapabilities.minImageCount, surfaceCapabilities.maxImageCount, imageCount);
+        }
+    }
+    LOG_TRACE(SWAPCHAIN, "Using {} images", imageCount);
 
     std::set<uint32_t> uniqueQueueFamilyIndicesSet = {graphicsQueueFamilyIndex};
     std::vector uniqueQueueFamilyIndicesVector(
@@ -51,7 +77,8 @@ quartz::rendering::Swapchain::createVulkanSwapchainPtr(
         surfaceCapabilities.currentTransform,
         vk::CompositeAlphaFlagBitsKHR::eOpaque,
         presentMode,
-        true
+        true,
+        oldSwapchain
     );
 
     vk::UniqueSwapchainKHR uniqueSwapchain = p_logicalDevice->createSwapchainKHRUnique(swapchainCreateInfo);
@@ -195,12 +222,129 @@ quartz::rendering::Swapchain::createVulkanFenceUniquePtrs(
     return fencePtrs;
 }
 
+std::vector<quartz::rendering::LocallyMappedBuffer>
+quartz::rendering::Swapchain::createIndirectDrawCommandBuffers(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t maxNumFramesInFlight
+) {
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "{} max frames in flight", maxNumFramesInFlight);
+
+    const uint32_t sizeBytes = sizeof(vk::DrawIndexedIndirectCommand) * QUARTZ_MAX_NUMBER_DRAWS;
+    LOG_TRACE(SWAPCHAIN, "Using {} bytes per buffer for {} draws", sizeBytes, QUARTZ_MAX_NUMBER_DRAWS);
+
+    std::vector<quartz::rendering::LocallyMappedBuffer> buffers;
+
+    for (uint32_t i = 0; i < maxNumFramesInFlight; ++i) {
+        buffers.emplace_back(
+            renderingDevice,
+            sizeBytes,
+            vk::BufferUsageFlagBits::eIndirectBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+    }
+
+    if (buffers.size() != maxNumFramesInFlight) {
+        LOG_THROW(SWAPCHAIN, util::VulkanCreationFailedError, "Created {} indirect draw command buffers instead of expected {}", buffers.size(), maxNumFramesInFlight);
+    }
+
+    LOG_TRACE(SWAPCHAIN, "Successfully created {} indirect draw command buffer(s)", buffers.size());
+
+    return buffers;
+}
+
+uint32_t
+quartz::rendering::Swapchain::determineNumRecordingThreads() {
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "");
+
+    const uint32_t hardwareConcurrency = std::thread::hardware_concurrency();
+    LOG_TRACE(SWAPCHAIN, "Hardware concurrency is {}", hardwareConcurrency);
+
+    const uint32_t numRecordingThreads = std::clamp<uint32_t>(
+        hardwareConcurrency,
+        1,
+        quartz::rendering::Swapchain::maxNumRecordingThreads
+    );
+    LOG_TRACE(SWAPCHAIN, "Using up to {} recording threads", numRecordingThreads);
+
+    return numRecordingThreads;
+}
+
+vk::ImageUsageFlags
+quartz::rendering::Swapchain::determineDepthBufferUsageFlags(
+    const quartz::rendering::Device& renderingDevice,
+    const vk::Format depthBufferFormat
+) {
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "");
+
+    // The depth pyramid samples the depth buffer, but only exists if the device can gpu cull
+    if (quartz::rendering::GpuCuller::getGpuCullingSupported(renderingDevice, depthBufferFormat)) {
+        LOG_TRACE(SWAPCHAIN, "Depth buffer will be sampled by the depth pyramid");
+        return vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
+    }
+
+    return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+}
+
+std::vector<vk::UniqueCommandPool>
+quartz::rendering::Swapchain::createVulkanRecordingCommandPoolPtrs(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t desiredCommandPoolCount
+) {
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "{} command pools desired", desiredCommandPoolCount);
+
+    std::vector<vk::UniqueCommandPool> commandPoolPtrs;
+    commandPoolPtrs.reserve(desiredCommandPoolCount);
+
+    for (uint32_t i = 0; i < desiredCommandPoolCount; ++i) {
+        commandPoolPtrs.push_back(
+            quartz::rendering::VulkanUtil::createVulkanCommandPoolPtr(
+                renderingDevice.getGraphicsQueueFamilyIndex(),
+                renderingDevice.getVulkanLogicalDevicePtr(),
+                vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient
+            )
+        );
+    }
+
+    LOG_TRACE(SWAPCHAIN, "Successfully created {} recording vk::CommandPool(s)", commandPoolPtrs.size());
+
+    return commandPoolPtrs;
+}
+
+std::vector<vk::UniqueCommandBuffer>
+quartz::rendering::Swapchain::allocateVulkanRecordingCommandBufferPtrs(
+    const vk::UniqueDevice& p_logicalDevice,
+    const std::vector<vk::UniqueCommandPool>& recordingCommandPoolPtrs
+) {
+    LOG_FUNCTION_SCOPE_TRACE(SWAPCHAIN, "{} command pools", recordingCommandPoolPtrs.size());
+
+    std::vector<vk::UniqueCommandBuffer> commandBufferPtrs;
+    commandBufferPtrs.reserve(recordingCommandPoolPtrs.size());
+
+    for (const vk::UniqueCommandPool& p_commandPool : recordingCommandPoolPtrs) {
+        std::vector<vk::UniqueCommandBuffer> allocatedCommandBufferPtrs = quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            p_logicalDevice,
+            p_commandPool,
+            vk::CommandBufferLevel::eSecondary,
+            1
+        );
+
+        commandBufferPtrs.push_back(std::move(allocatedCommandBufferPtrs[0]));
+    }
+
+    LOG_TRACE(SWAPCHAIN, "Successfully allocated {} recording vk::CommandBuffer(s)", commandBufferPtrs.size());
+
+    return commandBufferPtrs;
+}
+
 quartz::rendering::Swapchain::Swapchain(
     const quartz::rendering::Device& renderingDevice,
     const quartz::rendering::Window& renderingWindow,
     const quartz::rendering::RenderPass& renderingRenderPass,
-    const uint32_t maxNumFramesInFlight
+    const uint32_t maxNumFramesInFlight,
+    const uint32_t desiredImageCount
 ):
+    m_maxNumFramesInFlight(maxNumFramesInFlight),
+    m_desiredImageCount(desiredImageCount),
     m_shouldRecreate(false),
     mp_vulkanSwapchain(
         quartz::rendering::Swapchain::createVulkanSwapchainPtr(
@@ -210,7 +354,9 @@ quartz::rendering::Swapchain::Swapchain(
             renderingWindow.getVulkanSurfaceCapabilities(),
             renderingWindow.getVulkanSurfaceFormat(),
             renderingWindow.getVulkanPresentMode(),
-            renderingWindow.getVulkanExtent()
+            renderingWindow.getVulkanExtent(),
+            m_desiredImageCount,
+            {}
     )),
     m_vulkanImages(
         renderingDevice.getVulkanLogicalDevicePtr()->getSwapchainImagesKHR(
@@ -228,7 +374,10 @@ quartz::rendering::Swapchain::Swapchain(
         renderingDevice,
         renderingWindow.getVulkanExtent().width,
         renderingWindow.getVulkanExtent().height,
-        vk::ImageUsageFlagBits::eDepthStencilAttachment,
+        quartz::rendering::Swapchain::determineDepthBufferUsageFlags(
+            renderingDevice,
+            renderingWindow.getVulkanDepthBufferFormat()
+        ),
         renderingWindow.getVulkanDepthBufferFormat(),
         vk::ImageTiling::eOptimal
     ),
@@ -256,6 +405,14 @@ quartz::rendering::Swapchain::Swapchain(
             maxNumFramesInFlight
         )
     ),
+    m_vulkanCullingCommandBufferPtrs(
+        quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDrawingCommandPool,
+            maxNumFramesInFlight
+        )
+    ),
+    m_shouldSubmitCullingCommandBuffer(false),
     m_vulkanImageAvailableSemaphorePtrs(
         quartz::rendering::Swapchain::createVulkanSemaphoresUniquePtrs(
             renderingDevice.getVulkanLogicalDevicePtr(),
@@ -273,13 +430,124 @@ quartz::rendering::Swapchain::Swapchain(
             renderingDevice.getVulkanLogicalDevicePtr(),
             maxNumFramesInFlight
         )
-    )
+    ),
+    m_numRecordingThreads(quartz::rendering::Swapchain::determineNumRecordingThreads()),
+    m_vulkanSkyBoxCommandBufferPtrs(
+        quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDrawingCommandPool,
+            vk::CommandBufferLevel::eSecondary,
+            maxNumFramesInFlight
+        )
+    ),
+    m_vulkanRecordingCommandPoolPtrs(
+        quartz::rendering::Swapchain::createVulkanRecordingCommandPoolPtrs(
+            renderingDevice,
+            maxNumFramesInFlight * m_numRecordingThreads
+        )
+    ),
+    m_vulkanRecordingCommandBufferPtrs(
+        quartz::rendering::Swapchain::allocateVulkanRecordingCommandBufferPtrs(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            m_vulkanRecordingCommandPoolPtrs
+        )
+    ),
+    m_recordingThreads(),
+    m_recordingMutex(),
+    m_recordingStartedConditionVariable(),
+    m_recordingFinishedConditionVariable(),
+    m_currentRecordingJob(),
+    m_recordingGeneration(0),
+    m_numRecordingThreadsFinished(0),
+    m_shouldStopRecordingThreads(false),
+    m_recordingThreadNumDraws(),
+    m_currentVulkanCommandBufferInheritanceInfo(),
+    m_vulkanSecondaryCommandBuffersToExecute(),
+    m_currentLightingVulkanDescriptorSet(),
+    m_frustumCuller(),
+    mo_gpuCuller(),
+    m_gpuCullingBatches(),
+    mo_depthPyramid(),
+    mo_depthPyramidViewProjectionMatrix(),
+    m_vulkanOcclusionCommandBufferPtrs(
+        quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDrawingCommandPool,
+            vk::CommandBufferLevel::eSecondary,
+            maxNumFramesInFlight
+        )
+    ),
+    m_currentVulkanContinuationRenderPassBeginInfo(),
+    m_shouldRecordOcclusionCullingPhase(false),
+    m_vulkanTranslucentCommandBufferPtrs(
+        quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+            renderingDevice.getVulkanLogicalDevicePtr(),
+            mp_vulkanDrawingCommandPool,
+            vk::CommandBufferLevel::eSecondary,
+            maxNumFramesInFlight
+        )
+    ),
+    m_translucentDrawPackets(),
+    m_shouldDrawTranslucentAfterOcclusionCullingPhase(false),
+    m_shouldBuildDepthPyramid(false),
+    m_currentFrustumPlanes(),
+    m_currentViewProjectionMatrix(1.0f),
+    m_numGpuCulledInstances(0),
+    m_drawPackets(),
+    m_scratchDrawPackets(),
+    m_numGeometryBindsLastFrame(0),
+    m_numGeometryBindsAvoidedLastFrame(0),
+    m_numDrawsLastFrame(0),
+    m_indirectDrawCommandBuffers(
+        quartz::rendering::Swapchain::createIndirectDrawCommandBuffers(
+            renderingDevice,
+            maxNumFramesInFlight
+        )
+    ),
+    m_retiredResources(),
+    m_staleDepthPyramidDescriptorsMask(0)
 {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    if (quartz::rendering::GpuCuller::getGpuCullingSupported(renderingDevice, renderingWindow.getVulkanDepthBufferFormat())) {
+        mo_gpuCuller.emplace(
+            renderingDevice,
+            maxNumFramesInFlight
+        );
+        mo_depthPyramid.emplace(
+            renderingDevice,
+            m_depthBuffer,
+            renderingWindow.getVulkanExtent().width,
+            renderingWindow.getVulkanExtent().height,
+            renderingWindow.getVulkanDepthBufferFormat()
+        );
+        for (uint32_t i = 0; i < maxNumFramesInFlight; ++i) {
+            mo_gpuCuller->updateDepthPyramidDescriptors(
+                renderingDevice,
+                *mo_depthPyramid,
+                i
+            );
+        }
+    }
+
+    m_recordingThreads.reserve(m_numRecordingThreads - 1);
+    for (uint32_t i = 1; i < m_numRecordingThreads; ++i) {
+        m_recordingThreads.emplace_back(&quartz::rendering::Swapchain::runRecordingThread, this, i);
+    }
 }
 
 quartz::rendering::Swapchain::~Swapchain() {
     LOG_FUNCTION_CALL_TRACEthis("");
+
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        m_shouldStopRecordingThreads = true;
+    }
+    m_recordingStartedConditionVariable.notify_all();
+
+    for (std::thread& recordingThread : m_recordingThreads) {
+        recordingThread.join();
+    }
 }
 
 void
@@ -288,46 +556,49 @@ quartz::rendering::Swapchain::setScreenClearColor(const glm::vec3& screenClearCo
 }
 
 void
-quartz::rendering::Swapchain::reset() {
-    LOG_FUNCTION_SCOPE_TRACEthis("");
-
-    for (vk::UniqueFence& uniqueInFlightFence : m_vulkanInFlightFencePtrs) { uniqueInFlightFence.reset(); }
-
-    for (vk::UniqueSemaphore& uniqueRenderFinishedSemaphore : m_vulkanRenderFinishedSemaphorePtrs) { uniqueRenderFinishedSemaphore.reset(); }
-
-    for (vk::UniqueSemaphore& uniqueImageAvailableSemaphore : m_vulkanImageAvailableSemaphorePtrs) { uniqueImageAvailableSemaphore.reset(); }
-
-    for (vk::UniqueCommandBuffer& uniqueCommandBuffer : m_vulkanDrawingCommandBufferPtrs) { uniqueCommandBuffer.reset(); }
-
-    mp_vulkanDrawingCommandPool.reset();
-
-    for (vk::UniqueFramebuffer& uniqueFramebuffer : m_vulkanFramebufferPtrs) { uniqueFramebuffer.reset(); }
-
-    m_depthBuffer.reset();
-
-    for (vk::UniqueImageView& uniqueImageView : m_vulkanImageViewPtrs) { uniqueImageView.reset(); }
-
-    mp_vulkanSwapchain.reset();
+quartz::rendering::Swapchain::setDesiredImageCount(const uint32_t desiredImageCount) {
+    LOG_TRACEthis("Desiring {} images, requesting recreation", desiredImageCount);
+    m_desiredImageCount = desiredImageCount;
+    m_shouldRecreate = true;
 }
 
 void
 quartz::rendering::Swapchain::recreate(
     const quartz::rendering::Device& renderingDevice,
     const quartz::rendering::Window& renderingWindow,
-    const quartz::rendering::RenderPass& renderingRenderPass,
-    const uint32_t maxNumFramesInFlight
+    const quartz::rendering::RenderPass& renderingRenderPass
 ) {
     LOG_FUNCTION_SCOPE_TRACEthis("");
 
-    mp_vulkanSwapchain = quartz::rendering::Swapchain::createVulkanSwapchainPtr(
+    vk::UniqueSwapchainKHR p_newVulkanSwapchain = quartz::rendering::Swapchain::createVulkanSwapchainPtr(
         renderingDevice.getGraphicsQueueFamilyIndex(),
         renderingDevice.getVulkanLogicalDevicePtr(),
         renderingWindow.getVulkanSurfacePtr(),
         renderingWindow.getVulkanSurfaceCapabilities(),
         renderingWindow.getVulkanSurfaceFormat(),
         renderingWindow.getVulkanPresentMode(),
-        renderingWindow.getVulkanExtent()
+        renderingWindow.getVulkanExtent(),
+        m_desiredImageCount,
+        *mp_vulkanSwapchain
     );
+
+    // ----- retire everything sized to the old window, the frames in flight may still be using it ----- //
+
+    quartz::rendering::Swapchain::RetiredResources& retiredResources = m_retiredResources.emplace_back();
+    retiredResources.inFlightFramesToWaitForMask = (1u << m_maxNumFramesInFlight) - 1;
+    retiredResources.p_vulkanSwapchain = std::move(mp_vulkanSwapchain);
+    retiredResources.vulkanImageViewPtrs = std::move(m_vulkanImageViewPtrs);
+    retiredResources.o_depthBuffer.emplace(std::move(m_depthBuffer));
+    retiredResources.vulkanFramebufferPtrs = std::move(m_vulkanFramebufferPtrs);
+    if (mo_depthPyramid) {
+        retiredResources.o_depthPyramid.emplace(std::move(*mo_depthPyramid));
+        mo_depthPyramid.reset();
+    }
+    LOG_TRACEthis("Retired the old swapchain's resources, {} retirement(s) waiting to be released", m_retiredResources.size());
+
+    // ----- create everything sized to the new window ----- //
+
+    mp_vulkanSwapchain = std::move(p_newVulkanSwapchain);
     m_vulkanImages = renderingDevice.getVulkanLogicalDevicePtr()->getSwapchainImagesKHR(
         *mp_vulkanSwapchain
     );
@@ -340,7 +611,10 @@ quartz::rendering::Swapchain::recreate(
         renderingDevice,
         renderingWindow.getVulkanExtent().width,
         renderingWindow.getVulkanExtent().height,
-        vk::ImageUsageFlagBits::eDepthStencilAttachment,
+        quartz::rendering::Swapchain::determineDepthBufferUsageFlags(
+            renderingDevice,
+            renderingWindow.getVulkanDepthBufferFormat()
+        ),
         renderingWindow.getVulkanDepthBufferFormat(),
         vk::ImageTiling::eOptimal
     );
@@ -351,33 +625,52 @@ quartz::rendering::Swapchain::recreate(
         m_depthBuffer.getVulkanImageViewPtr(),
         renderingRenderPass.getVulkanRenderPassPtr()
     );
-    mp_vulkanDrawingCommandPool = quartz::rendering::VulkanUtil::createVulkanCommandPoolPtr(
-        renderingDevice.getGraphicsQueueFamilyIndex(),
-        renderingDevice.getVulkanLogicalDevicePtr(),
-        vk::CommandPoolCreateFlagBits::eResetCommandBuffer
-    );
-    m_vulkanDrawingCommandBufferPtrs = quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
-        renderingDevice.getVulkanLogicalDevicePtr(),
-        mp_vulkanDrawingCommandPool,
-        maxNumFramesInFlight
-    );
-    m_vulkanImageAvailableSemaphorePtrs = quartz::rendering::Swapchain::createVulkanSemaphoresUniquePtrs(
-        renderingDevice.getVulkanLogicalDevicePtr(),
-        maxNumFramesInFlight
-    );
-    m_vulkanRenderFinishedSemaphorePtrs = quartz::rendering::Swapchain::createVulkanSemaphoresUniquePtrs(
-        renderingDevice.getVulkanLogicalDevicePtr(),
-        maxNumFramesInFlight
-    );
-    m_vulkanInFlightFencePtrs = quartz::rendering::Swapchain::createVulkanFenceUniquePtrs(
-        renderingDevice.getVulkanLogicalDevicePtr(),
-        maxNumFramesInFlight
-    );
+
+    if (mo_gpuCuller) {
+        mo_depthPyramid.emplace(
+            renderingDevice,
+            m_depthBuffer,
+            renderingWindow.getVulkanExtent().width,
+            renderingWindow.getVulkanExtent().height,
+            renderingWindow.getVulkanDepthBufferFormat()
+        );
+
+        // The old pyramid's contents are from the old depth buffer, and the culling descriptor sets can only
+        // be pointed at the new pyramid once their frame is no longer in flight
+        mo_depthPyramidViewProjectionMatrix.reset();
+        m_staleDepthPyramidDescriptorsMask = (1u << m_maxNumFramesInFlight) - 1;
+    }
 
     LOG_TRACEthis("Clearing the \"should recreate\" flag");
     m_shouldRecreate = false;
 }
 
+void
+quartz::rendering::Swapchain::releaseRetiredResources(
+    const quartz::rendering::Device& renderingDevice,
+    const uint32_t inFlightFrameIndex
+) {
+    const uint32_t inFlightFrameBit = 1u << inFlightFrameIndex;
+
+    if (m_staleDepthPyramidDescriptorsMask & inFlightFrameBit) {
+        mo_gpuCuller->updateDepthPyramidDescriptors(
+            renderingDevice,
+            *mo_depthPyramid,
+            inFlightFrameIndex
+        );
+        m_staleDepthPyramidDescriptorsMask &= ~inFlightFrameBit;
+    }
+
+    for (quartz::rendering::Swapchain::RetiredResources& retiredResources : m_retiredResources) {
+        retiredResources.inFlightFramesToWaitForMask &= ~inFlightFrameBit;
+    }
+
+    while (!m_retiredResources.empty() && m_retiredResources.front().inFlightFramesToWaitForMask == 0) {
+        LOG_TRACEthis("Releasing retired swapchain resources");
+        m_retiredResources.pop_front();
+    }
+}
+
 void
 quartz::rendering::Swapchain::waitForInFlightFence(
     const quartz::rendering::Device& renderingDevice,
@@ -391,10 +684,16 @@ quartz::rendering::Swapchain::waitForInFlightFence(
 
     if (result != vk::Result::eSuccess) {
         LOG_ERRORthis("Failed to wait for previous frame to finish: {}", static_cast<uint32_t>(result));
+        return;
     }
+
+    this->releaseRetiredResources(
+        renderingDevice,
+        inFlightFrameIndex
+    );
 }
 
-uint32_t
+std::optional<uint32_t>
 quartz::rendering::Swapchain::getAvailableImageIndex(
     const quartz::rendering::Device& renderingDevice,
     const uint32_t inFlightFrameIndex
@@ -411,6 +710,7 @@ quartz::rendering::Swapchain::getAvailableImageIndex(
     if (acquireAvailableImageIndexResult == vk::Result::eErrorOutOfDateKHR) {
         LOG_INFOthis("Swapchain is out of date. Requesting recreation ( {} )", static_cast<uint32_t>(acquireAvailableImageIndexResult));
         m_shouldRecreate = true;
+        return std::nullopt;
     } else if (acquireAvailableImageIndexResult == vk::Result::eSuboptimalKHR) {
         LOG_INFOthis("Swapchain is suboptimal. Requesting recreation ( {} )", static_cast<uint32_t>(acquireAvailableImageIndexResult));
         m_shouldRecreate = true;
@@ -435,6 +735,7 @@ void
 quartz::rendering::Swapchain::resetAndBeginDrawingCommandBuffer(
     const quartz::rendering::Window& renderingWindow,
     const quartz::rendering::RenderPass& renderingRenderPass,
+    quartz::rendering::LightCuller& lightCuller,
     const uint32_t inFlightFrameIndex,
     const uint32_t availableSwapchainImageIndex
 ) {
@@ -453,6 +754,14 @@ quartz::rendering::Swapchain::resetAndBeginDrawingCommandBuffer(
         commandBufferBeginInfo
     );
 
+    // ----- bin the lights into clusters before anything is shaded with them ----- //
+
+    lightCuller.recordCullingToCommandBuffer(
+        *(m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]),
+        inFlightFrameIndex
+    );
+    m_currentLightingVulkanDescriptorSet = lightCuller.getVulkanDescriptorSet(inFlightFrameIndex);
+
     // ----- start a render pass ----- //
 
     std::array<vk::ClearValue, 2> clearValues = {
@@ -491,19 +800,78 @@ quartz::rendering::Swapchain::resetAndBeginDrawingCommandBuffer(
 
     m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->beginRenderPass(
         renderPassBeginInfo,
-        vk::SubpassContents::eInline
+        vk::SubpassContents::eSecondaryCommandBuffers
+    );
+
+    // ----- remember what the secondary command buffers are going to be executed within ----- //
+
+    m_currentVulkanCommandBufferInheritanceInfo = vk::CommandBufferInheritanceInfo(
+        *renderingRenderPass.getVulkanRenderPassPtr(),
+        0,
+        *(m_vulkanFramebufferPtrs[availableSwapchainImageIndex])
+    );
+
+    // The continuation render pass is compatible with the render pass, so it can use the same framebuffer
+    // and the same secondary command buffer inheritance info. It loads everything, so there is nothing to clear
+    m_currentVulkanContinuationRenderPassBeginInfo = vk::RenderPassBeginInfo(
+        *renderingRenderPass.getVulkanContinuationRenderPassPtr(),
+        *(m_vulkanFramebufferPtrs[availableSwapchainImageIndex]),
+        renderPassRenderArea,
+        {}
+    );
+
+    m_vulkanSecondaryCommandBuffersToExecute.clear();
+    m_shouldSubmitCullingCommandBuffer = false;
+    m_shouldRecordOcclusionCullingPhase = false;
+    m_shouldDrawTranslucentAfterOcclusionCullingPhase = false;
+    m_shouldBuildDepthPyramid = false;
+}
+
+uint32_t
+quartz::rendering::Swapchain::selectDoodadLodLevel(
+    const quartz::scene::Doodad& doodad,
+    const quartz::scene::Camera& camera
+) {
+    const quartz::rendering::Primitive::BoundingBox& boundingBox = doodad.getModel().getBoundingBox();
+    const glm::mat4& transformationMatrix = doodad.getTransformationMatrix();
+
+    const glm::vec3 worldCenter = glm::vec3(transformationMatrix * glm::vec4((boundingBox.minimum + boundingBox.maximum) * 0.5f, 1.0f));
+
+    // Scale the radius by the largest axis scale so the sphere still contains the whole model
+    const float maxScale = std::max({
+        glm::length(glm::vec3(transformationMatrix[0])),
+        glm::length(glm::vec3(transformationMatrix[1])),
+        glm::length(glm::vec3(transformationMatrix[2]))
+    });
+    const float worldRadius = glm::length(boundingBox.maximum - boundingBox.minimum) * 0.5f * maxScale;
+
+    return quartz::rendering::Primitive::selectLodLevel(
+        camera.calculateScreenSize(worldCenter, worldRadius)
     );
 }
 
 void
-quartz::rendering::Swapchain::bindPipelineToDrawingCommandBuffer(
+quartz::rendering::Swapchain::beginSecondaryCommandBuffer(
+    const vk::CommandBuffer& secondaryCommandBuffer,
+    const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo
+) {
+    vk::CommandBufferBeginInfo commandBufferBeginInfo(
+        vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        &commandBufferInheritanceInfo
+    );
+
+    secondaryCommandBuffer.begin(commandBufferBeginInfo);
+}
+
+void
+quartz::rendering::Swapchain::bindPipelineToCommandBuffer(
+    const vk::CommandBuffer& commandBuffer,
     const quartz::rendering::Window& renderingWindow,
-    const quartz::rendering::Pipeline& renderingPipeline,
-    const uint32_t inFlightFrameIndex
+    const quartz::rendering::Pipeline& renderingPipeline
 ) {
     // ----- draw (bind graphics pipeline, set up viewport & scissor) ----- //
 
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindPipeline(
+    commandBuffer.bindPipeline(
         vk::PipelineBindPoint::eGraphics,
         *renderingPipeline.getVulkanGraphicsPipelinePtr()
     );
@@ -516,7 +884,7 @@ quartz::rendering::Swapchain::bindPipelineToDrawingCommandBuffer(
         0.0f,
         1.0f
     );
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->setViewport(
+    commandBuffer.setViewport(
         0,
         viewport
     );
@@ -525,7 +893,7 @@ quartz::rendering::Swapchain::bindPipelineToDrawingCommandBuffer(
         vk::Offset2D(0.0f, 0.0f),
         renderingWindow.getVulkanExtent()
     );
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->setScissor(
+    commandBuffer.setScissor(
         0,
         scissor
     );
@@ -533,135 +901,800 @@ quartz::rendering::Swapchain::bindPipelineToDrawingCommandBuffer(
 
 void
 quartz::rendering::Swapchain::recordSkyBoxToDrawingCommandBuffer(
+    const quartz::rendering::Window& renderingWindow,
     const quartz::rendering::Pipeline& skyBoxRenderingPipeline,
     const quartz::scene::SkyBox& skyBox,
     const uint32_t inFlightFrameIndex
 ) {
-    uint32_t offset = 0;
+    const vk::CommandBuffer& commandBuffer = *(m_vulkanSkyBoxCommandBufferPtrs[inFlightFrameIndex]);
+
+    quartz::rendering::Swapchain::beginSecondaryCommandBuffer(
+        commandBuffer,
+        m_currentVulkanCommandBufferInheritanceInfo
+    );
 
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindDescriptorSets(
+    quartz::rendering::Swapchain::bindPipelineToCommandBuffer(
+        commandBuffer,
+        renderingWindow,
+        skyBoxRenderingPipeline
+    );
+
+    commandBuffer.bindDescriptorSets(
         vk::PipelineBindPoint::eGraphics,
         *skyBoxRenderingPipeline.getVulkanPipelineLayoutPtr(),
         0,
-        1,
-        &(skyBoxRenderingPipeline.getVulkanDescriptorSets()[inFlightFrameIndex]),
-        0,
-        &offset
+        skyBoxRenderingPipeline.getVulkanDescriptorSets()[inFlightFrameIndex],
+        skyBoxRenderingPipeline.getDynamicOffsets(inFlightFrameIndex)
     );
 
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindVertexBuffers(
+    const vk::DeviceSize offset = 0;
+    commandBuffer.bindVertexBuffers(
         0,
         *(skyBox.getCubeMap().getStagedVertexBuffer().getVulkanLogicalBufferPtr()),
         offset
     );
 
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindIndexBuffer(
+    commandBuffer.bindIndexBuffer(
         *(skyBox.getCubeMap().getStagedIndexBuffer().getVulkanLogicalBufferPtr()),
         0,
         vk::IndexType::eUint32
     );
 
-    m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->drawIndexed(
+    commandBuffer.drawIndexed(
         quartz::rendering::CubeMap::getIndexCount(),
         1,
         0,
         0,
         0
     );
+
+    commandBuffer.end();
+
+    m_vulkanSecondaryCommandBuffersToExecute.push_back(commandBuffer);
 }
 
 void
-quartz::rendering::Swapchain::recordDoodadToDrawingCommandBuffer(
-    const quartz::rendering::Device& renderingDevice,
-    const quartz::rendering::Pipeline& doodadRenderingPipeline,
-    const quartz::scene::Doodad& doodad,
+quartz::rendering::Swapchain::recordDoodadsToDrawingCommandBuffer(
+    const quartz::rendering::Window& renderingWindow,
+    quartz::rendering::Pipeline& doodadRenderingPipeline,
+    const std::vector<quartz::scene::Doodad>& doodads,
+    const quartz::scene::Camera& camera,
+    const uint32_t perDrawUniformBufferIndex,
+    const bool shouldDrawIndirectly,
+    const bool shouldCullOnGpu,
+    const bool shouldCullOccluded,
     const uint32_t inFlightFrameIndex
 ) {
-    const uint32_t minUniformBufferOffsetAlignment = renderingDevice.getVulkanPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+    // ----- build a packet for every primitive we are going to draw ----- //
+
+    m_drawPackets.clear();
+
+    bool reachedMaxNumberDraws = false;
+    for (const quartz::scene::Doodad& doodad : doodads) {
+        const uint32_t lodLevel = quartz::rendering::Swapchain::selectDoodadLodLevel(doodad, camera);
+
+        for (const quartz::rendering::Model::DrawEntry& drawEntry : doodad.getModel().getDrawEntries()) {
+            const uint32_t instanceCount = std::max<uint32_t>(drawEntry.p_node->getInstanceTransformationMatrices().size(), 1);
+
+            if (m_drawPackets.size() + drawEntry.primitiveCount * instanceCount > QUARTZ_MAX_NUMBER_DRAWS) {
+                reachedMaxNumberDraws = true;
+                break;
+            }
+
+            for (uint32_t i = 0; i < drawEntry.primitiveCount; ++i) {
+                for (uint32_t j = 0; j < instanceCount; ++j) {
+                    m_drawPackets.emplace_back(
+                        doodad,
+                        drawEntry,
+                        drawEntry.p_primitives[i],
+                        j,
+                        lodLevel,
+                        camera.getWorldPosition()
+                    );
+                }
+            }
+        }
 
-    std::queue<std::shared_ptr<quartz::rendering::Node>> nodeQueue(
-        std::deque(
-            doodad.getModel().getDefaultScene().getRootNodePtrs().begin(),
-            doodad.getModel().getDefaultScene().getRootNodePtrs().end()
-        )
+        if (reachedMaxNumberDraws) {
+            LOG_WARNINGthis("Reached the maximum number of draws ({}). Not drawing the remaining primitives", QUARTZ_MAX_NUMBER_DRAWS);
+            break;
+        }
+    }
+
+    // ----- throw away everything the camera can't see ----- //
+
+    const bool cullingOnGpu = shouldCullOnGpu && shouldDrawIndirectly && mo_gpuCuller.has_value();
+    if (!cullingOnGpu) {
+        m_frustumCuller.cullDrawPackets(
+            camera.getFrustumPlanes(),
+            m_drawPackets
+        );
+    }
+
+    if (m_drawPackets.empty()) {
+        m_numGeometryBindsLastFrame = 0;
+        m_numGeometryBindsAvoidedLastFrame = 0;
+        m_numDrawsLastFrame = 0;
+        return;
+    }
+
+    // ----- sort the packets so we only change state when we need to ----- //
+
+    const uint32_t numUnsortedGeometryBinds = quartz::rendering::DrawPacket::countGeometryBinds(m_drawPackets);
+
+    quartz::rendering::DrawPacket::radixSort(
+        m_drawPackets,
+        m_scratchDrawPackets
+    );
+
+    m_numGeometryBindsLastFrame = quartz::rendering::DrawPacket::countGeometryBinds(m_drawPackets);
+    m_numGeometryBindsAvoidedLastFrame = numUnsortedGeometryBinds - m_numGeometryBindsLastFrame;
+    LOG_TRACEthis("Binding geometry {} times for {} draws. Avoided {} binds by sorting", m_numGeometryBindsLastFrame, m_drawPackets.size(), m_numGeometryBindsAvoidedLastFrame);
+
+    if (cullingOnGpu) {
+        // Blended draws sort after everything else. Keep them on the cpu so they stay back to front
+        const std::vector<quartz::rendering::DrawPacket>::iterator firstTranslucentDrawPacketIt = std::find_if(
+            m_drawPackets.begin(),
+            m_drawPackets.end(),
+            [](const quartz::rendering::DrawPacket& drawPacket) { return drawPacket.getIsTranslucent(); }
+        );
+        m_translucentDrawPackets.assign(firstTranslucentDrawPacketIt, m_drawPackets.end());
+        m_drawPackets.erase(firstTranslucentDrawPacketIt, m_drawPackets.end());
+
+        m_frustumCuller.cullDrawPackets(
+            camera.getFrustumPlanes(),
+            m_translucentDrawPackets
+        );
+
+        const uint32_t opaqueDrawCount = m_drawPackets.size();
+        m_drawPackets.insert(m_drawPackets.end(), m_translucentDrawPackets.begin(), m_translucentDrawPackets.end());
+
+        // With nothing opaque there is nothing for the culling shader to do, and no batches to draw
+        m_numDrawsLastFrame = 0;
+        if (opaqueDrawCount > 0) {
+            this->recordGpuCulledDrawPacketsToDrawingCommandBuffer(
+                renderingWindow,
+                doodadRenderingPipeline,
+                camera,
+                perDrawUniformBufferIndex,
+                shouldCullOccluded,
+                inFlightFrameIndex
+            );
+        }
+
+        if (!m_translucentDrawPackets.empty()) {
+            this->recordTranslucentDrawPacketsToDrawingCommandBuffer(
+                renderingWindow,
+                doodadRenderingPipeline,
+                perDrawUniformBufferIndex,
+                opaqueDrawCount,
+                inFlightFrameIndex
+            );
+        }
+        return;
+    }
+
+    // ----- split the packets evenly between the threads ----- //
+
+    const uint32_t drawCount = m_drawPackets.size();
+    const uint32_t numThreadsToUse = std::clamp<uint32_t>(
+        drawCount / quartz::rendering::Swapchain::minNumDrawsPerRecordingThread,
+        1,
+        m_numRecordingThreads
+    );
+    const uint32_t numDrawsPerThread = (drawCount + numThreadsToUse - 1) / numThreadsToUse;
+
+    // ----- record ----- //
+
+    quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects = reinterpret_cast<quartz::rendering::Primitive::DrawStorageBufferObject*>(
+        doodadRenderingPipeline.getMappedUniformBufferPtr(inFlightFrameIndex, perDrawUniformBufferIndex)
+    );
+    vk::DrawIndexedIndirectCommand* p_indirectDrawCommands = reinterpret_cast<vk::DrawIndexedIndirectCommand*>(
+        m_indirectDrawCommandBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr()
+    );
+    const vk::Buffer& indirectDrawCommandBuffer = *(m_indirectDrawCommandBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr());
+
+    const bool shouldWakeRecordingThreads = numThreadsToUse > 1;
+
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+        m_currentRecordingJob = {
+            &renderingWindow,
+            &doodadRenderingPipeline,
+            inFlightFrameIndex,
+            numThreadsToUse,
+            numDrawsPerThread,
+            drawCount,
+            p_drawStorageBufferObjects,
+            p_indirectDrawCommands,
+            indirectDrawCommandBuffer,
+            shouldDrawIndirectly
+        };
+        m_numRecordingThreadsFinished = 0;
+
+        if (shouldWakeRecordingThreads) {
+            ++m_recordingGeneration;
+        }
+    }
+
+    if (shouldWakeRecordingThreads) {
+        m_recordingStartedConditionVariable.notify_all();
+    }
+
+    // Do our share instead of sitting idle while waiting for the others
+    this->recordRecordingThreadsShare(m_currentRecordingJob, 0);
+
+    if (shouldWakeRecordingThreads) {
+        std::unique_lock<std::mutex> lock(m_recordingMutex);
+        m_recordingFinishedConditionVariable.wait(lock, [this, numThreadsToUse]() {
+            return m_numRecordingThreadsFinished == numThreadsToUse - 1;
+        });
+    }
+
+    doodadRenderingPipeline.markUniformBufferWritten(
+        inFlightFrameIndex,
+        perDrawUniformBufferIndex,
+        0,
+        drawCount * sizeof(quartz::rendering::Primitive::DrawStorageBufferObject)
     );
 
-    while (!nodeQueue.empty()) {
-        const std::shared_ptr<quartz::rendering::Node>& p_node = nodeQueue.front();
-        nodeQueue.pop();
+    m_numDrawsLastFrame = 0;
+    for (uint32_t i = 0; i < numThreadsToUse; ++i) {
+        m_vulkanSecondaryCommandBuffersToExecute.push_back(
+            *(m_vulkanRecordingCommandBufferPtrs[inFlightFrameIndex * m_numRecordingThreads + i])
+        );
+        m_numDrawsLastFrame += m_recordingThreadNumDraws[i];
+    }
+    LOG_TRACEthis("Recorded {} instances with {} draws", drawCount, m_numDrawsLastFrame);
+}
+
+void
+quartz::rendering::Swapchain::runRecordingThread(const uint32_t threadIndex) {
+    uint64_t seenRecordingGeneration = 0;
+
+    while (true) {
+        quartz::rendering::Swapchain::RecordingJob recordingJob;
 
-        for (const std::shared_ptr<quartz::rendering::Node>& p_child : p_node->getChildrenNodePtrs()) {
-            nodeQueue.push(p_child);
+        {
+            std::unique_lock<std::mutex> lock(m_recordingMutex);
+            m_recordingStartedConditionVariable.wait(lock, [this, seenRecordingGeneration]() {
+                return m_shouldStopRecordingThreads || m_recordingGeneration != seenRecordingGeneration;
+            });
+
+            if (m_shouldStopRecordingThreads) {
+                return;
+            }
+
+            seenRecordingGeneration = m_recordingGeneration;
+            recordingJob = m_currentRecordingJob;
         }
 
-        if (!p_node->getMeshPtr()) {
+        if (threadIndex >= recordingJob.numThreadsToUse) {
             continue;
         }
 
-        glm::mat4 currentTransformationMatrix = doodad.getTransformationMatrix() * p_node->getTransformationMatrix();
-        const quartz::rendering::PushConstantInfo& transformMatrixPushConstantInfo = doodadRenderingPipeline.getPushConstantInfos()[0];
-        m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->pushConstants(
-            *doodadRenderingPipeline.getVulkanPipelineLayoutPtr(),
-            transformMatrixPushConstantInfo.getVulkanShaderStageFlags(),
-            transformMatrixPushConstantInfo.getOffset(),
-            transformMatrixPushConstantInfo.getSize(),
-            reinterpret_cast<void*>(&currentTransformationMatrix)
+        this->recordRecordingThreadsShare(recordingJob, threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_recordingMutex);
+            ++m_numRecordingThreadsFinished;
+        }
+        m_recordingFinishedConditionVariable.notify_one();
+    }
+}
+
+void
+quartz::rendering::Swapchain::recordRecordingThreadsShare(
+    const quartz::rendering::Swapchain::RecordingJob& recordingJob,
+    const uint32_t threadIndex
+) {
+    const uint32_t firstDrawIndex = std::min(threadIndex * recordingJob.numDrawsPerThread, recordingJob.drawCount);
+    const uint32_t endDrawIndex = std::min(firstDrawIndex + recordingJob.numDrawsPerThread, recordingJob.drawCount);
+
+    m_recordingThreadNumDraws[threadIndex] = quartz::rendering::Swapchain::recordDrawPacketsToSecondaryCommandBuffer(
+        *(m_vulkanRecordingCommandBufferPtrs[recordingJob.inFlightFrameIndex * m_numRecordingThreads + threadIndex]),
+        m_currentVulkanCommandBufferInheritanceInfo,
+        *recordingJob.p_renderingWindow,
+        *recordingJob.p_doodadRenderingPipeline,
+        recordingJob.inFlightFrameIndex,
+        m_currentLightingVulkanDescriptorSet,
+        m_drawPackets,
+        firstDrawIndex,
+        endDrawIndex - firstDrawIndex,
+        recordingJob.p_drawStorageBufferObjects,
+        recordingJob.p_indirectDrawCommands,
+        recordingJob.indirectDrawCommandBuffer,
+        recordingJob.shouldDrawIndirectly
+    );
+}
+
+void
+quartz::rendering::Swapchain::recordGpuCulledDrawPacketsToDrawingCommandBuffer(
+    const quartz::rendering::Window& renderingWindow,
+    quartz::rendering::Pipeline& doodadRenderingPipeline,
+    const quartz::scene::Camera& camera,
+    const uint32_t perDrawUniformBufferIndex,
+    const bool shouldCullOccluded,
+    const uint32_t inFlightFrameIndex
+) {
+    quartz::rendering::GpuCuller& gpuCuller = *mo_gpuCuller;
+    const uint32_t drawCount = m_drawPackets.size() - m_translucentDrawPackets.size(); // the translucent packets after these are recorded on the cpu
+
+    // ----- write every packet's draw data and culling instance, splitting them into batches ----- //
+
+    m_frustumCuller.gatherWorldBounds(m_drawPackets);
+
+    quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects = reinterpret_cast<quartz::rendering::Primitive::DrawStorageBufferObject*>(
+        doodadRenderingPipeline.getMappedUniformBufferPtr(inFlightFrameIndex, perDrawUniformBufferIndex)
+    );
+    quartz::rendering::GpuCuller::InstanceStorageBufferObject* p_cullingInstances = gpuCuller.getMappedInstancesPtr(inFlightFrameIndex);
+
+    m_gpuCullingBatches.clear();
+
+    for (uint32_t i = 0; i < drawCount; ++i) {
+        const quartz::rendering::DrawPacket& drawPacket = m_drawPackets[i];
+        const quartz::rendering::Primitive& primitive = drawPacket.getPrimitive();
+        const quartz::rendering::GeometryPool::Range& geometryRange = drawPacket.getGeometryRange();
+
+        if (m_gpuCullingBatches.empty() || m_gpuCullingBatches.back().geometryBlockIndex != geometryRange.blockIndex) {
+            m_gpuCullingBatches.push_back({geometryRange.blockIndex, i, 0});
+        }
+        quartz::rendering::GpuCuller::Batch& batch = m_gpuCullingBatches.back();
+        ++batch.drawCount;
+
+        p_drawStorageBufferObjects[i].modelMatrix = drawPacket.getDoodad().getTransformationMatrix() * drawPacket.getInstanceTransformationMatrix();
+        p_drawStorageBufferObjects[i].positionQuantizationOffset = primitive.getPositionQuantization().offset;
+        p_drawStorageBufferObjects[i].positionQuantizationScale = primitive.getPositionQuantization().scale;
+        p_drawStorageBufferObjects[i].materialMasterIndex = primitive.getMaterialMasterIndex();
+
+        p_cullingInstances[i] = {
+            glm::vec4(m_frustumCuller.getWorldBoundsCenter(i), 1.0f),
+            glm::vec4(m_frustumCuller.getWorldBoundsExtent(i), 0.0f),
+            geometryRange.indexCount,
+            geometryRange.firstIndex,
+            geometryRange.vertexOffset,
+            i,
+            static_cast<uint32_t>(m_gpuCullingBatches.size() - 1),
+            batch.firstDrawIndex
+        };
+    }
+
+    doodadRenderingPipeline.markUniformBufferWritten(
+        inFlightFrameIndex,
+        perDrawUniformBufferIndex,
+        0,
+        drawCount * sizeof(quartz::rendering::Primitive::DrawStorageBufferObject)
+    );
+
+    // ----- record the culling dispatch, which is submitted ahead of the drawing command buffer ----- //
+
+    const vk::CommandBuffer& cullingCommandBuffer = *(m_vulkanCullingCommandBufferPtrs[inFlightFrameIndex]);
+
+    cullingCommandBuffer.reset();
+
+    vk::CommandBufferBeginInfo cullingCommandBufferBeginInfo(
+        vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+        {}
+    );
+
+    cullingCommandBuffer.begin(cullingCommandBufferBeginInfo);
+
+    // Without a pyramid from a previous frame there is nothing to test against, so only frustum cull
+    const std::optional<glm::mat4> o_occlusionViewProjectionMatrix = shouldCullOccluded ?
+        mo_depthPyramidViewProjectionMatrix :
+        std::nullopt;
+
+    gpuCuller.recordCullingToCommandBuffer(
+        cullingCommandBuffer,
+        inFlightFrameIndex,
+        quartz::rendering::GpuCuller::Phase::First,
+        camera.getFrustumPlanes(),
+        o_occlusionViewProjectionMatrix,
+        mo_depthPyramid->getSize(),
+        drawCount,
+        m_gpuCullingBatches.size()
+    );
+
+    cullingCommandBuffer.end();
+
+    m_shouldSubmitCullingCommandBuffer = true;
+
+    // ----- draw each batch's survivors ----- //
+
+    const vk::CommandBuffer& secondaryCommandBuffer = *(m_vulkanRecordingCommandBufferPtrs[inFlightFrameIndex * m_numRecordingThreads]);
+
+    quartz::rendering::Swapchain::recordGpuCulledBatchesToSecondaryCommandBuffer(
+        secondaryCommandBuffer,
+        m_currentVulkanCommandBufferInheritanceInfo,
+        renderingWindow,
+        doodadRenderingPipeline,
+        inFlightFrameIndex,
+        m_currentLightingVulkanDescriptorSet,
+        m_gpuCullingBatches,
+        *(gpuCuller.getVulkanDrawCommandBufferPtr(inFlightFrameIndex, quartz::rendering::GpuCuller::Phase::First)),
+        *(gpuCuller.getVulkanDrawCountBufferPtr(inFlightFrameIndex, quartz::rendering::GpuCuller::Phase::First))
+    );
+
+    m_vulkanSecondaryCommandBuffersToExecute.push_back(secondaryCommandBuffer);
+
+    // ----- the same draws again for whatever the second phase finds to be visible after all ----- //
+
+    if (o_occlusionViewProjectionMatrix) {
+        quartz::rendering::Swapchain::recordGpuCulledBatchesToSecondaryCommandBuffer(
+            *(m_vulkanOcclusionCommandBufferPtrs[inFlightFrameIndex]),
+            m_currentVulkanCommandBufferInheritanceInfo,
+            renderingWindow,
+            doodadRenderingPipeline,
+            inFlightFrameIndex,
+            m_currentLightingVulkanDescriptorSet,
+            m_gpuCullingBatches,
+            *(gpuCuller.getVulkanDrawCommandBufferPtr(inFlightFrameIndex, quartz::rendering::GpuCuller::Phase::Second)),
+            *(gpuCuller.getVulkanDrawCountBufferPtr(inFlightFrameIndex, quartz::rendering::GpuCuller::Phase::Second))
         );
 
-        for (const quartz::rendering::Primitive& primitive : p_node->getMeshPtr()->getPrimitives()) {
-            /** @brief This is the offset into the dynamic uniform buffer */
-            uint32_t materialMasterIndex = primitive.getMaterialMasterIndex();
-            uint32_t materialByteOffset = minUniformBufferOffsetAlignment > 0 ?
-                (sizeof(quartz::rendering::Material::UniformBufferObject) + minUniformBufferOffsetAlignment - 1) & ~(minUniformBufferOffsetAlignment - 1) :
-                sizeof(quartz::rendering::Material::UniformBufferObject);
-            materialByteOffset *= materialMasterIndex;
-
-            // Bind the descriptor set
-            m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindDescriptorSets(
-                vk::PipelineBindPoint::eGraphics,
-                *doodadRenderingPipeline.getVulkanPipelineLayoutPtr(),
-                0,
-                1,
-                &(doodadRenderingPipeline.getVulkanDescriptorSets()[inFlightFrameIndex]),
-                1,
-                &materialByteOffset
-            );
+        m_shouldRecordOcclusionCullingPhase = true;
+        m_currentFrustumPlanes = camera.getFrustumPlanes();
+        m_numGpuCulledInstances = drawCount;
+    }
 
-            /** @brief 2024/05/16 This isn't actually used for anything and is just here as an example of using a push constant in the fragment shader */
-            const quartz::rendering::PushConstantInfo& dummyPushConstantInfo = doodadRenderingPipeline.getPushConstantInfos()[1];
-            m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->pushConstants(
-                *doodadRenderingPipeline.getVulkanPipelineLayoutPtr(),
-                dummyPushConstantInfo.getVulkanShaderStageFlags(),
-                dummyPushConstantInfo.getOffset(),
-                dummyPushConstantInfo.getSize(),
-                reinterpret_cast<void*>(&materialMasterIndex)
-            );
+    if (shouldCullOccluded) {
+        m_shouldBuildDepthPyramid = true;
+        m_currentViewProjectionMatrix = camera.getProjectionMatrix() * camera.getViewMatrix();
+    }
+
+    // The cpu never finds out how many draws survived, so this is the most there could have been
+    m_numDrawsLastFrame = drawCount;
+    LOG_TRACEthis("Recorded {} gpu culled instances in {} batches ({}occlusion culled)", drawCount, m_gpuCullingBatches.size(), o_occlusionViewProjectionMatrix ? "" : "not ");
+}
+
+void
+quartz::rendering::Swapchain::recordTranslucentDrawPacketsToDrawingCommandBuffer(
+    const quartz::rendering::Window& renderingWindow,
+    quartz::rendering::Pipeline& doodadRenderingPipeline,
+    const uint32_t perDrawUniformBufferIndex,
+    const uint32_t opaqueDrawCount,
+    const uint32_t inFlightFrameIndex
+) {
+    const uint32_t translucentDrawCount = m_drawPackets.size() - opaqueDrawCount;
+
+    quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects = reinterpret_cast<quartz::rendering::Primitive::DrawStorageBufferObject*>(
+        doodadRenderingPipeline.getMappedUniformBufferPtr(inFlightFrameIndex, perDrawUniformBufferIndex)
+    );
+
+    const vk::CommandBuffer& translucentCommandBuffer = *(m_vulkanTranslucentCommandBufferPtrs[inFlightFrameIndex]);
+    vk::DrawIndexedIndirectCommand* p_indirectDrawCommands = reinterpret_cast<vk::DrawIndexedIndirectCommand*>(
+        m_indirectDrawCommandBuffers[inFlightFrameIndex].getMappedLocalMemoryPtr()
+    );
+    const vk::Buffer& indirectDrawCommandBuffer = *(m_indirectDrawCommandBuffers[inFlightFrameIndex].getVulkanLogicalBufferPtr());
+
+    const uint32_t numTranslucentDraws = quartz::rendering::Swapchain::recordDrawPacketsToSecondaryCommandBuffer(
+        translucentCommandBuffer,
+        m_currentVulkanCommandBufferInheritanceInfo,
+        renderingWindow,
+        doodadRenderingPipeline,
+        inFlightFrameIndex,
+        m_currentLightingVulkanDescriptorSet,
+        m_drawPackets,
+        opaqueDrawCount,
+        translucentDrawCount,
+        p_drawStorageBufferObjects,
+        p_indirectDrawCommands,
+        indirectDrawCommandBuffer,
+        true
+    );
+
+    doodadRenderingPipeline.markUniformBufferWritten(
+        inFlightFrameIndex,
+        perDrawUniformBufferIndex,
+        opaqueDrawCount * sizeof(quartz::rendering::Primitive::DrawStorageBufferObject),
+        translucentDrawCount * sizeof(quartz::rendering::Primitive::DrawStorageBufferObject)
+    );
+
+    // Whatever the second phase finds to be visible is opaque, so it has to be drawn before these
+    if (m_shouldRecordOcclusionCullingPhase) {
+        m_shouldDrawTranslucentAfterOcclusionCullingPhase = true;
+    } else {
+        m_vulkanSecondaryCommandBuffersToExecute.push_back(translucentCommandBuffer);
+    }
+
+    m_numDrawsLastFrame += numTranslucentDraws;
+    LOG_TRACEthis("Recorded {} translucent instances with {} draws on the cpu", translucentDrawCount, numTranslucentDraws);
+}
+
+void
+quartz::rendering::Swapchain::recordOcclusionCullingPhaseToDrawingCommandBuffer(
+    const uint32_t inFlightFrameIndex
+) {
+    const vk::CommandBuffer& drawingCommandBuffer = *(m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]);
+
+    // ----- re-test the occluded draws against what the first phase drew ----- //
+
+    mo_depthPyramid->recordBuildToCommandBuffer(drawingCommandBuffer);
+
+    mo_gpuCuller->recordCullingToCommandBuffer(
+        drawingCommandBuffer,
+        inFlightFrameIndex,
+        quartz::rendering::GpuCuller::Phase::Second,
+        m_currentFrustumPlanes,
+        m_currentViewProjectionMatrix,
+        mo_depthPyramid->getSize(),
+        m_numGpuCulledInstances,
+        m_gpuCullingBatches.size()
+    );
+
+    // ----- draw the ones which became visible on top of everything else ----- //
+
+    drawingCommandBuffer.beginRenderPass(
+        m_currentVulkanContinuationRenderPassBeginInfo,
+        vk::SubpassContents::eSecondaryCommandBuffers
+    );
+
+    std::array<vk::CommandBuffer, 2> continuationCommandBuffers;
+    uint32_t numContinuationCommandBuffers = 0;
+    continuationCommandBuffers[numContinuationCommandBuffers++] = *(m_vulkanOcclusionCommandBufferPtrs[inFlightFrameIndex]);
+    if (m_shouldDrawTranslucentAfterOcclusionCullingPhase) {
+        continuationCommandBuffers[numContinuationCommandBuffers++] = *(m_vulkanTranslucentCommandBufferPtrs[inFlightFrameIndex]);
+    }
+
+    drawingCommandBuffer.executeCommands(
+        vk::ArrayProxyNoTemporaries<const vk::CommandBuffer>(numContinuationCommandBuffers, continuationCommandBuffers.data())
+    );
+
+    drawingCommandBuffer.endRenderPass();
+}
+
+uint32_t
+quartz::rendering::Swapchain::recordDrawPacketsToSecondaryCommandBuffer(
+    const vk::CommandBuffer& secondaryCommandBuffer,
+    const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo,
+    const quartz::rendering::Window& renderingWindow,
+    const quartz::rendering::Pipeline& doodadRenderingPipeline,
+    const uint32_t inFlightFrameIndex,
+    const vk::DescriptorSet& lightingDescriptorSet,
+    const std::vector<quartz::rendering::DrawPacket>& drawPackets,
+    const uint32_t firstDrawIndex,
+    const uint32_t drawCount,
+    quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects,
+    vk::DrawIndexedIndirectCommand* p_indirectDrawCommands,
+    const vk::Buffer& indirectDrawCommandBuffer,
+    const bool shouldDrawIndirectly
+) {
+    quartz::rendering::Swapchain::beginSecondaryCommandBuffer(
+        secondaryCommandBuffer,
+        commandBufferInheritanceInfo
+    );
+
+    quartz::rendering::Swapchain::bindPipelineToCommandBuffer(
+        secondaryCommandBuffer,
+        renderingWindow,
+        doodadRenderingPipeline
+    );
+
+    /**
+     * @brief Everything a draw needs lives in the per draw storage buffer and is found with the
+     *   draw's firstInstance, so the descriptor sets only need to be bound once for all doodads
+     */
+    const std::array<vk::DescriptorSet, 2> descriptorSets = {
+        doodadRenderingPipeline.getVulkanDescriptorSets()[inFlightFrameIndex],
+        lightingDescriptorSet
+    };
+
+    secondaryCommandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *doodadRenderingPipeline.getVulkanPipelineLayoutPtr(),
+        0,
+        descriptorSets,
+        doodadRenderingPipeline.getDynamicOffsets(inFlightFrameIndex)
+    );
+
+    /**
+     * @brief Which geometry pool block's buffers are currently bound to the command buffer, so we only
+     *   rebind vertex and index buffers when the sort key's block changes
+     */
+    std::optional<uint32_t> o_boundGeometryBlockIndex;
+
+    /**
+     * @brief Sorted packets from the same doodad and draw entry usually end up next to each other, so
+     *   hold onto the doodad's transformation matrix combined with the node's instead of calculating
+     *   it for every packet
+     */
+    const quartz::scene::Doodad* p_previousDoodad = nullptr;
+    const quartz::rendering::Model::DrawEntry* p_previousDrawEntry = nullptr;
+    glm::mat4 currentTransformationMatrix(1.0f);
+
+    /**
+     * @brief Every packet gets its own slot in the per draw storage buffer, but a run of packets of the
+     *   same primitive only needs a single draw command. So there are never more commands than packets
+     *   and each thread can write its commands starting at its first packet's slot
+     */
+    uint32_t drawCommandIndex = firstDrawIndex;
+    uint32_t batchFirstDrawCommandIndex = firstDrawIndex;
+
+    uint32_t drawIndex = firstDrawIndex;
+    while (drawIndex < firstDrawIndex + drawCount) {
+        const quartz::rendering::Primitive& primitive = drawPackets[drawIndex].getPrimitive();
+        const uint32_t lodLevel = drawPackets[drawIndex].getLodLevel();
+        const quartz::rendering::GeometryPool::Range& geometryRange = drawPackets[drawIndex].getGeometryRange();
+
+        // Bind the geometry pool block's vertex and index buffers if they aren't already bound,
+        // submitting everything which used the previously bound block first
+        if (!o_boundGeometryBlockIndex || *o_boundGeometryBlockIndex != geometryRange.blockIndex) {
+            if (shouldDrawIndirectly) {
+                quartz::rendering::Swapchain::recordIndirectDrawBatchToCommandBuffer(
+                    secondaryCommandBuffer,
+                    indirectDrawCommandBuffer,
+                    batchFirstDrawCommandIndex,
+                    drawCommandIndex - batchFirstDrawCommandIndex
+                );
+                batchFirstDrawCommandIndex = drawCommandIndex;
+            }
+
+            const quartz::rendering::GeometryPool::Block& geometryBlock = quartz::rendering::GeometryPool::getBlock(geometryRange.blockIndex);
 
-            // Bind the vertex buffer
             uint32_t offset = 0;
-            m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindVertexBuffers(
+            secondaryCommandBuffer.bindVertexBuffers(
                 0,
-                *(primitive.getStagedVertexBuffer().getVulkanLogicalBufferPtr()),
+                *(geometryBlock.getVulkanLogicalVertexBufferPtr()),
                 offset
             );
 
-            // Index buffer
-            m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->bindIndexBuffer(
-                *(primitive.getStagedIndexBuffer().getVulkanLogicalBufferPtr()),
+            secondaryCommandBuffer.bindIndexBuffer(
+                *(geometryBlock.getVulkanLogicalIndexBufferPtr()),
                 0,
                 vk::IndexType::eUint32
             );
 
-            // Draw using the vertex and index buffer
-            m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->drawIndexed(
-                primitive.getIndexCount(),
-                1,
-                0,
-                0,
-                0
+            o_boundGeometryBlockIndex = geometryRange.blockIndex;
+        }
+
+        // Write every neighbouring packet of this primitive (at this level of detail) into the storage
+        // buffer as an instance
+        const uint32_t firstInstanceIndex = drawIndex;
+        do {
+            const quartz::rendering::DrawPacket& drawPacket = drawPackets[drawIndex];
+
+            if (&drawPacket.getDoodad() != p_previousDoodad || &drawPacket.getDrawEntry() != p_previousDrawEntry) {
+                p_previousDoodad = &drawPacket.getDoodad();
+                p_previousDrawEntry = &drawPacket.getDrawEntry();
+                currentTransformationMatrix = p_previousDoodad->getTransformationMatrix() * p_previousDrawEntry->transformationMatrix;
+            }
+
+            const std::vector<glm::mat4>& instanceTransformationMatrices = p_previousDrawEntry->p_node->getInstanceTransformationMatrices();
+
+            p_drawStorageBufferObjects[drawIndex].modelMatrix = instanceTransformationMatrices.empty() ?
+                currentTransformationMatrix :
+                currentTransformationMatrix * instanceTransformationMatrices[drawPacket.getInstanceIndex()];
+            p_drawStorageBufferObjects[drawIndex].positionQuantizationOffset = primitive.getPositionQuantization().offset;
+            p_drawStorageBufferObjects[drawIndex].positionQuantizationScale = primitive.getPositionQuantization().scale;
+            p_drawStorageBufferObjects[drawIndex].materialMasterIndex = primitive.getMaterialMasterIndex();
+
+            ++drawIndex;
+        } while (
+            drawIndex < firstDrawIndex + drawCount &&
+            &drawPackets[drawIndex].getPrimitive() == &primitive &&
+            drawPackets[drawIndex].getLodLevel() == lodLevel
+        );
+        const uint32_t instanceCount = drawIndex - firstInstanceIndex;
+
+        // Use the first instance's index as the first instance so the shaders can find each instance's data
+        if (shouldDrawIndirectly) {
+            p_indirectDrawCommands[drawCommandIndex] = vk::DrawIndexedIndirectCommand(
+                geometryRange.indexCount,
+                instanceCount,
+                geometryRange.firstIndex,
+                geometryRange.vertexOffset,
+                firstInstanceIndex
+            );
+        } else {
+            secondaryCommandBuffer.drawIndexed(
+                geometryRange.indexCount,
+                instanceCount,
+                geometryRange.firstIndex,
+                geometryRange.vertexOffset,
+                firstInstanceIndex
             );
         }
+
+        ++drawCommandIndex;
+    }
+
+    if (shouldDrawIndirectly) {
+        quartz::rendering::Swapchain::recordIndirectDrawBatchToCommandBuffer(
+            secondaryCommandBuffer,
+            indirectDrawCommandBuffer,
+            batchFirstDrawCommandIndex,
+            drawCommandIndex - batchFirstDrawCommandIndex
+        );
     }
+
+    secondaryCommandBuffer.end();
+
+    return drawCommandIndex - firstDrawIndex;
+}
+
+void
+quartz::rendering::Swapchain::recordGpuCulledBatchesToSecondaryCommandBuffer(
+    const vk::CommandBuffer& secondaryCommandBuffer,
+    const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo,
+    const quartz::rendering::Window& renderingWindow,
+    const quartz::rendering::Pipeline& doodadRenderingPipeline,
+    const uint32_t inFlightFrameIndex,
+    const vk::DescriptorSet& lightingDescriptorSet,
+    const std::vector<quartz::rendering::GpuCuller::Batch>& batches,
+    const vk::Buffer& drawCommandBuffer,
+    const vk::Buffer& drawCountBuffer
+) {
+    quartz::rendering::Swapchain::beginSecondaryCommandBuffer(
+        secondaryCommandBuffer,
+        commandBufferInheritanceInfo
+    );
+
+    quartz::rendering::Swapchain::bindPipelineToCommandBuffer(
+        secondaryCommandBuffer,
+        renderingWindow,
+        doodadRenderingPipeline
+    );
+
+    const std::array<vk::DescriptorSet, 2> descriptorSets = {
+        doodadRenderingPipeline.getVulkanDescriptorSets()[inFlightFrameIndex],
+        lightingDescriptorSet
+    };
+
+    secondaryCommandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *doodadRenderingPipeline.getVulkanPipelineLayoutPtr(),
+        0,
+        descriptorSets,
+        doodadRenderingPipeline.getDynamicOffsets(inFlightFrameIndex)
+    );
+
+    for (uint32_t i = 0; i < batches.size(); ++i) {
+        const quartz::rendering::GpuCuller::Batch& batch = batches[i];
+        const quartz::rendering::GeometryPool::Block& geometryBlock = quartz::rendering::GeometryPool::getBlock(batch.geometryBlockIndex);
+
+        uint32_t offset = 0;
+        secondaryCommandBuffer.bindVertexBuffers(
+            0,
+            *(geometryBlock.getVulkanLogicalVertexBufferPtr()),
+            offset
+        );
+
+        secondaryCommandBuffer.bindIndexBuffer(
+            *(geometryBlock.getVulkanLogicalIndexBufferPtr()),
+            0,
+            vk::IndexType::eUint32
+        );
+
+        secondaryCommandBuffer.drawIndexedIndirectCount(
+            drawCommandBuffer,
+            batch.firstDrawIndex * sizeof(vk::DrawIndexedIndirectCommand),
+            drawCountBuffer,
+            i * sizeof(uint32_t),
+            batch.drawCount,
+            sizeof(vk::DrawIndexedIndirectCommand)
+        );
+    }
+
+    secondaryCommandBuffer.end();
+}
+
+void
+quartz::rendering::Swapchain::recordIndirectDrawBatchToCommandBuffer(
+    const vk::CommandBuffer& commandBuffer,
+    const vk::Buffer& indirectDrawCommandBuffer,
+    const uint32_t firstDrawIndex,
+    const uint32_t drawCount
+) {
+    if (drawCount == 0) {
+        return;
+    }
+
+    commandBuffer.drawIndexedIndirect(
+        indirectDrawCommandBuffer,
+        firstDrawIndex * sizeof(vk::DrawIndexedIndirectCommand),
+        drawCount,
+        sizeof(vk::DrawIndexedIndirectCommand)
+    );
 }
 
 void
@@ -669,18 +1702,44 @@ quartz::rendering::Swapchain::endAndSubmitDrawingCommandBuffer(
     const quartz::rendering::Device& renderingDevice,
     const uint32_t inFlightFrameIndex
 ) {
+    if (!m_vulkanSecondaryCommandBuffersToExecute.empty()) {
+        m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->executeCommands(
+            m_vulkanSecondaryCommandBuffersToExecute
+        );
+    }
+
     m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->endRenderPass();
 
+    if (m_shouldRecordOcclusionCullingPhase) {
+        this->recordOcclusionCullingPhaseToDrawingCommandBuffer(inFlightFrameIndex);
+    }
+
+    // Rebuild from the finished depth buffer for the next frame's first phase to test against
+    if (m_shouldBuildDepthPyramid) {
+        mo_depthPyramid->recordBuildToCommandBuffer(*(m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]));
+        mo_depthPyramidViewProjectionMatrix = m_currentViewProjectionMatrix;
+    } else {
+        mo_depthPyramidViewProjectionMatrix.reset();
+    }
+
     m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]->end();
 
     vk::PipelineStageFlags waitStageMask(
         vk::PipelineStageFlagBits::eColorAttachmentOutput
     );
 
+    // The culling commands only touch buffers, so they don't need to wait for the image to be available
+    std::array<vk::CommandBuffer, 2> commandBuffersToSubmit;
+    uint32_t numCommandBuffersToSubmit = 0;
+    if (m_shouldSubmitCullingCommandBuffer) {
+        commandBuffersToSubmit[numCommandBuffersToSubmit++] = *(m_vulkanCullingCommandBufferPtrs[inFlightFrameIndex]);
+    }
+    commandBuffersToSubmit[numCommandBuffersToSubmit++] = *(m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]);
+
     vk::SubmitInfo commandBufferSubmitInfo(
         *(m_vulkanImageAvailableSemaphorePtrs[inFlightFrameIndex]),
         waitStageMask,
-        *(m_vulkanDrawingCommandBufferPtrs[inFlightFrameIndex]),
+        vk::ArrayProxyNoTemporaries<const vk::CommandBuffer>(numCommandBuffersToSubmit, commandBuffersToSubmit.data()),
         *(m_vulkanRenderFinishedSemaphorePtrs[inFlightFrameIndex])
     );
 
@@ -1,17 +1,33 @@
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 #include <vulkan/vulkan.hpp>
 
 #include "quartz/rendering/Loggers.hpp"
+#include "quartz/rendering/buffer/LocallyMappedBuffer.hpp"
+#include "quartz/rendering/culling/DepthPyramid.hpp"
+#include "quartz/rendering/culling/FrustumCuller.hpp"
+#include "quartz/rendering/culling/GpuCuller.hpp"
+#include "quartz/rendering/culling/LightCuller.hpp"
 #include "quartz/rendering/depth_buffer/DepthBuffer.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/draw_packet/DrawPacket.hpp"
 #include "quartz/rendering/model/Model.hpp"
+#include "quartz/rendering/model/Primitive.hpp"
 #include "quartz/rendering/pipeline/Pipeline.hpp"
 #include "quartz/rendering/window/Window.hpp"
+#include "quartz/scene/camera/Camera.hpp"
 #include "quartz/scene/doodad/Doodad.hpp"
 #include "quartz/scene/sky_box/SkyBox.hpp"
 
@@ -27,29 +43,57 @@ public: // member functions
         const quartz::rendering::Device& renderingDevice,
         const quartz::rendering::Window& renderingWindow,
         const quartz::rendering::RenderPass& renderingRenderPass,
-        const uint32_t maxNumFramesInFlight
+        const uint32_t maxNumFramesInFlight,
+        const uint32_t desiredImageCount
     );
     ~Swapchain();
 
-    void reset();
+    /**
+     * @brief Replace everything sized to the window (the swapchain, its images, the depth buffer and the
+     *   framebuffers) without waiting for the device to go idle. The old swapchain is handed to the new one
+     *   as its oldSwapchain and the old resources are retired, to be destroyed once every frame in flight
+     *   has waited for its fence. The command buffers and synchronization objects are kept as they are
+     */
     void recreate(
         const quartz::rendering::Device& renderingDevice,
         const quartz::rendering::Window& renderingWindow,
-        const quartz::rendering::RenderPass& renderingRenderPass,
-        const uint32_t maxNumFramesInFlight
+        const quartz::rendering::RenderPass& renderingRenderPass
     );
 
     USE_LOGGER(SWAPCHAIN);
 
     bool getShouldRecreate() const { return m_shouldRecreate; }
+    uint32_t getDesiredImageCount() const { return m_desiredImageCount; }
+    uint32_t getImageCount() const { return m_vulkanImages.size(); }
+    uint32_t getNumRecordingThreads() const { return m_numRecordingThreads; }
+    uint32_t getNumGeometryBindsLastFrame() const { return m_numGeometryBindsLastFrame; }
+    uint32_t getNumGeometryBindsAvoidedLastFrame() const { return m_numGeometryBindsAvoidedLastFrame; }
+    uint32_t getNumInstancesLastFrame() const { return m_drawPackets.size(); }
+    uint32_t getNumDrawsLastFrame() const { return m_numDrawsLastFrame; }
+    const quartz::rendering::FrustumCuller& getFrustumCuller() const { return m_frustumCuller; }
+    bool getGpuCullerCreated() const { return mo_gpuCuller.has_value(); }
 
     void setScreenClearColor(const glm::vec3& screenClearColor);
 
+    /**
+     * @brief Zero lets the swapchain choose. Anything else is clamped to what the surface supports. This
+     *   requests recreation, since the image count can only be chosen when the swapchain is created
+     */
+    void setDesiredImageCount(const uint32_t desiredImageCount);
+
+    /**
+     * @brief Once the frame's fence is signaled nothing the frame last submitted is in use anymore, so this
+     *   also destroys the retired resources no frame could still be using
+     */
     void waitForInFlightFence(
         const quartz::rendering::Device& renderingDevice,
         const uint32_t inFlightFrameIndex
     );
-    uint32_t getAvailableImageIndex(
+    /**
+     * @brief Empty when the swapchain is out of date and no image was acquired, in which case it must be
+     *   recreated before drawing. A suboptimal swapchain still gives an image, and only requests recreation
+     */
+    std::optional<uint32_t> getAvailableImageIndex(
         const quartz::rendering::Device& renderingDevice,
         const uint32_t inFlightFrameIndex
     );
@@ -57,28 +101,54 @@ public: // member functions
         const quartz::rendering::Device& renderingDevice,
         const uint32_t inFlightFrameIndex
     );
+    /**
+     * @brief Also records the light culler's binning dispatch ahead of the render pass, and remembers
+     *   its descriptor set so the doodads can bind it as set 1
+     */
     void resetAndBeginDrawingCommandBuffer(
         const quartz::rendering::Window& renderingWindow,
         const quartz::rendering::RenderPass& renderingRenderPass,
+        quartz::rendering::LightCuller& lightCuller,
         const uint32_t inFlightFrameIndex,
         const uint32_t availableSwapchainImageIndex
     );
-    void bindPipelineToDrawingCommandBuffer(
-        const quartz::rendering::Window& renderingWindow,
-        const quartz::rendering::Pipeline& renderingPipeline,
-        const uint32_t inFlightFrameIndex
-    );
     void recordSkyBoxToDrawingCommandBuffer(
+        const quartz::rendering::Window& renderingWindow,
         const quartz::rendering::Pipeline& skyBoxRenderingPipeline,
         const quartz::scene::SkyBox& skyBox,
         const uint32_t inFlightFrameIndex
     );
-    void recordDoodadToDrawingCommandBuffer(
-        const quartz::rendering::Device& renderingDevice,
-        const quartz::rendering::Pipeline& doodadRenderingPipeline,
-        const quartz::scene::Doodad& doodad,
+
+    /**
+     * @brief Build a draw packet for every primitive, cull the ones outside of the camera's view frustum,
+     *   and sort the rest by state (and then by depth), then split
+     *   the sorted packets across up to m_numRecordingThreads threads. Each thread records its share into
+     *   its own secondary command buffer (allocated from its own command pool) which the primary drawing
+     *   command buffer executes when the frame is submitted
+     *
+     * @param shouldCullOnGpu Leave the culling to the GpuCuller's compute shader instead (requires
+     *   shouldDrawIndirectly). Every packet is still sorted and written on the cpu, but only the
+     *   survivors are drawn, with one vkCmdDrawIndexedIndirectCount per geometry pool block
+     * @param shouldCullOccluded Also occlusion cull against the depth pyramid (requires shouldCullOnGpu).
+     *   The draws found occluded by the previous frame's depth are re-tested and drawn in a second
+     *   render pass when the frame is submitted
+     */
+    void recordDoodadsToDrawingCommandBuffer(
+        const quartz::rendering::Window& renderingWindow,
+        quartz::rendering::Pipeline& doodadRenderingPipeline,
+        const std::vector<quartz::scene::Doodad>& doodads,
+        const quartz::scene::Camera& camera,
+        const uint32_t perDrawUniformBufferIndex,
+        const bool shouldDrawIndirectly,
+        const bool shouldCullOnGpu,
+        const bool shouldCullOccluded,
         const uint32_t inFlightFrameIndex
     );
+
+    /**
+     * @brief When occlusion culling, this also records the second culling phase and its render pass
+     *   followed by building the depth pyramid the next frame's first phase tests against
+     */
     void endAndSubmitDrawingCommandBuffer(
         const quartz::rendering::Device& renderingDevice,
         const uint32_t inFlightFrameIndex
@@ -89,7 +159,82 @@ public: // member functions
         const uint32_t availableSwapchainImageIndex
     );
 
+public: // static variables
+    static constexpr uint32_t maxNumRecordingThreads = 16;
+
+    /**
+     * @brief Waking a thread isn't free, so don't give a thread fewer draws than this to record
+     */
+    static constexpr uint32_t minNumDrawsPerRecordingThread = 256;
+
+private: // classes
+    /**
+     * @brief Everything a recording thread needs to record its share of the frame's draw packets. The
+     *   threads copy it while holding the recording mutex
+     */
+    struct RecordingJob {
+    public: // member variables
+        const quartz::rendering::Window* p_renderingWindow;
+        const quartz::rendering::Pipeline* p_doodadRenderingPipeline;
+        uint32_t inFlightFrameIndex;
+        uint32_t numThreadsToUse;
+        uint32_t numDrawsPerThread;
+        uint32_t drawCount;
+        quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects;
+        vk::DrawIndexedIndirectCommand* p_indirectDrawCommands;
+        vk::Buffer indirectDrawCommandBuffer;
+        bool shouldDrawIndirectly;
+    };
+
+    /**
+     * @brief Everything sized to the window which was replaced by a recreation, kept alive until every frame
+     *   in flight which might have been using it has waited for its fence
+     */
+    struct RetiredResources {
+    public: // member variables
+        uint32_t inFlightFramesToWaitForMask; // bit i is set until frame i has waited for its fence
+        vk::UniqueSwapchainKHR p_vulkanSwapchain;
+        std::vector<vk::UniqueImageView> vulkanImageViewPtrs;
+        std::optional<quartz::rendering::DepthBuffer> o_depthBuffer;
+        std::vector<vk::UniqueFramebuffer> vulkanFramebufferPtrs;
+        std::optional<quartz::rendering::DepthPyramid> o_depthPyramid;
+    };
+
+private: // member functions
+    void releaseRetiredResources(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t inFlightFrameIndex
+    );
+    void runRecordingThread(const uint32_t threadIndex);
+    void recordRecordingThreadsShare(
+        const quartz::rendering::Swapchain::RecordingJob& recordingJob,
+        const uint32_t threadIndex
+    );
+    void recordGpuCulledDrawPacketsToDrawingCommandBuffer(
+        const quartz::rendering::Window& renderingWindow,
+        quartz::rendering::Pipeline& doodadRenderingPipeline,
+        const quartz::scene::Camera& camera,
+        const uint32_t perDrawUniformBufferIndex,
+        const bool shouldCullOccluded,
+        const uint32_t inFlightFrameIndex
+    );
+    void recordTranslucentDrawPacketsToDrawingCommandBuffer(
+        const quartz::rendering::Window& renderingWindow,
+        quartz::rendering::Pipeline& doodadRenderingPipeline,
+        const uint32_t perDrawUniformBufferIndex,
+        const uint32_t opaqueDrawCount,
+        const uint32_t inFlightFrameIndex
+    );
+    void recordOcclusionCullingPhaseToDrawingCommandBuffer(
+        const uint32_t inFlightFrameIndex
+    );
+
 private: // static functions
+    static uint32_t determineNumRecordingThreads();
+    static vk::ImageUsageFlags determineDepthBufferUsageFlags(
+        const quartz::rendering::Device& renderingDevice,
+        const vk::Format depthBufferFormat
+    );
     static vk::UniqueSwapchainKHR createVulkanSwapchainPtr(
         const uint32_t graphicsQueueFamilyIndex,
         const vk::UniqueDevice& p_logicalDevice,
@@ -97,7 +242,9 @@ private: // static functions
         const vk::SurfaceCapabilitiesKHR& surfaceCapabilities,
         const vk::SurfaceFormatKHR& surfaceFormat,
         const vk::PresentModeKHR& presentMode,
-        const vk::Extent2D& swapchainExtent
+        const vk::Extent2D& swapchainExtent,
+        const uint32_t desiredImageCount,
+        const vk::SwapchainKHR& oldSwapchain
     );
     static std::vector<vk::UniqueImageView> createVulkanSwapchainImageViewUniquePtrs(
         const vk::UniqueDevice& p_logicalDevice,
@@ -119,8 +266,80 @@ private: // static functions
         const vk::UniqueDevice& p_logicalDevice,
         const uint32_t desiredFenceCount
     );
+    static std::vector<quartz::rendering::LocallyMappedBuffer> createIndirectDrawCommandBuffers(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t maxNumFramesInFlight
+    );
+
+    static std::vector<vk::UniqueCommandPool> createVulkanRecordingCommandPoolPtrs(
+        const quartz::rendering::Device& renderingDevice,
+        const uint32_t desiredCommandPoolCount
+    );
+    static std::vector<vk::UniqueCommandBuffer> allocateVulkanRecordingCommandBufferPtrs(
+        const vk::UniqueDevice& p_logicalDevice,
+        const std::vector<vk::UniqueCommandPool>& recordingCommandPoolPtrs
+    );
+
+    /**
+     * @brief Every primitive of a doodad is drawn at the same level of detail, chosen from how much of
+     *   the screen the sphere around the doodad's model covers
+     */
+    static uint32_t selectDoodadLodLevel(
+        const quartz::scene::Doodad& doodad,
+        const quartz::scene::Camera& camera
+    );
+
+    // These are used by the recording threads, so they must not touch any member state
+
+    static void beginSecondaryCommandBuffer(
+        const vk::CommandBuffer& secondaryCommandBuffer,
+        const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo
+    );
+    static void bindPipelineToCommandBuffer(
+        const vk::CommandBuffer& commandBuffer,
+        const quartz::rendering::Window& renderingWindow,
+        const quartz::rendering::Pipeline& renderingPipeline
+    );
+    /**
+     * @brief Returns the number of draws recorded, which is fewer than drawCount when neighbouring
+     *   packets of the same primitive are drawn together as instances
+     */
+    static uint32_t recordDrawPacketsToSecondaryCommandBuffer(
+        const vk::CommandBuffer& secondaryCommandBuffer,
+        const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo,
+        const quartz::rendering::Window& renderingWindow,
+        const quartz::rendering::Pipeline& doodadRenderingPipeline,
+        const uint32_t inFlightFrameIndex,
+        const vk::DescriptorSet& lightingDescriptorSet,
+        const std::vector<quartz::rendering::DrawPacket>& drawPackets,
+        const uint32_t firstDrawIndex,
+        const uint32_t drawCount,
+        quartz::rendering::Primitive::DrawStorageBufferObject* p_drawStorageBufferObjects,
+        vk::DrawIndexedIndirectCommand* p_indirectDrawCommands,
+        const vk::Buffer& indirectDrawCommandBuffer,
+        const bool shouldDrawIndirectly
+    );
+    static void recordIndirectDrawBatchToCommandBuffer(
+        const vk::CommandBuffer& commandBuffer,
+        const vk::Buffer& indirectDrawCommandBuffer,
+        const uint32_t firstDrawIndex,
+        const uint32_t drawCount
+    );
+    static void recordGpuCulledBatchesToSecondaryCommandBuffer(
+        const vk::CommandBuffer& secondaryCommandBuffer,
+        const vk::CommandBufferInheritanceInfo& commandBufferInheritanceInfo,
+        const quartz::rendering::Window& renderingWindow,
+        const quartz::rendering::Pipeline& doodadRenderingPipeline,
+        const uint32_t inFlightFrameIndex,
+        const vk::DescriptorSet& lightingDescriptorSet,
+        const std::vector<quartz::rendering::GpuCuller::Batch>& batches,
+        const vk::Buffer& drawCommandBuffer,
+        const vk::Buffer& drawCountBuffer
+    );
 
 private: // member variables
+    const uint32_t m_maxNumFramesInFlight;
+    uint32_t m_desiredImageCount;
     bool m_shouldRecreate;
 
     vk::UniqueSwapchainKHR mp_vulkanSwapchain;
@@ -134,7 +353,112 @@ private: // member variables
     glm::vec3 m_screenClearColor;
     vk::UniqueCommandPool mp_vulkanDrawingCommandPool;
     std::vector<vk::UniqueCommandBuffer> m_vulkanDrawingCommandBufferPtrs;
+
+    /**
+     * @brief Primary command buffers (from the drawing command pool) holding the gpu culling dispatch.
+     *   When one was recorded this frame it is submitted right before the drawing command buffer
+     */
+    std::vector<vk::UniqueCommandBuffer> m_vulkanCullingCommandBufferPtrs;
+    bool m_shouldSubmitCullingCommandBuffer;
+
     std::vector<vk::UniqueSemaphore> m_vulkanImageAvailableSemaphorePtrs;
     std::vector<vk::UniqueSemaphore> m_vulkanRenderFinishedSemaphorePtrs;
     std::vector<vk::UniqueFence> m_vulkanInFlightFencePtrs;
+
+    /**
+     * @brief The render pass' contents are all recorded into secondary command buffers. The sky box
+     *   gets one per frame from the drawing command pool (it is only ever recorded on the calling thread)
+     *   and every recording thread gets its own command pool per frame, indexed by
+     *   frame * m_numRecordingThreads + thread, because command pools can't be shared across threads
+     */
+    const uint32_t m_numRecordingThreads;
+    std::vector<vk::UniqueCommandBuffer> m_vulkanSkyBoxCommandBufferPtrs;
+    std::vector<vk::UniqueCommandPool> m_vulkanRecordingCommandPoolPtrs;
+    std::vector<vk::UniqueCommandBuffer> m_vulkanRecordingCommandBufferPtrs;
+
+    /**
+     * @brief The recording threads live as long as the swapchain, so a frame never has to spawn threads
+     *   (or allocate their state) to record. The calling thread records the first share itself, so there
+     *   is one fewer of these than m_numRecordingThreads. Bumping the generation hands them the current
+     *   job, and each one that was given a share counts itself as finished once it is done
+     */
+    std::vector<std::thread> m_recordingThreads;
+    std::mutex m_recordingMutex;
+    std::condition_variable m_recordingStartedConditionVariable;
+    std::condition_variable m_recordingFinishedConditionVariable;
+    quartz::rendering::Swapchain::RecordingJob m_currentRecordingJob;
+    uint64_t m_recordingGeneration;
+    uint32_t m_numRecordingThreadsFinished;
+    bool m_shouldStopRecordingThreads;
+    std::array<uint32_t, quartz::rendering::Swapchain::maxNumRecordingThreads> m_recordingThreadNumDraws;
+
+    vk::CommandBufferInheritanceInfo m_currentVulkanCommandBufferInheritanceInfo;
+    std::vector<vk::CommandBuffer> m_vulkanSecondaryCommandBuffersToExecute;
+
+    /**
+     * @brief The light culler's descriptor set for the frame being recorded, bound as set 1 by the doodads
+     */
+    vk::DescriptorSet m_currentLightingVulkanDescriptorSet;
+
+    quartz::rendering::FrustumCuller m_frustumCuller;
+    std::optional<quartz::rendering::GpuCuller> mo_gpuCuller; // only created if the device supports it
+    std::vector<quartz::rendering::GpuCuller::Batch> m_gpuCullingBatches;
+
+    /**
+     * @brief Built from the depth buffer at the end of every occlusion culled frame (and in between the
+     *   two phases). Only created alongside the gpu culler, and recreated with the depth buffer
+     */
+    std::optional<quartz::rendering::DepthPyramid> mo_depthPyramid;
+
+    /**
+     * @brief The view projection matrix the depth pyramid's current contents were drawn with. Empty
+     *   until a frame has built the pyramid, so the first phase knows when it can't occlusion cull yet
+     */
+    std::optional<glm::mat4> mo_depthPyramidViewProjectionMatrix;
+
+    /**
+     * @brief Everything the second phase needs, recorded into the drawing command buffer after the
+     *   first phase's render pass ends. The draws are recorded into secondary command buffers from the
+     *   drawing command pool (one per frame) and executed within the continuation render pass
+     */
+    std::vector<vk::UniqueCommandBuffer> m_vulkanOcclusionCommandBufferPtrs;
+    vk::RenderPassBeginInfo m_currentVulkanContinuationRenderPassBeginInfo;
+    bool m_shouldRecordOcclusionCullingPhase;
+
+    /**
+     * @brief The gpu culler's survivors come out in no particular order, so blended draws skip it and
+     *   are recorded in their sorted order into these (one per frame, from the drawing command pool).
+     *   They are drawn after the first phase, or after the second phase when there is one
+     */
+    std::vector<vk::UniqueCommandBuffer> m_vulkanTranslucentCommandBufferPtrs;
+    std::vector<quartz::rendering::DrawPacket> m_translucentDrawPackets;
+    bool m_shouldDrawTranslucentAfterOcclusionCullingPhase;
+
+    bool m_shouldBuildDepthPyramid;
+    std::array<glm::vec4, 6> m_currentFrustumPlanes;
+    glm::mat4 m_currentViewProjectionMatrix;
+    uint32_t m_numGpuCulledInstances;
+    std::vector<quartz::rendering::DrawPacket> m_drawPackets;
+    std::vector<quartz::rendering::DrawPacket> m_scratchDrawPackets;
+    uint32_t m_numGeometryBindsLastFrame;
+    uint32_t m_numGeometryBindsAvoidedLastFrame;
+    uint32_t m_numDrawsLastFrame;
+
+    /**
+     * @brief One buffer of vk::DrawIndexedIndirectCommands per frame in flight. These don't depend on
+     *   the window at all so they survive swapchain recreation
+     */
+    std::vector<quartz::rendering::LocallyMappedBuffer> m_indirectDrawCommandBuffers;
+
+    /**
+     * @brief Oldest first. Later retirements always finish waiting no earlier than the ones before them,
+     *   so they are only ever released from the front
+     */
+    std::deque<quartz::rendering::Swapchain::RetiredResources> m_retiredResources;
+
+    /**
+     * @brief Bit i is set while frame i's gpu culling descriptor sets still point at a retired depth
+     *   pyramid. They are repointed once the frame has waited for its fence
+     */
+    uint32_t m_staleDepthPyramidDescriptorsMask;
 };
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "quartz/rendering/Loggers.hpp"
 #include "quartz/rendering/buffer/StagedImageBuffer.hpp"
 #include "quartz/rendering/device/Device.hpp"
+#include "quartz/rendering/device/MemoryAccounting.hpp"
 #include "quartz/rendering/texture/Texture.hpp"
 #include "quartz/rendering/vulkan_util/VulkanUtil.hpp"
 
@@ -34,6 +35,12 @@ quartz::rendering::Texture::createTexture(
         quartz::rendering::Texture::initializeMasterTextureList(renderingDevice);
     }
 
+    // Charged on top of the model loading it, so each texture shows up on its own
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope(
+        "texture " + std::to_string(quartz::rendering::Texture::masterTextureList.size()) +
+        " " + (gltfImage.uri.empty() ? gltfImage.name : gltfImage.uri)
+    );
+
     std::shared_ptr<quartz::rendering::Texture> p_texture = std::make_shared<quartz::rendering::Texture>(
         renderingDevice,
         gltfImage,
@@ -59,6 +66,8 @@ quartz::rendering::Texture::initializeMasterTextureList(
         return;
     }
 
+    const quartz::rendering::MemoryAccounting::AssetScope assetScope("default textures");
+
     quartz::rendering::Texture::masterTextureList.reserve(QUARTZ_MAX_NUMBER_TEXTURES);
 
     LOG_TRACE(TEXTURE, "Creating base color default texture");
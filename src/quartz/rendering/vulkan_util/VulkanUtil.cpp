@@ -1,5 +1,9 @@
+#include <string>
+#include <vector>
+
 #include <vulkan/vulkan.hpp>
 
+#include "util/file_system/FileSystem.hpp"
 #include "util/logger/Logger.hpp"
 
 #include "quartz/rendering/Loggers.hpp"
@@ -114,6 +118,29 @@ quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
     const vk::ComponentMapping components,
     const vk::ImageAspectFlags imageAspectFlags,
     const vk::ImageViewType imageViewType // vk::ImageViewType::eCube , vk::ImageViewType::e2D
+) {
+    return quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
+        p_logicalDevice,
+        image,
+        format,
+        components,
+        imageAspectFlags,
+        imageViewType,
+        0,
+        1
+    );
+}
+
+vk::UniqueImageView
+quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::Image& image,
+    const vk::Format format,
+    const vk::ComponentMapping components,
+    const vk::ImageAspectFlags imageAspectFlags,
+    const vk::ImageViewType imageViewType,
+    const uint32_t baseMipLevel,
+    const uint32_t mipLevelCount
 ) {
     LOG_FUNCTION_SCOPE_TRACE(IMAGE, "");
 
@@ -121,6 +148,7 @@ quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
     const uint32_t layerCount = imageViewType == vk::ImageViewType::eCube ? 6 : 1;
     LOG_TRACE(IMAGE, "Using image view type: {}", quartz::rendering::VulkanUtil::toString(imageViewType));
     LOG_TRACE(IMAGE, "Using layer count: {}", layerCount);
+    LOG_TRACE(IMAGE, "Using mip levels [{}, {})", baseMipLevel, baseMipLevel + mipLevelCount);
 
     vk::ImageViewCreateInfo imageViewCreateInfo(
         {},
@@ -130,8 +158,8 @@ quartz::rendering::VulkanUtil::createVulkanImageViewPtr(
         components,
         {
             imageAspectFlags,
-            0,
-            1,
+            baseMipLevel,
+            mipLevelCount,
             0,
             layerCount
         }
@@ -218,13 +246,28 @@ std::vector<vk::UniqueCommandBuffer>
 quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
     const vk::UniqueDevice& p_logicalDevice,
     const vk::UniqueCommandPool& p_commandPool,
+    const uint32_t desiredCommandBufferCount
+) {
+    return quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+        p_logicalDevice,
+        p_commandPool,
+        vk::CommandBufferLevel::ePrimary,
+        desiredCommandBufferCount
+    );
+}
+
+std::vector<vk::UniqueCommandBuffer>
+quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniqueCommandPool& p_commandPool,
+    const vk::CommandBufferLevel commandBufferLevel,
     UNUSED const uint32_t desiredCommandBufferCount
 ) {
-    LOG_FUNCTION_SCOPE_TRACE(VULKANUTIL, "{} command buffers desired", desiredCommandBufferCount);
+    LOG_FUNCTION_SCOPE_TRACE(VULKANUTIL, "{} {} command buffers desired", desiredCommandBufferCount, commandBufferLevel == vk::CommandBufferLevel::ePrimary ? "primary" : "secondary");
 
     vk::CommandBufferAllocateInfo commandBufferAllocateInfo(
         *p_commandPool,
-        vk::CommandBufferLevel::ePrimary,
+        commandBufferLevel,
         desiredCommandBufferCount
     );
 
@@ -246,3 +289,61 @@ quartz::rendering::VulkanUtil::allocateVulkanCommandBufferPtr(
 
     return commandBufferPtrs;
 }
+
+vk::UniqueShaderModule
+quartz::rendering::VulkanUtil::createVulkanShaderModulePtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const std::string& filepath
+) {
+    LOG_FUNCTION_CALL_TRACE(VULKANUTIL, "{}", filepath);
+
+    const std::vector<char> shaderBytes = util::FileSystem::readBytesFromFile(filepath);
+
+    vk::ShaderModuleCreateInfo shaderModuleCreateInfo(
+        {},
+        shaderBytes.size(),
+        reinterpret_cast<const uint32_t*>(shaderBytes.data())
+    );
+
+    vk::UniqueShaderModule p_shaderModule = p_logicalDevice->createShaderModuleUnique(shaderModuleCreateInfo);
+
+    if (!p_shaderModule) {
+        LOG_THROW(VULKANUTIL, util::VulkanCreationFailedError, "Failed to create vk::ShaderModule");
+    }
+
+    return p_shaderModule;
+}
+
+vk::UniquePipeline
+quartz::rendering::VulkanUtil::createVulkanComputePipelinePtr(
+    const vk::UniqueDevice& p_logicalDevice,
+    const vk::UniquePipelineCache& p_pipelineCache,
+    const vk::UniqueShaderModule& p_computeShaderModule,
+    const vk::UniquePipelineLayout& p_pipelineLayout
+) {
+    LOG_FUNCTION_SCOPE_TRACE(VULKANUTIL, "");
+
+    vk::PipelineShaderStageCreateInfo shaderStageCreateInfo(
+        {},
+        vk::ShaderStageFlagBits::eCompute,
+        *p_computeShaderModule,
+        "main"
+    );
+
+    vk::ComputePipelineCreateInfo computePipelineCreateInfo(
+        {},
+        shaderStageCreateInfo,
+        *p_pipelineLayout
+    );
+
+    vk::ResultValue<vk::UniquePipeline> computePipelineCreationResult = p_logicalDevice->createComputePipelineUnique(
+        *p_pipelineCache,
+        computePipelineCreateInfo
+    );
+
+    if (computePipelineCreationResult.result != vk::Result::eSuccess) {
+        LOG_THROW(VULKANUTIL, util::VulkanCreationFailedError, "Failed to create compute vk::Pipeline");
+    }
+
+    return std::move(computePipelineCreationResult.value);
+}
@@ -33,6 +33,16 @@ public: // static functions
         const vk::ImageAspectFlags imageAspectFlags,
         const vk::ImageViewType imageViewType
     );
+    static vk::UniqueImageView createVulkanImageViewPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::Image& image,
+        const vk::Format format,
+        const vk::ComponentMapping components,
+        const vk::ImageAspectFlags imageAspectFlags,
+        const vk::ImageViewType imageViewType,
+        const uint32_t baseMipLevel,
+        const uint32_t mipLevelCount
+    );
 
     static vk::UniqueSampler createVulkanSamplerPtr(
         const vk::PhysicalDevice& vulkanPhysicalDevice,
@@ -56,4 +66,23 @@ public: // static functions
         const vk::UniqueCommandPool& p_commandPool,
         const uint32_t desiredCommandBufferCount
     );
+    static std::vector<vk::UniqueCommandBuffer> allocateVulkanCommandBufferPtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniqueCommandPool& p_commandPool,
+        const vk::CommandBufferLevel commandBufferLevel,
+        const uint32_t desiredCommandBufferCount
+    );
+
+    // ----- compute things ----- //
+
+    static vk::UniqueShaderModule createVulkanShaderModulePtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const std::string& filepath
+    );
+    static vk::UniquePipeline createVulkanComputePipelinePtr(
+        const vk::UniqueDevice& p_logicalDevice,
+        const vk::UniquePipelineCache& p_pipelineCache,
+        const vk::UniqueShaderModule& p_computeShaderModule,
+        const vk::UniquePipelineLayout& p_pipelineLayout
+    );
 };
\ No newline at end of file
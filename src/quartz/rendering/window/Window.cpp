@@ -143,9 +143,10 @@ quartz::rendering::Window::getBestSurfaceFormat(
 vk::PresentModeKHR
 quartz::rendering::Window::getBestPresentMode(
     const vk::UniqueSurfaceKHR& p_surface,
-    const vk::PhysicalDevice& physicalDevice
+    const vk::PhysicalDevice& physicalDevice,
+    const vk::PresentModeKHR desiredPresentMode
 ) {
-    LOG_FUNCTION_SCOPE_TRACE(WINDOW, "");
+    LOG_FUNCTION_SCOPE_TRACE(WINDOW, "desired present mode {}", vk::to_string(desiredPresentMode));
 
     std::vector<vk::PresentModeKHR> presentModes = physicalDevice.getSurfacePresentModesKHR(*p_surface);
 
@@ -153,23 +154,17 @@ quartz::rendering::Window::getBestPresentMode(
         LOG_THROW(WINDOW, util::VulkanFeatureNotSupportedError, "No present modes available for chosen physical device");
     }
 
-    vk::PresentModeKHR bestPresentMode = vk::PresentModeKHR::eFifo;
-
     LOG_TRACE(WINDOW, "Choosing best present mode");
     for (const vk::PresentModeKHR& presentMode : presentModes) {
-        if (presentMode == vk::PresentModeKHR::eMailbox) {
-            bestPresentMode = presentMode;
-            break;
+        if (presentMode == desiredPresentMode) {
+            LOG_TRACE(WINDOW, "Using desired {} present mode", vk::to_string(presentMode));
+            return presentMode;
         }
     }
 
-    if (bestPresentMode == vk::PresentModeKHR::eMailbox) {
-        LOG_TRACE(WINDOW, "Using mailbox present mode");
-    } else {
-        LOG_TRACE(WINDOW, "Using fifo present mode");
-    }
+    LOG_WARNING(WINDOW, "Desired {} present mode is not supported, using fifo present mode instead", vk::to_string(desiredPresentMode));
 
-    return bestPresentMode;
+    return vk::PresentModeKHR::eFifo;
 }
 
 vk::Extent2D
@@ -260,6 +255,7 @@ quartz::rendering::Window::Window(
     const std::string& name,
     const uint32_t windowWidthPixels,
     const uint32_t windowHeightPixels,
+    const vk::PresentModeKHR desiredPresentMode,
     const quartz::rendering::Instance& renderingInstance,
     const quartz::rendering::Device& renderingDevice
 ) :
@@ -292,10 +288,12 @@ quartz::rendering::Window::Window(
             renderingDevice.getVulkanPhysicalDevice()
         )
     ),
+    m_desiredVulkanPresentMode(desiredPresentMode),
     m_vulkanPresentMode(
         quartz::rendering::Window::getBestPresentMode(
             mp_vulkanSurface,
-            renderingDevice.getVulkanPhysicalDevice()
+            renderingDevice.getVulkanPhysicalDevice(),
+            m_desiredVulkanPresentMode
         )
     ),
     m_vulkanExtent(
@@ -354,7 +352,33 @@ quartz::rendering::Window::recreate(
 
     m_vulkanPresentMode = quartz::rendering::Window::getBestPresentMode(
         mp_vulkanSurface,
-        renderingDevice.getVulkanPhysicalDevice()
+        renderingDevice.getVulkanPhysicalDevice(),
+        m_desiredVulkanPresentMode
+    );
+
+    m_vulkanExtent = quartz::rendering::Window::getBestVulkanExtent(
+        mp_glfwWindow,
+        m_vulkanSurfaceCapabilities
+    );
+
+    LOG_TRACEthis("Clearing the \"was resized\" flag");
+    m_wasResized = false;
+}
+
+void
+quartz::rendering::Window::refreshSurfaceCapabilities(
+    const quartz::rendering::Device& renderingDevice
+) {
+    LOG_FUNCTION_SCOPE_TRACEthis("");
+
+    m_vulkanSurfaceCapabilities = renderingDevice.getVulkanPhysicalDevice().getSurfaceCapabilitiesKHR(
+        *mp_vulkanSurface
+    );
+
+    m_vulkanPresentMode = quartz::rendering::Window::getBestPresentMode(
+        mp_vulkanSurface,
+        renderingDevice.getVulkanPhysicalDevice(),
+        m_desiredVulkanPresentMode
     );
 
     m_vulkanExtent = quartz::rendering::Window::getBestVulkanExtent(
@@ -391,3 +415,11 @@ quartz::rendering::Window::setShouldDisplayCursor(
         glfwSetInputMode(mp_glfwWindow.get(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
 }
+
+void
+quartz::rendering::Window::setDesiredVulkanPresentMode(
+    const vk::PresentModeKHR desiredPresentMode
+) {
+    LOG_TRACEthis("Desiring {} present mode", vk::to_string(desiredPresentMode));
+    m_desiredVulkanPresentMode = desiredPresentMode;
+}
@@ -22,6 +22,7 @@ public: // member functions
         const std::string& name,
         const uint32_t widthPixels,
         const uint32_t heightPixels,
+        const vk::PresentModeKHR desiredPresentMode,
         const quartz::rendering::Instance& renderingInstance,
         const quartz::rendering::Device& renderingDevice
     );
@@ -33,12 +34,22 @@ public: // member functions
         const quartz::rendering::Device& renderingDevice
     );
 
+    /**
+     * @brief Query the surface's capabilities and extent again after a resize (and choose the present mode
+     *   again, in case the desired one changed), keeping the surface itself and the surface format chosen
+     *   for it so nothing built from them needs rebuilding
+     */
+    void refreshSurfaceCapabilities(
+        const quartz::rendering::Device& renderingDevice
+    );
+
     USE_LOGGER(WINDOW);
 
     const std::shared_ptr<GLFWwindow>& getGLFWwindowPtr() const { return mp_glfwWindow; }
     const vk::UniqueSurfaceKHR& getVulkanSurfacePtr() const { return mp_vulkanSurface; }
     const vk::SurfaceCapabilitiesKHR& getVulkanSurfaceCapabilities() const { return m_vulkanSurfaceCapabilities; }
     const vk::SurfaceFormatKHR& getVulkanSurfaceFormat() const { return m_vulkanSurfaceFormat; }
+    const vk::PresentModeKHR& getDesiredVulkanPresentMode() const { return m_desiredVulkanPresentMode; }
     const vk::PresentModeKHR& getVulkanPresentMode() const { return m_vulkanPresentMode; }
     const vk::Extent2D& getVulkanExtent() const { return m_vulkanExtent; }
     const vk::Format& getVulkanDepthBufferFormat() const { return m_vulkanDepthBufferFormat; }
@@ -48,6 +59,12 @@ public: // member functions
 
     void setShouldDisplayCursor(const bool shouldDisplayCursor);
 
+    /**
+     * @brief Only takes effect the next time the surface capabilities are refreshed (when the swapchain is
+     *   recreated). Falls back to fifo, which every device supports, when the desired mode isn't supported
+     */
+    void setDesiredVulkanPresentMode(const vk::PresentModeKHR desiredPresentMode);
+
 public: // static functions
     // The callback we give to glfw to use when it resizes the window
     static void glfwFramebufferSizeCallback(
@@ -73,7 +90,8 @@ private: // static functions
     );
     static vk::PresentModeKHR getBestPresentMode(
         const vk::UniqueSurfaceKHR& p_surface,
-        const vk::PhysicalDevice& physicalDevice
+        const vk::PhysicalDevice& physicalDevice,
+        const vk::PresentModeKHR desiredPresentMode
     );
     static vk::Extent2D getBestVulkanExtent(
         const std::shared_ptr<const GLFWwindow>& p_GLFWwindow,
@@ -95,6 +113,7 @@ private: // member variables
     vk::UniqueSurfaceKHR mp_vulkanSurface;
     vk::SurfaceCapabilitiesKHR m_vulkanSurfaceCapabilities;
     vk::SurfaceFormatKHR m_vulkanSurfaceFormat;
+    vk::PresentModeKHR m_desiredVulkanPresentMode;
     vk::PresentModeKHR m_vulkanPresentMode;
     vk::Extent2D m_vulkanExtent;
 
@@ -1,6 +1,11 @@
+#include <array>
 #include <chrono>
+#include <cmath>
 
+#include <glm/geometric.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "quartz/scene/camera/Camera.hpp"
@@ -23,6 +28,35 @@ quartz::scene::Camera::UniformBufferObject::UniformBufferObject(
     projectionMatrix(camera.m_projectionMatrix)
 {}
 
+std::array<glm::vec4, 6>
+quartz::scene::Camera::calculateFrustumPlanes(
+    const glm::mat4& viewMatrix,
+    const glm::mat4& projectionMatrix
+) {
+    const glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+
+    const glm::vec4 row0 = glm::row(viewProjectionMatrix, 0);
+    const glm::vec4 row1 = glm::row(viewProjectionMatrix, 1);
+    const glm::vec4 row2 = glm::row(viewProjectionMatrix, 2);
+    const glm::vec4 row3 = glm::row(viewProjectionMatrix, 3);
+
+    // Clip space depth goes from 0 to 1 in vulkan, so the near plane is just the third row
+    std::array<glm::vec4, 6> frustumPlanes = {
+        row3 + row0, // left
+        row3 - row0, // right
+        row3 + row1, // bottom
+        row3 - row1, // top
+        row2,        // near
+        row3 - row2  // far
+    };
+
+    for (glm::vec4& frustumPlane : frustumPlanes) {
+        frustumPlane /= glm::length(glm::vec3(frustumPlane));
+    }
+
+    return frustumPlanes;
+}
+
 quartz::scene::Camera::Camera() :
     m_pitch(0.0f),
     m_yaw(0.0f),
@@ -34,7 +68,8 @@ quartz::scene::Camera::Camera() :
         0.0f
     ),
     m_viewMatrix(),
-    m_projectionMatrix()
+    m_projectionMatrix(),
+    m_frustumPlanes()
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
@@ -52,7 +87,8 @@ quartz::scene::Camera::Camera(
     m_fovDegrees(fovDegrees),
     m_worldPosition(worldPosition),
     m_viewMatrix(),
-    m_projectionMatrix()
+    m_projectionMatrix(),
+    m_frustumPlanes()
 {
     LOG_FUNCTION_CALL_TRACEthis("");
 }
@@ -73,6 +109,7 @@ quartz::scene::Camera::operator=(
     m_fovDegrees = other.m_fovDegrees;
     m_worldPosition = other.m_worldPosition;
     m_viewMatrix = other.m_viewMatrix;
+    m_frustumPlanes = other.m_frustumPlanes;
 
     return *this;
 }
@@ -174,10 +211,30 @@ quartz::scene::Camera::update(
     m_projectionMatrix = glm::perspective(
         glm::radians(m_fovDegrees),
         windowWidth / windowHeight,
-        0.1f,
-        1000.0f
+        quartz::scene::Camera::nearPlaneDistance,
+        quartz::scene::Camera::farPlaneDistance
     );
 
     // Because glm is meant for OpenGL where Y clip coordinate is inverted
     m_projectionMatrix[1][1] *= -1;
+
+    m_frustumPlanes = quartz::scene::Camera::calculateFrustumPlanes(
+        m_viewMatrix,
+        m_projectionMatrix
+    );
+}
+
+float
+quartz::scene::Camera::calculateScreenSize(
+    const glm::vec3& worldCenter,
+    const float worldRadius
+) const {
+    const float distance = glm::length(worldCenter - m_worldPosition);
+
+    if (distance <= worldRadius) {
+        return 1.0f;
+    }
+
+    // The projected diameter in normalized device coordinates, over the height of the screen (2)
+    return worldRadius * std::abs(m_projectionMatrix[1][1]) / distance;
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
+
 #include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
 
 #include "quartz/managers/input_manager/InputManager.hpp"
 #include "quartz/scene/Loggers.hpp"
@@ -52,6 +55,7 @@ public: // member functions
     const glm::vec3& getWorldPosition() const { return m_worldPosition; }
     const glm::mat4& getViewMatrix() const { return m_viewMatrix; }
     const glm::mat4& getProjectionMatrix() const { return m_projectionMatrix; }
+    const std::array<glm::vec4, 6>& getFrustumPlanes() const { return m_frustumPlanes; }
 
     void update(
         const float windowWidth,
@@ -60,7 +64,29 @@ public: // member functions
         const double tickTimeDelta
     );
 
+    /**
+     * @brief Roughly how much of the screen's height a sphere covers, from 0 when it is infinitely far
+     *   away to 1 when it fills the screen. Spheres the camera is inside of always cover the whole screen
+     */
+    float calculateScreenSize(
+        const glm::vec3& worldCenter,
+        const float worldRadius
+    ) const;
+
+public: // static variables
+    static constexpr float nearPlaneDistance = 0.1f;
+    static constexpr float farPlaneDistance = 1000.0f;
+
 private: // static functions
+    /**
+     * @brief Extract the left, right, bottom, top, near, and far planes from the combined view projection
+     *   matrix. Each plane is (normal, distance) in world space with the normal pointing into the frustum
+     *   and normalized, so dot(normal, point) + distance is the signed distance of the point to the plane
+     */
+    static std::array<glm::vec4, 6> calculateFrustumPlanes(
+        const glm::mat4& viewMatrix,
+        const glm::mat4& projectionMatrix
+    );
 
 private: // member variables
     float m_pitch;
@@ -71,4 +97,5 @@ private: // member variables
 
     glm::mat4 m_viewMatrix;
     glm::mat4 m_projectionMatrix;
+    std::array<glm::vec4, 6> m_frustumPlanes;
 };
\ No newline at end of file
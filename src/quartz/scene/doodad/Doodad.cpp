@@ -1,3 +1,4 @@
+#include <memory>
 #include <string>
 
 #include <glm/mat4x4.hpp>
@@ -11,9 +12,11 @@ quartz::scene::Doodad::Doodad(
     const std::string& objectFilepath,
     const quartz::scene::Transform& transform
 ) :
-    m_model(
-        renderingDevice,
-        objectFilepath
+    mp_model(
+        quartz::rendering::Model::loadModel(
+            renderingDevice,
+            objectFilepath
+        )
     ),
     m_transform(transform),
     m_transformationMatrix()
@@ -29,7 +32,7 @@ quartz::scene::Doodad::Doodad(
 quartz::scene::Doodad::Doodad(
     quartz::scene::Doodad&& other
 ) :
-    m_model(std::move(other.m_model)),
+    mp_model(std::move(other.mp_model)),
     m_transform(other.m_transform),
     m_transformationMatrix(other.m_transformationMatrix)
 {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include <glm/vec3.hpp>
@@ -28,7 +29,8 @@ public: // member functions
 
     USE_LOGGER(DOODAD);
 
-    const quartz::rendering::Model& getModel() const { return m_model; }
+    const quartz::rendering::Model& getModel() const { return *mp_model; }
+    const std::shared_ptr<const quartz::rendering::Model>& getModelPtr() const { return mp_model; }
     const glm::mat4& getTransformationMatrix() const { return m_transformationMatrix; }
 
     void update(const double tickTimeDelta);
@@ -36,7 +38,10 @@ public: // member functions
 private: // static functions
 
 private: // member variables
-    quartz::rendering::Model m_model;
+    /**
+     * @brief Shared with every other doodad using the same model file
+     */
+    std::shared_ptr<const quartz::rendering::Model> mp_model;
 
     quartz::scene::Transform m_transform;
 
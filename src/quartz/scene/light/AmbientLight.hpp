@@ -15,6 +15,11 @@ public: // member functions
     AmbientLight(const AmbientLight& other);
     AmbientLight& operator=(const AmbientLight& other);
 
+    /**
+     * @brief So the scene can tell when setting a light doesn't change anything
+     */
+    bool operator==(const AmbientLight& other) const = default;
+
 public: // member variables
     alignas(16) glm::vec3 color;
 };
\ No newline at end of file
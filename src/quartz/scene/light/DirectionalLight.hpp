@@ -18,6 +18,8 @@ public: // member functions
     DirectionalLight(const DirectionalLight& other);
     DirectionalLight& operator=(const DirectionalLight& other);
 
+    bool operator==(const DirectionalLight& other) const = default;
+
 public: // member variables
     alignas(16) glm::vec3 color;
     alignas(16) glm::vec3 direction;
@@ -18,6 +18,8 @@ public: // member functions
         const float attenuationQuadraticFactor_
     );
 
+    bool operator==(const PointLight& other) const = default;
+
 public: // member variables
     alignas(16) glm::vec3 color;
     alignas(16) glm::vec3 position;
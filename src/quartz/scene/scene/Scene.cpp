@@ -4,6 +4,8 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include "quartz/managers/input_manager/InputManager.hpp"
+#include "quartz/rendering/buffer/GeometryPool.hpp"
+#include "quartz/rendering/buffer/UploadQueue.hpp"
 #include "quartz/rendering/device/Device.hpp"
 #include "quartz/rendering/texture/Texture.hpp"
 #include "quartz/rendering/window/Window.hpp"
@@ -42,10 +44,29 @@ quartz::scene::Scene::loadDoodads(
     return doodads;
 }
 
+quartz::scene::Scene::Scene() :
+    m_camera(),
+    m_doodads(),
+    m_skyBox(),
+    m_ambientLight(),
+    m_directionalLight(),
+    m_pointLights(),
+    m_spotLights(),
+    m_ambientLightRevision(0),
+    m_directionalLightRevision(0),
+    m_pointLightsRevision(0),
+    m_spotLightsRevision(0),
+    m_screenClearColor()
+{}
+
 quartz::scene::Scene::~Scene() {
     LOG_FUNCTION_CALL_TRACEthis("");
+    LOG_TRACEthis("Waiting for and cleaning up all upload batches");
+    quartz::rendering::UploadQueue::cleanUpAllBatches();
     LOG_TRACEthis("Cleaning up all textures");
     quartz::rendering::Texture::cleanUpAllTextures();
+    LOG_TRACEthis("Cleaning up all geometry blocks");
+    quartz::rendering::GeometryPool::cleanUpAllBlocks();
 }
 
 void
@@ -89,19 +110,26 @@ quartz::scene::Scene::load(
     LOG_TRACEthis("Loaded {} doodads", m_doodads.size());
 
     m_ambientLight = ambientLight;
+    ++m_ambientLightRevision;
     LOG_TRACEthis("Loaded ambient light with color {}", glm::to_string(m_ambientLight.color));
 
     m_directionalLight = directionalLight;
+    ++m_directionalLightRevision;
     LOG_TRACEthis("Loaded directional light with color {} and direction {}", glm::to_string(m_directionalLight.color), glm::to_string(m_directionalLight.direction));
 
     m_pointLights = pointLights;
+    ++m_pointLightsRevision;
     LOG_TRACEthis("Loaded {} point lights", m_pointLights.size());
 
     m_spotLights = spotLights;
+    ++m_spotLightsRevision;
     LOG_TRACEthis("Loaded {} spot lights", m_spotLights.size());
 
     m_screenClearColor = screenClearColor;
     LOG_TRACEthis("Loaded screen clear color {}", glm::to_string(m_screenClearColor));
+
+    const uint64_t uploadBatchId = quartz::rendering::UploadQueue::submit(renderingDevice);
+    LOG_TRACEthis("Submitted scene's uploads up to batch {}", uploadBatchId);
 }
 
 void
@@ -120,4 +148,80 @@ quartz::scene::Scene::update(
     for (quartz::scene::Doodad& doodad : m_doodads) {
         doodad.update(tickTimeDelta);
     }
-}
\ No newline at end of file
+}
+
+void
+quartz::scene::Scene::setAmbientLight(const quartz::scene::AmbientLight& ambientLight) {
+    if (ambientLight == m_ambientLight) {
+        return;
+    }
+
+    m_ambientLight = ambientLight;
+    ++m_ambientLightRevision;
+}
+
+void
+quartz::scene::Scene::setDirectionalLight(const quartz::scene::DirectionalLight& directionalLight) {
+    if (directionalLight == m_directionalLight) {
+        return;
+    }
+
+    m_directionalLight = directionalLight;
+    ++m_directionalLightRevision;
+}
+
+void
+quartz::scene::Scene::setPointLight(
+    const uint32_t index,
+    const quartz::scene::PointLight& pointLight
+) {
+    if (index >= m_pointLights.size()) {
+        LOG_WARNINGthis("Point light index {} is out of range of the {} point lights. Not setting it", index, m_pointLights.size());
+        return;
+    }
+
+    if (pointLight == m_pointLights[index]) {
+        return;
+    }
+
+    m_pointLights[index] = pointLight;
+    ++m_pointLightsRevision;
+}
+
+void
+quartz::scene::Scene::setPointLights(const std::vector<quartz::scene::PointLight>& pointLights) {
+    if (pointLights == m_pointLights) {
+        return;
+    }
+
+    m_pointLights = pointLights;
+    ++m_pointLightsRevision;
+}
+
+void
+quartz::scene::Scene::setSpotLight(
+    const uint32_t index,
+    const quartz::scene::SpotLight& spotLight
+) {
+    if (index >= m_spotLights.size()) {
+        LOG_WARNINGthis("Spot light index {} is out of range of the {} spot lights. Not setting it", index, m_spotLights.size());
+        return;
+    }
+
+    if (spotLight == m_spotLights[index]) {
+        return;
+    }
+
+    m_spotLights[index] = spotLight;
+    ++m_spotLightsRevision;
+}
+
+void
+quartz::scene::Scene::setSpotLights(const std::vector<quartz::scene::SpotLight>& spotLights) {
+    if (spotLights == m_spotLights) {
+        return;
+    }
+
+    m_spotLights = spotLights;
+    ++m_spotLightsRevision;
+}
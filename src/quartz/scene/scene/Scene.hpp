@@ -27,7 +27,7 @@ namespace scene {
 
 class quartz::scene::Scene {
 public: // member functions
-    Scene() = default;
+    Scene();
     ~Scene();
 
     USE_LOGGER(SCENE);
@@ -41,6 +41,22 @@ public: // member functions
     const std::vector<quartz::scene::SpotLight>& getSpotLights() const { return m_spotLights; }
     const glm::vec3& getScreenClearColor() const { return m_screenClearColor; }
 
+    /**
+     * @brief Each of these is bumped whenever its lights change, so the renderer can tell when the copies
+     *   it already uploaded are stale instead of uploading them every frame
+     */
+    uint64_t getAmbientLightRevision() const { return m_ambientLightRevision; }
+    uint64_t getDirectionalLightRevision() const { return m_directionalLightRevision; }
+    uint64_t getPointLightsRevision() const { return m_pointLightsRevision; }
+    uint64_t getSpotLightsRevision() const { return m_spotLightsRevision; }
+
+    void setAmbientLight(const quartz::scene::AmbientLight& ambientLight);
+    void setDirectionalLight(const quartz::scene::DirectionalLight& directionalLight);
+    void setPointLight(const uint32_t index, const quartz::scene::PointLight& pointLight);
+    void setPointLights(const std::vector<quartz::scene::PointLight>& pointLights);
+    void setSpotLight(const uint32_t index, const quartz::scene::SpotLight& spotLight);
+    void setSpotLights(const std::vector<quartz::scene::SpotLight>& spotLights);
+
     void load(
         const quartz::rendering::Device& renderingDevice,
         const quartz::scene::Camera& camera,
@@ -76,5 +92,10 @@ private: // member variables
     std::vector<quartz::scene::PointLight> m_pointLights;
     std::vector<quartz::scene::SpotLight> m_spotLights;
 
+    uint64_t m_ambientLightRevision;
+    uint64_t m_directionalLightRevision;
+    uint64_t m_pointLightsRevision;
+    uint64_t m_spotLightsRevision;
+
     glm::vec3 m_screenClearColor;
 };
\ No newline at end of file
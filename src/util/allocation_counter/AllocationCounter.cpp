@@ -0,0 +1,59 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "util/allocation_counter/AllocationCounter.hpp"
+
+namespace {
+    std::atomic<uint64_t> numAllocations = 0;
+}
+
+bool
+util::AllocationCounter::getIsCounting() {
+#if defined QUARTZ_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t
+util::AllocationCounter::getNumAllocations() {
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+#if defined QUARTZ_COUNT_ALLOCATIONS
+
+/**
+ * @brief Replacing the four basic forms is enough, every other form of operator new and operator delete
+ *   (nothrow, array, sized) forwards to these by default. Aligned allocations are left alone
+ */
+
+void*
+operator new(std::size_t sizeBytes) {
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* p_memory = std::malloc(sizeBytes == 0 ? 1 : sizeBytes);
+    if (!p_memory) {
+        throw std::bad_alloc();
+    }
+
+    return p_memory;
+}
+
+void*
+operator new[](std::size_t sizeBytes) {
+    return ::operator new(sizeBytes);
+}
+
+void
+operator delete(void* p_memory) noexcept {
+    std::free(p_memory);
+}
+
+void
+operator delete[](void* p_memory) noexcept {
+    ::operator delete(p_memory);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace util {
+    class AllocationCounter;
+}
+
+/**
+ * @brief Counts every call to the global operator new. The counting replacements of operator new and
+ *   operator delete are only compiled in when QUARTZ_COUNT_ALLOCATIONS is defined (configure with
+ *   -DQUARTZ_COUNT_ALLOCATIONS=ON), otherwise the count just stays at zero
+ */
+class util::AllocationCounter {
+public:
+    static bool getIsCounting();
+    static uint64_t getNumAllocations();
+};
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <filesystem>
 #include <fstream>
 
 #include "util/platform.hpp"
@@ -21,6 +22,12 @@ util::FileSystem::getCompiledShaderAbsoluteFilepath(const std::string& shaderSou
     return std::string(SHADER_BINARY_DIR) + std::string("/") + shaderSourceFilename + std::string(".spv");
 }
 
+bool
+util::FileSystem::fileExists(const std::string& filepath) {
+    std::error_code errorCode;
+    return std::filesystem::is_regular_file(filepath, errorCode);
+}
+
 std::vector<char>
 util::FileSystem::readBytesFromFile(const std::string& filepath) {
     LOG_FUNCTION_SCOPE_TRACE(FILESYSTEM, "{}", filepath);
@@ -45,6 +52,42 @@ util::FileSystem::readBytesFromFile(const std::string& filepath) {
     return bytes;
 }
 
+void
+util::FileSystem::writeBytesToFile(const std::string& filepath, const std::vector<char>& bytes) {
+    LOG_FUNCTION_SCOPE_TRACE(FILESYSTEM, "{}", filepath);
+
+    // Write everything somewhere else first so a failed or interrupted write never leaves half a file behind
+    const std::string temporaryFilepath = filepath + ".tmp";
+    std::ofstream outfile(temporaryFilepath, std::ios::trunc | std::ios::binary);
+
+    if (!outfile.is_open()) {
+        LOG_CRITICAL(FILESYSTEM, "Failed to open {} for binary writing", temporaryFilepath);
+        throw std::runtime_error("");
+    }
+
+    outfile.write(bytes.data(), bytes.size());
+
+    outfile.close();
+
+    if (outfile.fail()) {
+        LOG_CRITICAL(FILESYSTEM, "Failed to write {} bytes to {}", bytes.size(), temporaryFilepath);
+        std::error_code errorCode;
+        std::filesystem::remove(temporaryFilepath, errorCode);
+        throw std::runtime_error("");
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryFilepath, filepath, errorCode);
+
+    if (errorCode) {
+        LOG_CRITICAL(FILESYSTEM, "Failed to replace {} with {}: {}", filepath, temporaryFilepath, errorCode.message());
+        std::filesystem::remove(temporaryFilepath, errorCode);
+        throw std::runtime_error("");
+    }
+
+    LOG_TRACE(FILESYSTEM, "Successfully wrote {} bytes", bytes.size());
+}
+
 std::string
 util::FileSystem::getFileExtension(const std::string& filepath) {
     return filepath.substr(filepath.find_last_of('.') + 1);
@@ -12,7 +12,9 @@ public:
     static std::string getAbsoluteFilepathInProjectDirectory(const std::string& filepathInProjectDirectory);
     static std::string getAbsoluteFilepathInBinaryDirectory(const std::string& filepathInBinaryDirectory);
     static std::string getCompiledShaderAbsoluteFilepath(const std::string& shaderSourceFilename);
+    static bool fileExists(const std::string& filepath);
     static std::vector<char> readBytesFromFile(const std::string& filepath);
+    static void writeBytesToFile(const std::string& filepath, const std::vector<char>& bytes); // through filepath.tmp, so a failed write leaves the old file intact
     static std::string getFileExtension(const std::string& filepath);
 
 public:
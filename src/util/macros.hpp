@@ -118,10 +118,6 @@
 #define QUARTZ_MAX_NUMBER_MATERIALS -1
 #endif
 
-#ifndef QUARTZ_MAX_NUMBER_POINT_LIGHTS
-#define QUARTZ_MAX_NUMBER_POINT_LIGHTS -1
-#endif
-
-#ifndef QUARTZ_MAX_NUMBER_SPOT_LIGHTS
-#define QUARTZ_MAX_NUMBER_SPOT_LIGHTS -1
+#ifndef QUARTZ_MAX_NUMBER_DRAWS
+#define QUARTZ_MAX_NUMBER_DRAWS -1
 #endif
\ No newline at end of file